@@ -12,6 +12,10 @@ double daxpy(const int &n, const double& a, const double *x,const int& incx,
 double dcopy(const int &n, const double *x,const int& incx,
         const double *y,const int& incy);
 double dnrm2(const int &n, const double *x,const int& incx);
+void dgemm(const char *transa, const char *transb, const int& m,
+        const int& n, const int& k, const double& alpha, const double *a,
+        const int& lda, const double *b, const int& ldb, const double& beta,
+        double *c, const int& ldc);
 void dgetrf(int&,int&,double*,int&,int*,int&);
 void dgetri(int&,double*,int&,int*,double*,int&,int&);
 double dlamch(const char *cmach);
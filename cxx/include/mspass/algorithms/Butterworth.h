@@ -380,6 +380,8 @@ private:
     const double astop, const double apass);
   void set_hi(const double fstop, const double fpass,
     const double astop, const double apass);
+  /* Applies the filter in place to n samples starting at d. */
+  void filter_samples(double *d, const int n);
 };
 }  // namespace end
 #endif
@@ -0,0 +1,166 @@
+#ifndef _ENSEMBLE_WORKERS_H_
+#define _ENSEMBLE_WORKERS_H_
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/Metadata.h"
+#include "mspass/seismic/Ensemble.h"
+namespace mspass::algorithms{
+/*! \brief Return the number of worker threads to use for n members.
+
+\param nthreads is the requested number of threads.  0 means use the
+  number of hardware threads.
+\param n is the number of members to process.
+\return number of threads to start (at least 1 and never more than n).
+*/
+inline size_t ensemble_worker_count(const size_t nthreads, const size_t n)
+{
+  size_t nt=nthreads;
+  if(nt==0) nt=std::thread::hardware_concurrency();
+  return std::max(std::min(nt,n),static_cast<size_t>(1));
+}
+/*! \brief Call a function for indices 0 to n-1 with a pool of threads.
+
+This template is the engine used by the ensemble versions of the
+algorithms in mspass.  It starts a pool of threads that take the next
+index from a shared counter, so the load is balanced when the work
+for each index (normally one ensemble member) is very different.
+
+Operators like Butterworth cache state that depends on the data
+(e.g. the sample interval), so they cannot be shared by threads.  Each
+thread works with its own copy of op made with the copy constructor.
+
+No python code may be called by f because the python bindings run this
+function with the GIL released (see hold_python_objects).
+
+\param n is the number of indices.
+\param op is the operator cloned for each thread.
+\param f is called as f(local_op,i) for each index.
+\param nthreads is the number of threads (default 1, 0 means all hardware threads).
+\exception f should handle its own errors.  If f throws, the threads
+  stop taking new indices and the first exception is rethrown after all
+  threads finish.
+*/
+template <typename Operator, typename Function>
+  void for_each_index(const size_t n, const Operator& op, Function f,
+    const size_t nthreads=1)
+{
+  std::atomic<size_t> next(0);
+  std::exception_ptr first_error;
+  std::mutex error_lock;
+  auto worker=[&](){
+    try{
+      Operator local(op);
+      size_t i;
+      while((i=next.fetch_add(1))<n) f(local,i);
+    }catch(...)
+    {
+      std::lock_guard<std::mutex> guard(error_lock);
+      if(!first_error) first_error=std::current_exception();
+      next.store(n);
+    }
+  };
+  size_t nt=ensemble_worker_count(nthreads,n);
+  if(nt==1)
+    worker();
+  else
+  {
+    std::vector<std::thread> pool;
+    for(size_t k=0;k<nt;++k) pool.emplace_back(worker);
+    for(auto& t : pool) t.join();
+  }
+  if(first_error) std::rethrow_exception(first_error);
+}
+/* Placeholder operator for functions that need no operator object */
+class NullOperator{};
+/*! \brief Apply a function to every live member of an ensemble with a pool of threads.
+
+Errors are handled per member as in the python wrappers.  An exception
+thrown while processing a member is posted to the member's elog and
+the member is killed.  Other members are not affected.  Dead members
+are skipped.   Each member is given to exactly one thread, so f may change
+member i but must not change or read other members.  Members can share
+samples and Metadata with each other.  That is safe because the copy on
+write tests in SampleVector and MetadataMap use sole_owner.
+
+\param member is the vector of members to process.
+\param op is the operator cloned for each thread (see for_each_index).
+\param f is called as f(local_op,member[i],i) for each live member.
+\param alg is the algorithm name used for error messages.
+\param nthreads is the number of threads (default 1, 0 means all hardware threads).
+*/
+template <typename Tdata, typename Operator, typename Function>
+  void for_each_member(std::vector<Tdata>& member, const Operator& op,
+    Function f, const std::string alg, const size_t nthreads=1)
+{
+  for_each_index(member.size(),op,[&](Operator& local, const size_t i){
+      Tdata& d=member[i];
+      if(d.dead()) return;
+      try{
+        f(local,d,i);
+      }catch(mspass::utility::MsPASSError& err)
+      {
+        d.elog.log_error(err);
+        d.kill();
+      }catch(std::exception& err)
+      {
+        d.elog.log_error(alg,err.what(),mspass::utility::ErrorSeverity::Invalid);
+        d.kill();
+      }
+    },nthreads);
+}
+/*! \brief Apply a function that needs no operator object to every live member.
+
+Same as the operator version but f is called as f(member[i],i).
+*/
+template <typename Tdata, typename Function>
+  void for_each_member(std::vector<Tdata>& member, Function f,
+    const std::string alg, const size_t nthreads=1)
+{
+  for_each_member(member,NullOperator(),
+    [&f](NullOperator&, Tdata& d, const size_t i){f(d,i);},alg,nthreads);
+}
+/*! \brief Apply an operator with an apply method to every live member.
+
+Works for any operator with an apply(Tdata&) method and a copy
+constructor.  That includes Butterworth and the taper family.
+
+\param op is the operator to apply.   op itself is not altered.
+\param d is the ensemble to process.  Members are altered in place.
+\param nthreads is the number of threads (default 1, 0 means all hardware threads).
+*/
+template <typename Operator, typename Tdata>
+  void apply_to_members(const Operator& op, mspass::seismic::Ensemble<Tdata>& d,
+    const size_t nthreads=1)
+{
+  for_each_member(d.member,op,[](Operator& local, Tdata& m, const size_t){
+      local.apply(m);
+    },"apply_to_members",nthreads);
+}
+/*! \brief Test if any Metadata value of an ensemble is a python object.
+
+Copying or destroying a python object requires the python GIL.  The
+python bindings of the ensemble entry points release the GIL only when
+this function returns false.  Otherwise they run with one thread and the
+GIL held.
+*/
+template <typename Tdata>
+  bool hold_python_objects(const mspass::seismic::Ensemble<Tdata>& d)
+{
+  auto test=[](const mspass::utility::Metadata& md){
+    for(auto mdptr=md.begin();mdptr!=md.end();++mdptr)
+      if(mdptr->second.type()==typeid(pybind11::object)) return true;
+    return false;
+  };
+  if(test(d)) return true;
+  for(auto& m : d.member)
+    if(test(m)) return true;
+  return false;
+}
+}  // End namespace mspass::algorithms
+#endif
@@ -0,0 +1,99 @@
+#ifndef _MSPASS_GATHER_MATRIX_H_
+#define _MSPASS_GATHER_MATRIX_H_
+#include <vector>
+#include "mspass/utility/dmatrix.h"
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Ensemble.h"
+namespace mspass::algorithms{
+/*! \brief Dense matrix form of a TimeSeries ensemble.
+
+Array methods like stacking, semblance, f-k analysis, SVD, and
+beamforming are matrix operations on a gather.  Running them across the
+separate sample vectors of ensemble members is slow.  This class copies
+the members into a single dmatrix with one column per member.   Columns
+are contiguous because dmatrix uses Fortran order, so the matrix can be
+passed directly to BLAS level 3 and LAPACK functions or used with
+matmul.
+
+All columns share one time axis.  It spans the earliest start time and
+the latest end time of the members used.   Each member is placed at the
+nearest sample of that axis and samples outside a member's time span are
+zero.   Time shifts smaller than one sample are not interpolated.
+
+Column j always holds member j.   The column of a dead member, or of a
+member with a sample interval different from that of the first live
+member, is all zeros and is marked false in the liveness mask.
+
+After processing, scatter copies the columns of the live members back
+into the samples of the ensemble members.
+*/
+class GatherMatrix
+{
+public:
+  /*! Default constructor.  Creates an empty matrix with no members.
+  The matrix is also empty if the ensemble has no live members. */
+  GatherMatrix();
+  /*! \brief Build from an ensemble.
+
+  \param d is the ensemble to be copied.
+  \param dt_tolerance is the fractional difference of the sample
+    interval from that of the first live member that is accepted.
+  \param max_npts is the largest number of samples (rows) accepted for
+    the common time axis.   It guards against a huge allocation for an
+    ensemble whose members are far apart in time.  The default is a bit
+    more than one day of data sampled at 100 samples per second.
+
+  \exception MsPASSError if the live members do not use the same time
+    reference (UTC or relative), if the sample interval of the first live
+    member is not positive, if a member has an invalid start time, or if
+    the time axis would need more than max_npts samples.
+  */
+  GatherMatrix(const mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>& d,
+    const double dt_tolerance=0.0001, const size_t max_npts=10000000);
+  /*! \brief Copy the columns of live members back into an ensemble.
+
+  The samples of member j are replaced by the rows of column j that
+  span the time range of member j when this object was built.  Members
+  with a false mask value and members that are now dead are not
+  changed.  The ensemble is normally the one this object was built from.
+
+  \exception MsPASSError if the number of members or the number of
+    samples of a live member differs from the ensemble used to build
+    this object.
+  */
+  void scatter(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>& d) const;
+  /*! Return the matrix.   Rows are samples and columns are members. */
+  mspass::utility::dmatrix& matrix() {return gather;};
+  const mspass::utility::dmatrix& matrix() const {return gather;};
+  /*! Return number of samples (rows) on the common time axis. */
+  size_t npts() const {return nsamp;};
+  /*! Return number of members (columns). */
+  size_t members() const {return mask.size();};
+  /*! Return number of columns holding data from a live member. */
+  size_t number_live() const;
+  /*! Return true if column j holds data from a live member. */
+  bool live(const size_t j) const {return mask.at(j);};
+  /*! Return the liveness mask.  One value for each column. */
+  const std::vector<bool>& live_mask() const {return mask;};
+  /*! Return time of the first row. */
+  double t0() const {return mt0;};
+  /*! Return the sample interval. */
+  double dt() const {return mdt;};
+  /*! Return the time of row i. */
+  double time(const int i) const {return mt0+mdt*static_cast<double>(i);};
+  /*! Return the row nearest time t.  The result can be outside the matrix. */
+  int sample_number(const double t) const;
+  /*! Return the row that holds the first sample of member j. */
+  size_t row_offset(const size_t j) const {return offset.at(j);};
+private:
+  mspass::utility::dmatrix gather;
+  std::vector<bool> mask;
+  /* First row and number of samples of each member when this was built */
+  std::vector<size_t> offset;
+  std::vector<size_t> member_npts;
+  size_t nsamp;
+  double mt0;
+  double mdt;
+};
+}  // End namespace mspass::algorithms
+#endif
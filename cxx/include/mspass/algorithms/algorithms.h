@@ -34,6 +34,22 @@ This function does not throw an exception, but can post errors to the
 ErrorLogger object that is a member of Seismogram.
 */
 mspass::seismic::TimeSeries agc(mspass::seismic::Seismogram& d,const double twin);
+/*! \brief Apply agc to every live member of an ensemble.
+
+Members are processed in parallel by a pool of threads (see
+for_each_member in EnsembleWorkers.h).
+
+\param d - ensemble to apply the operator to.  Members are altered.
+\param twin - length of the agc operator in seconds
+\param nthreads - number of threads (default 1, 0 means all hardware threads)
+
+\return ensemble holding the gain function of each member in member
+  order.  The gain function of a dead member is an empty, dead TimeSeries.
+  The result is marked dead if d is dead or no member has a gain function.
+*/
+mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> agc(
+  mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& d,
+  const double twin, const size_t nthreads=1);
 /*! \brief Extracts a requested time window of data from a parent Seismogram object.
 
 It is common to need to extract a smaller segment of data from a larger
@@ -46,14 +62,23 @@ sample data if the window time range does not enclose the time range of
 the data.  In that case a message is left on elog to allow post mortem
 analysis of data in parallel constructs.
 
+When view is true the samples of the result are not copied.  The
+result refers to the window range of the parent samples and is copied
+only when it is changed (see SampleVector::slice).   That makes cutting
+many short windows from a long parent cheap, but each view keeps all
+the parent samples in memory for as long as it lives.   The samples of a
+parent used as a numpy array are exclusive.  A view of such a parent sees
+the changes made through the array until the view is changed.
+
 \return new Seismgram object derived from  parent but windowed by input
       time window range.
 
 \param parent is the larger Seismogram object to be windowed
 \param tw defines the data range to be extracted from parent.
+\param view when true return a view of the parent samples instead of a copy.
 */
 mspass::seismic::Seismogram WindowData(const mspass::seismic::Seismogram& parent,
-  const mspass::algorithms::TimeWindow& tw);
+  const mspass::algorithms::TimeWindow& tw, const bool view=false);
   /*! \brief Extracts a requested time window of data from a parent CoreSeismogram object.
 
   It is common to need to extract a smaller segment of data from a larger
@@ -85,14 +110,41 @@ sample data if the window time range does not enclose the time range of
 the data.  In that case a message is left on elog to allow post mortem
 analysis of data in parallel constructs.
 
+See the Seismogram version for the meaning of view.
+
 \return new Seismgram object derived from  parent but windowed by input
       time window range.
 
 \param parent is the larger TimeSeries object to be windowed
 \param tw defines the data range to be extracted from parent.
+\param view when true return a view of the parent samples instead of a copy.
 */
 mspass::seismic::TimeSeries WindowData(const mspass::seismic::TimeSeries& parent,
-  const mspass::algorithms::TimeWindow& tw);
+  const mspass::algorithms::TimeWindow& tw, const bool view=false);
+/*! \brief Window every live member of a TimeSeries ensemble.
+
+This is the ensemble version of WindowData.  Members are windowed in
+parallel by a pool of threads (see for_each_member in EnsembleWorkers.h).
+Dead members are copied unaltered.   Members that do not enclose the
+window are killed as in the atomic version.   The result is live when
+parent is live and at least one member of the result is live.
+
+\param parent is the ensemble to be windowed.
+\param tw defines the data range to be extracted from each member.
+\param nthreads is the number of threads (default 1, 0 means all hardware threads).
+\param view when true members are views of the parent samples (see
+  the atomic version).
+\return new ensemble with the ensemble Metadata and elog of parent.
+*/
+mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> WindowData(
+  const mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>& parent,
+  const mspass::algorithms::TimeWindow& tw, const size_t nthreads=1,
+  const bool view=false);
+/*! Window every live member of a Seismogram ensemble.  See the TimeSeries version. */
+mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> WindowData(
+  const mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& parent,
+  const mspass::algorithms::TimeWindow& tw, const size_t nthreads=1,
+  const bool view=false);
   /*! \brief Extracts a requested time window of data from a parent CoreTimeSeries object.
 
   It is common to need to extract a smaller segment of data from a larger
@@ -10,6 +10,7 @@
 #include "mspass/utility/Metadata.h"
 #include "mspass/algorithms/TimeWindow.h"
 #include "mspass/algorithms/algorithms.h"
+#include "mspass/algorithms/EnsembleWorkers.h"
 namespace mspass::algorithms::amplitudes{
 double PeakAmplitude(const mspass::seismic::CoreTimeSeries& d);
 double PeakAmplitude(const mspass::seismic::CoreSeismogram& d);
@@ -149,27 +150,32 @@ the scale function for each.  The template is for member data type.
   To use the entire data range for the scaling pass a window with an end time
   less than the start time.  That is used by the function as a signal to
   ignore the actual range and use the entire data range instead.
+\param nthreads is the number of threads used to process members (default
+  1, 0 means all hardware threads).  Members are independent so they
+  can be scaled in parallel (see for_each_member in EnsembleWorkers.h).
 
-\return vector of computed amplitudes
+Error handling changed when threads were added.  An exception thrown
+while scaling a member no longer aborts the whole ensemble.  The error
+is posted to the member's elog, the member is killed, and its amplitude
+is returned as 0.  Dead members are skipped and also return 0.  Callers
+that relied on the exception should test the member liveness instead.
+Only the test of level for ClipPerc still throws.
+
+\return vector of computed amplitudes.  The value for dead and killed
+  members is 0.
 */
 template <typename Tdata> std::vector<double> scale_ensemble_members(mspass::seismic::Ensemble<Tdata>& d,
-  const ScalingMethod& method, const double level, const mspass::algorithms::TimeWindow win)
+  const ScalingMethod& method, const double level, const mspass::algorithms::TimeWindow win,
+  const size_t nthreads=1)
 {
   if((method==ScalingMethod::ClipPerc) && (level<=0.0 || level>1.0))
     throw mspass::utility::MsPASSError("scale_ensemble_members function:  illegal perf level specified for clip percentage scale - must be between 0 and 1\nData unaltered - may cause downstream problems",
        mspass::utility::ErrorSeverity::Suspect);
-  try{
-    typename std::vector<Tdata>::iterator dptr;
-    std::vector<double> amps;
-    amps.reserve(d.member.size());
-    for(dptr=d.member.begin();dptr!=d.member.end();++dptr)
-    {
-      double thisamp;
-      thisamp=scale(*dptr,method,level,win);
-      amps.push_back(thisamp);
-    }
-    return amps;
-  }catch(...){throw;};
+  std::vector<double> amps(d.member.size(),0.0);
+  mspass::algorithms::for_each_member(d.member,[&](Tdata& m, const size_t i){
+      amps[i]=scale(m,method,level,win);
+    },"scale_ensemble_members",nthreads);
+  return amps;
 }
 /*! Generic function to apply an ensemble average scale factor.
 
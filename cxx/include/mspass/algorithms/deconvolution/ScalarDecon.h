@@ -2,10 +2,17 @@
 #define __SIMPLE_DECON_H__
 
 #include <vector>
+#include <sstream>
+#include <algorithm>
+#include <utility>
 #include "mspass/utility/Metadata.h"
 #include "mspass/algorithms/deconvolution/BasicDeconOperator.h"
 #include "mspass/algorithms/deconvolution/ShapingWavelet.h"
 #include "mspass/seismic/CoreTimeSeries.h"
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Seismogram.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/algorithms/EnsembleWorkers.h"
 namespace mspass::algorithms::deconvolution{
 /*! \brief Base class decon operator for single station 3C decon (receiver functions).
 
@@ -92,5 +99,89 @@ protected:
     std::vector<double> result;
     ShapingWavelet shapingwavelet;
 };
+/*! \brief Copy a deconvolution result into one component of a datum.
+
+The result is truncated to npts samples.  If it is shorter the remaining
+samples are set to zero and a complaint is posted to elog.  This is the
+same logic used by the python RFdecon function.
+*/
+inline void store_decon_result(const std::vector<double>& r, double *x,
+  const size_t npts, const size_t stride, mspass::utility::ErrorLogger& elog)
+{
+  size_t n=std::min(r.size(),npts);
+  for(size_t i=0;i<n;++i) x[i*stride]=r[i];
+  for(size_t i=n;i<npts;++i) x[i*stride]=0.0;
+  if(n<npts)
+  {
+    std::stringstream ss;
+    ss << "Windowing size mismatch."<<std::endl
+       << "Data window length = "<<r.size()<<" which is less than operator length= "
+       << npts;
+    elog.log_error("deconvolve_members",ss.str(),mspass::utility::ErrorSeverity::Complaint);
+  }
+}
+/*! \brief Deconvolve every live member of a TimeSeries ensemble with one wavelet.
+
+The members are processed by a pool of threads that each use a copy of
+op (see for_each_member).  Any other inputs the operator requires
+(e.g. the noise for the multitaper methods) must be loaded into op before
+calling this function.   The sample data of each member are replaced by
+the deconvolved result.  Members for which the operator throws an
+exception are killed.
+
+\param op is the deconvolution operator.  It is not altered.
+\param d is the ensemble to process.
+\param wavelet is the wavelet estimate used for all members.
+\param nthreads is the number of threads (default 1, 0 means all hardware threads).
+*/
+template <typename Operator> void deconvolve_members(const Operator& op,
+  mspass::seismic::Ensemble<mspass::seismic::TimeSeries>& d,
+  const std::vector<double>& wavelet, const size_t nthreads=1)
+{
+  mspass::algorithms::for_each_member(d.member,op,
+    [&wavelet](Operator& local, mspass::seismic::TimeSeries& m, const size_t){
+      local.loadwavelet(wavelet);
+      local.loaddata(std::as_const(m.s).as_vector());
+      local.process();
+      store_decon_result(local.getresult(),m.s.data(),m.npts(),1,m.elog);
+    },"deconvolve_members",nthreads);
+}
+/*! \brief Deconvolve every live member of a Seismogram ensemble.
+
+This is the ensemble version of the RFdecon function.  All three
+components of each member are deconvolved with the wavelet defined by
+component wcomp of the same member (normally the P wave dominated
+component).  Data should already be windowed.  See the TimeSeries
+version for the handling of threads and errors.
+
+\param op is the deconvolution operator.  It is not altered.
+\param d is the ensemble to process.
+\param wcomp is the component used as the wavelet estimate.
+\param nthreads is the number of threads (default 1, 0 means all hardware threads).
+*/
+template <typename Operator> void deconvolve_members(const Operator& op,
+  mspass::seismic::Ensemble<mspass::seismic::Seismogram>& d,
+  const int wcomp, const size_t nthreads=1)
+{
+  if(wcomp<0 || wcomp>2)
+    throw mspass::utility::MsPASSError("deconvolve_members:  wavelet component number must be 0, 1, or 2",
+      mspass::utility::ErrorSeverity::Invalid);
+  mspass::algorithms::for_each_member(d.member,op,
+    [wcomp](Operator& local, mspass::seismic::Seismogram& m, const size_t){
+      size_t npts=m.npts();
+      /* Read through a const reference so u is not made private per sample */
+      const mspass::utility::dmatrix& u=m.u;
+      std::vector<double> x(npts);
+      for(size_t i=0;i<npts;++i) x[i]=u(wcomp,i);
+      local.loadwavelet(x);
+      for(int k=0;k<3;++k)
+      {
+        for(size_t i=0;i<npts;++i) x[i]=u(k,i);
+        local.loaddata(x);
+        local.process();
+        store_decon_result(local.getresult(),m.u.get_address(k,0),npts,3,m.elog);
+      }
+    },"deconvolve_members",nthreads);
+}
 }
 #endif
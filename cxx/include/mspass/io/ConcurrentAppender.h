@@ -0,0 +1,143 @@
+#ifndef _CONCURRENTAPPENDER_H_
+#define _CONCURRENTAPPENDER_H_
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+namespace mspass::io
+{
+/*! \brief Writer that lets many threads and processes append to one file.
+
+The native writers append with the FileHandleCache.  That computes foff
+with lseek just before the write.  The result is correct for threads of
+one process that share a handle, but not when several processes append
+to the same file at once (e.g. many dask workers writing one large file).
+Another process can append between the lseek and the write so the foff
+returned would be wrong.
+
+This class avoids that problem by reserving a disjoint range of bytes
+for every write before any data are written.  The data are then written
+with pwrite to the reserved range, so writers never wait for each other.
+Reservations use two levels:
+  -# Within a process threads take ranges from an extent owned by
+     the process with an atomic compare and swap.  No lock is taken.
+  -# When the extent is exhausted a new extent is reserved across
+     processes through a small lock file (the data file name with the
+     suffix ".lock").  The lock file holds the next free offset of the
+     file and the device and inode of the data file.  It is updated
+     while holding an exclusive flock.  The offset is ignored if the
+     data file was removed and created again.
+Extents are extent_size bytes, or the size of the request if that is
+larger.  A size of 0 makes every reservation go through the lock file.
+
+Because processes reserve extents they may not fill, a file written by
+several processes can contain holes (read as zeros).  The foff of every
+datum is still correct.  release (called by the destructor) returns the
+unused tail of the last extent if no other process has reserved space
+after it, so a file written by one process has no holes.
+
+Do not mix this writer with writers that simply append to the same file
+(e.g. formatted output or the FileHandleCache writers) while any
+ConcurrentAppender is active on that file.  An append could land inside
+a range reserved but not yet written.
+
+Appenders for one file are normally shared through the registry methods
+(get, set_enabled, close_file, close_all).  The native fwrite_to_file
+functions use this class instead of the FileHandleCache when the
+registry is enabled.
+*/
+class ConcurrentAppender
+{
+public:
+  /*! \brief Open a file for concurrent appends.
+
+  \param fname is the name of the file to write (created if needed).
+  \param extent_size is the size in bytes of the ranges reserved
+    for this object in the lock file.
+  \exception MsPASSError is thrown if the data or lock file cannot be opened.
+  */
+  ConcurrentAppender(const std::string fname, const size_t extent_size=16777216);
+  /*! Destructor calls release and closes the files.  Errors are ignored.*/
+  ~ConcurrentAppender();
+  ConcurrentAppender(const ConcurrentAppender& parent) = delete;
+  ConcurrentAppender& operator=(const ConcurrentAppender& parent) = delete;
+  /*! \brief Reserve a range of bytes.
+
+  \param nbytes is the size of the range.
+  \return byte offset of the first byte of the range.
+  \exception MsPASSError is thrown if the lock file protocol fails.
+  */
+  long int reserve(const size_t nbytes);
+  /*! \brief Reserve a range and write a block of bytes to it.
+
+  \return foff of the block.
+  \exception MsPASSError is thrown for any write error.
+  */
+  long int write_bytes(const char *buffer, const size_t nbytes);
+  /*! \brief Write several blocks back to back in one reserved range.
+
+  \param blocks is a vector of pointers to the first byte of each block.
+  \param sizes is the size in bytes of each block.
+  \return vector of foff values for each block.
+  \exception MsPASSError is thrown for any write error or if blocks
+    and sizes are not the same length.
+  */
+  std::vector<long int> write_bytes(const std::vector<const char*>& blocks,
+    const std::vector<size_t>& sizes);
+  /*! \brief Return the unused part of the current extent.
+
+  If no other writer reserved space after the current extent the next
+  free offset in the lock file is set back to the end of the data written
+  by this object.  The object remains usable.
+  */
+  void release();
+  /*! Return the name of the data file. */
+  std::string name() const {return fname;};
+  /*! Return the name of the lock file used for a data file. */
+  static std::string lock_file_name(const std::string fname);
+
+  /*! \brief Fetch the shared appender for a file from the registry.
+
+  The appender is created the first time a file is requested and
+  held until close_file or close_all is called.
+  */
+  static std::shared_ptr<ConcurrentAppender> get(const std::string fname);
+  /*! \brief Enable or disable use of the registry by fwrite_to_file.
+
+  When disabling, all registered appenders are released and closed.
+  \param extent_size is the extent size for appenders created after this call.
+  */
+  static void set_enabled(const bool enable, const size_t extent_size=16777216);
+  /*! Return true if fwrite_to_file should use the registry. */
+  static bool enabled();
+  /*! Release and remove the registered appender for one file. */
+  static void close_file(const std::string fname);
+  /*! Release and remove all registered appenders. */
+  static void close_all();
+  /*! \brief Release the appender for a file and remove its lock file.
+
+  Call this when the data file is removed.  It must not be called while
+  another process may still append to the file.
+  \exception MsPASSError is thrown if the lock file exists and cannot
+    be removed.
+  */
+  static void remove_lock_file(const std::string fname);
+private:
+  std::string fname;
+  int fd;
+  int lockfd;
+  size_t extent_size;
+  /* Next free offset in the extent owned by this object */
+  std::atomic<long int> cursor;
+  /* End of the extent owned by this object */
+  std::atomic<long int> extent_end;
+  /* Serializes the slow path that reserves a new extent */
+  std::mutex extent_lock;
+  long int reserve_extent(const size_t nbytes);
+  long int read_next_offset();
+  void write_next_offset(const long int next);
+};
+}
+#endif
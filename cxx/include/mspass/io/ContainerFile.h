@@ -0,0 +1,236 @@
+#ifndef _CONTAINERFILE_H_
+#define _CONTAINERFILE_H_
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Seismogram.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/io/SampleEncoding.h"
+#include "mspass/io/FileHandleCache.h"
+namespace mspass::io
+{
+/*! Type of data object stored in a block of a container file. */
+enum class ContainerDataType
+{
+  timeseries, /*!< Block holds npts samples of a TimeSeries */
+  seismogram  /*!< Block holds 3*npts samples of a Seismogram */
+};
+/*! \brief One entry of the index stored at the end of a container file.
+
+A container file has one of these for each block of sample data it
+holds.  The index alone is enough to locate, verify, and rebuild the
+sample data and time base of every datum in the file.
+*/
+class ContainerIndexEntry
+{
+public:
+  /*! Object id of the datum (by default the ProcessingHistory uuid). */
+  std::string id;
+  /*! Byte offset of the first byte of the block. */
+  long int foff;
+  /*! Number of bytes in the block. */
+  long int nbytes;
+  /*! Number of samples (per component for Seismogram data). */
+  size_t npts;
+  /*! Type of data object stored in the block. */
+  ContainerDataType dtype;
+  /*! Encoding of the samples in the block. */
+  SampleEncoding encoding;
+  /*! Scale factor for int32 encoding (1 otherwise). */
+  double scale;
+  /*! Start time of the datum. */
+  double t0;
+  /*! Sample interval of the datum. */
+  double dt;
+  /*! True if t0 is a UTC epoch time. */
+  bool utc;
+  /*! CRC32 checksum of the nbytes stored in the block. */
+  uint32_t checksum;
+  ContainerIndexEntry() : foff(0),nbytes(0),npts(0),
+    dtype(ContainerDataType::timeseries),encoding(SampleEncoding::float64),
+    scale(1.0),t0(0.0),dt(1.0),utc(false),checksum(0){};
+};
+/*! \brief Compute a CRC32 checksum.
+
+This is the standard (zlib/ethernet) CRC32 polynomial.  Pass the return
+of a previous call as crc to checksum data in pieces.
+*/
+uint32_t crc32_checksum(const char *buffer, const size_t nbytes,
+  const uint32_t crc=0);
+/*! \brief Writer for self describing container files.
+
+Native files written by fwrite_to_file are raw sample data.  Every
+datum in such a file is useless without the dir, dfile, foff, and npts
+attributes stored in its MongoDB document.  A container file adds a
+compact binary index at the end of the file that defines every block
+of sample data it holds.  A reader can locate every datum with one
+open and one read of the index.
+
+The file layout is a 16 byte header (magic string and version), the
+sample data blocks written in the order they were added, the index,
+and a fixed size trailer that defines the location and size of the
+index.  The index is only written by close (or the destructor) so a
+new file that is not closed properly has no index and cannot be read
+with ContainerReader.
+
+A writer opened on an existing container appends to it.  The old index
+is loaded and new blocks are written after the old trailer.  The new
+index written by close includes all the old entries.  If an appending
+writer is not closed the reader finds the last complete index, so only
+the data added by that writer are lost.  The space used by old indexes
+is not reclaimed.
+
+A writer is not thread safe and only one writer can be active on a
+file at a time.
+*/
+class ContainerWriter
+{
+public:
+  /*! \brief Open a container file for writing.
+
+  \param dir is the directory of the file (no trailing slash).
+  \param dfile is the leaf name of the file.
+  \param append when true (default) an existing container is extended.
+    When false any existing file is truncated.
+  \exception MsPASSError is thrown if the file cannot be opened or if
+    append is true and an existing file is not a valid container.
+  */
+  ContainerWriter(const std::string dir, const std::string dfile,
+    const bool append=true);
+  /*! Destructor calls close.  Errors are silently ignored.*/
+  ~ContainerWriter();
+  ContainerWriter(const ContainerWriter& parent) = delete;
+  ContainerWriter& operator=(const ContainerWriter& parent) = delete;
+  /*! \brief Write the sample data of a TimeSeries.
+
+  \param d is the datum to save.  Dead data are not written.
+  \param enc is the encoding to use for the samples.
+  \param id is the id to store in the index.  If empty d.id() is used.
+  \return index of the entry created or -1 if d was dead.
+  \exception MsPASSError is thrown for a write error or if the writer was closed.
+  */
+  long int write(const mspass::seismic::TimeSeries& d,
+    const SampleEncoding enc=SampleEncoding::float64,
+    const std::string id=std::string());
+  /*! Write the sample data of a Seismogram.  See TimeSeries overload.*/
+  long int write(const mspass::seismic::Seismogram& d,
+    const SampleEncoding enc=SampleEncoding::float64,
+    const std::string id=std::string());
+  /*! \brief Write all live members of a TimeSeries ensemble.
+
+  Members are written in order with the id of each member taken from
+  its ProcessingHistory.
+  \return vector of index entries for each member (-1 for dead members).
+  */
+  std::vector<long int> write(const mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>& d,
+    const SampleEncoding enc=SampleEncoding::float64);
+  /*! Write all live members of a Seismogram ensemble.  See TimeSeries overload.*/
+  std::vector<long int> write(const mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& d,
+    const SampleEncoding enc=SampleEncoding::float64);
+  /*! \brief Write the index and close the file.
+
+  Calling close more than once is harmless.
+  \exception MsPASSError is thrown if the index write fails.
+  */
+  void close();
+  /*! Return the number of entries in the index. */
+  size_t size() const {return index.size();};
+  /*! Return the index entries written so far. */
+  const std::vector<ContainerIndexEntry>& entries() const {return index;};
+private:
+  std::string fname;
+  int fd;
+  /* offset of the next byte to write */
+  long int eof;
+  std::vector<ContainerIndexEntry> index;
+  long int write_block(const double *d, const size_t nd, ContainerIndexEntry& entry);
+};
+/*! \brief Reader for container files created by ContainerWriter.
+
+The constructor reads and validates the index with one read.  The
+blocks of sample data can then be read individually or as a complete
+ensemble.  Ensemble reads load all the blocks with the same coalesced
+reads used by the fread_from_file ensemble functions.  Every block read
+is verified against the checksum stored in the index.
+
+The file is opened through the FileHandleCache.
+*/
+class ContainerReader
+{
+public:
+  /*! \brief Open a container and load its index.
+
+  \exception MsPASSError is thrown if the file cannot be read, is not
+    a container file, or the index is corrupted.
+  */
+  ContainerReader(const std::string dir, const std::string dfile);
+  /*! Return the number of entries in the index. */
+  size_t size() const {return index.size();};
+  /*! Return the index. */
+  const std::vector<ContainerIndexEntry>& entries() const {return index;};
+  /*! Return the index entry i.  Throws MsPASSError if i is out of range.*/
+  const ContainerIndexEntry& entry(const size_t i) const;
+  /*! Return the position of the first entry with a given id or -1 if
+  the id is not in the index.*/
+  long int find(const std::string id) const;
+  /*! \brief Read one TimeSeries.
+
+  The result is sized from the index, has the time base (t0, dt, and time
+  reference) stored in the index, and has its ProcessingHistory id set
+  to the id in the index.  The dir, dfile, foff, and sample encoding
+  attributes are set in the Metadata as with fwrite_to_file.  Blocks use
+  the same layout as native files so the result can be reread with
+  fread_from_file.
+
+  \exception MsPASSError is thrown if entry i is not a TimeSeries, the
+    read is short, or the checksum does not match.
+  */
+  mspass::seismic::TimeSeries read_TimeSeries(const size_t i) const;
+  /*! \brief Read one Seismogram.
+
+  Same as read_TimeSeries.  Only the sample data are stored in the
+  container so the result has cardinal orientation.
+  */
+  mspass::seismic::Seismogram read_Seismogram(const size_t i) const;
+  /*! \brief Read all the TimeSeries entries in the container as an ensemble.
+
+  Entries that are not TimeSeries are skipped.   A member with a short read
+  or bad checksum is marked dead with an error posted to its elog.
+  */
+  mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> read_TimeSeriesEnsemble() const;
+  /*! Read a subset of the container entries as a TimeSeries ensemble.
+
+  \param which is the list of entries to read.  Members are in this order.
+  \exception MsPASSError is thrown if any entry is not a TimeSeries.
+  */
+  mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> read_TimeSeriesEnsemble(
+    const std::vector<size_t>& which) const;
+  /*! Read all the Seismogram entries in the container as an ensemble. */
+  mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> read_SeismogramEnsemble() const;
+  /*! Read a subset of the container entries as a Seismogram ensemble. */
+  mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> read_SeismogramEnsemble(
+    const std::vector<size_t>& which) const;
+private:
+  std::string dir;
+  std::string dfile;
+  std::vector<ContainerIndexEntry> index;
+  std::map<std::string,size_t> idmap;
+};
+/*! \brief Load the index of a container file.
+
+This is the low level function used by ContainerReader and by
+ContainerWriter in append mode.  If the file does not end with a
+trailer (a writer appending to it was not closed) the last complete
+index in the file is returned.
+\param fh is the file to read.
+\param index_foff is set to the byte offset of the start of the index.
+\return the index stored in the file.
+\exception MsPASSError is thrown if the file is not a valid container.
+*/
+std::vector<ContainerIndexEntry> read_container_index(const CachedFile& fh,
+  long int& index_foff);
+}
+#endif
@@ -0,0 +1,177 @@
+#ifndef _FILEHANDLECACHE_H_
+#define _FILEHANDLECACHE_H_
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+namespace mspass::io
+{
+/*! \brief Open file descriptor held by a FileHandleCache.
+
+This is a thin wrapper on a unix file descriptor.   The descriptor
+is closed when the last reference to the object is released.  The
+cache hands out these objects through a std::shared_ptr so a handle
+that is evicted from the cache while another thread is still using
+it will not be closed out from under that thread.
+
+Readers use pread so a single descriptor can be shared by any
+number of threads without locking.  Writers always append.  The
+append method serializes writers through a mutex so the offset it
+returns is guaranteed to be the location where the data were written
+when all writers in a process use the same handle.
+*/
+class CachedFile
+{
+public:
+  /*! \brief Open a file.
+
+  \param fname is the full path name of the file to open.
+  \param writable when true the file is opened for append and created
+    if it does not exist.  When false the file is opened read only.
+  \exception MsPASSError is thrown if the open fails.
+  */
+  CachedFile(const std::string fname, const bool writable);
+  /*! Destructor closes the file descriptor. */
+  ~CachedFile();
+  CachedFile(const CachedFile& parent) = delete;
+  CachedFile& operator=(const CachedFile& parent) = delete;
+  /*! \brief Append a block of doubles to the end of the file.
+
+  \param dptr is the first sample to write
+  \param nd is the number of samples to write
+  \return byte offset of the first sample written (foff)
+  \exception MsPASSError is thrown for a write error.
+  */
+  long int append(const double *dptr, const size_t nd);
+  /*! \brief Append several blocks of doubles as one contiguous write.
+
+  This is used by the ensemble writers.   All blocks are written with
+  writev while holding the append lock so they are guaranteed to be
+  laid out back to back in the file.
+
+  \param blocks is a vector of pointers to the first sample of each block.
+  \param sizes is the number of samples in each block (same length as blocks)
+  \return vector of byte offsets of the start of each block.
+  \exception MsPASSError is thrown for a write error.
+  */
+  std::vector<long int> append(const std::vector<const double*>& blocks,
+    const std::vector<size_t>& sizes);
+  /*! \brief Append a block of raw bytes to the end of the file.
+
+  Same as append but for encoded data that are not native doubles.
+  \return byte offset of the first byte written (foff)
+  */
+  long int append_bytes(const char *buffer, const size_t nbytes);
+  /*! \brief Append several blocks of raw bytes as one contiguous write.
+
+  Same as the gathered append method but sizes are in bytes.
+  */
+  std::vector<long int> append_bytes(const std::vector<const char*>& blocks,
+    const std::vector<size_t>& sizes);
+  /*! \brief Read a block of doubles from the file with pread.
+
+  \param buffer is the output buffer (must hold at least nd doubles)
+  \param foff is the byte offset of the first sample to read
+  \param nd is the number of samples to read
+  \return number of samples read.  Like fread a short read is not
+    treated as an error and the caller should test this value.
+  */
+  size_t read(double *buffer, const long int foff, const size_t nd) const;
+  /*! \brief Read a block of raw bytes from the file with pread.
+
+  Same as read but for data that are not native doubles (e.g. miniseed).
+  \return number of bytes read.
+  */
+  size_t read_bytes(char *buffer, const long int foff, const size_t nbytes) const;
+  /*! \brief Hint that a block of the file will be read soon.
+
+  This is a wrapper on posix_fadvise with POSIX_FADV_WILLNEED.   It
+  normally starts asynchronous readahead into the page cache.  Errors
+  are ignored as it is only a hint.
+  */
+  void advise_willneed(const long int foff, const size_t nbytes) const;
+  /*! Force data written to this file to storage with fdatasync. */
+  void flush();
+  /*! Return the unix file descriptor. */
+  int descriptor() const {return fd;};
+  /*! Return true if the file was opened for writing. */
+  bool writable() const {return write_mode;};
+  /*! Return the file name used to open this file. */
+  std::string name() const {return fname;};
+private:
+  int fd;
+  bool write_mode;
+  std::string fname;
+  std::mutex append_lock;
+};
+/*! \brief Process wide LRU cache of open file descriptors.
+
+The native file readers and writers in this namespace traditionally
+open and close the file defined by dir and dfile for every call.  On
+parallel file systems like Lustre or GPFS the metadata operations
+of open/close can cost more than the I/O itself for small objects.
+This class caches open descriptors keyed by file name and access mode
+so repeated saves to or reads from the same file reuse one descriptor.
+
+There is only one instance of this class in a process that is fetched
+with the static instance method.  All methods are thread safe.   The
+number of open descriptors is bounded by the size set with set_size.
+When that bound is reached the least recently used descriptor is
+released.  A size of 0 (the default) disables caching and makes
+get return a descriptor that is closed when the caller releases it.
+That default is intentional.  A cached descriptor refers to the file
+that existed when it was opened.  If an application removes or replaces
+a file while a descriptor for it is cached, later writes will go to
+the removed file.  Code that enables the cache must call close_file
+or close_all before removing or replacing any file it may have cached.
+*/
+class FileHandleCache
+{
+public:
+  /*! Return the process wide instance of the cache. */
+  static FileHandleCache& instance();
+  /*! \brief Fetch an open descriptor.
+
+  This is the main method of this class.  If a descriptor for fname
+  with the requested mode is cached it is returned and marked most
+  recently used.  Otherwise the file is opened and, if caching is
+  enabled, added to the cache.
+
+  \param fname is the full path name of the file.
+  \param writable is true to get an append mode descriptor.
+  \exception MsPASSError is thrown if the file cannot be opened.
+  */
+  std::shared_ptr<CachedFile> get(const std::string fname, const bool writable);
+  /*! \brief Set the maximum number of cached descriptors.
+
+  If the new size is smaller than the current number of cached
+  descriptors the least recently used are released.  0 disables caching.
+  */
+  void set_size(const size_t n);
+  /*! Return the maximum number of cached descriptors. */
+  size_t max_size() const;
+  /*! Return the number of descriptors currently cached. */
+  size_t size() const;
+  /*! Call fdatasync on all cached descriptors opened for write. */
+  void flush();
+  /*! Release any cached descriptors for the file fname. */
+  void close_file(const std::string fname);
+  /*! Release all cached descriptors. */
+  void close_all();
+  FileHandleCache(const FileHandleCache& parent) = delete;
+  FileHandleCache& operator=(const FileHandleCache& parent) = delete;
+private:
+  FileHandleCache() : maxsize(0) {};
+  typedef std::pair<std::string,bool> CacheKey;
+  typedef std::list<std::pair<CacheKey,std::shared_ptr<CachedFile>>> LRUList;
+  size_t maxsize;
+  /* front of this list is the most recently used entry */
+  LRUList lru;
+  std::map<CacheKey,LRUList::iterator> index;
+  mutable std::mutex cache_lock;
+  void trim();
+};
+}
+#endif
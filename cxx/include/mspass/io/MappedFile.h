@@ -0,0 +1,120 @@
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+#include <string>
+#include <memory>
+#include <sys/types.h>
+#include <sys/stat.h>
+namespace mspass::io
+{
+/*! \brief Read only memory map of a native sample data file.
+
+fread_from_file copies sample data through the kernel into the object's
+buffer and reads every byte of a datum even if the caller only wants a
+small window of it.  This class maps an entire file into the address
+space once.  Readers then copy only the samples they need directly from
+the page cache, or use a MappedSampleView that references the mapped pages
+with no copy at all.  Only the pages that are touched are ever read from
+storage.
+
+Mappings are shared.  The static get method returns an existing mapping of
+a file if one is still referenced anywhere in the process and the file has
+not changed since it was mapped.  The mapping is released when the last
+shared_ptr to it is destroyed.
+*/
+class MappedFile
+{
+public:
+  /*! \brief Map a file.
+
+  \param fname is the full path name of the file to map.
+  \exception MsPASSError is thrown if the file cannot be opened or mapped.
+  */
+  MappedFile(const std::string fname);
+  /*! Destructor unmaps the file. */
+  ~MappedFile();
+  MappedFile(const MappedFile& parent) = delete;
+  MappedFile& operator=(const MappedFile& parent) = delete;
+  /*! \brief Return a shared mapping of a file.
+
+  This is the normal way to get a MappedFile.   If the file was mapped
+  earlier and that mapping is still in use it is returned unless the
+  size, modification time, or inode of the file have changed.  In
+  that case, as when the file was not mapped, a new mapping is created.
+
+  \param fname is the full path name of the file to map.
+  \exception MsPASSError is thrown if the file cannot be opened or mapped.
+  */
+  static std::shared_ptr<MappedFile> get(const std::string fname);
+  /*! \brief Return a pointer to a block of samples in the mapping.
+
+  \param foff is the byte offset of the first sample.  Must be a multiple
+    of sizeof(double).
+  \param nd is the number of samples requested.
+  \exception MsPASSError is thrown if the block is not inside the file
+    or foff is not properly aligned.
+  */
+  const double *samples(const long int foff, const size_t nd) const;
+  /*! \brief Copy a block of samples from the mapping.
+
+  \param buffer is the output buffer (must hold at least nd doubles)
+  \param foff is the byte offset of the first sample to copy
+  \param nd is the number of samples to copy.
+  \return number of samples copied.   Like fread this will be less
+    than nd if the block extends past the end of the file and callers
+    should test the value.
+  */
+  size_t copy(double *buffer, const long int foff, const size_t nd) const;
+  /*! \brief Hint to the kernel that a block will be used soon.
+
+  This is a wrapper on madvise with MADV_WILLNEED.  Errors are silently
+  ignored as it is only a hint.
+  */
+  void willneed(const long int foff, const size_t nbytes) const;
+  /*! Return a pointer to the first byte of the mapped file (NULL for an empty file). */
+  const char *data() const {return base;};
+  /*! Return the size of the mapped file in bytes. */
+  size_t size() const {return length;};
+  /*! Return the file name used to create this mapping. */
+  std::string name() const {return fname;};
+private:
+  std::string fname;
+  char *base;
+  size_t length;
+  /* These identify the version of the file that was mapped */
+  dev_t device;
+  ino_t inode;
+  struct timespec mtime;
+  bool is_current(const struct stat& sbuf) const;
+};
+/*! \brief Read only view of a block of samples in a MappedFile.
+
+This is the zero copy interface to a mapped file.  The view holds a
+reference to the mapping so the data it points to remain valid as long
+as the view exists, even if no other code is using the file.  Note the
+samples are only valid as long as the file is not modified by another
+process.  The python bindings expose this object through the buffer
+protocol so a numpy array can be constructed from it with no copy.
+*/
+class MappedSampleView
+{
+public:
+  /*! Default constructor creates an empty view. */
+  MappedSampleView() : ptr(NULL),nd(0) {};
+  /*! \brief Construct a view of nd samples starting at foff in a mapping.
+
+  \exception MsPASSError is thrown if the block is not inside the file.
+  */
+  MappedSampleView(std::shared_ptr<MappedFile> mf, const long int foff, const size_t nd);
+  /*! Return a pointer to the first sample. */
+  const double *data() const {return ptr;};
+  /*! Return the number of samples in the view. */
+  size_t size() const {return nd;};
+  /*! Return sample i.  No range checking. */
+  double operator[](const size_t i) const {return ptr[i];};
+private:
+  std::shared_ptr<MappedFile> mapping;
+  const double *ptr;
+  size_t nd;
+};
+}
+#endif
@@ -0,0 +1,100 @@
+#ifndef _MSEEDTIMEINDEX_H_
+#define _MSEEDTIMEINDEX_H_
+#include <string>
+#include <vector>
+#include <map>
+#include "mspass/io/mseed_index.h"
+#include "mspass/io/PrefetchReader.h"
+namespace mspass::io
+{
+/*! \brief One block of miniseed packets returned by a MseedTimeIndex query.
+
+Holds the file name and the mseed_index entry for the block.  That is
+everything needed to decode the block with mseed_fread_from_file.
+*/
+class MseedBlock
+{
+public:
+  /*! Directory of the file holding the block. */
+  std::string dir;
+  /*! Leaf name of the file holding the block. */
+  std::string dfile;
+  /*! Index data for the block (foff and nbytes define the byte range). */
+  mseed_index index;
+  MseedBlock(){};
+  MseedBlock(const std::string d, const std::string df, const mseed_index& ind)
+    : dir(d),dfile(df),index(ind){};
+  /*! Return a request to load this block with a PrefetchReader. */
+  PrefetchRequest request() const
+  {
+    return PrefetchRequest(dir,dfile,index.foff,index.nbytes,SampleFormat::mseed);
+  };
+};
+/*! \brief In memory time range index of miniseed blocks.
+
+Extracting time windows from indexed miniseed files requires finding
+the blocks that overlap a time range for one channel.  Doing that with
+a database query or a linear scan of a large index for every window is
+slow when a job cuts thousands of windows.  This class holds the output
+of mseed_file_indexer (or mseed_index_files) for any number of files
+organized by SEED channel (net, sta, loc, and chan).  The blocks for
+each channel are sorted by start time with a running maximum of end
+time.  That allows the blocks overlapping a time range to be found
+with two binary searches so a query costs O(log n) plus the number of
+blocks returned.
+
+Usage is to call add once for each indexed file and then run any number
+of queries.  Queries are const and can be run from multiple threads,
+but add must not be called while a query is running.
+*/
+class MseedTimeIndex
+{
+public:
+  /*! Construct an empty index. */
+  MseedTimeIndex(){};
+  /*! Construct and load the index for one file.  See add.*/
+  MseedTimeIndex(const std::vector<mseed_index>& ind, const std::string dir,
+    const std::string dfile);
+  /*! \brief Add the index data for one file.
+
+  \param ind is the index of the file (e.g. first of the return of
+    mseed_file_indexer).
+  \param dir is the directory of the file.
+  \param dfile is the leaf name of the file.
+  */
+  void add(const std::vector<mseed_index>& ind, const std::string dir,
+    const std::string dfile);
+  /*! \brief Find all blocks for a channel that overlap a time range.
+
+  A block overlaps [t0,t1] if its starttime is less than or equal to t1
+  and its endtime is greater than or equal to t0.
+
+  \return blocks sorted by start time.  Empty if there are no matches.
+  */
+  std::vector<MseedBlock> query(const std::string net, const std::string sta,
+    const std::string loc, const std::string chan,
+    const double t0, const double t1) const;
+  /*! Return the number of blocks in the index. */
+  size_t size() const;
+  /*! Return the list of channel keys in the index.  The format of the
+  keys is net.sta.loc.chan as returned by seed_key. */
+  std::vector<std::string> channels() const;
+  /*! Return the key used for a SEED channel. */
+  static std::string seed_key(const std::string net, const std::string sta,
+    const std::string loc, const std::string chan);
+  /*! Remove all blocks from the index. */
+  void clear(){blocks.clear();};
+private:
+  class ChannelBlocks
+  {
+  public:
+    /* Sorted by index.starttime */
+    std::vector<MseedBlock> blocks;
+    /* maxend[i] is the largest endtime of blocks 0 through i */
+    std::vector<double> maxend;
+    void sort();
+  };
+  std::map<std::string,ChannelBlocks> blocks;
+};
+}
+#endif
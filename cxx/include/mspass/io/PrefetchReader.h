@@ -0,0 +1,146 @@
+#ifndef _PREFETCHREADER_H_
+#define _PREFETCHREADER_H_
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Seismogram.h"
+namespace mspass::io
+{
+/*! Defines the format of a block of sample data read by PrefetchReader.*/
+enum class SampleFormat
+{
+  binary, /*!< Native binary doubles written by fwrite_to_file */
+  mseed   /*!< Block of miniseed packets (normally defined by mseed_index) */
+};
+/*! \brief Defines one block of data to be loaded by a PrefetchReader. */
+class PrefetchRequest
+{
+public:
+  /*! Directory name of the file (no trailing slash) */
+  std::string dir;
+  /*! Leaf name of the file */
+  std::string dfile;
+  /*! Byte offset of the first byte of the block */
+  long int foff;
+  /*! Number of bytes in the block */
+  long int nbytes;
+  /*! Format of the data in the block */
+  SampleFormat format;
+  PrefetchRequest() : foff(0),nbytes(0),format(SampleFormat::binary){};
+  PrefetchRequest(const std::string d, const std::string df, const long int fo,
+    const long int nb, const SampleFormat fmt=SampleFormat::binary)
+    : dir(d),dfile(df),foff(fo),nbytes(nb),format(fmt){};
+};
+/*! \brief Raw data loaded by a PrefetchReader for one request.
+
+The contents are the raw bytes of the block.  The load methods copy
+(native) or decode (miniseed) those bytes into a data object.  No file
+I/O is done by the load methods.
+*/
+class PrefetchResult
+{
+public:
+  /*! Position of this result in the list of requests given to the reader */
+  size_t index;
+  /*! Copy of the request that produced this result */
+  PrefetchRequest request;
+  /*! Raw bytes read.  May be shorter than request.nbytes at end of file.*/
+  std::vector<char> buffer;
+  /*! False if the read failed */
+  bool ok;
+  /*! Error message if ok is false */
+  std::string message;
+  PrefetchResult() : index(0),ok(false){};
+  /*! \brief Load the data into a TimeSeries.
+
+  For binary format the samples are copied into d.s and decoded if the
+  Metadata of d define a sample_encoding.  d must already be sized to
+  hold the data as with fread_from_file.  For mseed format the
+  packets are decoded with mseed_decode_block.
+  \param fill_value is used to fill gaps in miniseed data.
+  \return number of samples loaded.
+  \exception MsPASSError is thrown if ok is false.
+  */
+  size_t load(mspass::seismic::TimeSeries& d, const double fill_value=0.0) const;
+  /*! \brief Load the data into a Seismogram.
+
+  Only binary format is supported.   d must already be sized to hold the
+  data as with fread_from_file.
+  \return number of samples (3*npts) loaded.
+  \exception MsPASSError is thrown if ok is false or format is mseed.
+  */
+  size_t load(mspass::seismic::Seismogram& d) const;
+};
+/*! \brief Background reader that loads a list of blocks ahead of the caller.
+
+Workflows that read one datum at a time stall on every read.  This
+class accepts the full list of blocks to read at construction and
+starts a pool of threads that read them in the background while the
+caller processes blocks already loaded.  Results are always returned
+by next in the order of the request list.
+
+The number of results held in memory is bounded by queue_size.  Workers
+wait when queue_size results are loaded but not yet consumed.  When a
+worker takes a request it also calls posix_fadvise (WILLNEED) on the block
+queue_size positions further down the list.  That starts kernel readahead
+so the page cache is warm before a worker gets to that block.
+
+Files are accessed through the FileHandleCache so many blocks in the
+same file normally share one descriptor when the cache is enabled.
+
+The destructor stops the workers, so a reader can be abandoned
+before all results are consumed.
+*/
+class PrefetchReader
+{
+public:
+  /*! \brief Construct a reader and start the background threads.
+
+  \param requests is the list of blocks to read.
+  \param nthreads is the number of worker threads (minimum 1).
+  \param queue_size is the maximum number of loaded results not yet
+    consumed by the caller (minimum 1).
+  */
+  PrefetchReader(const std::vector<PrefetchRequest>& requests,
+    const size_t nthreads=2, const size_t queue_size=8);
+  /*! Destructor stops and joins the worker threads. */
+  ~PrefetchReader();
+  PrefetchReader(const PrefetchReader& parent) = delete;
+  PrefetchReader& operator=(const PrefetchReader& parent) = delete;
+  /*! \brief Fetch the next result.
+
+  Blocks until the next result in request order is loaded.
+  \param result is set to the next result.
+  \return false when all results have been returned or the reader
+    was cancelled.  result is not altered in that case.
+  */
+  bool next(PrefetchResult& result);
+  /*! Stop the workers.  Results not yet returned are discarded. */
+  void cancel();
+  /*! Return the total number of requests. */
+  size_t size() const {return requests.size();};
+  /*! Return the number of results already returned by next. */
+  size_t delivered() const;
+private:
+  std::vector<PrefetchRequest> requests;
+  size_t queue_size;
+  /* Index of the next request to be taken by a worker */
+  size_t next_request;
+  /* Index of the next result next will return */
+  size_t next_result;
+  bool stopping;
+  std::map<size_t,PrefetchResult> ready;
+  mutable std::mutex lock;
+  std::condition_variable work_ready;
+  std::condition_variable result_ready;
+  std::vector<std::thread> workers;
+  void worker();
+  PrefetchResult read_block(const size_t i) const;
+  void advise(const size_t i) const;
+};
+}
+#endif
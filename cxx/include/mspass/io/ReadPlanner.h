@@ -0,0 +1,100 @@
+#ifndef _READPLANNER_H_
+#define _READPLANNER_H_
+#include <vector>
+#include "mspass/io/FileHandleCache.h"
+namespace mspass::io
+{
+/*! \brief Summary of the work done by a ReadPlanner.
+
+This is a simple struct returned by the ensemble readers so callers
+can see how effective the read coalescing was.  The counts are
+cumulative for a single execution of a read plan.
+*/
+class ReadStatistics
+{
+public:
+  /*! Number of read requests (ensemble members) in the plan. */
+  size_t nrequests;
+  /*! Number of contiguous ranges the requests were merged into. */
+  size_t nranges;
+  /*! Number of preadv system calls issued. */
+  size_t syscalls;
+  /*! Total bytes returned by the operating system including gap bytes. */
+  size_t bytes_read;
+  /*! Bytes read to fill small holes between requests and then discarded. */
+  size_t gap_bytes;
+  ReadStatistics() : nrequests(0),nranges(0),syscalls(0),bytes_read(0),gap_bytes(0){};
+};
+/*! \brief Planner for a set of reads from one file.
+
+The ensemble readers originally did one seek and one read per member
+in whatever order the members were listed.  This class collects the
+set of (foff, buffer, size) requests for one file, sorts them by foff,
+and merges adjacent or nearly adjacent requests into contiguous ranges.
+Each range is loaded with preadv calls that scatter the data directly into
+the buffers of each request.  Holes between requests that are smaller than
+the max_gap parameter are read into a scratch buffer and discarded because
+one large read is almost always cheaper than two small ones.  Ensembles
+written by the fwrite_to_file ensemble functions are contiguous so they
+normally load with a single system call.
+
+Usage is to call add for each buffer and then call execute once.
+*/
+class ReadPlanner
+{
+public:
+  /*! \brief Construct an empty plan.
+
+  \param max_gap is the largest hole (in bytes) between requests that will
+    be read and discarded to merge two requests into one range.
+  \param max_range is the largest size (in bytes) of a merged range.  A
+    single request larger than this is never split.
+  */
+  ReadPlanner(const size_t max_gap=65536, const size_t max_range=268435456);
+  /*! \brief Add a read request to the plan.
+
+  \param buffer is the output buffer (must hold at least nd doubles)
+  \param foff is the byte offset of the first sample to read
+  \param nd is the number of samples to read
+  \return index of this request used to fetch results from execute.
+  */
+  size_t add(double *buffer, const long int foff, const size_t nd);
+  /*! \brief Add a request for a block of raw bytes to the plan.
+
+  This is used for encoded data.  Results from execute for requests
+  added with this method are in bytes rather than samples.
+  */
+  size_t add_bytes(char *buffer, const long int foff, const size_t nbytes);
+  /*! \brief Read all the data defined by this plan.
+
+  \param fh is the open file to read from.
+  \return vector of the number of samples (bytes for add_bytes) read for
+    each request in the order they were added.  Like fread a short read is not treated
+    as an error and callers should compare each value to the size requested.
+  */
+  std::vector<size_t> execute(const CachedFile& fh);
+  /*! Return the statistics from the last call to execute. */
+  ReadStatistics statistics() const {return stats;};
+  /*! Return the number of requests in the plan. */
+  size_t size() const {return requests.size();};
+  /*! Remove all requests from the plan. */
+  void clear();
+private:
+  class ReadRequest
+  {
+  public:
+    char *buffer;
+    long int foff;
+    size_t nbytes;
+    /* size of the units returned by execute (sizeof(double) or 1) */
+    size_t unit;
+  };
+  size_t max_gap;
+  size_t max_range;
+  std::vector<ReadRequest> requests;
+  ReadStatistics stats;
+  size_t add_request(char *buffer, const long int foff, const size_t nbytes,
+    const size_t unit);
+};
+}
+#endif
@@ -0,0 +1,90 @@
+#ifndef _SAMPLEENCODING_H_
+#define _SAMPLEENCODING_H_
+#include <string>
+#include <vector>
+#include "mspass/utility/Metadata.h"
+namespace mspass::io
+{
+/*! \brief Defines the encoding of sample data in native files.
+
+Native files written by fwrite_to_file originally always contained
+raw 8 byte doubles (float64).  The encoded writers can store samples in
+a more compact form.  The encoding used for a datum is stored in its
+Metadata with the key sample_encoding so the readers can decode
+the data automatically.
+*/
+enum class SampleEncoding
+{
+  float64, /*!< Raw 8 byte doubles - the original native format */
+  float32, /*!< 4 byte floats.  Lossy but exact for 24 bit integer data. */
+  int32,   /*!< 4 byte integers multiplied by sample_scale on input */
+  delta    /*!< Lossless first differences with Rice or varint entropy coding */
+};
+/*! Return the name used to store an encoding in Metadata. */
+std::string encoding_name(const SampleEncoding enc);
+/*! \brief Convert a name stored in Metadata to a SampleEncoding.
+
+\exception MsPASSError is thrown if name is not a valid encoding name.
+*/
+SampleEncoding parse_encoding(const std::string name);
+/*! \brief Encode a vector of samples.
+
+\param d is the first sample to encode
+\param n is the number of samples to encode
+\param enc is the encoding to use
+\param scale is used only for int32.  Stored values are round(d[i]/scale).
+  If scale is not positive on input it is computed from the largest
+  absolute value of the data so that no sample overflows.  The value
+  used is returned in scale.
+\return buffer of encoded bytes
+*/
+std::vector<char> encode_samples(const double *d, const size_t n,
+  const SampleEncoding enc, double& scale);
+/*! \brief Decode a block of encoded samples.
+
+\param buffer is the first byte of the encoded data
+\param nbytes is the size of buffer in bytes
+\param enc is the encoding of the data in buffer
+\param scale is the scale factor used for int32 (ignored otherwise)
+\param d is the output buffer (must hold at least n doubles)
+\param n is the number of samples expected
+\return number of samples decoded.   This will be less than n if
+  buffer is truncated.  Callers should compare this to n.
+*/
+size_t decode_samples(const char *buffer, const size_t nbytes,
+  const SampleEncoding enc, const double scale, double *d, const size_t n);
+/*! \brief Fetch the encoding of a datum from its Metadata.
+
+Returns float64 if the sample_encoding key is not defined.
+\exception MsPASSError is thrown if the value stored is not a valid name.
+*/
+SampleEncoding get_sample_encoding(const mspass::utility::Metadata& md);
+/*! \brief Fetch the int32 scale factor of a datum from its Metadata.
+
+Returns 1.0 if the sample_scale key is not defined.
+*/
+double get_sample_scale(const mspass::utility::Metadata& md);
+/*! \brief Set the Metadata attributes that define the encoding of a datum.
+
+Sets sample_encoding, nbytes (delta only), and (int32 only) sample_scale.
+nbytes is erased for the fixed width encodings.  For float64
+the encoding attributes are erased so data saved in the original
+native format have the same attributes as before encodings were added.
+That also avoids stale attributes when a datum read from an encoded file
+is saved again as float64.
+*/
+void set_sample_encoding(mspass::utility::Metadata& md, const SampleEncoding enc,
+  const double scale, const size_t nbytes);
+/*! \brief Return the number of bytes stored for a datum.
+
+For fixed width encodings this is computed from n.  For delta encoding
+the size is variable and is fetched from the nbytes attribute.
+\param md is the Metadata of the datum
+\param enc is the encoding of the datum
+\param n is the number of samples stored (3*npts for Seismogram)
+\exception MsPASSError is thrown if nbytes is required and not defined.
+*/
+size_t encoded_size(const mspass::utility::Metadata& md,
+  const SampleEncoding enc, const size_t n);
+}
+#endif
@@ -1,10 +1,27 @@
-#ifndef _MSEED_INDEX_H_
-#define _MSEED_INDEX_H_
+#ifndef _FILEIO_H_
+#define _FILEIO_H_
 #include <string>
 #include "mspass/seismic/TimeSeries.h"
 #include "mspass/seismic/Seismogram.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/io/ReadPlanner.h"
+#include "mspass/io/MappedFile.h"
+#include "mspass/io/SampleEncoding.h"
+#include "mspass/algorithms/TimeWindow.h"
 namespace mspass::io
 {
+/*! \brief Build the path name of a data file from dir and dfile.
+
+All the native readers and writers use this function to build the name
+of the file they open.  Caches keyed by file name (FileHandleCache,
+MappedFile, ConcurrentAppender) need the same string, so code that
+refers to a file by dir and dfile should always build its name here.
+
+\param dir directory name (no trailing slash).   When empty the result
+  is dfile.
+\param dfile leaf file name
+*/
+std::string build_fname(const std::string dir, const std::string dfile);
 /*! \brief Fast file writer for native TimeSeries save to a file.
 
 When saving data to a file system there is no standard way to do so we
@@ -143,6 +160,55 @@ function in a try block.
 std::vector<long int> fwrite_to_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& d,
   const std::string dir,const std::string dfile);
 
+/*! \brief Save the sample data of a TimeSeries with a compact encoding.
+
+The writers without an encoding argument always save raw 8 byte doubles.
+This overload encodes the samples (see SampleEncoding) before they are
+appended to the file.  float32 and int32 halve the storage and read
+bandwidth.  Data from 24 bit digitizers are stored exactly by either.
+delta is lossless for any data and is normally the most compact for
+integer valued raw data.  In addition to dir, dfile, and foff the
+attributes sample_encoding, nbytes (delta only), and (for int32)
+sample_scale are set in the Metadata of d.  fread_from_file and mmap_read_from_file use
+those attributes to decode the data automatically.  Saving with float64
+erases the encoding attributes.
+
+\param d is the data to save
+\param dir is the directory name (no trailing slash)
+\param dfile is the leaf file name
+\param enc is the encoding to use
+\param scale is used only for int32.  Stored values are round(sample/scale).
+  When 0 (default) the scale is computed from the data.  It is 1 for integer
+  valued data that fit in 32 bits and otherwise is set to use the full range.
+\return foff of the data written or -1 if d was marked dead.
+\exception MsPASSError is thrown for any write error.
+*/
+long int fwrite_to_file(mspass::seismic::TimeSeries& d,
+  const std::string dir,const std::string dfile,
+  const SampleEncoding enc, const double scale=0.0);
+/*! \brief Save the sample data of a Seismogram with a compact encoding.
+
+See TimeSeries overload for details.  All 3*npts samples share one scale.
+*/
+long int fwrite_to_file(mspass::seismic::Seismogram& d,
+  const std::string dir,const std::string dfile,
+  const SampleEncoding enc, const double scale=0.0);
+/*! \brief Save the sample data of a TimeSeries ensemble with a compact encoding.
+
+See atomic overload for details.   When scale is 0 each member gets
+its own scale.
+*/
+std::vector<long int> fwrite_to_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>& d,
+  const std::string dir,const std::string dfile,
+  const SampleEncoding enc, const double scale=0.0);
+/*! \brief Save the sample data of a Seismogram ensemble with a compact encoding.
+
+See atomic overload for details.   When scale is 0 each member gets
+its own scale.
+*/
+std::vector<long int> fwrite_to_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& d,
+  const std::string dir,const std::string dfile,
+  const SampleEncoding enc, const double scale=0.0);
 /*! \brief Use C fread to read sample data from a file.
 
 This low level function is used in the file based reader of mspass to
@@ -153,7 +219,8 @@ That buffer in this function is the the dmatrix container, u, used to hold
 the sample data of a Seismogram object.  The reader assumes the input
 has been initialized on construction or with set_npts to the size
 matching the data file contents.  If there is a mismatch the results
-are unpredictable.
+are unpredictable.  If the Metadata of d define a sample_encoding
+(see fwrite_to_file) the data are decoded into u as they are read.
 
 \param Seismogram object to hold the sample data to be read from the file.
   Note that this function acts like a subroutine with entire purpose being
@@ -185,7 +252,8 @@ That buffer in this function is the std::vector container, s, used to hold
 the sample data of a Seismogram object.  The reader assumes the input
 has been initialized on construction or with set_npts to the size
 matching the data file contents.  If there is a mismatch the results
-are unpredictable.
+are unpredictable.  If the Metadata of d define a
+sample_encoding (see fwrite_to_file) the data are decoded as they are read.
 
 \param TimeSeries object to hold the sample data to be read from the file
   Note that this function acts like a subroutine with entire purpose being
@@ -239,6 +307,20 @@ guaranteed to be invalid.
 
 size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> &de,
  const std::string dir, const std::string dfile, std::vector<long int> indexes);
+/*! \brief Read multiple TimeSeries from a file and return I/O statistics.
+
+Identical to the overload without the stats argument, which calls this
+function, but also returns the statistics of the read.  Members are sorted
+by foff and adjacent blocks are merged into large preadv calls so an
+ensemble saved with fwrite_to_file normally loads with one system call.
+stats can be used to verify that.
+
+\param stats is filled with the counts of bytes read, ranges, and
+  system calls on return.
+*/
+size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes,
+ ReadStatistics& stats);
 
 /*! \brief Use C fread to read multiple Seismogram from a file.
 
@@ -272,6 +354,107 @@ guaranteed to be invalid.
 
 size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &de,
  const std::string dir, const std::string dfile, std::vector<long int> indexes);
+/*! \brief Read multiple Seismogram from a file and return I/O statistics.
+
+Identical to the overload without the stats argument, which calls this
+function, but also returns the statistics of the read.  Members are sorted
+by foff and adjacent blocks are merged into large preadv calls so an
+ensemble saved with fwrite_to_file normally loads with one system call.
+stats can be used to verify that.
+
+\param stats is filled with the counts of bytes read, ranges, and
+  system calls on return.
+*/
+size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes,
+ ReadStatistics& stats);
+
+/*! \brief Read the sample data for a TimeSeries from a memory mapped file.
+
+This is an alternative to fread_from_file that maps dfile with mmap
+(see MappedFile) and copies the samples directly from the page cache into
+the data vector.  The mapping of a file is shared by all readers in
+a process so reading many objects from the same file maps it only once.
+Like fread_from_file the object must be sized (npts set) to match the
+data in the file before calling this function.
+
+\param d is the TimeSeries to hold the sample data.
+\param dir is the directory name to use for file name (no trailing slash)
+\param dfile is the leaf file name to be openned.
+\param foff is the byte offset to the first sample of this datum.
+
+\return number of samples read.  Caller should test this value as a short
+  read will not cause an error to be thrown.
+\exception MsPASSError is thrown if the file cannot be mapped.
+*/
+size_t mmap_read_from_file(mspass::seismic::TimeSeries& d,const std::string dir,
+  const std::string dfile, const long int foff);
+/*! \brief Read the sample data for a Seismogram from a memory mapped file.
+
+See the TimeSeries overload for details.  foff is the offset to the first
+sample of the 3xnpts matrix.
+*/
+size_t mmap_read_from_file(mspass::seismic::Seismogram& d,const std::string dir,
+  const std::string dfile, const long int foff);
+/*! \brief Read a time window of a TimeSeries from a memory mapped file.
+
+Reading a few seconds from a large datum with fread_from_file requires
+reading the entire datum and then windowing it.   This function uses
+the time base of d (t0, dt, and npts defining the full datum stored at foff)
+to compute the samples spanned by tw and copies only those.  Only the
+pages of the file holding the window are ever touched.  On return d has
+npts and t0 set to match the window.
+
+\param d is the TimeSeries to hold the sample data.  On entry the time
+  base must describe the full datum saved at foff.
+\param dir is the directory name to use for file name (no trailing slash)
+\param dfile is the leaf file name to be openned.
+\param foff is the byte offset to the first sample of the full datum.
+\param tw is the time window to extract.
+
+\return number of samples read.
+\exception MsPASSError is thrown if the window is not inside the data
+  range as in WindowData or if the file cannot be mapped.
+*/
+size_t mmap_read_from_file(mspass::seismic::TimeSeries& d,const std::string dir,
+  const std::string dfile, const long int foff,
+  const mspass::algorithms::TimeWindow& tw);
+/*! \brief Read a time window of a Seismogram from a memory mapped file.
+
+See the TimeSeries overload for details.  The sample matrix is stored in
+column order so a time window of a Seismogram is a contiguous block
+in the file.
+*/
+size_t mmap_read_from_file(mspass::seismic::Seismogram& d,const std::string dir,
+  const std::string dfile, const long int foff,
+  const mspass::algorithms::TimeWindow& tw);
+/*! \brief Read multiple TimeSeries from a memory mapped file.
+
+This is the memory mapped equivalent of the ensemble version of
+fread_from_file.  Error handling for each member is identical.
+*/
+size_t mmap_read_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes);
+/*! \brief Read multiple Seismogram from a memory mapped file.
 
+This is the memory mapped equivalent of the ensemble version of
+fread_from_file.  Error handling for each member is identical.
+*/
+size_t mmap_read_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes);
+/*! \brief Return a zero copy view of a block of samples in a native file.
+
+The view references the memory mapped file directly so no samples are
+copied.  Pages are only read from storage when the samples are accessed.
+
+\param dir is the directory name to use for file name (no trailing slash)
+\param dfile is the leaf file name to be openned.
+\param foff is the byte offset to the first sample.
+\param nd is the number of samples (3*npts for a Seismogram).
+\exception MsPASSError is thrown if the file cannot be mapped or the block
+  extends past the end of the file.
+*/
+MappedSampleView mmap_sample_view(const std::string dir, const std::string dfile,
+  const long int foff, const size_t nd);
 }
 #endif
@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include "mspass/utility/ErrorLogger.h"
+#include "mspass/seismic/TimeSeries.h"
 namespace mspass::io
 {
 
@@ -106,6 +107,123 @@ of interest only if something breaks.
 std::pair<std::vector<mseed_index>,mspass::utility::ErrorLogger>
    mseed_file_indexer(const std::string inputfile, const bool segment_timetears,
      const bool Verbose);
+/*! \brief Index a list of miniseed files in parallel.
+
+Indexing a large archive with mseed_file_indexer one file at a time can
+take hours because every packet of every file has to be read.  This
+function indexes a list of files with a pool of threads and caches the
+result for each file in a small binary sidecar file.  The sidecar
+records the size and modification time of the data file and the
+value of segment_timetears used to build it.  When all match the
+cached index is returned without reading the data file so reindexing
+an unchanged archive is nearly instant.
+
+The sidecar for a file is the data file name with the suffix ".msidx"
+appended.  If cache_dir is not empty sidecars are written to that
+directory instead (needed for read only archives).  In that case the
+sidecar name is the full path of the data file with each "/" replaced
+by "_".  Failure to write a sidecar is silently ignored.  Indexes of
+files with any error posted to the error log are never cached so the
+errors are reported every time the file is indexed.
+
+\param files is the list of files to index.
+\param nthreads is the number of worker threads (minimum 1).
+\param segment_timetears is passed to mseed_file_indexer.
+\param Verbose is passed to mseed_file_indexer.
+\param use_cache when false the sidecar files are neither read nor
+  written.
+\param cache_dir is the directory for sidecar files (see above).
+\return vector of the same length as files with the result of
+  mseed_file_indexer for each file in the same order.  Exceptions
+  thrown while indexing a file are posted to the error log of that file.
+*/
+std::vector<std::pair<std::vector<mseed_index>,mspass::utility::ErrorLogger>>
+  mseed_index_files(const std::vector<std::string>& files,
+    const size_t nthreads=1, const bool segment_timetears=true,
+    const bool Verbose=false, const bool use_cache=true,
+    const std::string cache_dir=std::string());
+/*! \brief Return the name of the sidecar index file for a miniseed file.
+
+See mseed_index_files for the naming rules.
+*/
+std::string mseed_sidecar_name(const std::string fname,
+  const std::string cache_dir=std::string());
+/*! \brief Decode a block of miniseed packets directly into a TimeSeries.
+
+This is the reader companion to mseed_file_indexer.   It reads nbytes
+starting at byte offset foff of the file defined by dir and dfile with
+a single fread and then decodes each miniseed packet in that block with
+libmseed.   Decoded samples are converted to double and copied directly
+into the sample vector (s) of d.  The normal use is to load the block
+defined by one mseed_index entry into a TimeSeries skeleton constructed
+from the matching MongoDB document (i.e. a TimeSeries constructed with
+npts, dt, and t0 already set).
+
+The position of each packet in the output vector is computed from the
+packet start time relative to d.t0().  That means gaps between packets
+are filled with fill_value and overlaps are resolved by the later
+packet overwriting earlier samples.  Both conditions are posted to the
+error log of d as complaints.   If the first packet time or the packet
+sample rate do not match the t0 and dt of d the values in the packets
+are used and a complaint is posted.  If the packets contain fewer samples
+than d.npts() the vector is shortened to match the data.  Samples beyond
+the end of the preallocated buffer are discarded with a complaint.
+
+\param d is the TimeSeries to hold the decoded data.  Like fread_from_file
+  this function assumes the data vector was already allocated with the
+  expected number of samples.
+\param dir is the directory name to use for file name (no trailing slash)
+\param dfile is the leaf file name to be opened.
+\param foff is the byte offset of the first packet of the block.
+\param nbytes is the number of bytes of packet data to decode.
+\param fill_value is the value used to fill gaps between packets
+  (default 0.0).
+
+\return number of samples decoded into d.   Packet decoding errors are
+  posted to the error log of d and do not cause an exception.
+\exception MsPASSError will be thrown if the file cannot be opened or
+  read.
+*/
+size_t mseed_fread_from_file(mspass::seismic::TimeSeries& d,
+  const std::string dir, const std::string dfile,
+  const long int foff, const long int nbytes,
+  const double fill_value=0.0);
+/*! \brief Decode a block of miniseed packets already loaded into memory.
+
+This is the decoder used by mseed_fread_from_file.   It is exposed for
+readers like PrefetchReader that load the raw packets themselves.  All
+the rules for placing packets, filling gaps, and logging problems are
+the same as for mseed_fread_from_file.
+
+\param d is the TimeSeries to hold the decoded data.
+\param buffer is the first byte of the first packet.
+\param nbytes is the number of bytes in buffer.
+\param fill_value is the value used to fill gaps (default 0.0).
+\param source is a name used in error messages (normally the file name)
+
+\return number of samples decoded into d.
+*/
+size_t mseed_decode_block(mspass::seismic::TimeSeries& d, const char *buffer,
+  const size_t nbytes, const double fill_value=0.0,
+  const std::string source=std::string("buffer"));
+/*! \brief Decode the data block defined by an mseed_index into a TimeSeries.
+
+Convenience overload of the function with explicit foff and nbytes
+arguments.  The foff and nbytes values are taken from ind.   If the
+number of samples allocated in d does not match ind.npts the buffer
+is resized with set_npts before decoding.
+
+\param d is the TimeSeries to hold the decoded data.
+\param dir is the directory name to use for file name (no trailing slash)
+\param dfile is the leaf file name to be opened.
+\param ind is the index entry defining the block of packets to decode.
+\param fill_value is the value used to fill gaps (default 0.0).
+
+\return number of samples decoded into d.
+*/
+size_t mseed_fread_from_file(mspass::seismic::TimeSeries& d,
+  const std::string dir, const std::string dfile,
+  const mseed_index& ind, const double fill_value=0.0);
 
 } // end namespace
 #endif
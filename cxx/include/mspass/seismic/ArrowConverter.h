@@ -0,0 +1,129 @@
+#ifndef _ARROW_CONVERTER_H_
+#define _ARROW_CONVERTER_H_
+#include <stdint.h>
+#include <string>
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Ensemble.h"
+/* Structures of the Arrow C data interface.  The arrow specification
+(https://arrow.apache.org/docs/format/CDataInterface.html) defines them as
+a stable ABI that producers and consumers copy verbatim.  That lets mspass
+exchange data with pyarrow (and through it pandas, polars, and duckdb)
+without linking the arrow libraries. */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+namespace mspass::seismic{
+/*! Name of the list<double> column holding the samples of each member. */
+const std::string ARROW_SAMPLES_COLUMN("samples");
+/*! Name of the boolean column holding the live state of members. */
+const std::string ARROW_LIVE_COLUMN("live");
+/*! Name of the boolean column that is true for members with UTC time. */
+const std::string ARROW_UTC_COLUMN("utc");
+/*! Name of the nullable float64 column holding t0shift. */
+const std::string ARROW_T0SHIFT_COLUMN("t0shift");
+/*! Schema metadata key of the ensemble Metadata. */
+const std::string ARROW_ENSEMBLE_METADATA_KEY("mspass.ensemble_metadata");
+/*! Schema metadata key of the ensemble live state ("true" or "false"). */
+const std::string ARROW_ENSEMBLE_LIVE_KEY("mspass.ensemble_live");
+/*! \brief Export a TimeSeriesEnsemble with the Arrow C data interface.
+
+A TimeSeriesEnsemble is exported as an arrow record batch (a struct array
+in the C data interface) with one row per member.   The columns are:
+  -# starttime, delta, and npts (float64, float64, int64) holding t0, dt,
+     and the number of samples of each member.
+  -# live and utc (boolean) holding the live/dead state and whether the
+     time reference is UTC.
+  -# t0shift (float64) holding the time shift of data converted to
+     relative time.  The value is null if the shift is not valid.
+  -# One column for each Metadata key found in any member, in key order.
+     The type of the column is that of the values (bool, int32, int64,
+     float32, float64, or utf8).   Integer keys with int and long values
+     are stored as int64 and numeric keys with integer and floating point
+     values are stored as float64.   The value is null for members that do
+     not define the key.
+  -# samples (list<double>) holding the sample data.
+The ensemble Metadata (in the binary format used by pickle) and the
+ensemble live state are stored in the schema metadata.   The
+ProcessingHistory and error logs are not exported.  The arrow form is
+meant for analysis of large gathers with dataframe tools, not as a
+replacement for pickle.
+
+The samples of all members are copied to one contiguous buffer and the
+Metadata values to one buffer per column.  The consumer owns the result
+and must call the release callbacks of schema and array when done with
+them.   A consumer like pyarrow does that itself, and the buffers are
+not copied again by pyarrow or by tools that read from it.
+
+\param d is the ensemble to export.
+\param schema is set to the schema of the result.
+\param array is set to the data of the result.
+\exception MsPASSError is thrown if a Metadata value has a type that
+  cannot be stored in an arrow column, if a key has values of
+  incompatible types in different members, or if a Metadata key
+  matches one of the reserved column names.
+*/
+void export_to_arrow(const LoggingEnsemble<TimeSeries>& d,
+  ArrowSchema *schema, ArrowArray *array);
+/*! \brief Build a TimeSeriesEnsemble from data in the Arrow C data interface.
+
+The input must be a struct array (a record batch) with the layout
+written by export_to_arrow.  Only the samples column is required.
+A record batch with no rows gives an ensemble with no members.
+Other columns are handled as follows:
+  -# The reserved columns set the attributes of each member.  Missing
+     or null values leave the defaults (t0=0, dt=1, relative time).
+     Members are marked live when there is no live column.   npts is
+     always the length of the samples list.
+  -# Any other column with a boolean, integer, floating point, or string
+     type is loaded into the member Metadata.   A null value leaves the
+     key undefined in that member.
+The schema and array are not released.  The caller still owns them.
+
+\param schema is the schema of the data.
+\param array is the data.
+\exception MsPASSError is thrown if the input is not a struct array,
+  has no samples column, or has a column with a type that cannot be
+  converted.
+*/
+LoggingEnsemble<TimeSeries> import_from_arrow(const ArrowSchema *schema,
+  const ArrowArray *array);
+}  // End namespace mspass::seismic
+#endif
@@ -0,0 +1,202 @@
+#ifndef _BINARY_SERIALIZATION_H_
+#define _BINARY_SERIALIZATION_H_
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Seismogram.h"
+#include "mspass/seismic/Ensemble.h"
+namespace mspass::seismic{
+/*! \brief Binary wire format used by the pickle interface of atomic data.
+
+Pickling a TimeSeries or Seismogram (e.g. when dask moves data between
+workers) used to require several boost text archives and a nested python
+pickle of the Metadata converted to a dict.   The functions declared here
+replace that with a single versioned binary block with this layout:
+  -# A fixed header of BINARY_SERIALIZATION_HEADER_SIZE bytes holding
+     the magic string "MSPB", the format version (uint16), the data
+     type (uint16), flags (uint32), a reserved uint32, npts (uint64),
+     and the sizes in bytes (uint64) of each of the four blocks that
+     follow.
+  -# The BasicTimeSeries attributes.   For a Seismogram this block also
+     holds the cardinal and orthogonal booleans and the 3x3
+     transformation matrix.
+  -# The Metadata block.  Each entry is a type tag, the key, and the
+     value.   bool, int, long, float, double, and string values are
+     stored as raw binary values.   Any other value must be a python
+     object and is stored as a python pickle.  The block ends with a
+     bitmap of the entries marked as changed or set.
+  -# The ProcessingHistory block (including the error log).
+  -# The raw sample bytes (npts doubles for TimeSeries or 3*npts
+     doubles stored in the column order of the u matrix for Seismogram).
+     If the BINARY_SAMPLES_OUT_OF_BAND flag is set this block is empty
+     and the samples are passed separately.   That is used for pickle
+     protocol 5, where the samples can be sent as out-of-band buffers
+     without being copied into the pickle stream.
+
+Values are in host byte order.  The format is meant for moving data
+between processes of one job, not for long term storage.
+*/
+const char BINARY_SERIALIZATION_MAGIC[4]={'M','S','P','B'};
+/*! Version of the binary format written by serialize_binary. */
+const uint16_t BINARY_SERIALIZATION_VERSION(2);
+/*! Size in bytes of the fixed header of the binary format. */
+const size_t BINARY_SERIALIZATION_HEADER_SIZE(56);
+/*! Header flag set when the samples are not stored in the serialized data. */
+const uint32_t BINARY_SAMPLES_OUT_OF_BAND(2);
+/*! Pointer to and size in bytes of a sample buffer passed out-of-band. */
+typedef std::pair<const char*,size_t> SampleBufferView;
+/*! Data type codes stored in the binary format header. */
+enum class SerializedDataType : uint16_t
+{
+  timeseries=1,
+  seismogram=2
+};
+/*! \brief Header of one object stored with the binary format. */
+class BinarySerializationHeader
+{
+public:
+  uint16_t version;
+  SerializedDataType type;
+  uint32_t flags;
+  uint64_t npts;
+  uint64_t bts_size;
+  uint64_t md_size;
+  uint64_t history_size;
+  uint64_t sample_size;
+  BinarySerializationHeader();
+  /*! Total size in bytes of the object including the header. */
+  size_t total_size() const
+  {
+    return BINARY_SERIALIZATION_HEADER_SIZE+bts_size+md_size
+      +history_size+sample_size;
+  };
+};
+/*! \brief Append a TimeSeries in the binary format to a buffer.
+
+\param d is the datum to serialize.
+\param buf is the buffer the result is appended to.
+\param samples_out_of_band when true the samples are not written and
+  must be passed to the deserializer separately (see sample_buffer).
+\return number of bytes appended.
+\exception MsPASSError is thrown if a Metadata value has an
+  unsupported type.
+*/
+size_t serialize_binary(const TimeSeries& d, std::vector<char>& buf,
+  const bool samples_out_of_band=false);
+/*! Append a Seismogram in the binary format to a buffer.  See the TimeSeries overload. */
+size_t serialize_binary(const Seismogram& d, std::vector<char>& buf,
+  const bool samples_out_of_band=false);
+/*! Return the sample buffer of a TimeSeries as written by serialize_binary. */
+SampleBufferView sample_buffer(const TimeSeries& d);
+/*! Return the sample buffer of a Seismogram as written by serialize_binary. */
+SampleBufferView sample_buffer(const Seismogram& d);
+/*! \brief Restore a TimeSeries from the binary format.
+
+\param buf is the first byte of the serialized object.
+\param n is the number of bytes available at buf.
+\param nused when not NULL is set to the number of bytes consumed.
+\exception MsPASSError is thrown if the data are truncated, corrupted,
+  or do not hold a TimeSeries.
+*/
+TimeSeries deserialize_TimeSeries(const char *buf, const size_t n,
+  size_t *nused=NULL);
+/*! Restore a Seismogram from the binary format.  See deserialize_TimeSeries. */
+Seismogram deserialize_Seismogram(const char *buf, const size_t n,
+  size_t *nused=NULL);
+/*! \brief Restore a TimeSeries from the binary format into an existing object.
+
+This is the same as deserialize_TimeSeries but the result replaces
+the contents of d.   That avoids a copy when the result is an element
+of a container (e.g. an ensemble member).
+
+\param samples is the sample buffer of data serialized with the samples
+  out-of-band.   It must be the size of the samples of the datum.  It is
+  ignored if the samples were written in the serialized data.
+\exception MsPASSError is thrown if the data are out-of-band and samples
+  is missing or has the wrong size, and for all the errors of
+  deserialize_TimeSeries.
+*/
+void deserialize_binary(const char *buf, const size_t n, TimeSeries& d,
+  size_t *nused=NULL, const SampleBufferView samples=SampleBufferView(NULL,0));
+/*! Restore a Seismogram into an existing object.  See the TimeSeries overload.*/
+void deserialize_binary(const char *buf, const size_t n, Seismogram& d,
+  size_t *nused=NULL, const SampleBufferView samples=SampleBufferView(NULL,0));
+
+/*! \brief Binary format used by the pickle interface of ensembles.
+
+An ensemble is written as one contiguous block with this layout:
+  -# A fixed header of BINARY_SERIALIZATION_HEADER_SIZE bytes holding
+     the magic string "MSPE", the format version (uint16), the member
+     data type (uint16), flags (uint32 with bit 0 set if the ensemble
+     is live), a reserved uint32, the number of members (uint64), and
+     the sizes in bytes (uint64) of the Metadata, error log, offset
+     table, and member blocks.
+  -# The ensemble Metadata block (same as for atomic data).
+  -# The ensemble ErrorLogger block.
+  -# The member offset table.   One uint64 for each member holding the
+     offset of the member from the start of the member blocks.
+  -# The member blocks.  Each is one atomic datum in the format
+     written by serialize_binary.
+The offset table allows members to be restored independently and in
+any order.   Restoring builds each member directly in the member vector
+of the result so no intermediate copies of the members are held.
+*/
+const char BINARY_ENSEMBLE_MAGIC[4]={'M','S','P','E'};
+/*! \brief Header of an ensemble stored with the binary format. */
+class BinaryEnsembleHeader
+{
+public:
+  uint16_t version;
+  SerializedDataType type;
+  uint32_t flags;
+  uint64_t nmembers;
+  uint64_t md_size;
+  uint64_t elog_size;
+  uint64_t table_size;
+  uint64_t member_size;
+  BinaryEnsembleHeader();
+  /*! Return true if the ensemble was marked live. */
+  bool live() const {return (flags & 1)!=0;};
+  /*! Total size in bytes of the ensemble including the header. */
+  size_t total_size() const
+  {
+    return BINARY_SERIALIZATION_HEADER_SIZE+md_size+elog_size
+      +table_size+member_size;
+  };
+};
+/*! \brief Append a TimeSeriesEnsemble in the binary format to a buffer.
+
+\param d is the ensemble to serialize.
+\param buf is the buffer the result is appended to.
+\param samples_out_of_band when true the samples of all members are not
+  written.  They must be passed to the deserializer in member order.
+\return number of bytes appended.
+\exception MsPASSError is thrown if a Metadata value has an
+  unsupported type.
+*/
+size_t serialize_binary(const LoggingEnsemble<TimeSeries>& d, std::vector<char>& buf,
+  const bool samples_out_of_band=false);
+/*! Append a SeismogramEnsemble in the binary format to a buffer.  See the TimeSeries overload. */
+size_t serialize_binary(const LoggingEnsemble<Seismogram>& d, std::vector<char>& buf,
+  const bool samples_out_of_band=false);
+/*! \brief Restore a TimeSeriesEnsemble from the binary format.
+
+\param buf is the first byte of the serialized ensemble.
+\param n is the number of bytes available at buf.
+\param nused when not NULL is set to the number of bytes consumed.
+\param samples holds the sample buffer of each member in member order
+  when the ensemble was serialized with the samples out-of-band.
+\exception MsPASSError is thrown if the data are truncated, corrupted,
+  or do not hold a TimeSeriesEnsemble, or if out-of-band samples are
+  missing or have the wrong size.
+*/
+LoggingEnsemble<TimeSeries> deserialize_TimeSeriesEnsemble(const char *buf,
+  const size_t n, size_t *nused=NULL,
+  const std::vector<SampleBufferView>& samples=std::vector<SampleBufferView>());
+/*! Restore a SeismogramEnsemble from the binary format.  See deserialize_TimeSeriesEnsemble. */
+LoggingEnsemble<Seismogram> deserialize_SeismogramEnsemble(const char *buf,
+  const size_t n, size_t *nused=NULL,
+  const std::vector<SampleBufferView>& samples=std::vector<SampleBufferView>());
+}  // End namespace mspass::seismic
+#endif
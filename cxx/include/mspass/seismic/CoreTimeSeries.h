@@ -3,6 +3,7 @@
 #include <vector>
 #include "mspass/seismic/BasicTimeSeries.h"
 #include "mspass/utility/Metadata.h"
+#include "mspass/utility/SampleVector.h"
 
 namespace mspass::seismic{
 /*! \brief Scalar time series data object.
@@ -18,14 +19,15 @@ class CoreTimeSeries: public mspass::seismic::BasicTimeSeries ,
 {
 public:
 /*!
-Actual data stored as an STL vector container.
-Note the STL guarantees the data elements of vector container are
-contiguous in memory like FORTRAN vectors.  As a result things
+Actual data stored in a copy-on-write container with the interface of
+an STL vector (see mspass::utility::SampleVector).  Copies of an object
+share the samples until one of them changes them.
+The data elements are contiguous in memory like FORTRAN vectors.  As a result things
 like the BLAS can be used with data object by using a syntax
 like this: if d is a CoreTimeSeries object, the address of the first sample of
 the data is &(d.s[0]).
 **/
-	std::vector<double>s;
+	mspass::utility::SampleVector s;
 /*!
 Default constructor.  Initializes object data to zeros and sets the
 initial STL vector size to 0 length.
@@ -1,6 +1,7 @@
 #ifndef _MSPASS_ENSEMBLE_H_
 #define _MSPASS_ENSEMBLE_H_
 #include <vector>
+#include <type_traits>
 #include "mspass/seismic/TimeSeries.h"
 #include "mspass/seismic/Seismogram.h"
 #include "mspass/utility/memory_constants.h"
@@ -86,7 +87,9 @@ public:
     a metadata component.  This method takes the ensemble metadata and
     copies it to each of the member objects.   The operation will overwrite
     previous key:value pairs in a member that are also present in the
-    ensemble metadata.
+    ensemble metadata.   The members share one copy of the ensemble
+    metadata (see Metadata::merge_shared).  A member only copies the
+    shared values when it changes one of them.
     */
   void sync_metadata()
   {
@@ -94,7 +97,7 @@ public:
       for(i=0;i<this->member.size();++i)
       {
           mspass::utility::Metadata *mdmember=&(this->member[i]);
-          (*mdmember)+=dynamic_cast<mspass::utility::Metadata&>(*this);
+          mdmember->merge_shared(dynamic_cast<mspass::utility::Metadata&>(*this));
       }
   };
   /*! \brief copy ensemble metadata to all members except for the ones excluded.
@@ -111,10 +114,42 @@ public:
     for (size_t i = 0; i < this->member.size(); ++i)
     {
       mspass::utility::Metadata *mdmember = &(this->member[i]);
-      (*mdmember) += sync_md;
+      mdmember->merge_shared(sync_md);
     }
   };
+  /*! \brief Store the samples of all members in one contiguous block.
 
+  By default each member owns a separate sample buffer.   This method
+  copies the samples of all members, in member order, into a single
+  block shared by the ensemble.  Each member starts on a 64 byte cache
+  line.  Whole gather operations then run on one contiguous piece of
+  memory and releasing the ensemble frees the samples with one
+  deallocation.   Members keep working normally.   A
+  member changes its samples in place in the block until it is copied,
+  resized, or its samples are converted to a std::vector (as done by the
+  python data property).   Only then does it get a buffer of its own
+  (see mspass::utility::SampleVector::pack).
+
+  Members appended later are not packed.  Call this method again after
+  the ensemble is complete.
+  */
+  void pack_samples()
+  {
+    if constexpr (std::is_base_of<CoreSeismogram,Tdata>::value)
+    {
+      std::vector<mspass::utility::dmatrix*> parts;
+      parts.reserve(this->member.size());
+      for(auto& d : this->member) parts.push_back(&(d.u));
+      mspass::utility::dmatrix::pack(parts);
+    }
+    else
+    {
+      std::vector<mspass::utility::SampleVector*> parts;
+      parts.reserve(this->member.size());
+      for(auto& d : this->member) parts.push_back(&(d.s));
+      mspass::utility::SampleVector::pack(parts);
+    }
+  };
 };
 
 
@@ -1,6 +1,7 @@
 #ifndef _KEYWORDS_H_
 #define _KEYWORDS_H_
 #include <string>
+#include "mspass/utility/MetadataMap.h"
 /*! \brief Define metadata keys.
 
 This include file defines a set ofconst std::string values that serve as
@@ -65,6 +66,12 @@ const std::string SEISMICMD_dfile("dfile");
 const std::string SEISMICMD_dir("dir");
 /*! Offset in bytes from beginning of a file to first data sample.*/
 const std::string SEISMICMD_foff("foff");
+/*! Number of bytes for storage of sample data - required for some formats*/
+const std::string SEISMICMD_nbytes("nbytes");
+/*! Encoding of native sample data in an external file (float64 if not defined).*/
+const std::string SEISMICMD_sample_encoding("sample_encoding");
+/*! Scale factor to convert stored integer samples to data units.*/
+const std::string SEISMICMD_sample_scale("sample_scale");
 /*! Holds transformation matrix in MsPASS use for Seismogram.  */
 const std::string SEISMICMD_tmatrix("tmatrix");
 /*! Universal Unique Identifier used for history.  */
@@ -85,5 +92,24 @@ const std::string SEISMICMD_time_standard("time_standard");
 const std::string SEISMICMD_t0_shift("starttime_shift");
 /*! Defines boolean used in BasicTimeSeries for properly handling Relative/UTC time standards*/
 const std::string SEISMICMD_utc_convertible("utc_convertible");
+
+/* Pre-resolved handles for keys read or written on hot paths.  Metadata
+get, put, and is_defined calls with a handle use the interned key id
+instead of string compares (see mspass::utility::MetadataKey).  The
+template argument is the type stored with the key.*/
+/*! Handle for SEISMICMD_npts. */
+const mspass::utility::MetadataKey<long> SEISMICMD_npts_key(SEISMICMD_npts);
+/*! Handle for SEISMICMD_dt. */
+const mspass::utility::MetadataKey<double> SEISMICMD_dt_key(SEISMICMD_dt);
+/*! Handle for SEISMICMD_t0. */
+const mspass::utility::MetadataKey<double> SEISMICMD_t0_key(SEISMICMD_t0);
+/*! Handle for SEISMICMD_net. */
+const mspass::utility::MetadataKey<std::string> SEISMICMD_net_key(SEISMICMD_net);
+/*! Handle for SEISMICMD_sta. */
+const mspass::utility::MetadataKey<std::string> SEISMICMD_sta_key(SEISMICMD_sta);
+/*! Handle for SEISMICMD_chan. */
+const mspass::utility::MetadataKey<std::string> SEISMICMD_chan_key(SEISMICMD_chan);
+/*! Handle for SEISMICMD_loc. */
+const mspass::utility::MetadataKey<std::string> SEISMICMD_loc_key(SEISMICMD_loc);
 }
 #endif
@@ -0,0 +1,228 @@
+#ifndef _BINARY_ARCHIVE_H_
+#define _BINARY_ARCHIVE_H_
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <utility>
+#include <type_traits>
+#include <boost/serialization/access.hpp>
+#include "mspass/utility/MsPASSError.h"
+namespace mspass
+{
+namespace utility{
+/*! \brief Compact binary output archive for classes with boost serialize methods.
+
+Most mspass classes define a boost serialization template method
+(serialize) that lists the members that define the object.   The boost
+text archives that use those methods are portable but slow and large
+because every number is formatted as text.  The boost binary archives
+add class tracking and version data we never need for the pickle
+interface.   This class is a minimal archive that can be passed to the
+same serialize methods.   It appends the raw bytes of every arithmetic
+and enum member to a buffer and handles the few standard containers used
+by mspass classes.   Strings and containers are written as a count
+followed by the contents.
+
+Values are in host byte order.  The output is intended for moving
+objects between processes (e.g. dask workers) and not as a storage
+format.
+*/
+class BinaryOArchive
+{
+public:
+  /*! Construct an archive that appends to buf. */
+  BinaryOArchive(std::vector<char>& buf) : obuf(buf){};
+  template <typename T> BinaryOArchive& operator&(const T& val)
+  {
+    this->save(val);
+    return *this;
+  };
+  template <typename T> BinaryOArchive& operator<<(const T& val)
+  {
+    this->save(val);
+    return *this;
+  };
+  /*! Append n raw bytes. */
+  void write(const void *p, const size_t n)
+  {
+    if(n==0) return;
+    size_t pos=obuf.size();
+    obuf.resize(pos+n);
+    memcpy(&(obuf[pos]),p,n);
+  };
+  /*! Return the number of bytes in the output buffer. */
+  size_t size() const {return obuf.size();};
+private:
+  std::vector<char>& obuf;
+  template <typename T> void save(const T& val)
+  {
+    if constexpr (std::is_arithmetic<T>::value || std::is_enum<T>::value)
+      this->write(&val,sizeof(T));
+    else
+      boost::serialization::access::serialize(*this,const_cast<T&>(val),0);
+  };
+  void save(const std::string& val)
+  {
+    this->save_count(val.size());
+    this->write(val.data(),val.size());
+  };
+  template <typename T> void save(const std::vector<T>& val)
+  {
+    this->save_count(val.size());
+    if constexpr (std::is_arithmetic<T>::value)
+      this->write(val.data(),sizeof(T)*val.size());
+    else
+      for(auto& v : val) this->save(v);
+  };
+  template <typename T> void save(const std::list<T>& val)
+  {
+    this->save_count(val.size());
+    for(auto& v : val) this->save(v);
+  };
+  template <typename K, typename V> void save(const std::pair<K,V>& val)
+  {
+    this->save(val.first);
+    this->save(val.second);
+  };
+  template <typename K, typename V> void save(const std::map<K,V>& val)
+  {
+    this->save_count(val.size());
+    for(auto& v : val) this->save(v);
+  };
+  template <typename K, typename V> void save(const std::multimap<K,V>& val)
+  {
+    this->save_count(val.size());
+    for(auto& v : val) this->save(v);
+  };
+  void save_count(const size_t n)
+  {
+    uint64_t count(n);
+    this->write(&count,sizeof(uint64_t));
+  };
+};
+/*! \brief Input archive to restore data written by BinaryOArchive.
+
+The archive reads from a buffer owned by the caller.  Every read is
+bounds checked so a truncated or corrupted buffer throws an exception
+instead of reading past the end of the buffer.
+*/
+class BinaryIArchive
+{
+public:
+  /*! Construct an archive that reads n bytes starting at buf.*/
+  BinaryIArchive(const char *buf, const size_t n) : p(buf),end(buf+n){};
+  template <typename T> BinaryIArchive& operator&(T& val)
+  {
+    this->load(val);
+    return *this;
+  };
+  template <typename T> BinaryIArchive& operator>>(T& val)
+  {
+    this->load(val);
+    return *this;
+  };
+  /*! Copy the next n bytes to dest.
+  \exception MsPASSError is thrown if fewer than n bytes remain. */
+  void read(void *dest, const size_t n)
+  {
+    if(n==0) return;
+    this->check(n);
+    memcpy(dest,p,n);
+    p += n;
+  };
+  /*! Return the number of bytes not yet read. */
+  size_t remaining() const {return static_cast<size_t>(end-p);};
+private:
+  const char *p;
+  const char *end;
+  void check(const size_t n) const
+  {
+    if(static_cast<size_t>(end-p)<n)
+      throw MsPASSError("BinaryIArchive:  read past end of buffer - serialized data are truncated or corrupted",
+        ErrorSeverity::Invalid);
+  };
+  template <typename T> void load(T& val)
+  {
+    if constexpr (std::is_arithmetic<T>::value || std::is_enum<T>::value)
+      this->read(&val,sizeof(T));
+    else
+      boost::serialization::access::serialize(*this,val,0);
+  };
+  void load(std::string& val)
+  {
+    size_t n=this->load_count(1);
+    val.assign(p,n);
+    p += n;
+  };
+  template <typename T> void load(std::vector<T>& val)
+  {
+    if constexpr (std::is_arithmetic<T>::value)
+    {
+      size_t n=this->load_count(sizeof(T));
+      val.resize(n);
+      this->read(val.data(),sizeof(T)*n);
+    }
+    else
+    {
+      size_t n=this->load_count(1);
+      val.resize(n);
+      for(auto& v : val) this->load(v);
+    }
+  };
+  template <typename T> void load(std::list<T>& val)
+  {
+    size_t n=this->load_count(1);
+    val.clear();
+    for(size_t i=0;i<n;++i)
+    {
+      T v;
+      this->load(v);
+      val.push_back(std::move(v));
+    }
+  };
+  template <typename K, typename V> void load(std::pair<K,V>& val)
+  {
+    this->load(val.first);
+    this->load(val.second);
+  };
+  /* Maps were written in key order so every insert can use end as the hint */
+  template <typename K, typename V> void load(std::map<K,V>& val)
+  {
+    size_t n=this->load_count(1);
+    val.clear();
+    for(size_t i=0;i<n;++i)
+    {
+      std::pair<K,V> v;
+      this->load(v);
+      val.emplace_hint(val.end(),std::move(v));
+    }
+  };
+  template <typename K, typename V> void load(std::multimap<K,V>& val)
+  {
+    size_t n=this->load_count(1);
+    val.clear();
+    for(size_t i=0;i<n;++i)
+    {
+      std::pair<K,V> v;
+      this->load(v);
+      val.emplace_hint(val.end(),std::move(v));
+    }
+  };
+  /* Reads a count and verifies at least count*minsize bytes remain.  That
+  keeps a corrupted count from triggering a huge allocation. */
+  size_t load_count(const size_t minsize)
+  {
+    uint64_t count;
+    this->read(&count,sizeof(uint64_t));
+    if(count>this->remaining()/minsize)
+      throw MsPASSError("BinaryIArchive:  container size exceeds the size of the buffer - serialized data are corrupted",
+        ErrorSeverity::Invalid);
+    return static_cast<size_t>(count);
+  };
+};
+}  // End utility namespace
+}  // End mspass namespace
+#endif
@@ -11,6 +11,8 @@
 #include <pybind11/pybind11.h>
 #include "mspass/utility/MsPASSError.h"
 #include "mspass/utility/BasicMetadata.h"
+#include "mspass/utility/BinaryArchive.h"
+#include "mspass/utility/MetadataMap.h"
 
 namespace mspass
 {
@@ -124,6 +126,18 @@ other attributes.
   Metadata& operator+=(const Metadata& rhs) noexcept;
   /*! Add two Metadata objects.   Uses operator+=*/
   const Metadata operator+(const Metadata& other) const;
+  /*! \brief Append metadata with replacement sharing the storage of rhs.
+
+  The result is the same as operator+= but the entries of rhs are not
+  copied.   They become an immutable layer shared by rhs and every object
+  merged with it, and are only copied by an object that changes them.
+  Ensemble::sync_metadata uses this so the members of an ensemble hold
+  one copy of the ensemble Metadata instead of one copy per member.
+  Entries of this object not defined in rhs are kept.
+
+  \param rhs is the metadata to be shared by this object.
+  */
+  Metadata& merge_shared(const Metadata& rhs);
   /* All the getters - all but the template are wrappers with the type
   fixed */
   /*!
@@ -133,22 +147,16 @@ other attributes.
   \param key keyword associated with requested metadata member.
   **/
   double get_double(const std::string key) const override{
-    try{
-      double val;
-      val=get<double>(key);
-      return val;
-    }catch(MetadataGetError& merr)
-    {
-    /* Try a float if that failed */
-      try{
-        float fval;
-        fval=get<float>(key);
-        return fval;
-      }catch(MetadataGetError& merr)
-      {
-	throw merr;
-      }
-    }
+    /* Accept a float if the value is not a double.  The type tests use
+    the pointer form of any_cast so no exception is thrown unless both
+    fail. */
+    const boost::any& a=this->value(key,typeid(double).name());
+    const double *dptr=boost::any_cast<double>(&a);
+    if(dptr!=NULL) return *dptr;
+    const float *fptr=boost::any_cast<float>(&a);
+    if(fptr!=NULL) return *fptr;
+    throw MetadataGetError(boost::bad_any_cast().what(),key,
+      typeid(float).name(),a.type().name());
   };
   /*!
   Get an integer from the Metadata object.
@@ -158,22 +166,13 @@ other attributes.
   **/
   int get_int(const std::string key) const override
   {
-      try{
-        int val;
-        val=get<int>(key);
-        return val;
-      }
-      catch(MetadataGetError& merr)
-      {
-	try{
-          long lval;
-  	  lval=get<long>(key);
-  	  return static_cast<int>(lval);
-	}catch(MetadataGetError& merr)
-	{
-	  throw merr;
-	}
-      }
+    const boost::any& a=this->value(key,typeid(int).name());
+    const int *iptr=boost::any_cast<int>(&a);
+    if(iptr!=NULL) return *iptr;
+    const long *lptr=boost::any_cast<long>(&a);
+    if(lptr!=NULL) return static_cast<int>(*lptr);
+    throw MetadataGetError(boost::bad_any_cast().what(),key,
+      typeid(long).name(),a.type().name());
   };
   /*!
   Get a long integer from the Metadata object.
@@ -183,22 +182,13 @@ other attributes.
   **/
   long get_long(const std::string key) const
   {
-      try{
-        long val;
-        val=get<long>(key);
-        return val;
-      }
-      catch(MetadataGetError& merr)
-      {
-	try{
-          int ival;
-  	  ival=get<int>(key);
-  	  return static_cast<long>(ival);
-	}catch(MetadataGetError& merr)
-	{
-	  throw merr;
-	}
-      }
+    const boost::any& a=this->value(key,typeid(long).name());
+    const long *lptr=boost::any_cast<long>(&a);
+    if(lptr!=NULL) return *lptr;
+    const int *iptr=boost::any_cast<int>(&a);
+    if(iptr!=NULL) return static_cast<long>(*iptr);
+    throw MetadataGetError(boost::bad_any_cast().what(),key,
+      typeid(int).name(),a.type().name());
   };
   /*!
   Get a string from the Metadata object.
@@ -281,28 +271,51 @@ other attributes.
   \exception - MetadataGetError if requested parameter is not found.
   */
   boost::any get_any(const std::string key) const {
-    std::map<std::string,boost::any>::const_iterator iptr;
-    iptr=md.find(key);
-    if(iptr==md.end())
-    {
-      throw MetadataGetError(key,typeid(boost::any).name());
-    }
-    return iptr->second;
+    return this->value(key,typeid(boost::any).name());
+  };
+  /*! \brief Get a value with a pre-resolved key handle.
+
+  This is the fast form of get for keys used on hot paths.  See
+  MetadataKey.   The value is converted as in the typed getters:  a
+  double handle accepts a float value (get_double), an int handle a long
+  value (get_int), and a long handle an int value (get_long).  Other
+  types must match the handle exactly.
+
+  \exception MetadataGetError if the key is not defined or the value
+    has a type that cannot be converted.
+  */
+  template <typename T> T get(const MetadataKey<T>& key) const
+  {
+    const boost::any *aptr=md.find(key.id);
+    if(aptr==nullptr)
+      throw MetadataGetError(key.name,typeid(T).name());
+    const T *vptr=boost::any_cast<T>(aptr);
+    if(vptr!=NULL) return *vptr;
+    T val;
+    if(convert_value(*aptr,val)) return val;
+    throw MetadataGetError(boost::bad_any_cast().what(),key.name,
+      typeid(T).name(),aptr->type().name());
   };
   std::string type(const std::string key) const;
   template <typename T> void put(const std::string key, T val) noexcept
   {
-    boost::any aval=val;
-    md[key]=aval;
+    md.insert_or_assign(key,boost::any(val));
     changed_or_set.insert(key);
   }
+  /*! Put a value with a pre-resolved key handle.  See MetadataKey. */
+  template <typename T> void put(const MetadataKey<T>& key,
+    const typename MetadataKey<T>::value_type val) noexcept
+  {
+    md.insert_or_assign(key.name,key.id,boost::any(val));
+    changed_or_set.insert(key.name);
+  }
   template <typename T> void put (const char *key, T val) noexcept
   {
     /* could do this as put(string(key),val) but this is so trivial duplicating
     the code for the string method is more efficient than an added function call.*/
-    boost::any aval=val;
-    md[std::string(key)]=aval;
-    changed_or_set.insert(std::string(key));
+    std::string skey(key);
+    md.insert_or_assign(skey,boost::any(val));
+    changed_or_set.insert(skey);
   }
   void put(const std::string key, const double val) override
   {
@@ -407,6 +420,11 @@ other attributes.
   /*! Test if a key has an associated value.  Returns true if
    * a value is defined. */
   bool is_defined(const std::string key) const noexcept;
+  /*! Test if a key has an associated value using a pre-resolved handle. */
+  template <typename T> bool is_defined(const MetadataKey<T>& key) const noexcept
+  {
+    return md.find(key.id)!=nullptr;
+  };
   /*! Overload for C string*/
   /*
   bool is_defined(const char* key) const noexcept
@@ -426,9 +444,9 @@ other attributes.
   /*! Return the size of the internal map container. */
   std::size_t size() const noexcept;
   /*! Return iterator to beginning of internal map container. */
-  std::map<std::string,boost::any>::const_iterator  begin() const noexcept;
+  MetadataMap::const_iterator  begin() const noexcept;
   /*! Return iterator to end of internal map container. */
-  std::map<std::string,boost::any>::const_iterator  end() const noexcept;
+  MetadataMap::const_iterator  end() const noexcept;
   /*! \brief Change the keyword to access an attribute.
 
   Sometimes it is useful to change the key used to access a particular piece
@@ -446,11 +464,10 @@ other attributes.
   void change_key(const std::string oldkey, const std::string newkey);
   /*! Serialize Metadata to a python bytes object.
   This function is needed to support pickle in the python interface.
-  It cast the C++ object to a Python dict and calls pickle against that
-  dict directly to generate a Python bytes object. This may not be the
-  most elegant approach, but it should be bombproof.
+  The bytes hold the Metadata block written by serialize_metadata_binary
+  so python is only used for values stored as python objects.
     \param md is the Metadata object to be serialized
-    \return pickle serialized data object.
+    \return bytes object holding the serialized data.
   */
   friend pybind11::object serialize_metadata_py(const Metadata &md);
   /*! Unpack serialized Metadata.
@@ -461,32 +478,60 @@ other attributes.
   \return Metadata derived from sd
   */
   friend Metadata restore_serialized_metadata_py(const pybind11::object &sd);
+  friend void serialize_metadata_binary(const Metadata& md, BinaryOArchive& ar);
+  friend void restore_metadata_binary(BinaryIArchive& ar, Metadata& md);
   /*! Standard operator for overloading output to a stringstream */
   friend std::ostringstream& operator<<(std::ostringstream&,
      const mspass::utility::Metadata&);
 protected:
-  std::map<std::string,boost::any> md;
+  MetadataMap md;
+  /* Returns the value for key or throws MetadataGetError naming the
+  requested type if key is not defined. */
+  const boost::any& value(const std::string& key, const char *type_requested) const
+  {
+    const boost::any *aptr=md.find(key);
+    if(aptr==nullptr) throw MetadataGetError(key,type_requested);
+    return *aptr;
+  };
+  /* Conversions accepted by get with a MetadataKey when the value does
+  not have the type of the handle.  They match get_double, get_int, and
+  get_long.  Return false if a is not convertible. */
+  static bool convert_value(const boost::any& a, double& val) noexcept
+  {
+    const float *fptr=boost::any_cast<float>(&a);
+    if(fptr==NULL) return false;
+    val=*fptr;
+    return true;
+  };
+  static bool convert_value(const boost::any& a, int& val) noexcept
+  {
+    const long *lptr=boost::any_cast<long>(&a);
+    if(lptr==NULL) return false;
+    val=static_cast<int>(*lptr);
+    return true;
+  };
+  static bool convert_value(const boost::any& a, long& val) noexcept
+  {
+    const int *iptr=boost::any_cast<int>(&a);
+    if(iptr==NULL) return false;
+    val=*iptr;
+    return true;
+  };
+  template <typename T> static bool convert_value(const boost::any&, T&) noexcept
+  {
+    return false;
+  };
   /* The keys of any entry changed will be contained here.   */
   std::set<std::string> changed_or_set;
 };
 template <typename T> T Metadata::get(const std::string key) const
 {
-  T result;
-  std::map<std::string,boost::any>::const_iterator iptr;
-  iptr=md.find(key);
-  if(iptr==md.end())
-  {
-    throw MetadataGetError(key,typeid(T).name());
-  }
-  boost::any aval=iptr->second;
-  try{
-    result=boost::any_cast<T>(aval);
-  }catch(boost::bad_any_cast& err)
-  {
-    const std::type_info &ti = aval.type();
-    throw MetadataGetError(err.what(),key,typeid(T).name(),ti.name());
-  };
-  return result;
+  const boost::any& aval=this->value(key,typeid(T).name());
+  const T *vptr=boost::any_cast<T>(&aval);
+  if(vptr==NULL)
+    throw MetadataGetError(boost::bad_any_cast().what(),key,typeid(T).name(),
+      aval.type().name());
+  return *vptr;
 }
 /*! Return a pretty name from a boost any object.
  *
@@ -596,6 +641,26 @@ anything else.
 Metadata restore_serialized_metadata(const std::string);
 
 Metadata restore_serialized_metadata_py(const pybind11::object &sd);
+/*! \brief Append Metadata to a binary archive.
+
+This is the Metadata block of the binary format used by the pickle
+interface of data objects.  bool, int, long, float, double, and string
+values are written as raw binary values with a one byte type tag.
+Any other value must be a pybind11 object and is written as a python
+pickle.  The GIL is acquired only for those values.  The block ends with
+a bitmap with one bit per entry marking the keys that are changed or set.
+
+\param md is the Metadata to serialize.
+\param ar is the archive the result is appended to.
+\exception MsPASSError is thrown if a value has an unsupported type.
+*/
+void serialize_metadata_binary(const Metadata& md, BinaryOArchive& ar);
+/*! \brief Restore Metadata written by serialize_metadata_binary.
+
+Entries are added to md so md should normally be empty on entry.
+\exception MsPASSError is thrown if the data are truncated or corrupted.
+*/
+void restore_metadata_binary(BinaryIArchive& ar, Metadata& md);
 } // end utility namespace
 }  //End of namespace MsPASS
 #endif
@@ -0,0 +1,454 @@
+#ifndef _METADATA_MAP_H_
+#define _METADATA_MAP_H_
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <memory>
+#include <algorithm>
+#include <boost/any.hpp>
+#include "mspass/utility/shared_ownership.h"
+namespace mspass{
+namespace utility{
+/*! \brief Return the interned id of a Metadata key.
+
+Every key stored in a Metadata object is given a small integer id that
+is unique for the process.  Ids are assigned the first time a key is
+seen and never change, so comparing ids is equivalent to comparing the
+key strings.  The function is thread safe.   Ids are never 0.
+
+Because ids never change, the table of keys is never pruned.  It holds
+every distinct key stored in any Metadata object during the life of the
+process.  That is a few hundred keys for the schema used by mspass.
+Code that builds key names from data values (e.g. one key per station)
+makes the table grow without bound, at roughly the size of the key plus
+a hash table node per key.   Each thread keeps a cache of the keys it
+has interned, so only the first use of a key by a thread looks in the
+shared table.   That takes a shared lock.   The first use of a new key by
+any thread takes the exclusive lock, which briefly blocks all other
+threads that intern keys.  Both are reasons to keep key names fixed.
+Metadata interns a key string only when it adds the key.
+
+\param key is the key to intern.
+\return id of key.
+*/
+uint32_t intern_metadata_key(const std::string& key);
+/*! \brief Typed, pre-resolved handle for a Metadata key.
+
+A handle holds a key string and its interned id.  Metadata lookups with
+a handle do a binary search of a small contiguous array of ids instead
+of searching the entries with string compares.  Handles for the keys used
+on hot paths are defined in mspass/seismic/keywords.h.  The type T is
+the value type stored with the key.   put with a handle stores exactly
+that type.  get with a handle also accepts the alternative types the
+typed getters of Metadata accept (e.g. an int value for a long handle).
+*/
+template <typename T> class MetadataKey
+{
+public:
+  typedef T value_type;
+  /*! Create a handle for key.   Interns the key. */
+  explicit MetadataKey(const std::string& key)
+    : name(key),id(intern_metadata_key(key)){};
+  /*! Key string. */
+  const std::string name;
+  /*! Interned id of the key. */
+  const uint32_t id;
+  /*! Handles can be used wherever a key string is expected. */
+  operator const std::string&() const {return name;};
+};
+/*! \brief Flat, copy-on-write container of Metadata entries.
+
+Metadata used to store entries in a std::map.   Every entry was a
+separate heap node, so copying the Metadata of a data object allocated
+once per key and lookups walked a tree of scattered nodes.   This class
+stores entries in vectors sorted by key with parallel vectors of the
+interned key ids.   Lookups by string are a binary search over
+contiguous memory.  Lookups with a MetadataKey handle are a binary
+search of an index of the ids.
+
+The entries are held in two layers that are shared, not copied, when a
+MetadataMap is copied:
+  -# An immutable base layer.  The base is set by merge_shared.  An
+     ensemble uses it to give all members one copy of the ensemble
+     Metadata.
+  -# A layer of entries owned by this object.   Entries in this layer
+     hide base entries with the same key.  The layer is shared between
+     copies until one of them changes it (copy on write).
+Base entries that are erased are recorded by id so the base is never
+modified.   A copy of a MetadataMap is therefore constant time and
+the memory of the shared layers is only used once.   Copies that share
+layers can be used by different threads (see sole_owner).  One object
+must not be used by two threads at the same time.
+
+The interface is the subset of std::map used by Metadata.  Iteration
+is in key order over both layers and iterators point to pairs with the
+key (first) and the value (second), the same as for std::map.  Values
+cannot be changed through iterators.  Any change to the container
+invalidates iterators and pointers returned by find.
+*/
+class MetadataMap
+{
+public:
+  typedef std::pair<std::string,boost::any> value_type;
+private:
+  /* One layer of sorted entries and their interned ids */
+  struct Layer
+  {
+    std::vector<value_type> entries;
+    std::vector<uint32_t> ids;
+    /* Positions in entries sorted by id, so find_id is a binary search */
+    std::vector<uint32_t> by_id;
+    /* Rebuilds by_id after entries were appended */
+    void index()
+    {
+      by_id.resize(ids.size());
+      for(std::size_t i=0;i<by_id.size();++i) by_id[i]=static_cast<uint32_t>(i);
+      std::sort(by_id.begin(),by_id.end(),
+        [this](const uint32_t a, const uint32_t b){return ids[a]<ids[b];});
+    };
+  };
+public:
+  /*! Forward iterator over the entries of both layers in key order. */
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef MetadataMap::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef const value_type& reference;
+    const_iterator() : map(nullptr),bi(0),oi(0),in_own(false){};
+    reference operator*() const
+    {
+      return in_own ? map->own->entries[oi] : map->base->entries[bi];
+    };
+    pointer operator->() const {return &(this->operator*());};
+    /*! Interned id of the key of the current entry. */
+    uint32_t id() const
+    {
+      return in_own ? map->own->ids[oi] : map->base->ids[bi];
+    };
+    const_iterator& operator++()
+    {
+      if(in_own)
+        ++oi;
+      else
+        ++bi;
+      this->settle();
+      return *this;
+    };
+    const_iterator operator++(int)
+    {
+      const_iterator result(*this);
+      ++(*this);
+      return result;
+    };
+    bool operator==(const const_iterator& other) const
+    {
+      return bi==other.bi && oi==other.oi;
+    };
+    bool operator!=(const const_iterator& other) const
+    {
+      return !(*this==other);
+    };
+  private:
+    friend class MetadataMap;
+    const MetadataMap *map;
+    std::size_t bi,oi;
+    bool in_own;
+    const_iterator(const MetadataMap *m, const std::size_t b, const std::size_t o)
+      : map(m),bi(b),oi(o),in_own(false)
+    {
+      this->settle();
+    };
+    /* Skips base entries that were erased or are hidden by an owned
+    entry with the same key and then selects the layer with the lower key. */
+    void settle()
+    {
+      const std::size_t nb=map->base_size();
+      const std::size_t no=map->own_size();
+      while(bi<nb)
+      {
+        if(map->is_hidden(map->base->ids[bi]))
+          ++bi;
+        else if(oi<no && map->own->ids[oi]==map->base->ids[bi])
+          ++bi;
+        else
+          break;
+      }
+      if(oi>=no)
+        in_own=false;
+      else if(bi>=nb)
+        in_own=true;
+      else
+        in_own=(map->own->entries[oi].first < map->base->entries[bi].first);
+    };
+  };
+  MetadataMap() : count(0){};
+  std::size_t size() const noexcept {return count;};
+  bool empty() const noexcept {return count==0;};
+  void clear() noexcept
+  {
+    base.reset();
+    own.reset();
+    hidden.clear();
+    count=0;
+  };
+  /*! Reserve space for n owned entries. */
+  void reserve(const std::size_t n)
+  {
+    Layer& layer=this->writable();
+    layer.entries.reserve(n);
+    layer.ids.reserve(n);
+    layer.by_id.reserve(n);
+  };
+  const_iterator begin() const {return const_iterator(this,0,0);};
+  const_iterator end() const
+  {
+    const_iterator result;
+    result.map=this;
+    result.bi=this->base_size();
+    result.oi=this->own_size();
+    return result;
+  };
+  /*! Return a pointer to the value for key or nullptr if key is not defined. */
+  const boost::any* find(const std::string& key) const
+  {
+    if(own)
+    {
+      std::size_t i=lower_bound(*own,key);
+      if(i<own->entries.size() && own->entries[i].first==key)
+        return &(own->entries[i].second);
+    }
+    if(base)
+    {
+      std::size_t i=lower_bound(*base,key);
+      if(i<base->entries.size() && base->entries[i].first==key
+           && !this->is_hidden(base->ids[i]))
+        return &(base->entries[i].second);
+    }
+    return nullptr;
+  };
+  /*! Return a pointer to the value for the key with the interned id or
+  nullptr if the key is not defined. */
+  const boost::any* find(const uint32_t id) const
+  {
+    std::size_t i=find_id(own.get(),id);
+    if(i<this->own_size()) return &(own->entries[i].second);
+    i=find_id(base.get(),id);
+    if(i<this->base_size() && !this->is_hidden(id))
+      return &(base->entries[i].second);
+    return nullptr;
+  };
+  /*! Set the value for key.  Adds the entry if key is not defined.
+  The key is interned only when it is added to the owned layer. */
+  template <typename V> void insert_or_assign(const std::string& key, V&& val)
+  {
+    Layer& layer=this->writable();
+    std::size_t i=lower_bound(layer,key);
+    if(i<layer.entries.size() && layer.entries[i].first==key)
+    {
+      layer.entries[i].second=std::forward<V>(val);
+      return;
+    }
+    const uint32_t id=intern_metadata_key(key);
+    insert_at(layer,i,key,id,std::forward<V>(val));
+    if(!this->in_base(id)) ++count;
+    this->unhide(id);
+  };
+  /*! Set the value for a key with a known interned id. */
+  template <typename V> void insert_or_assign(const std::string& key,
+    const uint32_t id, V&& val)
+  {
+    Layer& layer=this->writable();
+    std::size_t i=find_id(&layer,id);
+    if(i<layer.entries.size())
+    {
+      layer.entries[i].second=std::forward<V>(val);
+      return;
+    }
+    insert_at(layer,lower_bound(layer,key),key,id,std::forward<V>(val));
+    if(!this->in_base(id)) ++count;
+    this->unhide(id);
+  };
+  /*! Set the value for key with a position hint.
+
+  Entries added in key order with hint end() to a MetadataMap without a
+  base are appended without a search.   That makes building a
+  MetadataMap from sorted input linear.*/
+  template <typename V> void insert_or_assign(const const_iterator& hint,
+    const std::string& key, V&& val)
+  {
+    if(!base && hint==this->end()
+        && (this->own_size()==0 || own->entries.back().first<key))
+    {
+      Layer& layer=this->writable();
+      insert_at(layer,layer.entries.size(),key,intern_metadata_key(key),
+        std::forward<V>(val));
+      ++count;
+      return;
+    }
+    this->insert_or_assign(key,std::forward<V>(val));
+  };
+  /*! Erase key if defined.  Returns the number of entries removed. */
+  std::size_t erase(const std::string& key)
+  {
+    bool removed(false);
+    std::size_t i=this->own_size();
+    if(own) i=lower_bound(*own,key);
+    if(i<this->own_size() && own->entries[i].first==key)
+    {
+      Layer& layer=this->writable();
+      erase_at(layer,i);
+      removed=true;
+    }
+    i=this->base_size();
+    if(base) i=lower_bound(*base,key);
+    if(i<this->base_size() && base->entries[i].first==key
+         && !this->is_hidden(base->ids[i]))
+    {
+      hidden.push_back(base->ids[i]);
+      removed=true;
+    }
+    if(!removed) return 0;
+    --count;
+    return 1;
+  };
+  /*! \brief Set all entries of rhs sharing their storage.
+
+  The result is the same as calling insert_or_assign for every entry of
+  rhs, but the entries of rhs become the base of this object and are not
+  copied.  Owned entries with keys defined in rhs are removed and any
+  entries of the previous base that rhs does not define are copied to
+  the owned layer.  Calling this method for many objects with the same
+  rhs makes them all share one copy of the entries of rhs.
+  */
+  void merge_shared(const MetadataMap& rhs)
+  {
+    std::shared_ptr<const Layer> layer=rhs.flattened();
+    if(!layer) return;
+    /* The visible entries not defined by the new base become the new
+    owned layer.   Both are sorted so one pass does the job. */
+    std::shared_ptr<Layer> kept=std::make_shared<Layer>();
+    std::size_t j(0);
+    for(const_iterator ptr=this->begin();ptr!=this->end();++ptr)
+    {
+      while(j<layer->entries.size() && layer->entries[j].first<ptr->first) ++j;
+      if(j<layer->entries.size() && layer->entries[j].first==ptr->first)
+        continue;
+      kept->entries.push_back(*ptr);
+      kept->ids.push_back(ptr.id());
+    }
+    kept->index();
+    count=layer->entries.size()+kept->entries.size();
+    base=std::move(layer);
+    hidden.clear();
+    if(kept->entries.empty())
+      own.reset();
+    else
+      own=std::move(kept);
+  };
+  /*! Return true if the base layer of this object is shared with others. */
+  bool shares_base() const noexcept
+  {
+    return base && !sole_owner(base);
+  };
+private:
+  std::shared_ptr<const Layer> base;
+  std::shared_ptr<Layer> own;
+  /* Ids of base entries that were erased */
+  std::vector<uint32_t> hidden;
+  std::size_t count;
+  std::size_t base_size() const noexcept {return base ? base->entries.size() : 0;};
+  std::size_t own_size() const noexcept {return own ? own->entries.size() : 0;};
+  bool is_hidden(const uint32_t id) const noexcept
+  {
+    return std::find(hidden.begin(),hidden.end(),id)!=hidden.end();
+  };
+  void unhide(const uint32_t id) noexcept
+  {
+    std::vector<uint32_t>::iterator ptr=std::find(hidden.begin(),hidden.end(),id);
+    if(ptr!=hidden.end()) hidden.erase(ptr);
+  };
+  /* True if the base defines id and it was not erased */
+  bool in_base(const uint32_t id) const noexcept
+  {
+    return find_id(base.get(),id)<this->base_size() && !this->is_hidden(id);
+  };
+  /* Returns the owned layer after making sure no other object shares it */
+  Layer& writable()
+  {
+    if(!own)
+      own=std::make_shared<Layer>();
+    else if(!sole_owner(own))
+      own=std::make_shared<Layer>(*own);
+    return *own;
+  };
+  /* Returns one layer with all visible entries.  That is the owned layer
+  itself when there is no base, so it is shared and not copied. */
+  std::shared_ptr<const Layer> flattened() const
+  {
+    if(count==0) return std::shared_ptr<const Layer>();
+    if(!base) return own;
+    if(!own && hidden.empty()) return base;
+    std::shared_ptr<Layer> result=std::make_shared<Layer>();
+    result->entries.reserve(count);
+    result->ids.reserve(count);
+    for(const_iterator ptr=this->begin();ptr!=this->end();++ptr)
+    {
+      result->entries.push_back(*ptr);
+      result->ids.push_back(ptr.id());
+    }
+    result->index();
+    return result;
+  };
+  /* Returns the position of id in layer or the layer size if id is not
+  in layer */
+  static std::size_t find_id(const Layer *layer, const uint32_t id) noexcept
+  {
+    if(!layer) return 0;
+    std::vector<uint32_t>::const_iterator ptr=std::lower_bound(layer->by_id.begin(),
+      layer->by_id.end(),id,
+      [layer](const uint32_t pos, const uint32_t k){return layer->ids[pos]<k;});
+    if(ptr!=layer->by_id.end() && layer->ids[*ptr]==id) return *ptr;
+    return layer->ids.size();
+  };
+  static std::size_t lower_bound(const Layer& layer, const std::string& key)
+  {
+    return std::lower_bound(layer.entries.begin(),layer.entries.end(),key,
+      [](const value_type& a, const std::string& k){return a.first<k;})
+      - layer.entries.begin();
+  };
+  template <typename V> static void insert_at(Layer& layer, const std::size_t i,
+    const std::string& key, const uint32_t id, V&& val)
+  {
+    /* Reserving first means the ids and by_id inserts cannot throw after
+    the entry is added, so the vectors always have the same size. */
+    if(layer.ids.size()==layer.ids.capacity())
+      layer.ids.reserve(2*layer.ids.size()+8);
+    if(layer.by_id.size()==layer.by_id.capacity())
+      layer.by_id.reserve(2*layer.by_id.size()+8);
+    layer.entries.insert(layer.entries.begin()+i,value_type(key,std::forward<V>(val)));
+    layer.ids.insert(layer.ids.begin()+i,id);
+    for(auto& pos : layer.by_id)
+      if(pos>=i) ++pos;
+    std::vector<uint32_t>::iterator ptr=std::lower_bound(layer.by_id.begin(),
+      layer.by_id.end(),id,
+      [&layer](const uint32_t pos, const uint32_t k){return layer.ids[pos]<k;});
+    layer.by_id.insert(ptr,static_cast<uint32_t>(i));
+  };
+  static void erase_at(Layer& layer, const std::size_t i)
+  {
+    layer.entries.erase(layer.entries.begin()+i);
+    layer.ids.erase(layer.ids.begin()+i);
+    layer.by_id.erase(std::find(layer.by_id.begin(),layer.by_id.end(),
+      static_cast<uint32_t>(i)));
+    for(auto& pos : layer.by_id)
+      if(pos>i) --pos;
+  };
+};
+} // End utility namespace
+} // End mspass namespace
+#endif
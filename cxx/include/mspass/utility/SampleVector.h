@@ -0,0 +1,595 @@
+#ifndef _SAMPLE_VECTOR_H_
+#define _SAMPLE_VECTOR_H_
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
+#include "mspass/utility/shared_ownership.h"
+namespace mspass{
+namespace utility{
+/*! \brief Copy-on-write container for sample data.
+
+TimeSeries samples and the dmatrix behind Seismogram data used to be
+stored in std::vector containers, so every copy of a data object copied
+all its samples.   Many processing steps copy an object and only change
+its Metadata.   This class holds the samples in a std::vector that is
+shared by copies through a reference count.   The samples are only
+copied when an object that shares them is about to change them.
+
+The interface is the subset of std::vector<double> used in mspass.  The
+const methods never copy.  Non-const methods that give access to the
+samples (operator[], data, begin, and the like) first make the storage
+private to this object.   The rules for pointers and iterators follow
+from that:
+  -# A pointer or iterator obtained from a non-const method is valid
+     for writes until the container is changed, the same as for
+     std::vector.
+  -# Copies made after a pointer was obtained share the samples.  Writes
+     through the old pointer are then visible in the copies.   Get the
+     pointer again after copying an object if the samples are to be
+     changed.   When that is not possible, as for a numpy array that
+     views the samples, use exclusive_vector.  Copies of such an object
+     never share its samples.
+  -# Sharing a container between threads is safe (see sole_owner).  As
+     for std::vector, one object must not be changed by one thread while
+     used by another.
+     That includes an exclusive object and the views of it.
+
+The const as_vector returns a std::vector copy of the samples for
+functions that take a const std::vector<double>&.  The conversion
+operator does the same but is explicit so the copy is always visible in
+the calling code.   Const methods never change the object, so
+several threads can read one SampleVector.  Use data, size, and the
+iterators to read the samples without copying them.  Use the non-const
+as_vector to get a reference that can be changed.
+
+A SampleVector can also be a view of a range of the samples of another
+one (see slice).   A view reads the parent samples in place.  It is
+materialized into a container of its own the first time it is changed
+or the non-const as_vector is called.   Until then it keeps all the
+parent samples in memory.   A parent that is not exclusive gets samples
+of its own when it is changed while views of it exist, so the views keep
+the old values.   An exclusive parent is changed in place, so its views
+see the new values, unless the change alters its size.  Then the views
+keep the old samples.
+
+pack stores the samples of a group of SampleVectors (e.g. the members
+of an ensemble) in one block.  Each one becomes a slot of that block.
+Slots start on a 64 byte (cache line) boundary and are padded to a
+multiple of 8 samples, so the sample kernels never split a load across
+cache lines and no two slots share a line.   Samples that are not packed
+are in a std::vector<double> that the python bindings use directly, so
+they are only aligned for a double.   The reference counted tokens that track copies of the
+slots are also allocated together, so pack makes a fixed number of
+allocations however many slots there are.   A slot is a view that is changed in place as long as no
+copy of it exists, so code that changes the samples of a packed object
+works on the block without allocating memory.   Copies and views of a
+slot follow the copy-on-write rules above.  The block is released as
+one unit when the last slot is released.
+*/
+class SampleVector
+{
+public:
+  typedef std::vector<double> container_type;
+  typedef double value_type;
+  typedef container_type::size_type size_type;
+  typedef container_type::difference_type difference_type;
+  typedef double& reference;
+  typedef const double& const_reference;
+  typedef container_type::iterator iterator;
+  typedef container_type::const_iterator const_iterator;
+  SampleVector(){};
+  explicit SampleVector(const size_type n, const double val=0.0)
+    : p(std::make_shared<container_type>(n,val)){};
+  SampleVector(const container_type& v)
+    : p(std::make_shared<container_type>(v)){};
+  SampleVector(container_type&& v)
+    : p(std::make_shared<container_type>(std::move(v))){};
+  SampleVector(std::initializer_list<double> vals)
+    : p(std::make_shared<container_type>(vals)){};
+  template <typename InputIt> SampleVector(InputIt first, InputIt last)
+    : p(std::make_shared<container_type>(first,last)){};
+  /*! Copies share the samples unless the parent is exclusive (see
+  exclusive_vector).   Constant time when they are shared. */
+  SampleVector(const SampleVector& parent)
+  {
+    if(parent.exclusive && parent.p)
+      p=std::make_shared<container_type>(parent.cbegin(),parent.cend());
+    else
+      this->share(parent);
+  };
+  SampleVector(SampleVector&& parent)=default;
+  /*! The samples of an exclusive object are replaced in place, as for
+  std::vector, so pointers to them stay valid if the size does not change. */
+  SampleVector& operator=(const SampleVector& parent)
+  {
+    if(this==&parent) return *this;
+    if(this->has_views() && parent.size()==this->size())
+    {
+      /* A view of this object with the same size has the same samples */
+      if(parent.data()!=p->data())
+        std::copy(parent.cbegin(),parent.cend(),p->begin());
+    }
+    else if(exclusive || parent.exclusive)
+      this->assign(parent.cbegin(),parent.cend());
+    else
+      this->share(parent);
+    return *this;
+  };
+  SampleVector& operator=(SampleVector&& parent)
+  {
+    if(exclusive || parent.exclusive)
+      return *this=static_cast<const SampleVector&>(parent);
+    p=std::move(parent.p);
+    off=parent.off;
+    len=parent.len;
+    isview=parent.isview;
+    slot=std::move(parent.slot);
+    parent.clear_view();
+    return *this;
+  };
+  SampleVector& operator=(const container_type& v)
+  {
+    if(exclusive && p)
+      *p=v;
+    else
+    {
+      p=std::make_shared<container_type>(v);
+      this->clear_view();
+    }
+    return *this;
+  };
+  SampleVector& operator=(container_type&& v)
+  {
+    if(exclusive && p)
+      *p=std::move(v);
+    else
+    {
+      p=std::make_shared<container_type>(std::move(v));
+      this->clear_view();
+    }
+    return *this;
+  };
+  SampleVector& operator=(std::initializer_list<double> vals)
+  {
+    if(exclusive && p)
+      *p=vals;
+    else
+    {
+      p=std::make_shared<container_type>(vals);
+      this->clear_view();
+    }
+    return *this;
+  };
+  /*! \brief Return a view of n samples starting at sample first.
+
+  The result shares the samples of this object without copying them.
+  That includes an exclusive object (see exclusive_vector).  The view
+  then sees later changes of the samples of this object that do not
+  alter its size (see the class description).
+  \exception std::out_of_range if the range is not inside this object.
+  */
+  SampleVector slice(const size_type first, const size_type n) const
+  {
+    if(first+n>this->size())
+      throw std::out_of_range("SampleVector::slice:  range is outside the samples");
+    SampleVector result;
+    if(n==0) return result;
+    result.p=p;
+    result.off=off+first;
+    result.len=n;
+    result.isview=true;
+    /* A view of a slot holds the slot so the slot is no longer changed
+    in place while the view exists. */
+    result.slot=slot;
+    return result;
+  };
+  /*! \brief Store the samples of a group of SampleVectors in one block.
+
+  Samples are copied into a single container in the order of parts and
+  each SampleVector becomes a slot of that container (see class
+  description).  Each slot starts on a 64 byte boundary and the gap to
+  the next slot is zero filled.   Empty SampleVectors are left unchanged.
+  Values and sizes are not altered.  Pointers obtained earlier from any
+  of the SampleVectors in parts are invalid after this call.
+  */
+  static void pack(const std::vector<SampleVector*>& parts)
+  {
+    size_type ntotal(0),nslots(0);
+    for(auto v : parts)
+    {
+      if(v->size()==0) continue;
+      ntotal+=padded_size(v->size());
+      ++nslots;
+    }
+    if(ntotal==0) return;
+    /* The container is a std::vector<double>, so its buffer is only
+    aligned for a double.   The extra samples let the first slot start
+    on a line boundary. */
+    std::shared_ptr<container_type> block
+      =std::make_shared<container_type>(ntotal+line_samples-1,0.0);
+    const size_type misalign=(reinterpret_cast<std::uintptr_t>(block->data())
+      %(line_samples*sizeof(double)))/sizeof(double);
+    size_type offset= misalign==0 ? 0 : line_samples-misalign;
+    /* All slot tokens come from one buffer (see slot_pool) */
+    slot_allocator<arena_slot> tokens(std::make_shared<slot_pool>(nslots));
+    for(auto v : parts)
+    {
+      const size_type n=v->size();
+      if(n==0) continue;
+      std::copy(v->cbegin(),v->cend(),block->begin()+offset);
+      v->p=block;
+      v->off=offset;
+      v->len=n;
+      v->isview=true;
+      v->slot=std::allocate_shared<arena_slot>(tokens);
+      v->exclusive=false;
+      offset+=padded_size(n);
+    }
+  };
+  /*! Return true if this is a view of the samples of another object. */
+  bool is_view() const noexcept {return isview && p;};
+  /*! Return true if the samples are stored in a block created by pack. */
+  bool packed() const noexcept {return this->is_view() && slot;};
+  /*! \brief Return a copy of the samples as a std::vector.
+
+  A view or a slot of a packed block has no std::vector of its own, so
+  the const conversion always returns a copy.   Use the iterators or
+  data to read the samples in place. */
+  explicit operator container_type() const {return this->as_vector();};
+  container_type as_vector() const
+  {
+    return container_type(this->cbegin(),this->cend());
+  };
+  /*! \brief Return the samples as a std::vector that can be changed.
+
+  The samples are copied first if they are shared. */
+  container_type& as_vector()
+  {
+    return this->unshared();
+  };
+  /*! \brief Return the samples as a std::vector that is never shared.
+
+  Like the non-const as_vector, but the samples also stay private to this
+  object afterward:  copies made later get samples of their own and
+  assignments to this object copy into the same std::vector.   This is
+  the std::vector behavior, so use it when a reference or pointer to the
+  samples can outlive the call, e.g. for a numpy array viewing them.
+  The object stays exclusive until it is packed or loaded from an
+  archive.  Both release its samples.
+  */
+  container_type& exclusive_vector()
+  {
+    container_type& v=this->unshared();
+    exclusive=true;
+    return v;
+  };
+  /*! Return true if the samples are never shared (see exclusive_vector). */
+  bool is_exclusive() const noexcept {return exclusive && p;};
+  size_type size() const noexcept
+  {
+    if(!p) return 0;
+    return isview ? len : p->size();
+  };
+  bool empty() const noexcept {return this->size()==0;};
+  size_type capacity() const noexcept
+  {
+    if(!p) return 0;
+    return isview ? len : p->capacity();
+  };
+  const double* data() const noexcept {return p ? p->data()+off : nullptr;};
+  /*! Non-const data, operator[], and the iterators check for sharing on
+  every call.   Loops that change many samples should get the pointer
+  from data once and index it. */
+  double* data() {return this->writable_data();};
+  const double& operator[](const size_type i) const {return (*p)[off+i];};
+  double& operator[](const size_type i) {return this->writable_data()[i];};
+  const double& at(const size_type i) const
+  {
+    if(i>=this->size())
+      throw std::out_of_range("SampleVector::at:  index is outside the samples");
+    return (*p)[off+i];
+  };
+  double& at(const size_type i)
+  {
+    if(i>=this->size())
+      throw std::out_of_range("SampleVector::at:  index is outside the samples");
+    return this->writable_data()[i];
+  };
+  const double& front() const {return (*p)[off];};
+  double& front() {return this->writable_data()[0];};
+  const double& back() const {return (*p)[off+this->size()-1];};
+  double& back() {return this->writable_data()[this->size()-1];};
+  const_iterator begin() const noexcept
+  {
+    return p ? p->cbegin()+off : empty_vector().begin();
+  };
+  const_iterator end() const noexcept {return this->begin()+this->size();};
+  const_iterator cbegin() const noexcept {return this->begin();};
+  const_iterator cend() const noexcept {return this->end();};
+  iterator begin()
+  {
+    if(this->in_place()) return p->begin()+off;
+    return this->unshared().begin();
+  };
+  iterator end()
+  {
+    iterator first=this->begin();
+    return first+this->size();
+  };
+  /*! Resize.  Shared samples past the new size are not copied. */
+  void resize(const size_type n, const double val=0.0)
+  {
+    if(this->shared() || (this->has_views() && n!=this->size()))
+    {
+      const size_type ncopy=std::min(n,this->size());
+      std::shared_ptr<container_type> newp=std::make_shared<container_type>();
+      newp->reserve(n);
+      newp->assign(this->cbegin(),this->cbegin()+ncopy);
+      newp->resize(n,val);
+      p=std::move(newp);
+      this->clear_view();
+    }
+    else
+      this->unshared().resize(n,val);
+  };
+  void reserve(const size_type n)
+  {
+    this->release_views();
+    this->unshared().reserve(n);
+  };
+  void shrink_to_fit()
+  {
+    if(p && !this->shared() && !isview && !this->has_views()) p->shrink_to_fit();
+  };
+  /*! Remove all samples.   Shared samples are released, not copied. */
+  void clear() noexcept
+  {
+    if(this->shared() || isview || this->has_views())
+    {
+      p.reset();
+      this->clear_view();
+    }
+    else if(p)
+      p->clear();
+  };
+  /*! Replace the contents.  Shared samples are released, not copied. */
+  void assign(const size_type n, const double val)
+  {
+    if(this->shared() || isview || this->has_views())
+    {
+      p.reset();
+      this->clear_view();
+    }
+    this->unshared().assign(n,val);
+  };
+  template <typename InputIt> void assign(InputIt first, InputIt last)
+  {
+    /* The range may point into the shared samples so they are released
+    only after the new container is built. */
+    if(this->shared() || isview || this->has_views())
+    {
+      p=std::make_shared<container_type>(first,last);
+      this->clear_view();
+    }
+    else
+      this->unshared().assign(first,last);
+  };
+  void push_back(const double val)
+  {
+    this->release_views();
+    this->unshared().push_back(val);
+  };
+  template <typename... Args> iterator insert(const_iterator pos, Args&&... args)
+  {
+    /* pos can point into shared samples.   Convert to an offset before
+    making the samples private. */
+    const difference_type i=pos-this->cbegin();
+    this->release_views();
+    container_type& v=this->unshared();
+    return v.insert(v.begin()+i,std::forward<Args>(args)...);
+  };
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    const difference_type i=first-this->cbegin();
+    const difference_type j=last-this->cbegin();
+    this->release_views();
+    container_type& v=this->unshared();
+    return v.erase(v.begin()+i,v.begin()+j);
+  };
+  void swap(SampleVector& other) noexcept
+  {
+    p.swap(other.p);
+    std::swap(off,other.off);
+    std::swap(len,other.len);
+    std::swap(isview,other.isview);
+    slot.swap(other.slot);
+    std::swap(exclusive,other.exclusive);
+  };
+  /*! Return true if the samples are shared with another object.  A view
+  is always shared unless it is a slot created by pack that has not been
+  copied.   Views of an exclusive object do not count (see the class
+  description). */
+  bool shared() const noexcept
+  {
+    if(!p) return false;
+    if(isview) return !slot || !sole_owner(slot);
+    return !exclusive && !sole_owner(p);
+  };
+  bool operator==(const SampleVector& other) const
+  {
+    if(this->size()!=other.size()) return false;
+    if(this->data()==other.data()) return true;
+    return std::equal(this->cbegin(),this->cend(),other.cbegin());
+  };
+  bool operator!=(const SampleVector& other) const {return !(*this==other);};
+private:
+  std::shared_ptr<container_type> p;
+  /* A view is the range [off,off+len) of *p.  off is 0 and len is
+  unused when isview is false. */
+  size_type off=0;
+  size_type len=0;
+  bool isview=false;
+  /* Set for slots created by pack and views of them.  Copies share it,
+  so the range can be changed in place only when its count is one. */
+  struct arena_slot{};
+  std::shared_ptr<arena_slot> slot;
+  /* Each slot needs a token with a reference count of its own.  pack
+  allocates them with slot_allocator, which takes the shared_ptr control
+  blocks of all the tokens of one block from a single buffer.  The
+  buffer is released with the last token. */
+  struct slot_pool
+  {
+    explicit slot_pool(const size_type n) noexcept : nslots(n){};
+    ~slot_pool(){::operator delete(buffer);};
+    slot_pool(const slot_pool&)=delete;
+    slot_pool& operator=(const slot_pool&)=delete;
+    size_type nslots;
+    size_type used=0;
+    size_t stride=0;
+    void *buffer=nullptr;
+  };
+  template <typename T> struct slot_allocator
+  {
+    typedef T value_type;
+    explicit slot_allocator(std::shared_ptr<slot_pool> sp) noexcept
+      : pool(std::move(sp)){};
+    template <typename U> slot_allocator(const slot_allocator<U>& other) noexcept
+      : pool(other.pool){};
+    T* allocate(const size_t n)
+    {
+      slot_pool& sp=*pool;
+      if(n==1 && alignof(T)<=__STDCPP_DEFAULT_NEW_ALIGNMENT__
+         && (sp.stride==0 || sp.stride==sizeof(T)) && sp.used<sp.nslots)
+      {
+        if(!sp.buffer)
+        {
+          sp.buffer=::operator new(sizeof(T)*sp.nslots);
+          sp.stride=sizeof(T);
+        }
+        return reinterpret_cast<T*>(static_cast<char*>(sp.buffer)+sp.stride*(sp.used++));
+      }
+      return std::allocator<T>().allocate(n);
+    };
+    void deallocate(T *ptr, const size_t n) noexcept
+    {
+      const char *c=reinterpret_cast<const char*>(ptr);
+      const char *b=static_cast<const char*>(pool->buffer);
+      /* Tokens in the buffer are freed with the pool */
+      if(b && c>=b && c<b+pool->stride*pool->nslots) return;
+      std::allocator<T>().deallocate(ptr,n);
+    };
+    template <typename U> bool operator==(const slot_allocator<U>& other) const noexcept
+    {
+      return pool==other.pool;
+    };
+    template <typename U> bool operator!=(const slot_allocator<U>& other) const noexcept
+    {
+      return pool!=other.pool;
+    };
+    std::shared_ptr<slot_pool> pool;
+  };
+  /* Set by exclusive_vector.  Copies and views do not inherit it. */
+  bool exclusive=false;
+  /* Number of samples in a 64 byte cache line.  pack aligns slots to it. */
+  static constexpr size_type line_samples=64/sizeof(double);
+  static size_type padded_size(const size_type n) noexcept
+  {
+    return ((n+line_samples-1)/line_samples)*line_samples;
+  };
+  static const container_type& empty_vector() noexcept
+  {
+    static const container_type empty;
+    return empty;
+  };
+  /* Makes this object share the samples of parent */
+  void share(const SampleVector& parent)
+  {
+    p=parent.p;
+    off=parent.off;
+    len=parent.len;
+    isview=parent.isview;
+    slot=parent.slot;
+  };
+  void clear_view() noexcept
+  {
+    off=0;
+    len=0;
+    isview=false;
+    slot.reset();
+  };
+  /* True for a slot that can be changed without copying */
+  bool in_place() const noexcept
+  {
+    return isview && slot && sole_owner(slot);
+  };
+  /* True for an exclusive object that views refer to.  Only views can
+  share the samples of an exclusive object. */
+  bool has_views() const noexcept
+  {
+    return exclusive && !isview && p && !sole_owner(p);
+  };
+  /* Called before the size of an exclusive object is changed in place.
+  The views keep the old samples. */
+  void release_views()
+  {
+    if(this->has_views()) p=std::make_shared<container_type>(*p);
+  };
+  /* Returns a pointer to the first sample that can be used for writes */
+  double* writable_data()
+  {
+    if(this->in_place()) return p->data()+off;
+    return this->unshared().data();
+  };
+  /* Replaces a view by a private copy of its range */
+  void materialize()
+  {
+    p=std::make_shared<container_type>(p->cbegin()+off,p->cbegin()+off+len);
+    this->clear_view();
+  };
+  /* Returns the samples after making sure no other object shares them */
+  container_type& unshared()
+  {
+    if(!p)
+    {
+      p=std::make_shared<container_type>();
+      this->clear_view();
+    }
+    else if(isview)
+      this->materialize();
+    else if(!exclusive && !sole_owner(p))
+      p=std::make_shared<container_type>(*p);
+    return *p;
+  };
+  friend class boost::serialization::access;
+  template<class Archive> void save(Archive& ar, const unsigned int version) const
+  {
+    if(p && !isview)
+    {
+      const container_type& v=*p;
+      ar & v;
+    }
+    else
+    {
+      const container_type v(this->cbegin(),this->cend());
+      ar & v;
+    }
+  };
+  template<class Archive> void load(Archive& ar, const unsigned int version)
+  {
+    container_type v;
+    ar & v;
+    p=std::make_shared<container_type>(std::move(v));
+    this->clear_view();
+    exclusive=false;
+  };
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+};
+} // End utility namespace
+} // End mspass namespace
+#endif
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <type_traits>
 /* Either text or binary can be specified here, but we use binary
  * to emphasize this class is normally serialized binary for 
  * speed*/
@@ -11,6 +12,7 @@
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/binary_iarchive.hpp>
 #include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/SampleVector.h"
 namespace mspass
 {
 namespace utility{       
@@ -83,6 +85,61 @@ Basic constructor for this error object.
 private:
 	size_t nrow1, ncol1, nrow2, ncol2;
 };
+/*! \brief Unchecked access to the elements of a dmatrix.
+
+The indexing operator of dmatrix checks the indices on every call and
+the non-const version also has to test if the samples are shared
+(see SampleVector).  That is a large cost in the inner loops of numerical
+kernels.   This class is a raw pointer with the matrix dimensions that
+does neither.   Get one from dmatrix::unchecked.  T is double for write
+access and const double for read only access.
+
+Like a pointer from get_address an object of this class is invalidated
+by anything that changes the size of the matrix.  It is also not
+updated if the matrix is copied, so write through it only if the
+matrix was not copied after it was obtained.  There is no bounds checking
+at all so use it only in code where the indices are known to be valid.
+*/
+template <typename T> class UncheckedMatrix
+{
+public:
+  UncheckedMatrix(T *p, const size_t nr, const size_t nc) noexcept
+    : ptr(p),nrr(nr),ncc(nc){};
+  T& operator()(const size_t r, const size_t c) const noexcept
+  {
+    return ptr[r+nrr*c];
+  };
+  /*! Pointer to the first element of column c.   Columns are contiguous. */
+  T* column(const size_t c) const noexcept {return ptr+nrr*c;};
+  /*! Iterators over all elements in Fortran order. */
+  T* begin() const noexcept {return ptr;};
+  T* end() const noexcept {return ptr+nrr*ncc;};
+  size_t rows() const noexcept {return nrr;};
+  size_t columns() const noexcept {return ncc;};
+private:
+  T *ptr;
+  size_t nrr, ncc;
+};
+/*! \brief Base of lazy element-wise dmatrix expressions.
+
+The +, - and scalar * operators for dmatrix objects return small
+expression objects instead of a new matrix.   Assigning an expression to
+a dmatrix evaluates it element by element in one loop, so a construct
+like X=a*A+B-C allocates only X.   E is the derived expression type.
+
+Operands are referenced, not copied.  An expression must be used in the
+statement that creates it.  Never store one in a variable declared with
+auto.
+*/
+template <typename E> class dmatrix_expression
+{
+public:
+  const E& derived() const noexcept {return static_cast<const E&>(*this);};
+};
+class dmatrix_operand;
+template <typename L, typename R, typename Op> class dmatrix_binary_expression;
+struct dmatrix_add;
+struct dmatrix_subtract;
 /*! \brief Lightweight, simple matrix object. 
  
 This class defines a lightweight, simple double precision matrix.
@@ -127,6 +184,21 @@ Can also be used to set an element as a left hand side (e.g. A(2,4)=2.0;).
   double& operator()(size_t r,size_t c);
 /*! Standard assignment operator */
   dmatrix& operator=(const dmatrix& other);
+/*! \brief Construct from an element-wise expression like A+B.
+
+See dmatrix_expression.
+*/
+  template <typename E> dmatrix(const dmatrix_expression<E>& x)
+    : length(0),nrr(0),ncc(0)
+  {
+    this->assign_expression(x.derived());
+  };
+/*! Evaluate an element-wise expression into this matrix. */
+  template <typename E> dmatrix& operator=(const dmatrix_expression<E>& x)
+  {
+    this->assign_expression(x.derived());
+    return *this;
+  };
   /*! \brief Add one matrix to another.
 
   Matrix addition is a standard operation but demands the two matrices
@@ -147,26 +219,20 @@ Can also be used to set an element as a left hand side (e.g. A(2,4)=2.0;).
   \exception throws a dmatrix_size_error if other and this are not the same size.
   */
   dmatrix& operator-=(const dmatrix& other);
-  /*! Operator to add two matrices. 
-
-  This operator is similar to += but is the operator used in constructs
-  like X=A+B.  Like += other and this must be the same size or an 
-  exception will be thrown.
-
-  \param other matrix to be added
-  \exception throws a dmatrix_size_error if other and this are not the same size.
-  */
-  dmatrix operator+(const dmatrix& other) const;
-  /*! Operator to add two matrices. 
-
-  This operator is similar to -= but is the operator used in constructs
-  like X=A-B.  Like -= other and this must be the same size or an 
-  exception will be thrown.
-
-  \param other matrix to be added
-  \exception throws a dmatrix_size_error if other and this are not the same size.
-  */
-  dmatrix operator-(const dmatrix& other) const;
+  /*! Add an element-wise expression to this matrix in one pass. */
+  template <typename E> dmatrix& operator+=(const dmatrix_expression<E>& x)
+  {
+    this->assign_expression(
+      dmatrix_binary_expression<dmatrix_operand,E,dmatrix_add>(*this,x.derived()));
+    return *this;
+  };
+  /*! Subtract an element-wise expression from this matrix in one pass. */
+  template <typename E> dmatrix& operator-=(const dmatrix_expression<E>& x)
+  {
+    this->assign_expression(
+      dmatrix_binary_expression<dmatrix_operand,E,dmatrix_subtract>(*this,x.derived()));
+    return *this;
+  };
   //friend class dvector;
   /*! \brief 
 
@@ -180,22 +246,11 @@ Can also be used to set an element as a left hand side (e.g. A(2,4)=2.0;).
     \exception dmatrix_size_error will be thrown if the columns in A are not
        equal to the rows in B.
     \return A*B
+
+    The product is computed with one call to the BLAS function dgemm
+    (see matmul).
        */
   friend dmatrix operator*(const dmatrix& A, const dmatrix& B);
-//@{
-// Scale a matrix by a constant.  X=c*A where c is a constant.
-//@}
-  /*! \brief Scale a matrix by a constant
-
-  This procedure will multiply all elements of a matrix by a constant.
-  The linear algebra concept of scaling a matrix.  
-
-  \param s is the scaling factor
-  \param A is the matrix to be scaled
-  \return sA 
-  */
-  friend dmatrix operator*(const double& s, const dmatrix& A) noexcept;
-  dmatrix operator* (double s) const noexcept;
   /*! \brief Transpose a matrix
    *
    A standard matrix operation is to transpose a matrix (reversing rows
@@ -215,13 +270,66 @@ Can also be used to set an element as a left hand side (e.g. A(2,4)=2.0;).
   The contiguous memory guarantee of std::vector allows vector operations
   with the BLAS to work by rows or columns.  
 
+  Copies of a dmatrix share the samples until one of them is changed
+  (see SampleVector).   The non-const version of this method makes the
+  samples private to this matrix before returning the pointer, so use it
+  to change the data.   Copies made later share the samples again, so
+  get the pointer again after copying the matrix.  The const version
+  never copies and returns a pointer that can only be used to read the data.
+
   \param r is the row index of the desired address
   \param c is the column index of the desired memory address.
   \return pointer to component at row r and column c.
   \exception dmatrix_size_error will be throw if r or c are outside 
     matrix dimensions. 
     */
-  double* get_address(size_t r, size_t c) const;
+  const double* get_address(size_t r, size_t c) const;
+  double* get_address(size_t r, size_t c);
+  /*! \brief Get a pointer that stays valid for writes when the matrix is copied.
+
+  Same as the non-const get_address, but the samples of this matrix are
+  never shared afterward (see SampleVector::exclusive_vector).   Use it
+  when the pointer can outlive the call, as for the numpy view of
+  the python buffer protocol.
+
+  \exception dmatrix_index_error if r or c are outside matrix dimensions.
+  */
+  double* exclusive_address(size_t r, size_t c);
+  /*! \brief Return a matrix that views a range of columns of this one.
+
+  Columns are contiguous in the Fortran order storage so the result can
+  share the samples of this matrix without copying them.  The view is
+  copied into memory of its own the first time it is changed
+  (see SampleVector::slice).
+
+  \param c0 is the first column of the range.
+  \param nc is the number of columns in the range.
+  \exception dmatrix_index_error if the range is not inside this matrix.
+  */
+  dmatrix column_range(const size_t c0, const size_t nc) const;
+  /*! \brief Store the elements of a group of matrices in one block.
+
+  Used to put the matrices of ensemble members in contiguous memory.
+  Values and sizes are not changed.  Pointers obtained earlier from any of
+  the matrices are invalid after this call (see SampleVector::pack).
+
+  \param parts are the matrices to be packed, in storage order.
+  */
+  static void pack(const std::vector<dmatrix*>& parts);
+  /*! \brief Return unchecked access to the elements of this matrix.
+
+  Intended for internal numerical kernels.  The non-const version makes
+  the samples private to this matrix once, so writes in the loop that
+  follows do not have to test for sharing.  See UncheckedMatrix.
+  */
+  UncheckedMatrix<double> unchecked()
+  {
+    return UncheckedMatrix<double>(ary.data(),nrr,ncc);
+  };
+  UncheckedMatrix<const double> unchecked() const
+  {
+    return UncheckedMatrix<const double>(ary.data(),nrr,ncc);
+  };
   /*! \brief Text output operator.
 
   Output is ascii data written in the matrix layout.  Note this can create
@@ -243,7 +351,7 @@ Can also be used to set an element as a left hand side (e.g. A(2,4)=2.0;).
   /*! Initialize a matrix to all zeros. */
   void zero();
 protected:
-   std::vector<double> ary;   // initial size of container 0
+   SampleVector ary;   // initial size of container 0, shared by copies
    size_t length;
    size_t nrr, ncc;
 private:
@@ -254,7 +362,180 @@ private:
        ar & nrr & ncc & length;
        ar & ary;
    }
+   /* Evaluates x into this matrix.   Element-wise expressions can be
+   evaluated in place when the samples are private and the size does not
+   change.  Otherwise the result goes to a new matrix, so the current
+   samples, which operands may point to, live until x is evaluated. */
+   template <typename E> void assign_expression(const E& x)
+   {
+     if(ary.shared() || (nrr!=x.rows()) || (ncc!=x.columns()))
+     {
+       dmatrix result(x.rows(),x.columns());
+       result.evaluate(x);
+       *this=result;
+     }
+     else
+       this->evaluate(x);
+   };
+   template <typename E> void evaluate(const E& x)
+   {
+     const size_t n=nrr*ncc;
+     double *ptr=ary.data();
+     for(size_t i=0;i<n;++i) ptr[i]=x[i];
+   };
+};
+/*! \brief Leaf of a dmatrix expression that refers to a dmatrix. */
+class dmatrix_operand : public dmatrix_expression<dmatrix_operand>
+{
+public:
+  dmatrix_operand(const dmatrix& a) noexcept
+    : ptr(a.unchecked().begin()),nrr(a.rows()),ncc(a.columns()){};
+  size_t rows() const noexcept {return nrr;};
+  size_t columns() const noexcept {return ncc;};
+  double operator[](const size_t i) const noexcept {return ptr[i];};
+private:
+  const double *ptr;
+  size_t nrr, ncc;
+};
+struct dmatrix_add
+{
+  static double apply(const double a, const double b) noexcept {return a+b;};
+};
+struct dmatrix_subtract
+{
+  static double apply(const double a, const double b) noexcept {return a-b;};
+};
+/*! \brief Element-wise sum or difference of two dmatrix expressions.
+
+The sizes are checked when the expression is created so errors are
+thrown from the operator as they were before expressions were added.
+Op is dmatrix_add or dmatrix_subtract.
+*/
+template <typename L, typename R, typename Op> class dmatrix_binary_expression
+  : public dmatrix_expression<dmatrix_binary_expression<L,R,Op>>
+{
+public:
+  dmatrix_binary_expression(const L& a, const R& b) : lhs(a),rhs(b)
+  {
+    if((a.rows()!=b.rows()) || (a.columns()!=b.columns()))
+      throw dmatrix_size_error(a.rows(),a.columns(),b.rows(),b.rows()*b.columns());
+  };
+  size_t rows() const noexcept {return lhs.rows();};
+  size_t columns() const noexcept {return lhs.columns();};
+  double operator[](const size_t i) const noexcept
+  {
+    return Op::apply(lhs[i],rhs[i]);
+  };
+private:
+  /* Nodes and leaves are small so they are held by value */
+  L lhs;
+  R rhs;
 };
+/*! \brief A dmatrix expression multiplied by a scalar. */
+template <typename E> class dmatrix_scaled_expression
+  : public dmatrix_expression<dmatrix_scaled_expression<E>>
+{
+public:
+  dmatrix_scaled_expression(const double s, const E& a) noexcept
+    : scale(s),x(a){};
+  size_t rows() const noexcept {return x.rows();};
+  size_t columns() const noexcept {return x.columns();};
+  double operator[](const size_t i) const noexcept {return scale*x[i];};
+private:
+  double scale;
+  E x;
+};
+/* Maps the types that can appear in an expression to the type stored in
+the expression tree.   Other types have no member type, which removes
+the operators below from overload resolution for them. */
+template <typename T, typename Enable=void> struct dmatrix_operand_type {};
+template <typename T> struct dmatrix_operand_type<T,
+  typename std::enable_if<std::is_base_of<dmatrix,T>::value>::type>
+{
+  typedef dmatrix_operand type;
+};
+template <typename T> struct dmatrix_operand_type<T,
+  typename std::enable_if<std::is_base_of<dmatrix_expression<T>,T>::value>::type>
+{
+  typedef T type;
+};
+template <typename T> using dmatrix_operand_t=typename dmatrix_operand_type<T>::type;
+/*! \brief Add two matrices.
+
+The result is a lazy expression that converts to a dmatrix (see
+dmatrix_expression).  A and B must be the same size.
+
+\exception dmatrix_size_error if A and B are not the same size.
+*/
+template <typename L, typename R>
+dmatrix_binary_expression<dmatrix_operand_t<L>,dmatrix_operand_t<R>,dmatrix_add>
+  operator+(const L& A, const R& B)
+{
+  return dmatrix_binary_expression<dmatrix_operand_t<L>,dmatrix_operand_t<R>,dmatrix_add>(
+    dmatrix_operand_t<L>(A),dmatrix_operand_t<R>(B));
+}
+/*! \brief Subtract two matrices.   See operator+. */
+template <typename L, typename R>
+dmatrix_binary_expression<dmatrix_operand_t<L>,dmatrix_operand_t<R>,dmatrix_subtract>
+  operator-(const L& A, const R& B)
+{
+  return dmatrix_binary_expression<dmatrix_operand_t<L>,dmatrix_operand_t<R>,dmatrix_subtract>(
+    dmatrix_operand_t<L>(A),dmatrix_operand_t<R>(B));
+}
+/*! \brief Scale a matrix by a constant
+
+This procedure will multiply all elements of a matrix by a constant.
+The linear algebra concept of scaling a matrix.   The result is a lazy
+expression that converts to a dmatrix (see dmatrix_expression).
+
+\param s is the scaling factor
+\param A is the matrix to be scaled
+\return sA
+*/
+template <typename T> dmatrix_scaled_expression<dmatrix_operand_t<T>>
+  operator*(const double s, const T& A) noexcept
+{
+  return dmatrix_scaled_expression<dmatrix_operand_t<T>>(s,dmatrix_operand_t<T>(A));
+}
+template <typename T> dmatrix_scaled_expression<dmatrix_operand_t<T>>
+  operator*(const T& A, const double s) noexcept
+{
+  return dmatrix_scaled_expression<dmatrix_operand_t<T>>(s,dmatrix_operand_t<T>(A));
+}
+/* Matrix products and transposes are not element-wise.  These evaluate
+expression arguments and use the dmatrix versions. */
+inline const dmatrix& dmatrix_evaluate(const dmatrix& A) noexcept {return A;}
+template <typename E> dmatrix dmatrix_evaluate(const dmatrix_expression<E>& A)
+{
+  return dmatrix(A);
+}
+template <typename L, typename R, typename=dmatrix_operand_t<L>,
+  typename=dmatrix_operand_t<R>> typename std::enable_if<
+  !std::is_base_of<dmatrix,L>::value || !std::is_base_of<dmatrix,R>::value,
+  dmatrix>::type operator*(const L& A, const R& B)
+{
+  return dmatrix_evaluate(A)*dmatrix_evaluate(B);
+}
+template <typename E> dmatrix tr(const dmatrix_expression<E>& A)
+{
+  return tr(dmatrix(A));
+}
+/*! \brief Multiply two matrices with optional transposes.
+
+Computes op(A)*op(B) where op(X) is X or X^T.  The product is computed
+with one call to the BLAS function dgemm, which works on the transposed
+forms directly.  That is much faster than forming tr(A) or tr(B) and
+using operator*.
+
+\param A is the left matrix.
+\param B is the right matrix.
+\param transpose_A when true use A^T in place of A.
+\param transpose_B when true use B^T in place of B.
+\exception dmatrix_size_error if op(A) and op(B) are not compatible.
+\return op(A)*op(B)
+*/
+dmatrix matmul(const dmatrix& A, const dmatrix& B,
+  const bool transpose_A=false, const bool transpose_B=false);
 /*! \brief A vector compatible with dmatrix objects.
  
 A vector is a special case of a matrix with one row or column.   In this 
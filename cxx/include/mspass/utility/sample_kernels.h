@@ -0,0 +1,33 @@
+#ifndef _SAMPLE_KERNELS_H_
+#define _SAMPLE_KERNELS_H_
+#include <cstddef>
+#include <string>
+/* Vector kernels for the element-wise sample operations used by the
+arithmetic operators of the seismic data objects and dmatrix.   Each
+function has an AVX-512, AVX2, and portable implementation.  The best one
+the cpu supports is selected the first time any of them is called, so a
+library built for a generic x86-64 target still uses the wide registers
+when they exist.  Loads are unaligned so any pointer into a sample buffer
+is valid.  Packed samples (see SampleVector::pack) start on a 64 byte
+boundary and run faster.
+
+Results of add, subtract, and scale are identical on every path.
+sum_of_squares accumulates in several partial sums on the vector paths so
+its result can differ from a sequential sum by normal rounding error.
+*/
+namespace mspass::utility{
+/*! Multiply n samples starting at y by a.  */
+void scale_samples(double *y, const size_t n, const double a);
+/*! Compute y[i]+=x[i] for n samples.  y and x must not partially overlap. */
+void add_samples(double *y, const double *x, const size_t n);
+/*! Compute y[i]-=x[i] for n samples.  y and x must not partially overlap. */
+void subtract_samples(double *y, const double *x, const size_t n);
+/*! Return the sum of the squares of n samples starting at x.  */
+double sum_of_squares(const double *x, const size_t n);
+/*! Return the name of the instruction set selected for the sample kernels.
+
+Value is one of "avx512", "avx2", or "generic".   Mainly for tests
+and diagnostics. */
+std::string sample_kernel_isa();
+} // End mspass::utility namespace
+#endif
@@ -0,0 +1,29 @@
+#ifndef _SHARED_OWNERSHIP_H_
+#define _SHARED_OWNERSHIP_H_
+#include <memory>
+#include <atomic>
+namespace mspass::utility
+{
+/*! \brief Return true if ptr holds the only reference to its object.
+
+Used by the copy-on-write containers (SampleVector and MetadataMap) to
+decide if the object can be changed in place.   When the answer is true
+no other reference exists, so no other thread can create one, and the
+answer cannot become wrong.   shared_ptr::use_count is only a relaxed
+load, though.  Alone it does not order the writes that follow after the
+reads other threads made through references they have since released.
+The acquire fence does that:  the release of the last other reference
+(an acq_rel decrement in the standard library) synchronizes with it.
+A false answer can be stale.  That only costs a copy that was not needed.
+
+Both containers still require that one object is not used by two
+threads at the same time.
+*/
+template <typename T> bool sole_owner(const std::shared_ptr<T>& ptr) noexcept
+{
+  if(ptr.use_count()!=1) return false;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return true;
+}
+} // End mspass::utility namespace
+#endif
@@ -0,0 +1,32 @@
+#include <pybind11/pybind11.h>
+#include <mspass/seismic/Ensemble.h>
+#include <mspass/algorithms/EnsembleWorkers.h>
+namespace mspass {
+namespace mspasspy {
+/* Runs f(nthreads) for an ensemble entry point with the GIL released.
+Metadata values that are python objects cannot be copied or destroyed
+without the GIL, so when the ensemble holds any f is run with one thread
+and the GIL held. */
+template <typename Tdata, typename Function>
+  void run_without_gil(const mspass::seismic::Ensemble<Tdata>& d,
+    const size_t nthreads, Function f)
+{
+  if(mspass::algorithms::hold_python_objects(d))
+  {
+    f(1);
+    return;
+  }
+  pybind11::gil_scoped_release release;
+  f(nthreads);
+}
+/* Binding of apply_to_members for operators with apply methods */
+template <typename Operator, typename Tdata>
+  void apply_to_members_py(const Operator& op,
+    mspass::seismic::LoggingEnsemble<Tdata>& d, const size_t nthreads)
+{
+  run_without_gil(d,nthreads,[&](const size_t nt){
+      mspass::algorithms::apply_to_members(op,d,nt);
+    });
+}
+} // namespace mspasspy
+} // namespace mspass
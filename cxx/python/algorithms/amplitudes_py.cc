@@ -2,6 +2,7 @@
 #include <pybind11/stl.h>
 
 #include <mspass/algorithms/amplitudes.h>
+#include "python/algorithms/EnsembleWorkers_py.h"
 
 namespace mspass {
 namespace mspasspy {
@@ -75,21 +76,31 @@ PYBIND11_MODULE(amplitudes, m) {
     py::return_value_policy::copy,
     py::arg("d"),py::arg("method"),py::arg("level"),py::arg("window") )
   ;
-  m.def("_scale_ensemble_members",py::overload_cast<Ensemble<Seismogram>&,
-          const ScalingMethod&,
-            const double,
-               const TimeWindow>(&scale_ensemble_members<Seismogram>),
+  m.def("_scale_ensemble_members",[](Ensemble<Seismogram>& d, const ScalingMethod& method,
+        const double level, const TimeWindow window, const size_t nthreads) {
+      std::vector<double> amps;
+      run_without_gil(d,nthreads,[&](const size_t nt){
+          amps=scale_ensemble_members(d,method,level,window,nt);
+        });
+      return amps;
+    },
     "Scale each member of a SeismogramEnsemble individually by selected metric",
     py::return_value_policy::copy,
-    py::arg("d"),py::arg("method"),py::arg("level"),py::arg("window") )
-  ;
-  m.def("_scale_ensemble_members",py::overload_cast<Ensemble<TimeSeries>&,
-          const ScalingMethod&,
-            const double,
-               const TimeWindow>(&scale_ensemble_members<TimeSeries>),
+    py::arg("d"),py::arg("method"),py::arg("level"),py::arg("window"),
+    py::arg("nthreads")=1 )
+  ;
+  m.def("_scale_ensemble_members",[](Ensemble<TimeSeries>& d, const ScalingMethod& method,
+        const double level, const TimeWindow window, const size_t nthreads) {
+      std::vector<double> amps;
+      run_without_gil(d,nthreads,[&](const size_t nt){
+          amps=scale_ensemble_members(d,method,level,window,nt);
+        });
+      return amps;
+    },
     "Scale each member of a TimeSeriesEnsemble individually by selected metric",
     py::return_value_policy::copy,
-    py::arg("d"),py::arg("method"),py::arg("level"),py::arg("window") )
+    py::arg("d"),py::arg("method"),py::arg("level"),py::arg("window"),
+    py::arg("nthreads")=1 )
   ;
   m.def("_scale_ensemble",py::overload_cast<Ensemble<Seismogram>&,
           const ScalingMethod&, const double, const bool>(&scale_ensemble<Seismogram>),
@@ -7,9 +7,11 @@
 
 #include <mspass/algorithms/algorithms.h>
 #include <mspass/algorithms/Butterworth.h>
+#include <mspass/algorithms/GatherMatrix.h>
 #include <mspass/algorithms/Taper.h>
 #include <mspass/algorithms/TimeWindow.h>
 #include <mspass/utility/Metadata.h>
+#include "python/algorithms/EnsembleWorkers_py.h"
 
 namespace mspass {
 namespace mspasspy {
@@ -85,6 +87,12 @@ PYBIND11_MODULE(basic, m) {
     .def("apply",py::overload_cast<mspass::seismic::Seismogram&>
          (&Butterworth::apply),
          "Apply the predefined filter to a 3c Seismogram object")
+    .def("apply",&apply_to_members_py<Butterworth,TimeSeries>,
+      "Apply to all members of a TimeSeriesEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
+    .def("apply",&apply_to_members_py<Butterworth,Seismogram>,
+      "Apply to all members of a SeismogramEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
     .def("dt",&Butterworth::current_dt,
       "Current sample interval used for nondimensionalizing frequencies")
     .def("low_corner",&Butterworth::low_corner,"Return low frequency f3d point")
@@ -134,23 +142,57 @@ PYBIND11_MODULE(basic, m) {
       py::arg("component")
   );
 
-  m.def("agc",&agc,"Automatic gain control a Seismogram",
+  m.def("agc",py::overload_cast<Seismogram&,const double>(&agc),
+    "Automatic gain control a Seismogram",
     py::return_value_policy::copy,
     py::arg("d"),
     py::arg("twin") )
   ;
-  m.def("_WindowData",py::overload_cast<const TimeSeries&,const TimeWindow&>(&WindowData),
+  m.def("agc",[](LoggingEnsemble<Seismogram>& d, const double twin, const size_t nthreads) {
+      LoggingEnsemble<TimeSeries> gains;
+      run_without_gil(d,nthreads,[&](const size_t nt){gains=agc(d,twin,nt);});
+      return gains;
+    },"Automatic gain control all members of a SeismogramEnsemble in parallel",
+    py::arg("d"),
+    py::arg("twin"),
+    py::arg("nthreads")=1 )
+  ;
+  m.def("_WindowData",py::overload_cast<const TimeSeries&,const TimeWindow&,const bool>(&WindowData),
           "Reduce data to window inside original",
     py::return_value_policy::copy,
     py::arg("d"),
-    py::arg("twin") )
+    py::arg("twin"),
+    py::arg("view")=false )
   ;
 
-  m.def("_WindowData3C",py::overload_cast<const Seismogram&,const TimeWindow&>(&WindowData),
+  m.def("_WindowData3C",py::overload_cast<const Seismogram&,const TimeWindow&,const bool>(&WindowData),
               "Reduce data to window inside original",
     py::return_value_policy::copy,
     py::arg("d"),
-    py::arg("twin") )
+    py::arg("twin"),
+    py::arg("view")=false )
+  ;
+  m.def("_WindowData",[](const LoggingEnsemble<TimeSeries>& d, const TimeWindow& twin,
+        const size_t nthreads, const bool view) {
+      LoggingEnsemble<TimeSeries> result;
+      run_without_gil(d,nthreads,[&](const size_t nt){result=WindowData(d,twin,nt,view);});
+      return result;
+    },"Window all members of a TimeSeriesEnsemble in parallel",
+    py::arg("d"),
+    py::arg("twin"),
+    py::arg("nthreads")=1,
+    py::arg("view")=false )
+  ;
+  m.def("_WindowData3C",[](const LoggingEnsemble<Seismogram>& d, const TimeWindow& twin,
+        const size_t nthreads, const bool view) {
+      LoggingEnsemble<Seismogram> result;
+      run_without_gil(d,nthreads,[&](const size_t nt){result=WindowData(d,twin,nt,view);});
+      return result;
+    },"Window all members of a SeismogramEnsemble in parallel",
+    py::arg("d"),
+    py::arg("twin"),
+    py::arg("nthreads")=1,
+    py::arg("view")=false )
   ;
 
   m.def("splice_segments",&splice_segments,"Splice a time sorted list of TimeSeries data into a continuous block",
@@ -228,6 +270,33 @@ PYBIND11_MODULE(basic, m) {
         }
       ))
   ;
+  py::class_<GatherMatrix>(m,"GatherMatrix",
+    "Dense column-major matrix form of a TimeSeriesEnsemble on a common time axis")
+    .def(py::init<>(),"Default constructor")
+    .def(py::init<const LoggingEnsemble<TimeSeries>&,const double,const size_t>(),
+      "Build from the live members of an ensemble",
+      py::arg("d"),py::arg("dt_tolerance")=0.0001,py::arg("max_npts")=10000000)
+    .def("scatter",&GatherMatrix::scatter,
+      "Copy the columns of live members back into the ensemble members",
+      py::arg("d"))
+    .def("matrix",py::overload_cast<>(&GatherMatrix::matrix),
+      "Return the matrix - rows are samples and columns are members",
+      py::return_value_policy::reference_internal)
+    .def("npts",&GatherMatrix::npts,"Return number of samples (rows)")
+    .def("members",&GatherMatrix::members,"Return number of members (columns)")
+    .def("number_live",&GatherMatrix::number_live,
+      "Return number of columns holding data from a live member")
+    .def("live",&GatherMatrix::live,"Return true if column j holds a live member",
+      py::arg("j"))
+    .def("live_mask",&GatherMatrix::live_mask,"Return the liveness mask as a list")
+    .def("t0",&GatherMatrix::t0,"Return the time of the first row")
+    .def("dt",&GatherMatrix::dt,"Return the sample interval")
+    .def("time",&GatherMatrix::time,"Return the time of row i",py::arg("i"))
+    .def("sample_number",&GatherMatrix::sample_number,
+      "Return the row nearest a time",py::arg("t"))
+    .def("row_offset",&GatherMatrix::row_offset,
+      "Return the row holding the first sample of member j",py::arg("j"))
+  ;
   py::class_<BasicTaper,PyBasicTaper>(m,"BasicTaper",
                     "Base class for family of taper algorithms")
       /* BasicTaper is a nearly pure abstract type.   It has some
@@ -250,6 +319,12 @@ PYBIND11_MODULE(basic, m) {
       "Apply taper to a scalar TimeSeries object")
     .def("apply",py::overload_cast<Seismogram&>(&LinearTaper::apply),
       "Apply taper to a Seismogram (3C) object")
+    .def("apply",&apply_to_members_py<LinearTaper,TimeSeries>,
+      "Apply to all members of a TimeSeriesEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
+    .def("apply",&apply_to_members_py<LinearTaper,Seismogram>,
+      "Apply to all members of a SeismogramEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
     .def("get_t0head",&LinearTaper::get_t0head,
       "Return time of end of zero zone - taper sets data with time < this value 0")
     .def("get_t1head",&LinearTaper::get_t1head,
@@ -283,6 +358,12 @@ PYBIND11_MODULE(basic, m) {
     .def(py::init<const double, const double, const double, const double>())
     .def("apply",py::overload_cast<TimeSeries&>(&CosineTaper::apply),"Apply taper to a scalar TimeSeries object")
     .def("apply",py::overload_cast<Seismogram&>(&CosineTaper::apply),"Apply taper to a Seismogram (3C) object")
+    .def("apply",&apply_to_members_py<CosineTaper,TimeSeries>,
+      "Apply to all members of a TimeSeriesEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
+    .def("apply",&apply_to_members_py<CosineTaper,Seismogram>,
+      "Apply to all members of a SeismogramEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
     .def("get_t0head",&CosineTaper::get_t0head,
       "Return time of end of zero zone - taper sets data with time < this value 0")
     .def("get_t1head",&CosineTaper::get_t1head,
@@ -318,6 +399,12 @@ PYBIND11_MODULE(basic, m) {
       "Apply taper to a scalar TimeSeries object")
     .def("apply",py::overload_cast<Seismogram&>(&VectorTaper::apply),
         "Apply taper to a Seismogram (3C) object")
+    .def("apply",&apply_to_members_py<VectorTaper,TimeSeries>,
+      "Apply to all members of a TimeSeriesEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
+    .def("apply",&apply_to_members_py<VectorTaper,Seismogram>,
+      "Apply to all members of a SeismogramEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
     .def(py::pickle(
       [](const VectorTaper& self)
       {
@@ -346,6 +433,12 @@ PYBIND11_MODULE(basic, m) {
       "Apply to a TimeSeries object")
     .def("apply",py::overload_cast<Seismogram&>(&TopMute::apply),
       "Apply to a Seismogram object")
+    .def("apply",&apply_to_members_py<TopMute,TimeSeries>,
+      "Apply to all members of a TimeSeriesEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
+    .def("apply",&apply_to_members_py<TopMute,Seismogram>,
+      "Apply to all members of a SeismogramEnsemble in parallel with the GIL released",
+      py::arg("d"),py::arg("nthreads")=1)
     .def("get_t0",&TopMute::get_t0,
       "Return the zero end time for marking the start of the mute")
     .def("get_t1",&TopMute::get_t1,
@@ -11,6 +11,7 @@
 #include <mspass/algorithms/deconvolution/MultiTaperSpecDivDecon.h>
 #include <mspass/algorithms/deconvolution/GeneralIterDecon.h>
 #include <mspass/algorithms/deconvolution/CNR3CDecon.h>
+#include "python/algorithms/EnsembleWorkers_py.h"
 PYBIND11_MAKE_OPAQUE(std::vector<double>);
 
 
@@ -24,6 +25,26 @@ using namespace mspass::seismic;
 using namespace mspass::algorithms::deconvolution;
 
 
+/* Defines the ensemble entry points for one ScalarDecon operator type.  The
+members are deconvolved in parallel with the GIL released. */
+template <typename Operator> void def_deconvolve_members(py::module_& m)
+{
+  m.def("deconvolve_members",[](const Operator& op, LoggingEnsemble<TimeSeries>& d,
+        const std::vector<double>& wavelet, const size_t nthreads) {
+      run_without_gil(d,nthreads,[&](const size_t nt){
+          deconvolve_members(op,d,wavelet,nt);
+        });
+    },"Deconvolve all members of a TimeSeriesEnsemble with one wavelet",
+    py::arg("op"),py::arg("d"),py::arg("wavelet"),py::arg("nthreads")=1);
+  m.def("deconvolve_members",[](const Operator& op, LoggingEnsemble<Seismogram>& d,
+        const int wcomp, const size_t nthreads) {
+      run_without_gil(d,nthreads,[&](const size_t nt){
+          deconvolve_members(op,d,wcomp,nt);
+        });
+    },"Deconvolve all members of a SeismogramEnsemble using component wcomp as the wavelet",
+    py::arg("op"),py::arg("d"),py::arg("wcomp")=2,py::arg("nthreads")=1);
+}
+
 /* Trampoline class for BasicDeconOperator */
 class PyBasicDeconOperator : public BasicDeconOperator
 {
@@ -270,6 +291,10 @@ PYBIND11_MODULE(deconvolution, m) {
       py::arg("d"),
       py::arg("i0") )
     ;
+  def_deconvolve_members<WaterLevelDecon>(m);
+  def_deconvolve_members<LeastSquareDecon>(m);
+  def_deconvolve_members<MultiTaperXcorDecon>(m);
+  def_deconvolve_members<MultiTaperSpecDivDecon>(m);
 }
 
 } // namespace mspasspy
@@ -7,29 +7,16 @@
 #include "mspass/seismic/Ensemble.h"
 #include "mspass/io/mseed_index.h"
 #include "mspass/io/fileio.h"
+#include "mspass/io/FileHandleCache.h"
+#include "mspass/io/ReadPlanner.h"
+#include "mspass/io/MappedFile.h"
+#include "mspass/io/PrefetchReader.h"
+#include "mspass/io/SampleEncoding.h"
+#include "mspass/io/ContainerFile.h"
+#include "mspass/io/MseedTimeIndex.h"
+#include "mspass/io/ConcurrentAppender.h"
 #include "mspass/seismic/TimeSeries.h"
 #include "mspass/seismic/Seismogram.h"
-/*  these are supposed to be included from fileio.h - temporary for testing only*/
-namespace mspass::io {
-
-long int fwrite_to_file(mspass::seismic::TimeSeries& d,
-  const std::string dir,const std::string dfile);
-long int fwrite_to_file(mspass::seismic::Seismogram& d,
-    const std::string dir,const std::string dfile);
-std::vector<long int> fwrite_to_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>& d,
-  const std::string dir,const std::string dfile);
-std::vector<long int> fwrite_to_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& d,
-  const std::string dir,const std::string dfile);
-size_t fread_from_file(mspass::seismic::Seismogram& d,const std::string dir, const std::string dfile,
-    const long int foff);
-size_t fread_from_file(mspass::seismic::TimeSeries& d,const std::string dir, const std::string dfile,
-    const long int foff);
-size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> &d, const std::string dir, 
-    const std::string dfile, std::vector<long int> indexes);
-size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &d, const std::string dir, 
-    const std::string dfile, std::vector<long int> indexes);
-}
-
 PYBIND11_MAKE_OPAQUE(std::vector<mspass::io::mseed_index>);
 namespace mspass {
 namespace mspasspy {
@@ -66,6 +53,206 @@ PYBIND11_MODULE(io,m){
     .def_readwrite("last_packet_time",&mseed_index::last_packet_time,
       "Time tag of last packe of data in this block - less than endtime")
     ;
+  py::class_<ReadStatistics>(m,"ReadStatistics",
+    "Summary of the system calls used to load an ensemble from a native file")
+    .def(py::init<>(),"Default constructor")
+    .def_readonly("nrequests",&ReadStatistics::nrequests,
+      "Number of ensemble members read")
+    .def_readonly("nranges",&ReadStatistics::nranges,
+      "Number of contiguous file ranges the members were merged into")
+    .def_readonly("syscalls",&ReadStatistics::syscalls,
+      "Number of read system calls issued")
+    .def_readonly("bytes_read",&ReadStatistics::bytes_read,
+      "Total number of bytes read including gaps between members")
+    .def_readonly("gap_bytes",&ReadStatistics::gap_bytes,
+      "Number of bytes read to merge nearly adjacent members and discarded")
+    ;
+  /* The buffer is marked read only because it points into a read only
+  memory map.   numpy.asarray on this object creates an array with no copy.*/
+  py::class_<MappedSampleView>(m,"MappedSampleView",py::buffer_protocol(),
+    "Read only zero copy view of sample data in a memory mapped native file")
+    .def(py::init<>(),"Default constructor")
+    .def("__len__",&MappedSampleView::size,"Number of samples in the view")
+    .def("__getitem__",[](const MappedSampleView& self, const size_t i) {
+      if(i>=self.size()) throw py::index_error();
+      return self[i];
+    })
+    .def_buffer([](MappedSampleView &v) -> py::buffer_info {
+      return py::buffer_info(
+        const_cast<double *>(v.data()),
+        sizeof(double),
+        py::format_descriptor<double>::format(),
+        1,
+        { v.size() },
+        { sizeof(double) },
+        true
+      );
+    })
+    ;
+  py::enum_<SampleEncoding>(m,"SampleEncoding")
+    .value("float64",SampleEncoding::float64)
+    .value("float32",SampleEncoding::float32)
+    .value("int32",SampleEncoding::int32)
+    .value("delta",SampleEncoding::delta)
+  ;
+  py::enum_<SampleFormat>(m,"SampleFormat")
+    .value("binary",SampleFormat::binary)
+    .value("mseed",SampleFormat::mseed)
+  ;
+  py::class_<PrefetchRequest>(m,"PrefetchRequest",
+    "Defines one block of data to be loaded by a PrefetchReader")
+    .def(py::init<>(),"Default constructor")
+    .def(py::init<const std::string,const std::string,const long int,
+      const long int,const SampleFormat>(),
+      "Construct from file name, offset, size, and format",
+      py::arg("dir"),
+      py::arg("dfile"),
+      py::arg("foff"),
+      py::arg("nbytes"),
+      py::arg("format")=SampleFormat::binary)
+    .def_readwrite("dir",&PrefetchRequest::dir,"Directory name of the file")
+    .def_readwrite("dfile",&PrefetchRequest::dfile,"Leaf name of the file")
+    .def_readwrite("foff",&PrefetchRequest::foff,"Byte offset of the block")
+    .def_readwrite("nbytes",&PrefetchRequest::nbytes,"Size of the block in bytes")
+    .def_readwrite("format",&PrefetchRequest::format,"Format of the data in the block")
+    ;
+  py::class_<PrefetchResult>(m,"PrefetchResult",
+    "Raw data loaded by a PrefetchReader for one request")
+    .def(py::init<>(),"Default constructor")
+    .def_readonly("index",&PrefetchResult::index,
+      "Position of this result in the request list")
+    .def_readonly("request",&PrefetchResult::request,
+      "Request that produced this result")
+    .def_readonly("ok",&PrefetchResult::ok,"False if the read failed")
+    .def_readonly("message",&PrefetchResult::message,"Error message if the read failed")
+    .def_property_readonly("nbytes",[](const PrefetchResult& self) {
+      return self.buffer.size();
+    },"Number of bytes loaded")
+    .def("load",py::overload_cast<mspass::seismic::TimeSeries&,const double>
+        (&PrefetchResult::load,py::const_),
+      "Copy or decode the loaded data into a TimeSeries",
+      py::arg("d"),
+      py::arg("fill_value")=0.0)
+    .def("load",py::overload_cast<mspass::seismic::Seismogram&>
+        (&PrefetchResult::load,py::const_),
+      "Copy the loaded data into a Seismogram",
+      py::arg("d"))
+    ;
+  /* The iterator releases the GIL while it waits for the next block so
+  python code (e.g. a dask worker) can run while the reads complete. */
+  py::class_<PrefetchReader>(m,"PrefetchReader",
+    "Background reader that loads a list of blocks ahead of the caller")
+    .def(py::init<const std::vector<PrefetchRequest>&,const size_t,const size_t>(),
+      "Construct and start background reads",
+      py::arg("requests"),
+      py::arg("nthreads")=2,
+      py::arg("queue_size")=8)
+    .def("__len__",&PrefetchReader::size,"Total number of requests")
+    .def("__iter__",[](PrefetchReader& self) -> PrefetchReader& {return self;})
+    .def("__next__",[](PrefetchReader& self) {
+      PrefetchResult result;
+      bool more;
+      {
+        py::gil_scoped_release release;
+        more=self.next(result);
+      }
+      if(!more) throw py::stop_iteration();
+      return result;
+    })
+    .def("cancel",&PrefetchReader::cancel,
+      "Stop the background reads",
+      py::call_guard<py::gil_scoped_release>())
+    .def("delivered",&PrefetchReader::delivered,
+      "Number of results already returned")
+    ;
+  py::enum_<ContainerDataType>(m,"ContainerDataType")
+    .value("timeseries",ContainerDataType::timeseries)
+    .value("seismogram",ContainerDataType::seismogram)
+  ;
+  py::class_<ContainerIndexEntry>(m,"ContainerIndexEntry",
+    "One entry of the index of a container file")
+    .def(py::init<>(),"Default constructor")
+    .def_readonly("id",&ContainerIndexEntry::id,"Object id of the datum")
+    .def_readonly("foff",&ContainerIndexEntry::foff,"Byte offset of the block")
+    .def_readonly("nbytes",&ContainerIndexEntry::nbytes,"Size of the block in bytes")
+    .def_readonly("npts",&ContainerIndexEntry::npts,"Number of samples")
+    .def_readonly("dtype",&ContainerIndexEntry::dtype,"Type of data object")
+    .def_readonly("encoding",&ContainerIndexEntry::encoding,"Sample encoding")
+    .def_readonly("scale",&ContainerIndexEntry::scale,"Scale factor for int32 encoding")
+    .def_readonly("t0",&ContainerIndexEntry::t0,"Start time of the datum")
+    .def_readonly("dt",&ContainerIndexEntry::dt,"Sample interval of the datum")
+    .def_readonly("utc",&ContainerIndexEntry::utc,"True if t0 is a UTC time")
+    .def_readonly("checksum",&ContainerIndexEntry::checksum,"CRC32 of the block")
+    ;
+  py::class_<ContainerWriter>(m,"ContainerWriter",
+    "Writer for self describing container files with an index of the data they hold")
+    .def(py::init<const std::string,const std::string,const bool>(),
+      "Open a container file for writing",
+      py::arg("dir"),
+      py::arg("dfile"),
+      py::arg("append")=true)
+    .def("write",py::overload_cast<const mspass::seismic::TimeSeries&,
+        const SampleEncoding,const std::string>(&ContainerWriter::write),
+      "Write the sample data of a TimeSeries",
+      py::arg("d"),
+      py::arg("encoding")=SampleEncoding::float64,
+      py::arg("id")="")
+    .def("write",py::overload_cast<const mspass::seismic::Seismogram&,
+        const SampleEncoding,const std::string>(&ContainerWriter::write),
+      "Write the sample data of a Seismogram",
+      py::arg("d"),
+      py::arg("encoding")=SampleEncoding::float64,
+      py::arg("id")="")
+    .def("write",py::overload_cast<const mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>&,
+        const SampleEncoding>(&ContainerWriter::write),
+      "Write all live members of a TimeSeriesEnsemble",
+      py::arg("d"),
+      py::arg("encoding")=SampleEncoding::float64)
+    .def("write",py::overload_cast<const mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>&,
+        const SampleEncoding>(&ContainerWriter::write),
+      "Write all live members of a SeismogramEnsemble",
+      py::arg("d"),
+      py::arg("encoding")=SampleEncoding::float64)
+    .def("close",&ContainerWriter::close,"Write the index and close the file")
+    .def("entries",&ContainerWriter::entries,"Return the index entries written so far")
+    .def("__len__",&ContainerWriter::size,"Number of entries in the index")
+    .def("__enter__",[](ContainerWriter& self) -> ContainerWriter& {return self;},
+      py::return_value_policy::reference)
+    .def("__exit__",[](ContainerWriter& self, py::object, py::object, py::object){
+      self.close();})
+    ;
+  py::class_<ContainerReader>(m,"ContainerReader",
+    "Reader for container files created by ContainerWriter")
+    .def(py::init<const std::string,const std::string>(),
+      "Open a container file and load its index",
+      py::arg("dir"),
+      py::arg("dfile"))
+    .def("__len__",&ContainerReader::size,"Number of entries in the index")
+    .def("entries",&ContainerReader::entries,"Return the index")
+    .def("entry",&ContainerReader::entry,"Return one entry of the index",
+      py::arg("i"))
+    .def("find",&ContainerReader::find,
+      "Return the position of the first entry with a given id or -1",
+      py::arg("id"))
+    .def("read_TimeSeries",&ContainerReader::read_TimeSeries,
+      "Read one TimeSeries",py::arg("i"))
+    .def("read_Seismogram",&ContainerReader::read_Seismogram,
+      "Read one Seismogram",py::arg("i"))
+    .def("read_TimeSeriesEnsemble",
+      py::overload_cast<>(&ContainerReader::read_TimeSeriesEnsemble,py::const_),
+      "Read all TimeSeries in the container as an ensemble")
+    .def("read_TimeSeriesEnsemble",
+      py::overload_cast<const std::vector<size_t>&>(&ContainerReader::read_TimeSeriesEnsemble,py::const_),
+      "Read a list of entries as a TimeSeriesEnsemble",
+      py::arg("which"))
+    .def("read_SeismogramEnsemble",
+      py::overload_cast<>(&ContainerReader::read_SeismogramEnsemble,py::const_),
+      "Read all Seismogram entries in the container as an ensemble")
+    .def("read_SeismogramEnsemble",
+      py::overload_cast<const std::vector<size_t>&>(&ContainerReader::read_SeismogramEnsemble,py::const_),
+      "Read a list of entries as a SeismogramEnsemble",
+      py::arg("which"))
+    ;
   m.def("_mseed_file_indexer",&mseed_file_indexer,
     "Builds an index for a miniseed file returning std::pair with index and ErrorLogger object",
     py::return_value_policy::copy,
@@ -74,6 +261,87 @@ PYBIND11_MODULE(io,m){
     py::arg("verbose") = false
     )
   ;
+  py::class_<MseedBlock>(m,"MseedBlock",
+    "Block of miniseed packets returned by a MseedTimeIndex query")
+    .def(py::init<>(),"Default constructor")
+    .def(py::init<const std::string,const std::string,const mseed_index&>(),
+      "Construct from file name and index entry",
+      py::arg("dir"),
+      py::arg("dfile"),
+      py::arg("index"))
+    .def_readwrite("dir",&MseedBlock::dir,"Directory of the file holding the block")
+    .def_readwrite("dfile",&MseedBlock::dfile,"Leaf name of the file holding the block")
+    .def_readwrite("index",&MseedBlock::index,"Index data for the block")
+    .def("request",&MseedBlock::request,
+      "Return a PrefetchRequest to load this block")
+    ;
+  py::class_<MseedTimeIndex>(m,"MseedTimeIndex",
+    "In memory time range index of miniseed blocks organized by SEED channel")
+    .def(py::init<>(),"Default constructor")
+    .def(py::init<const std::vector<mseed_index>&,const std::string,const std::string>(),
+      "Construct and load the index for one file",
+      py::arg("ind"),
+      py::arg("dir"),
+      py::arg("dfile"))
+    .def("add",&MseedTimeIndex::add,
+      "Add the index data for one file",
+      py::arg("ind"),
+      py::arg("dir"),
+      py::arg("dfile"))
+    .def("query",&MseedTimeIndex::query,
+      "Return all blocks for a channel that overlap a time range",
+      py::arg("net"),
+      py::arg("sta"),
+      py::arg("loc"),
+      py::arg("chan"),
+      py::arg("t0"),
+      py::arg("t1"))
+    .def("__len__",&MseedTimeIndex::size,"Number of blocks in the index")
+    .def("channels",&MseedTimeIndex::channels,"Return the list of channel keys")
+    .def("clear",&MseedTimeIndex::clear,"Remove all blocks from the index")
+    .def_static("seed_key",&MseedTimeIndex::seed_key,
+      "Return the key used for a SEED channel",
+      py::arg("net"),
+      py::arg("sta"),
+      py::arg("loc"),
+      py::arg("chan"))
+    ;
+  m.def("_mseed_index_files",&mseed_index_files,
+    "Index a list of miniseed files in parallel using cached sidecar indexes when valid",
+    py::call_guard<py::gil_scoped_release>(),
+    py::arg("files"),
+    py::arg("nthreads") = 1,
+    py::arg("segment") = true,
+    py::arg("verbose") = false,
+    py::arg("use_cache") = true,
+    py::arg("cache_dir") = ""
+  );
+  m.def("mseed_sidecar_name",&mseed_sidecar_name,
+    "Return the name of the sidecar index file for a miniseed file",
+    py::arg("fname"),
+    py::arg("cache_dir") = ""
+  );
+  m.def("_mseed_fread_from_file",
+    py::overload_cast<mspass::seismic::TimeSeries&,const std::string,
+      const std::string,const long int,const long int,const double>(&mseed_fread_from_file),
+    "Decode a block of miniseed packets directly into the sample vector of a TimeSeries",
+    py::arg("d"),
+    py::arg("dir"),
+    py::arg("dfile"),
+    py::arg("foff"),
+    py::arg("nbytes"),
+    py::arg("fill_value") = 0.0
+  );
+  m.def("_mseed_fread_from_file",
+    py::overload_cast<mspass::seismic::TimeSeries&,const std::string,
+      const std::string,const mseed_index&,const double>(&mseed_fread_from_file),
+    "Decode the block of miniseed packets defined by an mseed_index into a TimeSeries",
+    py::arg("d"),
+    py::arg("dir"),
+    py::arg("dfile"),
+    py::arg("index"),
+    py::arg("fill_value") = 0.0
+  );
  m.def("_fwrite_to_file",py::overload_cast<mspass::seismic::Seismogram&,
     const std::string,const std::string>(&fwrite_to_file),
     "Open and read sample data for native format std::vector<double> container",
@@ -105,6 +373,97 @@ PYBIND11_MODULE(io,m){
     py::arg("d"),
     py::arg("dir"),
     py::arg("dfile")
+  );
+  m.def("_fwrite_to_file",py::overload_cast<mspass::seismic::Seismogram&,
+    const std::string,const std::string,const SampleEncoding,const double>(&fwrite_to_file),
+    "Write sample data of a Seismogram with a compact encoding",
+    py::return_value_policy::copy,
+    py::arg("d"),
+    py::arg("dir"),
+    py::arg("dfile"),
+    py::arg("encoding"),
+    py::arg("scale") = 0.0
+  );
+  m.def("_fwrite_to_file",py::overload_cast<mspass::seismic::TimeSeries&,
+    const std::string,const std::string,const SampleEncoding,const double>(&fwrite_to_file),
+    "Write sample data of a TimeSeries with a compact encoding",
+    py::return_value_policy::copy,
+    py::arg("d"),
+    py::arg("dir"),
+    py::arg("dfile"),
+    py::arg("encoding"),
+    py::arg("scale") = 0.0
+  );
+  m.def("_fwrite_to_file",py::overload_cast<mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>&,
+    const std::string,const std::string,const SampleEncoding,const double>(&fwrite_to_file),
+    "Write data for format Ensemble<Seismogram> to one file with a compact encoding",
+    py::return_value_policy::copy,
+    py::arg("d"),
+    py::arg("dir"),
+    py::arg("dfile"),
+    py::arg("encoding"),
+    py::arg("scale") = 0.0
+  );
+  m.def("_fwrite_to_file",py::overload_cast<mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>&,
+    const std::string,const std::string,const SampleEncoding,const double>(&fwrite_to_file),
+    "Write data for format Ensemble<TimeSeries> to one file with a compact encoding",
+    py::return_value_policy::copy,
+    py::arg("d"),
+    py::arg("dir"),
+    py::arg("dfile"),
+    py::arg("encoding"),
+    py::arg("scale") = 0.0
+  );
+  m.def("set_file_handle_cache_size",[](const size_t n){
+      FileHandleCache::instance().set_size(n);
+    },
+    "Set the maximum number of open files cached by the native readers and writers (0 disables caching)",
+    py::arg("n")
+  );
+  m.def("get_file_handle_cache_size",[](){
+      return FileHandleCache::instance().max_size();
+    },
+    "Return the maximum number of open files cached by the native readers and writers"
+  );
+  m.def("number_cached_file_handles",[](){
+      return FileHandleCache::instance().size();
+    },
+    "Return the number of open files currently held by the file handle cache"
+  );
+  m.def("flush_file_handles",[](){
+      FileHandleCache::instance().flush();
+    },
+    "Force data written through cached file handles to storage"
+  );
+  m.def("close_file_handle",[](const std::string dir, const std::string dfile){
+      const std::string fname=build_fname(dir,dfile);
+      FileHandleCache::instance().close_file(fname);
+      ConcurrentAppender::close_file(fname);
+    },
+    "Release cached file handles for one file - must be called before removing or replacing a cached file",
+    py::arg("dir"),
+    py::arg("dfile")
+  );
+  m.def("remove_lock_file",[](const std::string dir, const std::string dfile){
+      ConcurrentAppender::remove_lock_file(build_fname(dir,dfile));
+    },
+    "Remove the lock file used by concurrent appends to a file - call when the file is removed",
+    py::arg("dir"),
+    py::arg("dfile")
+  );
+  m.def("close_file_handles",[](){
+      FileHandleCache::instance().close_all();
+      ConcurrentAppender::close_all();
+    },
+    "Release all cached file handles"
+  );
+  m.def("set_concurrent_append",&ConcurrentAppender::set_enabled,
+    "Enable (or disable) reserved range writes that let multiple processes append to one file",
+    py::arg("enable"),
+    py::arg("extent_size") = 16777216
+  );
+  m.def("get_concurrent_append",&ConcurrentAppender::enabled,
+    "Return True if native writers use reserved range writes"
   );
    m.def("_fread_from_file",
       py::overload_cast<mspass::seismic::TimeSeries&,
@@ -142,6 +501,91 @@ PYBIND11_MODULE(io,m){
      py::arg("dfile"),
      py::arg("indexes")
    );
+   m.def("_fread_from_file",
+      py::overload_cast<mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>&,
+        const std::string,const std::string,std::vector<long int>,ReadStatistics&>(&fread_from_file),
+      "Read the sample data for a TimeSeriesEnsemble object and fill a ReadStatistics object",
+     py::arg("de"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("indexes"),
+     py::arg("stats")
+   );
+   m.def("_fread_from_file",
+      py::overload_cast<mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>&,
+        const std::string,const std::string,std::vector<long int>,ReadStatistics&>(&fread_from_file),
+      "Read the sample data for a SeismogramEnsemble object and fill a ReadStatistics object",
+     py::arg("de"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("indexes"),
+     py::arg("stats")
+   );
+   m.def("_mmap_read_from_file",
+      py::overload_cast<mspass::seismic::TimeSeries&,
+         const std::string,const std::string,const long int>(&mmap_read_from_file),
+      "Read the sample data for a TimeSeries object from a memory mapped native file",
+     py::arg("d"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("foff")
+   );
+   m.def("_mmap_read_from_file",
+      py::overload_cast<mspass::seismic::TimeSeries&,
+         const std::string,const std::string,const long int,
+         const mspass::algorithms::TimeWindow&>(&mmap_read_from_file),
+      "Read only a time window of a TimeSeries object from a memory mapped native file",
+     py::arg("d"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("foff"),
+     py::arg("tw")
+   );
+   m.def("_mmap_read_from_file",
+      py::overload_cast<mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>&,
+        const std::string,const std::string,std::vector<long int>>(&mmap_read_from_file),
+      "Read the sample data for a TimeSeriesEnsemble object from a memory mapped native file",
+     py::arg("de"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("indexes")
+   );
+   m.def("_mmap_read_from_file",
+      py::overload_cast<mspass::seismic::Seismogram&,
+         const std::string,const std::string,const long int>(&mmap_read_from_file),
+      "Read the sample data for a Seismogram object from a memory mapped native file",
+     py::arg("d"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("foff")
+   );
+   m.def("_mmap_read_from_file",
+      py::overload_cast<mspass::seismic::Seismogram&,
+         const std::string,const std::string,const long int,
+         const mspass::algorithms::TimeWindow&>(&mmap_read_from_file),
+      "Read only a time window of a Seismogram object from a memory mapped native file",
+     py::arg("d"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("foff"),
+     py::arg("tw")
+   );
+   m.def("_mmap_read_from_file",
+      py::overload_cast<mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>&,
+        const std::string,const std::string,std::vector<long int>>(&mmap_read_from_file),
+      "Read the sample data for a SeismogramEnsemble object from a memory mapped native file",
+     py::arg("de"),
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("indexes")
+   );
+   m.def("mmap_sample_view",&mmap_sample_view,
+      "Return a zero copy view of a block of samples in a native file",
+     py::arg("dir"),
+     py::arg("dfile"),
+     py::arg("foff"),
+     py::arg("nd")
+   );
 }
 }   // namespace mspasspy
 }  // namespace mspas
@@ -15,6 +15,8 @@
 #include <mspass/seismic/PowerSpectrum.h>
 #include <mspass/seismic/DataGap.h>
 #include <mspass/seismic/TimeSeriesWGaps.h>
+#include <mspass/seismic/BinarySerialization.h>
+#include <mspass/seismic/ArrowConverter.h>
 
 #include <mspass/algorithms/TimeWindow.h>
 
@@ -41,6 +43,105 @@ using namespace mspass::utility;
 using namespace mspass::seismic;
 using mspass::algorithms::TimeWindow;
 
+/* Pickle support for atomic data and ensembles.  The state is a one element tuple
+holding a bytes object in the binary format defined in
+BinarySerialization.h.  The bytes are decoded in place to avoid a copy. */
+template <typename Tdata> py::tuple binary_pickle_state(const Tdata& d)
+{
+  std::vector<char> buf;
+  serialize_binary(d,buf);
+  return py::make_tuple(py::bytes(buf.data(),buf.size()));
+}
+std::pair<const char*,size_t> bytes_buffer(const py::handle& b)
+{
+  char *p;
+  Py_ssize_t n;
+  PyBytes_AsStringAndSize(b.ptr(),&p,&n);
+  return std::pair<const char*,size_t>(p,static_cast<size_t>(n));
+}
+std::pair<const char*,size_t> binary_pickle_buffer(const py::tuple& t)
+{
+  if(t.size()!=1 || !PyBytes_Check(t[0].ptr()))
+    throw MsPASSError("pickle:  invalid state - expected a tuple holding one bytes object",
+      ErrorSeverity::Invalid);
+  return bytes_buffer(t[0]);
+}
+/* Pickle protocol 5 support.  For protocol 5 and higher __reduce_ex__
+returns the binary state without the samples followed by one PickleBuffer
+for each sample array (one per member for ensembles).  The buffers are
+numpy views of the C++ sample storage with the data object as base, so a
+pickler with a buffer_callback never copies the samples.   Lower protocols
+store the samples in the state as with __getstate__.  The functions
+named by restore are module level functions that accept the state and
+any number of objects supporting the buffer protocol. */
+py::object sample_pickle_buffer(const py::object& owner, const SampleBufferView& sb)
+{
+  py::object b;
+  if(sb.second==0)
+    b=py::bytes();
+  else
+    b=py::array_t<double>(sb.second/sizeof(double),
+      reinterpret_cast<const double*>(sb.first),owner);
+  return py::module_::import("pickle").attr("PickleBuffer")(b);
+}
+template <typename Tdata> void append_sample_buffers(py::list& args,
+  const py::object& owner, const Tdata& d)
+{
+  args.append(sample_pickle_buffer(owner,sample_buffer(d)));
+}
+template <typename Tdata> void append_sample_buffers(py::list& args,
+  const py::object& owner, const LoggingEnsemble<Tdata>& d)
+{
+  for(auto& m : d.member) args.append(sample_pickle_buffer(owner,sample_buffer(m)));
+}
+template <typename Tdata> py::tuple binary_reduce_ex(const py::object& self,
+  const int protocol, const char *restore)
+{
+  const Tdata& d=self.cast<const Tdata&>();
+  py::object fn=py::module_::import("mspasspy.ccore.seismic").attr(restore);
+  std::vector<char> buf;
+  if(protocol<5)
+  {
+    serialize_binary(d,buf);
+    return py::make_tuple(fn,py::make_tuple(py::bytes(buf.data(),buf.size())));
+  }
+  serialize_binary(d,buf,true);
+  py::list args;
+  args.append(py::bytes(buf.data(),buf.size()));
+  append_sample_buffers(args,self,d);
+  return py::make_tuple(fn,py::tuple(args));
+}
+/* Returns views of the sample buffers passed to a restore function.
+info holds the buffer requests and must live until the data are restored. */
+std::vector<SampleBufferView> pickle_sample_buffers(const py::args& buffers,
+  std::vector<py::buffer_info>& info)
+{
+  std::vector<SampleBufferView> result;
+  info.reserve(buffers.size());
+  for(auto b : buffers)
+  {
+    info.push_back(py::reinterpret_borrow<py::buffer>(b).request());
+    const py::buffer_info& bi=info.back();
+    result.push_back(SampleBufferView(static_cast<const char*>(bi.ptr),
+      static_cast<size_t>(bi.size*bi.itemsize)));
+  }
+  return result;
+}
+template <typename Tdata> Tdata restore_pickle5(const py::bytes& state,
+  const py::args& buffers)
+{
+  std::vector<py::buffer_info> info;
+  std::vector<SampleBufferView> samples=pickle_sample_buffers(buffers,info);
+  if(samples.size()>1)
+    throw MsPASSError("pickle:  invalid state - atomic data have one sample buffer",
+      ErrorSeverity::Invalid);
+  std::pair<const char*,size_t> b=bytes_buffer(state);
+  Tdata d;
+  deserialize_binary(b.first,b.second,d,NULL,
+    samples.empty() ? SampleBufferView(NULL,0) : samples[0]);
+  return d;
+}
+
 /* Trampoline class for BasicTimeSeries */
 class PyBasicTimeSeries : public BasicTimeSeries
 {
@@ -136,10 +237,92 @@ public:
   }
 };
 
+/* Returns a pyarrow.RecordBatch holding a TimeSeriesEnsemble.  pyarrow
+takes ownership of the exported buffers so they are not copied again. */
+py::object TimeSeriesEnsemble_to_arrow(const LoggingEnsemble<TimeSeries>& d)
+{
+  py::object pa=py::module_::import("pyarrow");
+  ArrowSchema schema;
+  ArrowArray array;
+  {
+    py::gil_scoped_release release;
+    export_to_arrow(d,&schema,&array);
+  }
+  try{
+    return pa.attr("RecordBatch").attr("_import_from_c")(
+      reinterpret_cast<uintptr_t>(&array),reinterpret_cast<uintptr_t>(&schema));
+  }catch(...)
+  {
+    if(array.release!=NULL) array.release(&array);
+    if(schema.release!=NULL) schema.release(&schema);
+    throw;
+  }
+}
+/* Builds a TimeSeriesEnsemble from a pyarrow.RecordBatch or Table */
+LoggingEnsemble<TimeSeries> TimeSeriesEnsemble_from_arrow(py::object data)
+{
+  if(py::hasattr(data,"to_batches"))
+  {
+    py::list batches=data.attr("combine_chunks")().attr("to_batches")();
+    if(batches.size()==0)
+    {
+      /* A table with no rows has no batches.  An empty batch with the
+      same schema gives an empty ensemble, as for an empty RecordBatch. */
+      py::object pa=py::module_::import("pyarrow");
+      py::object schema=data.attr("schema");
+      py::list arrays;
+      for(auto field : schema)
+        arrays.append(pa.attr("array")(py::list(),py::arg("type")=field.attr("type")));
+      data=pa.attr("RecordBatch").attr("from_arrays")(arrays,py::arg("schema")=schema);
+    }
+    else
+      data=batches[0];
+  }
+  ArrowSchema schema;
+  ArrowArray array;
+  schema.release=NULL;
+  array.release=NULL;
+  data.attr("_export_to_c")(reinterpret_cast<uintptr_t>(&array),
+    reinterpret_cast<uintptr_t>(&schema));
+  LoggingEnsemble<TimeSeries> result;
+  try{
+    py::gil_scoped_release release;
+    result=import_from_arrow(&schema,&array);
+  }catch(...)
+  {
+    array.release(&array);
+    schema.release(&schema);
+    throw;
+  }
+  array.release(&array);
+  schema.release(&schema);
+  return result;
+}
+
 PYBIND11_MODULE(seismic, m) {
   m.attr("__name__") = "mspasspy.ccore.seismic";
   m.doc() = "A submodule for seismic namespace of ccore";
 
+  /* Restore functions returned by __reduce_ex__ for pickle protocol 5 */
+  m.def("_TimeSeries_from_binary",[](py::bytes state, py::args buffers) {
+      return restore_pickle5<TimeSeries>(state,buffers);
+    },"Restore a pickled TimeSeries - used by __reduce_ex__");
+  m.def("_Seismogram_from_binary",[](py::bytes state, py::args buffers) {
+      return restore_pickle5<Seismogram>(state,buffers);
+    },"Restore a pickled Seismogram - used by __reduce_ex__");
+  m.def("_TimeSeriesEnsemble_from_binary",[](py::bytes state, py::args buffers) {
+      std::vector<py::buffer_info> info;
+      std::vector<SampleBufferView> samples=pickle_sample_buffers(buffers,info);
+      std::pair<const char*,size_t> b=bytes_buffer(state);
+      return deserialize_TimeSeriesEnsemble(b.first,b.second,NULL,samples);
+    },"Restore a pickled TimeSeriesEnsemble - used by __reduce_ex__");
+  m.def("_SeismogramEnsemble_from_binary",[](py::bytes state, py::args buffers) {
+      std::vector<py::buffer_info> info;
+      std::vector<SampleBufferView> samples=pickle_sample_buffers(buffers,info);
+      std::pair<const char*,size_t> b=bytes_buffer(state);
+      return deserialize_SeismogramEnsemble(b.first,b.second,NULL,samples);
+    },"Restore a pickled SeismogramEnsemble - used by __reduce_ex__");
+
   /* Define the keywords here*/
   py::object scope = py::module_::import("__main__").attr("__dict__");
   /* The following hack on __name__ is needed to avoid contaminating
@@ -177,6 +360,9 @@ PYBIND11_MODULE(seismic, m) {
   Keywords["dfile"] = SEISMICMD_dfile;
   Keywords["dir"] = SEISMICMD_dir;
   Keywords["foff"] = SEISMICMD_foff;
+  Keywords["nbytes"] = SEISMICMD_nbytes;
+  Keywords["sample_encoding"] = SEISMICMD_sample_encoding;
+  Keywords["sample_scale"] = SEISMICMD_sample_scale;
   Keywords["tmatrix"] = SEISMICMD_tmatrix;
   Keywords["uuid"] = SEISMICMD_uuid;
   Keywords["rawdata"] = SEISMICMD_rawdata;
@@ -335,7 +521,13 @@ PYBIND11_MODULE(seismic, m) {
     .def(py::self + py::self)
     .def(py::self - py::self)
     .def(py::self *= double())
-    .def_readwrite("data",&CoreTimeSeries::s,"Actual samples are stored in this data vector")
+    /* Samples can be shared with copies (see SampleVector).  python can
+    hold a view of the result for any length of time, so the getter makes
+    them private to this object for good. */
+    .def_property("data",
+      [](CoreTimeSeries &self) -> std::vector<double>& {return self.s.exclusive_vector();},
+      [](CoreTimeSeries &self, const std::vector<double>& d){self.s=d;},
+      "Actual samples are stored in this data vector")
   ;
   py::class_<CoreSeismogram,BasicTimeSeries,Metadata>(m,"_CoreSeismogram","Defines basic concepts of a three-component seismogram")
     .def(py::init<>())
@@ -407,68 +599,16 @@ PYBIND11_MODULE(seismic, m) {
     .def("__sizeof__",[](const Seismogram& self){return self.memory_use();})
     .def(py::pickle(
       [](const Seismogram &self) {
-        pybind11::object sbuf;
-        sbuf=serialize_metadata_py(self);
-        stringstream ssbts;
-        ssbts << std::setprecision(17);
-        boost::archive::text_oarchive arbts(ssbts);
-        arbts << dynamic_cast<const BasicTimeSeries&>(self);
-        stringstream sscorets;
-        boost::archive::text_oarchive arcorets(sscorets);
-        arcorets<<dynamic_cast<const ProcessingHistory&>(self);
-        // these are behind getter/setters
-        bool cardinal=self.cardinal();
-        bool orthogonal=self.orthogonal();
-        dmatrix tmatrix=self.get_transformation_matrix();
-        stringstream sstm;
-        boost::archive::text_oarchive artm(sstm);
-        artm<<tmatrix;
-        //This creates a numpy array alias from the vector container
-        //without a move or copy of the data
-        size_t u_size = self.u.rows()*self.u.columns();
-        if(u_size==0){
-          py::array_t<double, py::array::f_style> darr(u_size,NULL);
-          return py::make_tuple(sbuf,ssbts.str(),sscorets.str(),
-            cardinal, orthogonal,sstm.str(),
-            u_size, darr);
-        } else {
-          py::array_t<double, py::array::f_style> darr(u_size,self.u.get_address(0,0));
-          return py::make_tuple(sbuf,ssbts.str(),sscorets.str(),
-            cardinal, orthogonal,sstm.str(),
-            u_size, darr);
-        }
+        return binary_pickle_state(self);
       },
       [](py::tuple t) {
-        pybind11::object sbuf=t[0];
-        Metadata md=restore_serialized_metadata_py(sbuf);
-        stringstream ssbts(t[1].cast<std::string>());
-        boost::archive::text_iarchive arbts(ssbts);
-        BasicTimeSeries bts;
-        arbts>>bts;
-        stringstream sscorets(t[2].cast<std::string>());
-        boost::archive::text_iarchive arcorets(sscorets);
-        ProcessingHistory corets;
-        arcorets>>corets;
-        bool cardinal=t[3].cast<bool>();
-        bool orthogonal=t[4].cast<bool>();
-        stringstream sstm(t[5].cast<std::string>());
-        boost::archive::text_iarchive artm(sstm);
-        dmatrix tmatrix;
-        artm>>tmatrix;
-        size_t u_size = t[6].cast<size_t>();
-        py::array_t<double, py::array::f_style> darr;
-        darr=t[7].cast<py::array_t<double, py::array::f_style>>();
-        py::buffer_info info = darr.request();
-        if(u_size==0) {
-          dmatrix u;
-          return Seismogram(bts,md,corets,cardinal,orthogonal,tmatrix,u);
-        } else {
-          dmatrix u(3, u_size/3);
-          memcpy(u.get_address(0,0), info.ptr, sizeof(double) * u_size);
-          return Seismogram(bts,md,corets,cardinal,orthogonal,tmatrix,u);
-        }
-     }
+        std::pair<const char*,size_t> b=binary_pickle_buffer(t);
+        return deserialize_Seismogram(b.first,b.second);
+      }
      ))
+    .def("__reduce_ex__",[](py::object self, int protocol) {
+        return binary_reduce_ex<Seismogram>(self,protocol,"_Seismogram_from_binary");
+      },"Pickle support - samples are out-of-band buffers for protocol 5")
     ;
 
     py::class_<TimeSeries,CoreTimeSeries,ProcessingHistory>(m,"TimeSeries","mspass scalar time series data object")
@@ -524,43 +664,16 @@ PYBIND11_MODULE(seismic, m) {
         */
       .def(py::pickle(
         [](const TimeSeries &self) {
-          pybind11::object sbuf;
-          sbuf=serialize_metadata_py(self);
-          stringstream ssbts;
-          ssbts << std::setprecision(17);
-          boost::archive::text_oarchive arbts(ssbts);
-          arbts << dynamic_cast<const BasicTimeSeries&>(self);
-          stringstream sscorets;
-          boost::archive::text_oarchive arcorets(sscorets);
-          arcorets<<dynamic_cast<const ProcessingHistory&>(self);
-          //This creates a numpy array alias from the vector container
-          //without a move or copy of the data
-          py::array_t<double, py::array::f_style> darr(self.s.size(),&(self.s[0]));
-          return py::make_tuple(sbuf,ssbts.str(),sscorets.str(),darr);
+          return binary_pickle_state(self);
         },
         [](py::tuple t) {
-         pybind11::object sbuf=t[0];
-         Metadata md=restore_serialized_metadata_py(sbuf);
-         stringstream ssbts(t[1].cast<std::string>());
-         boost::archive::text_iarchive arbts(ssbts);
-         BasicTimeSeries bts;
-         arbts>>bts;
-         stringstream sscorets(t[2].cast<std::string>());
-         boost::archive::text_iarchive arcorets(sscorets);
-         ProcessingHistory corets;
-         arcorets>>corets;
-         // There might be a faster way to do this than a copy like
-         //this but for now this, like Seismogram, is make it work before you
-         //make it fast
-         py::array_t<double, py::array::f_style> darr;
-         darr=t[3].cast<py::array_t<double, py::array::f_style>>();
-         py::buffer_info info = darr.request();
-         std::vector<double> d;
-         d.resize(info.shape[0]);
-         memcpy(d.data(), info.ptr, sizeof(double) * d.size());
-         return TimeSeries(bts,md,corets,d);;
-       }
+          std::pair<const char*,size_t> b=binary_pickle_buffer(t);
+          return deserialize_TimeSeries(b.first,b.second);
+        }
      ))
+      .def("__reduce_ex__",[](py::object self, int protocol) {
+          return binary_reduce_ex<TimeSeries>(self,protocol,"_TimeSeries_from_binary");
+        },"Pickle support - samples are out-of-band buffers for protocol 5")
      ;
   /* Wrappers for Ensemble containers. With pybind11 we need to explicitly declare the types to
      be supported by the container.  Hence, we have two nearly identical blocks below for TimeSeries
@@ -578,6 +691,7 @@ PYBIND11_MODULE(seismic, m) {
     .def("update_metadata",&Ensemble<TimeSeries>::update_metadata,"Update the ensemble header (metadata)")
     .def("sync_metadata",py::overload_cast<>(&Ensemble<TimeSeries>::sync_metadata),"Copy ensemble metadata to all members")
     .def("sync_metadata",py::overload_cast<std::vector<std::string>>(&Ensemble<TimeSeries>::sync_metadata),"Copy ensemble metadata to all members")
+    .def("pack_samples",&Ensemble<TimeSeries>::pack_samples,"Store the samples of all members in one contiguous block")
     // Note member is an std::container - requires py::bind_vector lines at the start of this module defintions
     //    to function properlty
     .def_readwrite("member",&Ensemble<TimeSeries>::member,
@@ -629,6 +743,7 @@ PYBIND11_MODULE(seismic, m) {
     .def("update_metadata",&Ensemble<Seismogram>::update_metadata,"Update the ensemble header (metadata)")
     .def("sync_metadata",py::overload_cast<>(&Ensemble<Seismogram>::sync_metadata),"Copy ensemble metadata to all members")
     .def("sync_metadata",py::overload_cast<std::vector<std::string>>(&Ensemble<Seismogram>::sync_metadata),"Copy ensemble metadata to all members")
+    .def("pack_samples",&Ensemble<Seismogram>::pack_samples,"Store the samples of all members in one contiguous block")
     // Note member is an std::container - requires py::bind_vector lines at the start of this module defintions
     //    to function properlty
     .def_readwrite("member",&Ensemble<Seismogram>::member,
@@ -691,59 +806,17 @@ PYBIND11_MODULE(seismic, m) {
     .def_readwrite("elog",&LoggingEnsemble<Seismogram>::elog,"Error log attached to the ensemble - not the same as member error logs")
     .def(py::pickle(
       [](const LoggingEnsemble<Seismogram> &self) {
-        pybind11::gil_scoped_acquire acquire;
-        try{
-          pybind11::object sbuf;
-          sbuf=serialize_metadata_py(self);
-          stringstream sselog;
-          boost::archive::text_oarchive arelog(sselog);
-          arelog << self.elog;
-          pybind11::module pickle = pybind11::module::import("pickle");
-          pybind11::object dumps = pickle.attr("dumps");
-          pybind11::object dbuf = dumps(py::list(pybind11::cast(self.member)));
-          bool is_live=self.live();
-          pybind11::tuple r_tuple = py::make_tuple(sbuf, sselog.str(), is_live, dbuf);
-          pybind11::gil_scoped_release release;
-          return r_tuple;
-        }catch(...){pybind11::gil_scoped_release release;throw;};
+        /* The ensemble and all members are serialized to one flat buffer */
+        return binary_pickle_state(self);
       },
       [](py::tuple t) {
-        pybind11::gil_scoped_acquire acquire;
-        try{
-          pybind11::object sbuf=t[0];
-          Metadata md=restore_serialized_metadata_py(sbuf);
-          ErrorLogger elog;
-          stringstream sselog(t[1].cast<std::string>());
-          boost::archive::text_iarchive arelog(sselog);;
-          arelog>>elog;
-          pybind11::module pickle = pybind11::module::import("pickle");
-          pybind11::object loads = pickle.attr("loads");
-          /* This algorithm is a horrible memory pig because it has to
-          hold both a copy of the monster list of strings of pickled
-          data members and the reconstituted C++ data objects (ensemble
-          members).  Need to see if we can find a way to handle that
-          in a more memory efficient way.
-          wangyinz: The new implementation below should be better. */
-          py::list dlist = loads(t[3]);
-          LoggingEnsemble<Seismogram> result(md, elog, 0);
-          pybind11::object member_py = pybind11::module_::import("mspasspy.ccore.seismic").attr("SeismogramVector")(dlist);
-          result.member = member_py.cast<vector<Seismogram>>();
-          bool is_live = t[2].cast<bool>();
-          if(is_live)
-            result.set_live();
-          else
-            /* this kill is not really necessary with the current implmentation
-            The constructor we use here set ensmeble dead by default.  For
-            a tiny cost we make this more robust by forcing a kill here */
-            result.kill();
-          pybind11::gil_scoped_release release;
-          return result;
-        }catch(...){
-          pybind11::gil_scoped_release release;
-          throw;
-        };
+        std::pair<const char*,size_t> b=binary_pickle_buffer(t);
+        return deserialize_SeismogramEnsemble(b.first,b.second);
       } )
     )
+    .def("__reduce_ex__",[](py::object self, int protocol) {
+        return binary_reduce_ex<LoggingEnsemble<Seismogram>>(self,protocol,"_SeismogramEnsemble_from_binary");
+      },"Pickle support - samples are out-of-band buffers for protocol 5")
   ;
   py::class_<LoggingEnsemble<TimeSeries>, Ensemble<TimeSeries> >(m,"TimeSeriesEnsemble","Gather of scalar time series objects")
     .def(py::init<>())
@@ -766,67 +839,25 @@ PYBIND11_MODULE(seismic, m) {
     .def("set_live",&LoggingEnsemble<TimeSeries>::set_live,"Mark ensemble live but use a validate test first")
     .def("__sizeof__",[](const LoggingEnsemble<TimeSeries>& self){return self.memory_use();})
     .def_readwrite("elog",&LoggingEnsemble<TimeSeries>::elog,"Error log attached to the ensemble - not the same as member error logs")
-    /* This is exactly parallel to the version for a SeismogramEnsemble.
-    Only changed Seismogram to TimeSeries everywhere in this section.
-    It might be preferable for maintenance to create a template version of
-    the key code in Ensemble.h to reduce the redundant code.   Making the
-    pickle bindings a template would really be adventure land but would
-    be the ideal solution. */
+    /* This is exactly parallel to the version for a SeismogramEnsemble. */
     .def(py::pickle(
       [](const LoggingEnsemble<TimeSeries> &self) {
-        pybind11::gil_scoped_acquire acquire;
-        try{
-          pybind11::object sbuf;
-          sbuf=serialize_metadata_py(self);
-          stringstream sselog;
-          boost::archive::text_oarchive arelog(sselog);
-          arelog << self.elog;
-          pybind11::module pickle = pybind11::module::import("pickle");
-          pybind11::object dumps = pickle.attr("dumps");
-          pybind11::object dbuf = dumps(py::list(pybind11::cast(self.member)));
-          bool is_live = self.live();
-          pybind11::tuple r_tuple = py::make_tuple(sbuf, sselog.str(), is_live, dbuf);
-          pybind11::gil_scoped_release release;
-          return r_tuple;
-        }catch(...){pybind11::gil_scoped_release release;throw;};
+        /* The ensemble and all members are serialized to one flat buffer */
+        return binary_pickle_state(self);
       },
       [](py::tuple t) {
-        pybind11::gil_scoped_acquire acquire;
-        try{
-          pybind11::object sbuf=t[0];
-          Metadata md=restore_serialized_metadata_py(sbuf);
-          ErrorLogger elog;
-          stringstream sselog(t[1].cast<std::string>());
-          boost::archive::text_iarchive arelog(sselog);;
-          arelog>>elog;
-          pybind11::module pickle = pybind11::module::import("pickle");
-          pybind11::object loads = pickle.attr("loads");
-          /* This algorithm is a horrible memory pig because it has to
-          hold both a copy of the monster list of strings of pickled
-          data members and the reconstituted C++ data objects (ensemble
-          members).  Need to see if we can find a way to handle that
-          in a more memory efficient way.
-          wangyinz: The new implementation below should be better. */
-          py::list dlist = loads(t[3]);
-          LoggingEnsemble<TimeSeries> result(md, elog, 0);
-          pybind11::object member_py = pybind11::module_::import("mspasspy.ccore.seismic").attr("TimeSeriesVector")(dlist);
-          result.member = member_py.cast<vector<TimeSeries>>();
-          bool is_live = t[2].cast<bool>();
-          if(is_live)
-            result.set_live();
-          else
-            /* this kill is not really necessary with the current implmentation
-            The constructor we use here set ensmeble dead by default.  For
-            a tiny cost we make this more robust by forcing a kill here */
-            result.kill();
-          pybind11::gil_scoped_release release;
-          return result;
-        }catch(...){
-          pybind11::gil_scoped_release release;
-          throw;
-        };
+        std::pair<const char*,size_t> b=binary_pickle_buffer(t);
+        return deserialize_TimeSeriesEnsemble(b.first,b.second);
       } )
     )
+    .def("__reduce_ex__",[](py::object self, int protocol) {
+        return binary_reduce_ex<LoggingEnsemble<TimeSeries>>(self,protocol,"_TimeSeriesEnsemble_from_binary");
+      },"Pickle support - samples are out-of-band buffers for protocol 5")
+    .def("to_arrow",&TimeSeriesEnsemble_to_arrow,
+      "Return the ensemble as a pyarrow.RecordBatch with one row per member")
+    .def_static("from_arrow",&TimeSeriesEnsemble_from_arrow,
+      "Build an ensemble from a pyarrow.RecordBatch or Table written by to_arrow - no rows give an empty ensemble",
+      py::arg("data"))
   ;
   py::class_<BasicSpectrum,PyBasicSpectrum>(m,"_BasicSpectrum",
      "Base class for data objects based on Fourier transforms with uniform sampling")
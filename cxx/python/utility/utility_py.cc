@@ -110,21 +110,26 @@ public:
   }
 };
 
-/* Special iterator data structure for python */
+/* Special iterator data structure for python.  Metadata entries are
+stored in a vector so inserts during iteration would invalidate an
+iterator.  The keys are copied when iteration starts instead. */
 struct PyMetadataIterator {
-    PyMetadataIterator(const Metadata &md, py::object ref) : md(md), ref(ref) { }
+    PyMetadataIterator(const Metadata &md, py::object ref) : ref(ref)
+    {
+        keys.reserve(md.size());
+        for(auto mdptr=md.begin();mdptr!=md.end();++mdptr)
+            keys.push_back(mdptr->first);
+    }
 
     std::string next() {
-        if (index == md.end())
+        if (index == keys.size())
             throw py::stop_iteration();
-        std::string key = index->first;
-        ++index;
-        return key;
+        return keys[index++];
     }
 
-    const Metadata &md;
     py::object ref; // keep a reference
-    std::map<std::string,boost::any>::const_iterator index = md.begin();
+    std::vector<std::string> keys;
+    size_t index = 0;
 };
 
 /* The following Python C API are needed to construct the PyMsPASSError
@@ -453,9 +458,10 @@ PYBIND11_MODULE(utility, m) {
       memcpy(v->get_address(0,0), info.ptr, sizeof(double) * v->rows() * v->columns());
       return v;
     }))
+    /* numpy keeps the pointer so copies of the matrix must not share it */
     .def_buffer([](dmatrix &m) -> py::buffer_info {
       return py::buffer_info(
-        m.get_address(0,0),                               /* Pointer to buffer */
+        m.exclusive_address(0,0),                         /* Pointer to buffer */
         sizeof(double),                          /* Size of one scalar */
         py::format_descriptor<double>::format(), /* Python struct-style format descriptor */
         2,                                      /* Number of dimensions */
@@ -477,21 +483,31 @@ PYBIND11_MODULE(utility, m) {
     .def_property_readonly("shape", [](const dmatrix& self) {
       return py::make_tuple(self.rows(), self.columns());
     },"Return the unit vector equivalent to direction defined in sphereical coordinates")
-    .def(py::self + py::self,"Operator +")
+    /* The C++ operators return lazy expressions (see dmatrix_expression)
+    so these are evaluated to a dmatrix before returning to python. */
+    .def("__add__",[](const dmatrix& a, const dmatrix& b) -> dmatrix {
+      return a+b;
+    },py::is_operator(),"Operator +")
     .def("__add__", [](const dmatrix &a, py::object b) {
       return py::module_::import("mspasspy.ccore.utility").attr("dmatrix")(
         py::cast(a).attr("__getitem__")(py::reinterpret_steal<py::slice>(
         PySlice_New(Py_None, Py_None, Py_None))).attr("__add__")(b));
     })
-    .def(py::self - py::self,"Operator -")
+    .def("__sub__",[](const dmatrix& a, const dmatrix& b) -> dmatrix {
+      return a-b;
+    },py::is_operator(),"Operator -")
     .def("__sub__", [](const dmatrix &a, py::object b) {
       return py::module_::import("mspasspy.ccore.utility").attr("dmatrix")(
         py::cast(a).attr("__getitem__")(py::reinterpret_steal<py::slice>(
         PySlice_New(Py_None, Py_None, Py_None))).attr("__sub__")(b));
     })
     .def(py::self * py::self,"Operator *")
-    .def(py::self * double(),"Operator *")
-    .def(double() * py::self,"Operator *")
+    .def("__mul__",[](const dmatrix& a, const double s) -> dmatrix {
+      return a*s;
+    },py::is_operator(),"Operator *")
+    .def("__rmul__",[](const dmatrix& a, const double s) -> dmatrix {
+      return s*a;
+    },py::is_operator(),"Operator *")
     .def(py::self += py::self,"Operator +=")
     .def(py::self -= py::self,"Operator -=")
     .def("__getitem__", [](dmatrix &m, py::slice slice) {
@@ -500,7 +516,7 @@ PYBIND11_MODULE(utility, m) {
         throw py::error_already_set();
       double* packet;
       try{
-        packet = m.get_address(start,0);
+        packet = m.exclusive_address(start,0);
       } catch (MsPASSError& e) {
         packet = nullptr;
       }
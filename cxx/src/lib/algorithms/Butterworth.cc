@@ -246,7 +246,7 @@ CoreTimeSeries Butterworth::impulse_response(const int n)
 	result.set_dt(this->dt);
 	result.set_tref(TimeReferenceType::Relative);
 	result.set_live();
-	this->apply(result.s);
+	this->filter_samples(result.s.data(),result.s.size());
 	return result;
 }
 /* Fraction of 1/dt used to cause disabling low pass (upper) corner*/
@@ -272,7 +272,7 @@ void Butterworth::apply(mspass::seismic::CoreTimeSeries& d)
 		}
 		this->change_dt(d_dt);
 	}
-	this->apply(d.s);
+	this->filter_samples(d.s.data(),d.s.size());
 }
 /* We use ErrorLogger and blunder on with TimeSeries objects instead of
 throwing an exception when the upper corner is bad. */
@@ -291,7 +291,7 @@ void Butterworth::apply(mspass::seismic::TimeSeries& d)
 			double olddt=this->dt;
 			double flow_old=this->f3db_lo;
 			use_hi=false;
-			this->apply(d.s);
+			this->filter_samples(d.s.data(),d.s.size());
 			use_hi=true;
 			this->dt=olddt;
 			this->f3db_lo=flow_old;
@@ -311,7 +311,7 @@ void Butterworth::apply(mspass::seismic::TimeSeries& d)
 			this->change_dt(d_dt);
 		}
 	}
-	this->apply(d.s);
+	this->filter_samples(d.s.data(),d.s.size());
 }
 /* Reverse a vector of doubles in place using a pointer algorithm
 for speed. */
@@ -327,29 +327,35 @@ void reverse_vector(int nd, double *d)
 }
 
 
+void Butterworth::apply(vector<double>& d)
+{
+	this->filter_samples(d.data(),d.size());
+}
 /* This is a core method.  The other apply methods just call his one.
 It depends on a property of seismic unix implementation of bw Filters
-that allow input and output to be the same data vector*/
-void Butterworth::apply(vector<double>& d)
+that allow input and output to be the same data vector.  The data object
+methods pass the sample buffer of the object so samples stored in a
+packed ensemble block are filtered where they are. */
+void Butterworth::filter_samples(double *d, const int n)
 {
 	if(use_lo)
 	{
-		this->bflowcut(npoles_hi,f3db_hi,d.size(),&(d[0]),&(d[0]));
+		this->bflowcut(npoles_hi,f3db_hi,n,d,d);
 		if(zerophase)
 		{
-			reverse_vector(d.size(),&(d[0]));
-			this->bflowcut(npoles_hi,f3db_hi,d.size(),&(d[0]),&(d[0]));
-			reverse_vector(d.size(),&(d[0]));
+			reverse_vector(n,d);
+			this->bflowcut(npoles_hi,f3db_hi,n,d,d);
+			reverse_vector(n,d);
 		}
 	}
 	if(use_hi)
 	{
-		this->bfhighcut(npoles_lo,f3db_lo,d.size(),&(d[0]),&(d[0]));
+		this->bfhighcut(npoles_lo,f3db_lo,n,d,d);
 		if(zerophase)
 		{
-			reverse_vector(d.size(),&(d[0]));
-			this->bfhighcut(npoles_lo,f3db_lo,d.size(),&(d[0]),&(d[0]));
-			reverse_vector(d.size(),&(d[0]));
+			reverse_vector(n,d);
+			this->bfhighcut(npoles_lo,f3db_lo,n,d,d);
+			reverse_vector(n,d);
 		}
 	}
 }
@@ -441,10 +447,10 @@ ComplexArray Butterworth::transfer_function(const int nfft)
 	undesirable phase shift for many algorithms.  We remove it here using our
 	circular shift function */
 	int ishift=imp.sample_number(0.0);
-	imp.s=circular_shift(imp.s,ishift);
+	imp.s=circular_shift(imp.s.as_vector(),ishift);
 	gsl_fft_complex_wavetable *wavetable = gsl_fft_complex_wavetable_alloc (nfft);
 	gsl_fft_complex_workspace *workspace = gsl_fft_complex_workspace_alloc (nfft);
-	ComplexArray work(nfft,imp.s);
+	ComplexArray work(nfft,imp.s.as_vector());
 	gsl_fft_complex_forward(work.ptr(), 1, nfft, wavetable, workspace);
 	gsl_fft_complex_wavetable_free (wavetable);
 	gsl_fft_complex_workspace_free (workspace);
@@ -0,0 +1,134 @@
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/algorithms/GatherMatrix.h"
+namespace mspass::algorithms{
+using namespace std;
+using namespace mspass::seismic;
+using mspass::utility::dmatrix;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+GatherMatrix::GatherMatrix() : gather(), mask(), offset(), member_npts()
+{
+  nsamp=0;
+  mt0=0.0;
+  mdt=0.0;
+}
+GatherMatrix::GatherMatrix(const LoggingEnsemble<TimeSeries>& d,
+  const double dt_tolerance, const size_t max_npts)
+    : mask(d.member.size(),false),offset(d.member.size(),0),
+      member_npts(d.member.size(),0)
+{
+  nsamp=0;
+  mt0=0.0;
+  mdt=0.0;
+  /* The first live member defines the sample interval and time standard */
+  auto first=std::find_if(d.member.begin(),d.member.end(),
+    [](const TimeSeries& m){return m.live() && m.npts()>0;});
+  if(first==d.member.end()) return;
+  mdt=first->dt();
+  if(!(mdt>0.0) || !isfinite(mdt))
+  {
+    stringstream ss;
+    ss << "GatherMatrix constructor:  invalid sample interval "<<mdt
+       << " for member "<<(first-d.member.begin())<<endl;
+    throw MsPASSError(ss.str(),ErrorSeverity::Invalid);
+  }
+  const TimeReferenceType tref=first->timetype();
+  size_t j;
+  double tstart(first->t0());
+  for(j=0;j<d.member.size();++j)
+  {
+    const TimeSeries& m=d.member[j];
+    if(m.dead() || m.npts()==0) continue;
+    /* Written so a NaN sample interval is also rejected */
+    if(!(fabs(m.dt()-mdt)/mdt <= dt_tolerance)) continue;
+    if(m.timetype()!=tref)
+      throw MsPASSError("GatherMatrix constructor:  ensemble has members with UTC and relative time standards",
+        ErrorSeverity::Invalid);
+    if(!isfinite(m.t0()))
+    {
+      stringstream ss;
+      ss << "GatherMatrix constructor:  member "<<j<<" has an invalid start time "
+         << m.t0()<<endl;
+      throw MsPASSError(ss.str(),ErrorSeverity::Invalid);
+    }
+    mask[j]=true;
+    tstart=min(tstart,m.t0());
+  }
+  mt0=tstart;
+  /* Members are placed at the nearest sample of the common time axis.
+  Computing the size from the offsets makes sure every member fits.
+  The size is tested in double precision first because members of a UTC
+  ensemble can be far enough apart to overflow the matrix size. */
+  for(j=0;j<d.member.size();++j)
+  {
+    if(!mask[j]) continue;
+    const TimeSeries& m=d.member[j];
+    const double doffset=round((m.t0()-mt0)/mdt);
+    if(doffset+static_cast<double>(m.npts()) > static_cast<double>(max_npts))
+    {
+      stringstream ss;
+      ss << "GatherMatrix constructor:  member "<<j<<" ends "
+         << doffset+static_cast<double>(m.npts())
+         << " samples after the earliest start time of the ensemble"<<endl
+         << "That exceeds the maximum matrix size of "<<max_npts
+         << " samples per column"<<endl;
+      throw MsPASSError(ss.str(),ErrorSeverity::Invalid);
+    }
+    offset[j]=static_cast<size_t>(doffset);
+    member_npts[j]=m.npts();
+    nsamp=max(nsamp,offset[j]+member_npts[j]);
+  }
+  /* The constructor initializes the matrix to zeros, which is the padding */
+  gather=dmatrix(nsamp,d.member.size());
+  for(j=0;j<d.member.size();++j)
+  {
+    if(!mask[j]) continue;
+    const double *dptr=d.member[j].s.data();
+    std::copy(dptr,dptr+member_npts[j],gather.get_address(offset[j],j));
+  }
+}
+void GatherMatrix::scatter(LoggingEnsemble<TimeSeries>& d) const
+{
+  if(d.member.size()!=mask.size())
+  {
+    stringstream ss;
+    ss << "GatherMatrix::scatter:  ensemble has "<<d.member.size()
+       << " members but this matrix was built from an ensemble with "
+       << mask.size()<<" members"<<endl;
+    throw MsPASSError(ss.str(),ErrorSeverity::Invalid);
+  }
+  size_t j;
+  /* Check all members first so an error leaves the ensemble unchanged */
+  for(j=0;j<mask.size();++j)
+  {
+    const TimeSeries& m=d.member[j];
+    if(mask[j] && m.live() && (m.npts()!=member_npts[j]))
+    {
+      stringstream ss;
+      ss << "GatherMatrix::scatter:  member "<<j<<" has "<<m.npts()
+         << " samples but had "<<member_npts[j]
+         << " samples when this matrix was built"<<endl;
+      throw MsPASSError(ss.str(),ErrorSeverity::Invalid);
+    }
+  }
+  for(j=0;j<mask.size();++j)
+  {
+    TimeSeries& m=d.member[j];
+    if(!mask[j] || m.dead()) continue;
+    const double *col=gather.get_address(offset[j],j);
+    std::copy(col,col+member_npts[j],m.s.data());
+  }
+}
+size_t GatherMatrix::number_live() const
+{
+  return std::count(mask.begin(),mask.end(),true);
+}
+int GatherMatrix::sample_number(const double t) const
+{
+  return static_cast<int>(round((t-mt0)/mdt));
+}
+}  // End namespace mspass::algorithms
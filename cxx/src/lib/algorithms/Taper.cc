@@ -55,10 +55,11 @@ int LinearTaper::apply(TimeSeries& d)
     }
     int is;
     double t,wt;
+    double *sptr=d.s.data();
     for(t=d.t0();t<t0head;t+=d.dt())
     {
       is=d.sample_number(t);
-      if(is>=0 && is<d.npts()) d.s[is]=0.0;
+      if(is>=0 && is<d.npts()) sptr[is]=0.0;
     }
     rampslope=1.0/(t1head-t0head);
     for(t=t0head;t<t1head;t+=d.dt())
@@ -67,7 +68,7 @@ int LinearTaper::apply(TimeSeries& d)
       if(is>=0)
       {
         wt=rampslope*(t-t0head);
-        d.s[is]*=wt;
+        sptr[is]*=wt;
       }
     }
   }
@@ -84,10 +85,11 @@ int LinearTaper::apply(TimeSeries& d)
     }
     int is;
     double t,wt;
+    double *sptr=d.s.data();
     for(t=d.endtime();t>=t0tail;t-=d.dt())
     {
       is=d.sample_number(t);
-      if(is>=0 && is<d.npts()) d.s[is]=0.0;
+      if(is>=0 && is<d.npts()) sptr[is]=0.0;
     }
     rampslope=1.0/(t0tail-t1tail);
     for(t=t0tail;t>=t1tail;t-=d.dt())
@@ -96,7 +98,7 @@ int LinearTaper::apply(TimeSeries& d)
       if(is>=0)
       {
         wt=rampslope*(t0tail-t);
-        d.s[is]*=wt;
+        sptr[is]*=wt;
       }
     }
   }
@@ -238,10 +240,11 @@ int CosineTaper::apply( TimeSeries& d)
     }
     int is;
     double t,wt;
+    double *sptr=d.s.data();
     for(t=d.t0();t<t0head;t+=d.dt())
     {
       is=d.sample_number(t);
-      if(is>=0 && is<d.npts()) d.s[is]=0.0;
+      if(is>=0 && is<d.npts()) sptr[is]=0.0;
     }
     for(t=t0head;t<t1head;t+=d.dt())
     {
@@ -249,7 +252,7 @@ int CosineTaper::apply( TimeSeries& d)
       if(is>=0)
       {
         wt=headcos(t0head,t1head,t);
-        d.s[is]*=wt;
+        sptr[is]*=wt;
       }
     }
   }
@@ -266,12 +269,13 @@ int CosineTaper::apply( TimeSeries& d)
     }
     int is;
     double t,wt;
+    double *sptr=d.s.data();
     for(t=d.endtime();t>=t0tail;t-=d.dt())
     {
       is=d.sample_number(t);
       if(is>=0 && is<d.npts())
       {
-        d.s[is]=0.0;
+        sptr[is]=0.0;
       }
     }
     for(t=t1tail;t<t0tail;t+=d.dt())
@@ -280,7 +284,7 @@ int CosineTaper::apply( TimeSeries& d)
       if(is>=0)
       {
         wt=tailcos(t0tail,t1tail,t);
-        d.s[is]*=wt;
+        sptr[is]*=wt;
       }
     }
   }
@@ -380,7 +384,8 @@ int VectorTaper::apply( TimeSeries& d)
       d.elog.log_error("VectorTaper",ss.str(),ErrorSeverity::Complaint);
       return -1;
     }
-    for(int i=0;i<d.npts();++i) d.s[i] *= taper[i];
+    double *sptr=d.s.data();
+    for(int i=0;i<d.npts();++i) sptr[i] *= taper[i];
     return 0;
   }
   else
@@ -1,8 +1,10 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string>
+#include <algorithm>
 #include "mspass/seismic/Seismogram.h"
 #include "mspass/algorithms/algorithms.h"
+#include "mspass/algorithms/EnsembleWorkers.h"
 namespace mspass::algorithms
 {
 using namespace std;
@@ -161,4 +163,19 @@ TimeSeries agc(Seismogram& d, const double twin)
         return TimeSeries();
     }
 }
+LoggingEnsemble<TimeSeries> agc(LoggingEnsemble<Seismogram>& d, const double twin,
+  const size_t nthreads)
+{
+  LoggingEnsemble<TimeSeries> gains;
+  gains.member.resize(d.member.size());
+  for_each_member(d.member,[&](Seismogram& m, const size_t i){
+      gains.member[i]=agc(m,twin);
+    },"agc",nthreads);
+  /* Gains of dead or killed members are dead default objects, so the
+  result is live only if the input is live and some gain was computed */
+  if(d.live() && std::any_of(gains.member.begin(),gains.member.end(),
+      [](const TimeSeries& g){return g.live();}))
+    gains.set_live();
+  return gains;
+}
 }// End mspass namespace
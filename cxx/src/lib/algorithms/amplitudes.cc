@@ -1,5 +1,8 @@
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/sample_kernels.h"
 #include "mspass/seismic/TimeSeries.h"
 #include "mspass/seismic/Seismogram.h"
 #include "misc/blas.h"
@@ -10,6 +13,7 @@ using namespace std;
 using namespace mspass::seismic;
 using mspass::utility::MsPASSError;
 using mspass::utility::ErrorSeverity;
+using mspass::utility::sum_of_squares;
 
 /* Series of overloaded functions to measure peak amplitudes for
 different types of seismic data objects.  These are used in
@@ -17,7 +21,7 @@ a generic algorithm defined in seispp.h */
 double PeakAmplitude(const CoreTimeSeries& d)
 {
 	if(d.dead() || ((d.npts())<=0)) return(0.0);
-	vector<double> work(d.s);
+	vector<double> work(d.s.as_vector());
 	vector<double>::iterator dptr,amp;
 	/* We want maximum absolute value of the amplitude */
 	for(dptr=work.begin();dptr!=work.end();++dptr) (*dptr)=fabs(*dptr);
@@ -29,7 +33,7 @@ double PeakAmplitude(const CoreSeismogram& d)
 	if(d.dead() || ((d.npts()<=0))) return(0.0);
 	// This loop could use p->ns but this more more bulletproof.
 	double ampval,ampvec;
-	double *ptr;
+	const double *ptr;
 	int j;
 	ampvec=0.0;
 	for(j=0;j<d.npts();++j)
@@ -46,26 +50,35 @@ double PeakAmplitude(const CoreSeismogram& d)
 	}
 	return(ampvec);
 }
+namespace {
+/* Root of the sum of squares of n contiguous samples divided by m.  The
+vector sum of squares is fast but overflows for amplitudes above about
+1e154, and squares below DBL_MIN lose precision.  In either case fall back
+to the blas norm, which rescales as it accumulates, and divide it by
+sqrt(m) so the result cannot overflow.  Data that are all zero also take
+the blas path, which returns 0. */
+double root_mean_square(const double *x, const size_t n, const size_t m)
+{
+	const double sumsq=sum_of_squares(x,n);
+	if(std::isfinite(sumsq) && (sumsq>=DBL_MIN*static_cast<double>(n)))
+		return sqrt(sumsq/static_cast<double>(m));
+	return dnrm2(static_cast<int>(n),x,1)/sqrt(static_cast<double>(m));
+}
+}
 double RMSAmplitude(const CoreTimeSeries& d)
 {
 	if(d.dead() || ((d.npts())<=0)) return(0.0);
-	double l2nrm=dnrm2(d.npts(),&(d.s[0]),1);
-	return sqrt(l2nrm*l2nrm/d.npts());
+	return root_mean_square(d.s.data(),d.npts(),d.npts());
 }
 double RMSAmplitude(const CoreSeismogram& d)
 {
 	/* rms is sum of squares so rms reduces to grand sum of squares of
 	amplitudes on all 3 components.*/
 	if(d.dead() || ((d.npts()<=0))) return(0.0);
-	double sumsq(0.0);
 	/* This depends upon implementation detail for dmatrix u where the
 	matrix is stored in contiguous block - beware of this implementation
 	detail if matrix implementation changed. */
-	double *ptr;
-	ptr=d.u.get_address(0,0);
-	size_t n=3*d.npts();
-	for(size_t k=0;k<n;++k,++ptr) sumsq += (*ptr)*(*ptr);
-	return sqrt(sumsq/d.npts());
+	return root_mean_square(d.u.get_address(0,0),3*d.npts(),d.npts());
 }
 double PercAmplitude(const CoreTimeSeries& d, const double perc)
 {
@@ -87,7 +100,7 @@ double PercAmplitude(const CoreTimeSeries& d, const double perc)
 		percfrac=perc/100.0;
 	}
 	vector<double> amps;
-	amps=d.s;
+	amps=d.s.as_vector();
 	vector<double>::iterator ptr;
 	for(ptr=amps.begin();ptr!=amps.end();++ptr) *ptr = fabs(*ptr);
 	sort(amps.begin(),amps.end());
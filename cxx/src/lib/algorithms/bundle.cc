@@ -19,15 +19,16 @@ Return -1 if x<y, 0 if x==y, and +1 if x>y.
 Undefined values require a definition.   two undefined field compare equal but
 and undefined value always compare > a defined field. */
 
-int cautious_compare(const TimeSeries& x, const TimeSeries& y, const string key)
+int cautious_compare(const TimeSeries& x, const TimeSeries& y,
+  const MetadataKey<string>& key)
 {
   if(x.is_defined(key))
   {
     if(y.is_defined(key))
     {
       string valx,valy;
-      valx=x.get<string>(key);
-      valy=y.get<string>(key);
+      valx=x.get(key);
+      valy=y.get(key);
       if(valx>valy)
         return 1;
       else if(valx==valy)
@@ -59,7 +60,7 @@ struct greater_seedorder
   bool operator()(TimeSeries x, TimeSeries y)
   {
     int retnet,retsta,retloc,retchan;
-    retnet=cautious_compare(x,y,SEISMICMD_net);
+    retnet=cautious_compare(x,y,SEISMICMD_net_key);
     switch(retnet)
     {
       case -1:
@@ -68,7 +69,7 @@ struct greater_seedorder
         return true;
       case 0:
       default:
-        retsta=cautious_compare(x,y,SEISMICMD_sta);
+        retsta=cautious_compare(x,y,SEISMICMD_sta_key);
         switch(retsta)
         {
           case -1:
@@ -77,7 +78,7 @@ struct greater_seedorder
             return true;
           case 0:
           default:
-            retloc=cautious_compare(x,y,SEISMICMD_loc);
+            retloc=cautious_compare(x,y,SEISMICMD_loc_key);
             switch(retloc)
             {
               case -1:
@@ -86,7 +87,7 @@ struct greater_seedorder
                 return true;
               case 0:
               default:
-                retchan=cautious_compare(x,y,SEISMICMD_chan);
+                retchan=cautious_compare(x,y,SEISMICMD_chan_key);
                 switch(retchan)
                 {
                   case +1:
@@ -162,11 +163,11 @@ Seismogram BundleSEEDGroup(const std::vector<TimeSeries>& d,
         chans_this_group.push_back("DEADCHANNEL");
         continue;
       }
-      net=d[i].get_string(SEISMICMD_net);
-      sta=d[i].get_string(SEISMICMD_sta);
-      chan=d[i].get_string(SEISMICMD_chan);
+      net=d[i].get(SEISMICMD_net_key);
+      sta=d[i].get(SEISMICMD_sta_key);
+      chan=d[i].get(SEISMICMD_chan_key);
       sta2.assign(chan,0,2);
-      loc=d[i].get_string(SEISMICMD_loc);
+      loc=d[i].get(SEISMICMD_loc_key);
       chans_this_group.push_back(chan);
       networks.insert(net);
       stations.insert(sta);
@@ -407,8 +408,8 @@ LoggingEnsemble<Seismogram> bundle_seed_data(LoggingEnsemble<TimeSeries>& d)
         /* If net, sta, and loc are defined we try to blunder on so we can
         retain elog entries in data received as dead.  Necessary or the
         user won't be able to track the reason something was dropped easily*/
-        if( dptr->is_defined(SEISMICMD_net) && dptr->is_defined(SEISMICMD_sta)
-           && dptr->is_defined(SEISMICMD_loc) )
+        if( dptr->is_defined(SEISMICMD_net_key) && dptr->is_defined(SEISMICMD_sta_key)
+           && dptr->is_defined(SEISMICMD_loc_key) )
         {
           has_dead_channel=true;
         }
@@ -423,46 +424,46 @@ LoggingEnsemble<Seismogram> bundle_seed_data(LoggingEnsemble<TimeSeries>& d)
       if(i==0)
       {
         /* These things need to all be initialized by the first member*/
-        if(dptr->is_defined(SEISMICMD_net))
+        if(dptr->is_defined(SEISMICMD_net_key))
         {
-          lastnet=dptr->get<string>(SEISMICMD_net);
+          lastnet=dptr->get(SEISMICMD_net_key);
         }
         else
         {
           lastnet="Undefined";
         }
-        if(dptr->is_defined(SEISMICMD_loc))
+        if(dptr->is_defined(SEISMICMD_loc_key))
         {
-          lastloc=dptr->get<string>(SEISMICMD_loc);
+          lastloc=dptr->get(SEISMICMD_loc_key);
         }
         else
         {
           lastloc="Undefined";
         }
-        laststa=dptr->get<string>(SEISMICMD_sta);
-        lastchan=dptr->get<string>(SEISMICMD_chan);
+        laststa=dptr->get(SEISMICMD_sta_key);
+        lastchan=dptr->get(SEISMICMD_chan_key);
         i0=0;
       }
       else
       {
-        if(dptr->is_defined(SEISMICMD_net))
+        if(dptr->is_defined(SEISMICMD_net_key))
         {
-          net=dptr->get<string>(SEISMICMD_net);
+          net=dptr->get(SEISMICMD_net_key);
         }
         else
         {
           net="Undefined";
         }
-        if(dptr->is_defined(SEISMICMD_loc))
+        if(dptr->is_defined(SEISMICMD_loc_key))
         {
-          loc=dptr->get<string>(SEISMICMD_loc);
+          loc=dptr->get(SEISMICMD_loc_key);
         }
         else
         {
           loc="Undefined";
         }
-        sta=dptr->get<string>(SEISMICMD_sta);
-        chan=dptr->get<string>(SEISMICMD_chan);
+        sta=dptr->get(SEISMICMD_sta_key);
+        chan=dptr->get(SEISMICMD_chan_key);
         if( (lastnet!=net || laststa!=sta || lastloc!=loc) ||
                (dptr==(d.member.end() - 1)) )
         {
@@ -521,6 +521,7 @@ void CNR3CDecon::loadwavelet(const TimeSeries& w)
 //DEBUG
 //cout << "t0 of wavelet stored now wavelet data objec="<<wavelet.t0()<<endl;
     /* We recycle the variable ntest defined above here for convenience only */
+    double *wptr=this->wavelet.s.data();
     for(k=0,ntest=0;k<w.npts();++k)
     {
       double t=w.time(k);
@@ -528,7 +529,7 @@ void CNR3CDecon::loadwavelet(const TimeSeries& w)
       if(ntest>ns_to_copy) break;
       kk=this->wavelet.sample_number(t);
       if( (kk>=0) && (kk<this->wavelet.npts()) )
-        this->wavelet.s[kk]=w.s[k];
+        wptr[kk]=w.s[k];
     }
     /* This was the old code fixed Dec 2020 - remove when revision is know to work
     for(k=0,kk=this->winlength;k<ns_to_copy;++k,++kk)this->wavelet.s[kk]=w.s[k];
@@ -946,7 +947,8 @@ TimeSeries CNR3CDecon::actual_output()
       copy ao elements rather than what was here before:
         result.s=ao;
         */
-      for(int k=0;k<FFTDeconOperator::nfft;++k) result.s[k]=ao[k];
+      double *sptr=result.s.data();
+      for(int k=0;k<FFTDeconOperator::nfft;++k) sptr[k]=ao[k];
       return result;
   } catch(...) {
       throw;
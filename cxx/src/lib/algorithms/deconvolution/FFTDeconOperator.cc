@@ -147,7 +147,8 @@ CoreTimeSeries FFTDeconOperator::FourierInverse(const ComplexArray& winv, const
     the values not use push back below */
     result.set_npts(nfft);
     result.set_tref(TimeReferenceType::Relative);
-    for(int k=0; k<winv_work.size(); ++k) result.s[k]=winv_work[k].real();
+    double *sptr=result.s.data();
+    for(int k=0; k<winv_work.size(); ++k) sptr[k]=winv_work[k].real();
     return result;
   }catch(...){throw;};
 }
@@ -504,7 +504,7 @@ void GeneralIterDecon::process()
         if(decon_type==MULTI_TAPER)
         {
             CoreTimeSeries nts(ExtractComponent(n,noise_component));
-            dynamic_cast<MultiTaperXcorDecon *>(preprocessor)->loadnoise(nts.s);
+            dynamic_cast<MultiTaperXcorDecon *>(preprocessor)->loadnoise(nts.s.as_vector());
         }
         /* For this case of receiver function deconvolution we always get the
         wavelet from component 2 - assumed here to be Z or L. */
@@ -514,7 +514,7 @@ void GeneralIterDecon::process()
             CoreTimeSeries dcomp(ExtractComponent(d_decon,k));
             /* Need the qualifier or we get the wrong overloaded
              * load method */
-            preprocessor->ScalarDecon::load(srcwavelet.s,dcomp.s);
+            preprocessor->ScalarDecon::load(srcwavelet.s.as_vector(),dcomp.s.as_vector());
             preprocessor->process();
             vector<double> deconout(preprocessor->getresult());
             int copysize=deconout.size();
@@ -557,7 +557,7 @@ void GeneralIterDecon::process()
         cerr << actual_out<<endl;
 */
         actual_out=trim(actual_out);
-        actual_o_fir=actual_out.s;
+        actual_o_fir=actual_out.s.as_vector();
         actual_o_0=actual_out.sample_number(0.0);
 	double peak_scale=actual_o_fir[actual_o_0];
 	vector<double>::iterator aoptr;
@@ -162,7 +162,8 @@ CoreTimeSeries LeastSquareDecon::actual_output()
         result.set_live();
         result.set_npts(nfft);
         result.set_tref(TimeReferenceType::Relative);
-        for(int k=0;k<nfft;++k)result.s[k]=ao[k];
+        double *sptr=result.s.data();
+        for(int k=0;k<nfft;++k)sptr[k]=ao[k];
         return result;
     } catch(...) {
         throw;
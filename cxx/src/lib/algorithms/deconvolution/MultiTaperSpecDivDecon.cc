@@ -503,7 +503,8 @@ CoreTimeSeries MultiTaperSpecDivDecon::actual_output()
       result.set_live();
       result.set_npts(nfft);
       result.set_tref(TimeReferenceType::Relative);
-      for(k=0;k<nfft;++k)result.s[k]=ao[k];
+      double *sptr=result.s.data();
+      for(k=0;k<nfft;++k)sptr[k]=ao[k];
       return result;
     } catch(...) {
         throw;
@@ -528,7 +529,8 @@ CoreTimeSeries MultiTaperSpecDivDecon::inverse_wavelet(const double t0parent)
            result+=work;
      }
      double nrmscal=1.0/((double)nseq);
-     for(int k=0;k<result.s.size();++k) result.s[k]*=nrmscal;
+     double *sptr=result.s.data();
+     for(int k=0;k<result.s.size();++k) sptr[k]*=nrmscal;
      return result;
      }
      catch(...) {
@@ -384,7 +384,8 @@ CoreTimeSeries MultiTaperXcorDecon::actual_output()
         result.set_live();
         result.set_tref(TimeReferenceType::Relative);
         result.set_npts(nfft);
-        for(int k=0;k<nfft;++k)result.s[k]=ao[k];
+        double *sptr=result.s.data();
+        for(int k=0;k<nfft;++k)sptr[k]=ao[k];
         return result;
     } catch(...) {
         throw;
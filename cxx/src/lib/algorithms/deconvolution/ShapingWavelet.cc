@@ -301,7 +301,7 @@ CoreTimeSeries ShapingWavelet::impulse_response()
         // we use this approach to unfold the fft output
         result.s.clear();
 	      for(k=0;k<nfft;++k) result.s.push_back(iwf[k].real());
-	      result.s=circular_shift(result.s,shift);
+	      result.s=circular_shift(result.s.as_vector(),shift);
         return result;
     } catch(...) {
         throw;
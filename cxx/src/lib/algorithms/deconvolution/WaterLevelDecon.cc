@@ -170,7 +170,8 @@ CoreTimeSeries WaterLevelDecon::actual_output()
         result.set_live();
         result.set_tref(TimeReferenceType::Relative);
         result.set_npts(nfft);
-        for(int k=0;k<nfft;++k)result.s[k]=ao[k];;
+        double *sptr=result.s.data();
+        for(int k=0;k<nfft;++k)sptr[k]=ao[k];
         return result;
     } catch(...) {
         throw;
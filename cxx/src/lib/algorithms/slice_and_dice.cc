@@ -1,9 +1,12 @@
 #include <sstream>
+#include <algorithm>
 #include "mspass/utility/MsPASSError.h"
 #include "mspass/algorithms/TimeWindow.h"
 #include "mspass/seismic/TimeSeries.h"
 #include "mspass/seismic/Seismogram.h"
 #include "mspass/seismic/keywords.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/algorithms/EnsembleWorkers.h"
 namespace mspass::algorithms
 {
 using namespace std;
@@ -104,13 +107,12 @@ CoreTimeSeries WindowData(const CoreTimeSeries& parent, const TimeWindow& tw)
   }
   int outns=ie-is+1;
 	CoreTimeSeries result(parent);
-	result.s.reserve(outns);
 	result.set_npts(outns);
 	result.set_t0(tw.start);
-	// Necessary to use the push_back method below or we get leading zeros
-	result.s.clear();
-
-  for(int i=is;i<=ie;++i) result.s.push_back(parent.s[i]);
+	/* result shares the parent samples after the copy.  Assigning the range
+	replaces them without first copying the whole parent as reserve and
+	push_back would. */
+	result.s.assign(parent.s.begin()+is,parent.s.begin()+ie+1);
   return(result);
 }
 
@@ -133,7 +135,8 @@ dead object for unrecoverable errors.
 \param parent is the larger Seismogram object to be windowed
 \param tw defines the data range to be extracted from parent.
 */
-Seismogram WindowData(const Seismogram& parent, const TimeWindow& tw)
+Seismogram WindowData(const Seismogram& parent, const TimeWindow& tw,
+  const bool view)
 {
 	// Always silently do nothing if marked dead
 	if(parent.dead())
@@ -172,9 +175,13 @@ Seismogram WindowData(const Seismogram& parent, const TimeWindow& tw)
 	3.  The constructor initializes the dmatrix u to zeros with length
 			determined from the set_npts result.
 	Less important is we have to add the load_history call here or history
-	would be lost.  Reason is the constructor uses CoreTimeSeries. */
+	would be lost.  Reason is the constructor uses CoreTimeSeries.
+	A view is built the same way with no samples and then given the
+	column range of parent.  A copy of parent would copy all its samples
+	when they are exclusive (e.g. after being used as a numpy array). */
+	const size_t nalloc = view ? 0 : outns;
 	BasicTimeSeries btstmp(dynamic_cast<const BasicTimeSeries&>(parent));
-	btstmp.set_npts(outns);
+	btstmp.set_npts(nalloc);
 	btstmp.set_t0(tw.start);
 	/* WARNING MAINTENANCE ISSUE:  this is less than ideal fix for a problem
 	found when debugging the revision of this algorithm to improve its
@@ -186,17 +193,21 @@ Seismogram WindowData(const Seismogram& parent, const TimeWindow& tw)
 	just did a dynamic cast to the input, which created the problem.
 	*/
 	Metadata mdtmp(dynamic_cast<const Metadata&>(parent));
-	mdtmp.put_long(SEISMICMD_npts,outns);
+	mdtmp.put(SEISMICMD_npts_key,static_cast<long>(nalloc));
 	Seismogram result(btstmp,mdtmp);
-
-	// Perhaps should do this with blas or memcpy for efficiency
-  //  but this makes the algorithm much clearer
-  int i,ii,k;
-  for(i=is,ii=0;i<=ie;++i,++ii)
-      for(k=0;k<3;++k)
-      {
-          result.u(k,ii)=parent.u(k,i);
-      }
+	if(view)
+	{
+		result.u=parent.u.column_range(is,outns);
+		result.sync_npts();
+	}
+	/* Columns are contiguous in u so the window is copied as one block.
+	column_range does the range check the indexing operator used to do. */
+	else if(outns>0)
+	{
+		const dmatrix window(parent.u.column_range(is,outns));
+		const double *wptr=window.get_address(0,0);
+		std::copy(wptr,wptr+3*outns,result.u.get_address(0,0));
+	}
 	/* Necessary because the constructor we called will set the Seismogram
 	it creates dead.  After filling in data we can mark it live */
 	result.set_live();
@@ -219,7 +230,8 @@ handling time.
 \param parent is the larger TimeSeries object to be windowed
 \param tw defines the data range to be extracted from parent.
 */
-TimeSeries WindowData(const TimeSeries& parent, const TimeWindow& tw)
+TimeSeries WindowData(const TimeSeries& parent, const TimeWindow& tw,
+  const bool view)
 {
 	// Always silently do nothing if marked dead
 	if(parent.dead())
@@ -263,19 +275,79 @@ TimeSeries WindowData(const TimeSeries& parent, const TimeWindow& tw)
 	3.  The constructor initializes the std::vector to zeros with length
 	    determined from the set_npts result.
 	Less important is we have to add the load_history call here or history
-	would be lost.  Reason is the constructor uses CoreTimeSeries. */
+	would be lost.  Reason is the constructor uses CoreTimeSeries.
+	As in the Seismogram version a view starts with no samples. */
 
 	BasicTimeSeries btstmp(dynamic_cast<const BasicTimeSeries&>(parent));
-	btstmp.set_npts(outns);
+	btstmp.set_npts(view ? 0 : outns);
 	btstmp.set_t0(tw.start);
 	TimeSeries result(btstmp,dynamic_cast<const Metadata&>(parent));
-	/* That constuctor initalizes s to zeroes so we can copy directly
-	to the container without push_back.  memcpy might buy a small performance
-	gain but would make this more fragile that it already is. */
-	for(int i=is,ii=0;i<=ie;++i,++ii) result.s[ii] = parent.s[i];
+	if(view)
+	{
+		result.s=parent.s.slice(is,outns);
+		result.sync_npts();
+	}
+	else
+	{
+		/* That constuctor initalizes s to zeroes so we can copy directly
+		to the container without push_back.  memcpy might buy a small performance
+		gain but would make this more fragile that it already is. */
+		double *sptr=result.s.data();
+		for(int i=is,ii=0;i<=ie;++i,++ii) sptr[ii] = parent.s[i];
+	}
 	/*This dynamic_cast may not be necessary, but makes the api clear */
 	result.load_history(dynamic_cast<const ProcessingHistory&>(parent));
 
   return(result);
 }
+/* Shared by the TimeSeries and Seismogram ensemble versions of WindowData.
+The result is built from the ensemble Metadata and elog of parent.  Members
+are filled by index:  dead members are copied and live members are
+windowed.  A member that throws is replaced by a dead copy of the parent
+member with the error posted to its elog, as for_each_member does. */
+template <typename Tdata> LoggingEnsemble<Tdata> WindowEnsemble(
+  const LoggingEnsemble<Tdata>& parent, const TimeWindow& tw, const size_t nthreads,
+  const bool view)
+{
+  const size_t n=parent.member.size();
+  LoggingEnsemble<Tdata> result(dynamic_cast<const Metadata&>(parent),parent.elog,n);
+  result.member.resize(n);
+  for_each_index(n,NullOperator(),[&](NullOperator&, const size_t i){
+      const Tdata& d=parent.member[i];
+      Tdata& m=result.member[i];
+      if(d.dead())
+      {
+        m=d;
+        return;
+      }
+      try{
+        m=WindowData(d,tw,view);
+      }catch(MsPASSError& err)
+      {
+        m=d;
+        m.elog.log_error(err);
+        m.kill();
+      }catch(std::exception& err)
+      {
+        m=d;
+        m.elog.log_error("WindowData",err.what(),ErrorSeverity::Invalid);
+        m.kill();
+      }
+    },nthreads);
+  if(parent.live())
+    result.set_live();
+  else
+    result.kill();
+  return result;
+}
+LoggingEnsemble<TimeSeries> WindowData(const LoggingEnsemble<TimeSeries>& parent,
+  const TimeWindow& tw, const size_t nthreads, const bool view)
+{
+  return WindowEnsemble(parent,tw,nthreads,view);
+}
+LoggingEnsemble<Seismogram> WindowData(const LoggingEnsemble<Seismogram>& parent,
+  const TimeWindow& tw, const size_t nthreads, const bool view)
+{
+  return WindowEnsemble(parent,tw,nthreads,view);
+}
 } // end mspass namespace
@@ -39,8 +39,8 @@ CoreSeismogram sparse_convolve(const CoreTimeSeries& wavelet,
            should guarantee no pointers fly outside the bounds of the data.*/
         int i,k;
         for(i=0;i<d.npts();++i,++si){
-            double *sptr=const_cast<double *>(out3c.u.get_address(0,si));
-            double *dptr=d.u.get_address(0,i);
+            double *sptr=out3c.u.get_address(0,si);
+            const double *dptr=d.u.get_address(0,i);
             for(k=0;k<3;++k){
                 if((*dptr)!=0.0){
                     daxpy(nw,(*dptr),wptr,1,sptr,3);
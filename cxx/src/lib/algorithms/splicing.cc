@@ -371,12 +371,15 @@ TimeSeriesWGaps splice_segments(std::vector<TimeSeries>& segments,
     data vector (symbol s) to spliced_nsamp zeros.  Gaps will then 
     not need to be zero filled.*/
     result.set_npts(issues.spliced_nsamp);
+    double *sptr=result.s.data();
     double previous_endtime,delta;
     previous_endtime = segments[issues.first_live].endtime();
     size_t ii;
     for(size_t i=issues.first_live;i<segments.size();++i)
     {
       if(segments[i].dead()) continue;
+      /* Read through a const pointer so the segment samples are not copied */
+      const double *segptr=static_cast<const TimeSeries&>(segments[i]).s.data();
       for(size_t j=0;j<segments[i].s.size();++j,++ii)
       {
         double t;
@@ -394,7 +397,7 @@ TimeSeriesWGaps splice_segments(std::vector<TimeSeries>& segments,
             <<endl;
           throw MsPASSError(ss.str(),ErrorSeverity::Fatal);
         }
-        result.s[ii] = segments[i].s[j];
+        sptr[ii] = segptr[j];
       }
       /* We use a signed test here because we can be sure there are no
       overlaps that create negative delta values larger than TIME_TEAR_TOLERANCE
@@ -0,0 +1,339 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <limits>
+#include <algorithm>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/io/ConcurrentAppender.h"
+namespace mspass::io
+{
+using namespace std;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+namespace {
+/* The cursor is set to this value while the slow path replaces the
+extent.  It is large enough that the fast path test always fails but
+small enough that adding a request size cannot overflow. */
+const long int CURSOR_BUSY(std::numeric_limits<long int>::max()/2);
+
+/* Contents of the lock file.  dev and ino identify the data file the
+next offset belongs to.  A record for a removed file of the same name
+is then never used for a new file. */
+struct LockRecord
+{
+  int64_t next;
+  uint64_t dev;
+  uint64_t ino;
+};
+
+/* RAII wrapper for the exclusive flock on the lock file */
+class LockFileGuard
+{
+public:
+  LockFileGuard(const int fdin, const string fname) : fd(fdin)
+  {
+    while(flock(fd,LOCK_EX)!=0)
+    {
+      if(errno==EINTR) continue;
+      throw MsPASSError("ConcurrentAppender:  flock failed on lock file for "
+        + fname + "\nSystem error message:  " + strerror(errno),
+        ErrorSeverity::Invalid);
+    }
+  };
+  ~LockFileGuard(){flock(fd,LOCK_UN);};
+private:
+  int fd;
+};
+} // End anonymous namespace
+
+string ConcurrentAppender::lock_file_name(const string fname)
+{
+  return fname + ".lock";
+}
+ConcurrentAppender::ConcurrentAppender(const string name, const size_t esize)
+  : fname(name),fd(-1),lockfd(-1),extent_size(esize),cursor(0),extent_end(0)
+{
+  string lname=lock_file_name(fname);
+  lockfd=open(lname.c_str(),O_RDWR|O_CREAT,0666);
+  if(lockfd<0)
+    throw MsPASSError("ConcurrentAppender constructor:  Open failed on lock file "
+      + lname + "\nSystem error message:  " + strerror(errno),
+      ErrorSeverity::Invalid);
+  /* The data file is created while holding the lock so no other process
+  can reserve space in a new file before its record is reset.
+  O_APPEND must not be used because linux pwrite ignores the offset
+  for files opened in append mode */
+  try{
+    LockFileGuard lock(lockfd,fname);
+    bool created(true);
+    fd=open(fname.c_str(),O_WRONLY|O_CREAT|O_EXCL,0666);
+    if(fd<0 && errno==EEXIST)
+    {
+      created=false;
+      fd=open(fname.c_str(),O_WRONLY);
+    }
+    if(fd<0)
+      throw MsPASSError("ConcurrentAppender constructor:  Open failed on file "
+        + fname + "\nSystem error message:  " + strerror(errno),
+        ErrorSeverity::Invalid);
+    if(created) this->write_next_offset(0);
+  }catch(...)
+  {
+    if(fd>=0) close(fd);
+    close(lockfd);
+    throw;
+  };
+}
+ConcurrentAppender::~ConcurrentAppender()
+{
+  try{
+    this->release();
+  }catch(...){};
+  if(fd>=0) close(fd);
+  if(lockfd>=0) close(lockfd);
+}
+long int ConcurrentAppender::read_next_offset()
+{
+  struct stat sb;
+  if(fstat(fd,&sb)!=0)
+    throw MsPASSError("ConcurrentAppender:  fstat failed on file "+fname
+      + "\nSystem error message:  " + strerror(errno),ErrorSeverity::Invalid);
+  /* A record left by a removed file of the same name is ignored */
+  long int next(0);
+  LockRecord r;
+  if(pread(lockfd,&r,sizeof(LockRecord),0)==sizeof(LockRecord)
+     && r.dev==static_cast<uint64_t>(sb.st_dev)
+     && r.ino==static_cast<uint64_t>(sb.st_ino))
+    next=static_cast<long int>(r.next);
+  /* Data written by other means (or before the lock file existed) are
+  protected by never handing out space below the current end of file */
+  return std::max(next,static_cast<long int>(sb.st_size));
+}
+void ConcurrentAppender::write_next_offset(const long int next)
+{
+  struct stat sb;
+  if(fstat(fd,&sb)!=0)
+    throw MsPASSError("ConcurrentAppender:  fstat failed on file "+fname
+      + "\nSystem error message:  " + strerror(errno),ErrorSeverity::Invalid);
+  LockRecord r;
+  r.next=next;
+  r.dev=static_cast<uint64_t>(sb.st_dev);
+  r.ino=static_cast<uint64_t>(sb.st_ino);
+  if(pwrite(lockfd,&r,sizeof(LockRecord),0)!=sizeof(LockRecord))
+    throw MsPASSError("ConcurrentAppender:  write failed on lock file for "+fname
+      + "\nSystem error message:  " + strerror(errno),ErrorSeverity::Invalid);
+}
+long int ConcurrentAppender::reserve(const size_t nbytes)
+{
+  const long int n=static_cast<long int>(nbytes);
+  /* Fast path:  take the range from the current extent with a CAS.  The
+  slow path changes cursor before it changes extent_end so a CAS that
+  succeeds always used a cursor value from the extent it tested against. */
+  long int c=cursor.load();
+  while(c+n<=extent_end.load())
+  {
+    if(cursor.compare_exchange_weak(c,c+n)) return c;
+  }
+  return this->reserve_extent(nbytes);
+}
+long int ConcurrentAppender::reserve_extent(const size_t nbytes)
+{
+  const long int n=static_cast<long int>(nbytes);
+  std::lock_guard<std::mutex> guard(extent_lock);
+  /* Another thread may have replaced the extent while we waited */
+  long int c=cursor.load();
+  while(c+n<=extent_end.load())
+  {
+    if(cursor.compare_exchange_weak(c,c+n)) return c;
+  }
+  /* Claim what is left of the extent.  Any fast path CAS now fails. */
+  long int cnow=cursor.exchange(CURSOR_BUSY);
+  long int eold=extent_end.load();
+  long int base,newend;
+  try{
+    LockFileGuard lock(lockfd,fname);
+    long int next=this->read_next_offset();
+    /* If nobody reserved space after our extent we can continue from
+    the cursor and not leave a hole */
+    if(next==eold && cnow<=eold)
+      base=cnow;
+    else
+      base=next;
+    newend=base+std::max(n,static_cast<long int>(extent_size));
+    this->write_next_offset(newend);
+  }catch(...)
+  {
+    cursor.store(cnow);
+    throw;
+  };
+  extent_end.store(newend);
+  cursor.store(base+n);
+  return base;
+}
+void ConcurrentAppender::release()
+{
+  std::lock_guard<std::mutex> guard(extent_lock);
+  long int cnow=cursor.exchange(CURSOR_BUSY);
+  long int eold=extent_end.load();
+  try{
+    if(cnow<eold)
+    {
+      LockFileGuard lock(lockfd,fname);
+      if(this->read_next_offset()==eold) this->write_next_offset(cnow);
+    }
+  }catch(...)
+  {
+    cursor.store(cnow);
+    throw;
+  };
+  /* Force the next reservation through the lock file */
+  extent_end.store(0);
+  cursor.store(0);
+}
+long int ConcurrentAppender::write_bytes(const char *buffer, const size_t nbytes)
+{
+  long int foff=this->reserve(nbytes);
+  const char *cptr=buffer;
+  size_t nleft=nbytes;
+  off_t pos=foff;
+  while(nleft>0)
+  {
+    ssize_t nw=pwrite(fd,cptr,nleft,pos);
+    if(nw<0)
+    {
+      if(errno==EINTR) continue;
+      throw MsPASSError("ConcurrentAppender::write_bytes:  write error while writing to file "
+        + fname + "\nSystem error message:  " + strerror(errno),
+        ErrorSeverity::Invalid);
+    }
+    cptr += nw;
+    pos += nw;
+    nleft -= nw;
+  }
+  return foff;
+}
+vector<long int> ConcurrentAppender::write_bytes(const vector<const char*>& blocks,
+  const vector<size_t>& sizes)
+{
+  if(blocks.size()!=sizes.size())
+    throw MsPASSError("ConcurrentAppender::write_bytes:  size mismatch of blocks and sizes vectors",
+      ErrorSeverity::Invalid);
+  size_t ntotal(0);
+  for(auto n : sizes) ntotal += n;
+  long int foff=this->reserve(ntotal);
+  vector<long int> foffs;
+  foffs.reserve(blocks.size());
+  vector<struct iovec> iov;
+  iov.reserve(blocks.size());
+  off_t pos=foff;
+  for(size_t i=0;i<blocks.size();++i)
+  {
+    foffs.push_back(static_cast<long int>(pos));
+    pos += sizes[i];
+    if(sizes[i]==0) continue;
+    struct iovec v;
+    v.iov_base=const_cast<char *>(blocks[i]);
+    v.iov_len=sizes[i];
+    iov.push_back(v);
+  }
+  /* Same loop as CachedFile::append_bytes but with pwritev */
+  size_t i0(0);
+  pos=foff;
+  while(i0<iov.size())
+  {
+    int niov=static_cast<int>(std::min(iov.size()-i0,static_cast<size_t>(IOV_MAX)));
+    ssize_t nw=pwritev(fd,&(iov[i0]),niov,pos);
+    if(nw<0)
+    {
+      if(errno==EINTR) continue;
+      throw MsPASSError("ConcurrentAppender::write_bytes:  pwritev error while writing to file "
+        + fname + "\nSystem error message:  " + strerror(errno),
+        ErrorSeverity::Invalid);
+    }
+    pos += nw;
+    size_t nleft=static_cast<size_t>(nw);
+    while(i0<iov.size() && nleft>=iov[i0].iov_len)
+    {
+      nleft -= iov[i0].iov_len;
+      ++i0;
+    }
+    if(nleft>0)
+    {
+      iov[i0].iov_base=static_cast<char *>(iov[i0].iov_base)+nleft;
+      iov[i0].iov_len -= nleft;
+    }
+  }
+  return foffs;
+}
+
+namespace {
+/* The registry is file scope state shared by the static methods */
+std::mutex registry_lock;
+std::map<std::string,std::shared_ptr<ConcurrentAppender>> registry;
+bool registry_enabled(false);
+size_t registry_extent_size(16777216);
+} // End anonymous namespace
+
+shared_ptr<ConcurrentAppender> ConcurrentAppender::get(const string fname)
+{
+  std::lock_guard<std::mutex> guard(registry_lock);
+  auto rptr=registry.find(fname);
+  if(rptr!=registry.end()) return rptr->second;
+  shared_ptr<ConcurrentAppender> result
+    =std::make_shared<ConcurrentAppender>(fname,registry_extent_size);
+  registry[fname]=result;
+  return result;
+}
+void ConcurrentAppender::set_enabled(const bool enable, const size_t extent_size)
+{
+  {
+    std::lock_guard<std::mutex> guard(registry_lock);
+    registry_enabled=enable;
+    registry_extent_size=extent_size;
+  }
+  if(!enable) ConcurrentAppender::close_all();
+}
+bool ConcurrentAppender::enabled()
+{
+  std::lock_guard<std::mutex> guard(registry_lock);
+  return registry_enabled;
+}
+void ConcurrentAppender::close_file(const string fname)
+{
+  shared_ptr<ConcurrentAppender> a;
+  {
+    std::lock_guard<std::mutex> guard(registry_lock);
+    auto rptr=registry.find(fname);
+    if(rptr==registry.end()) return;
+    a=rptr->second;
+    registry.erase(rptr);
+  }
+  /* The file is released when the last user drops its reference */
+  a->release();
+}
+void ConcurrentAppender::close_all()
+{
+  std::map<std::string,std::shared_ptr<ConcurrentAppender>> old;
+  {
+    std::lock_guard<std::mutex> guard(registry_lock);
+    old.swap(registry);
+  }
+  for(auto& a : old) a.second->release();
+}
+void ConcurrentAppender::remove_lock_file(const string fname)
+{
+  ConcurrentAppender::close_file(fname);
+  const string lname=lock_file_name(fname);
+  if(unlink(lname.c_str())!=0 && errno!=ENOENT)
+    throw MsPASSError("ConcurrentAppender::remove_lock_file:  unlink failed on "
+      + lname + "\nSystem error message:  " + strerror(errno),
+      ErrorSeverity::Invalid);
+}
+} // End namespace mspass::io
@@ -0,0 +1,598 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <list>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/seismic/keywords.h"
+#include "mspass/io/ReadPlanner.h"
+#include "mspass/io/ContainerFile.h"
+#include "mspass/io/fileio.h"
+namespace mspass::io
+{
+using namespace std;
+using namespace mspass::seismic;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+/* A container file begins with a 16 byte header (HEADER_MAGIC followed
+by the uint32 version and 4 unused bytes) and ends with a 32 byte trailer:
+  uint64 byte offset of the index
+  uint64 number of index entries
+  uint32 CRC32 of the index
+  uint32 version
+  8 byte TRAILER_MAGIC
+Each index entry is a uint16 length and the bytes of the id followed by
+fixed size fields in the order they are packed in pack_entry.  All values
+are stored in host byte order like the native sample data files.*/
+const char HEADER_MAGIC[8]={'M','S','P','C','N','T','N','R'};
+const char TRAILER_MAGIC[8]={'M','S','P','C','I','N','D','X'};
+const uint32_t CONTAINER_VERSION(1);
+const size_t CONTAINER_HEADER_SIZE(16);
+const size_t CONTAINER_TRAILER_SIZE(32);
+/* Size of an index entry with an empty id */
+const size_t CONTAINER_MIN_ENTRY_SIZE(57);
+
+uint32_t crc32_checksum(const char *buffer, const size_t nbytes, const uint32_t crc)
+{
+  /* Function scope static initialization is thread safe */
+  static const vector<uint32_t> table=[]{
+    vector<uint32_t> t(256);
+    for(uint32_t i=0;i<256;++i)
+    {
+      uint32_t c=i;
+      for(int k=0;k<8;++k)
+        c = (c&1) ? (0xEDB88320U^(c>>1)) : (c>>1);
+      t[i]=c;
+    }
+    return t;
+  }();
+  uint32_t c=crc^0xFFFFFFFFU;
+  const unsigned char *p=reinterpret_cast<const unsigned char*>(buffer);
+  for(size_t i=0;i<nbytes;++i)
+    c=table[(c^p[i])&0xFF]^(c>>8);
+  return c^0xFFFFFFFFU;
+}
+namespace {
+/* File scope functions to pack and unpack the index */
+template <typename T> void pack_value(vector<char>& buf, const T val)
+{
+  size_t pos=buf.size();
+  buf.resize(pos+sizeof(T));
+  memcpy(&(buf[pos]),&val,sizeof(T));
+}
+template <typename T> bool unpack_value(const char *& p, const char *end, T& val)
+{
+  if(static_cast<size_t>(end-p)<sizeof(T)) return false;
+  memcpy(&val,p,sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+void pack_entry(vector<char>& buf, const ContainerIndexEntry& e)
+{
+  pack_value<uint16_t>(buf,static_cast<uint16_t>(e.id.size()));
+  buf.insert(buf.end(),e.id.begin(),e.id.end());
+  pack_value<int64_t>(buf,e.foff);
+  pack_value<int64_t>(buf,e.nbytes);
+  pack_value<uint64_t>(buf,e.npts);
+  pack_value<uint8_t>(buf,static_cast<uint8_t>(e.dtype));
+  pack_value<uint8_t>(buf,static_cast<uint8_t>(e.encoding));
+  pack_value<uint8_t>(buf,e.utc ? 1 : 0);
+  pack_value<double>(buf,e.scale);
+  pack_value<double>(buf,e.t0);
+  pack_value<double>(buf,e.dt);
+  pack_value<uint32_t>(buf,e.checksum);
+}
+bool unpack_entry(const char *& p, const char *end, ContainerIndexEntry& e)
+{
+  uint16_t idlen;
+  int64_t i64;
+  uint64_t u64;
+  uint8_t dtype,enc,utc;
+  if(!unpack_value(p,end,idlen)) return false;
+  if(static_cast<size_t>(end-p)<idlen) return false;
+  e.id.assign(p,idlen);
+  p += idlen;
+  if(!unpack_value(p,end,i64)) return false;
+  e.foff=i64;
+  if(!unpack_value(p,end,i64)) return false;
+  e.nbytes=i64;
+  if(!unpack_value(p,end,u64)) return false;
+  e.npts=u64;
+  if(!(unpack_value(p,end,dtype) && unpack_value(p,end,enc)
+     && unpack_value(p,end,utc))) return false;
+  if(dtype>static_cast<uint8_t>(ContainerDataType::seismogram)) return false;
+  if(enc>static_cast<uint8_t>(SampleEncoding::delta)) return false;
+  e.dtype=static_cast<ContainerDataType>(dtype);
+  e.encoding=static_cast<SampleEncoding>(enc);
+  e.utc=(utc!=0);
+  return unpack_value(p,end,e.scale) && unpack_value(p,end,e.t0)
+     && unpack_value(p,end,e.dt) && unpack_value(p,end,e.checksum);
+}
+/* pwrite all of a buffer handling partial writes */
+void container_pwrite(const int fd, const char *buf, size_t nbytes, long int foff,
+  const string fname)
+{
+  while(nbytes>0)
+  {
+    ssize_t n=pwrite(fd,buf,nbytes,foff);
+    if(n<0)
+    {
+      if(errno==EINTR) continue;
+      throw MsPASSError(string("ContainerWriter:  write failed on file ")+fname
+        +"\nSystem error message:  "+strerror(errno),ErrorSeverity::Invalid);
+    }
+    buf += n;
+    nbytes -= n;
+    foff += n;
+  }
+}
+} // End anonymous namespace
+namespace {
+/* Load the index defined by a trailer starting at byte offset tpos.
+Returns false if there is no trailer there, if it is from a newer
+version, or if the index it defines is not valid. */
+bool load_container_index(const CachedFile& fh, const size_t tpos,
+  vector<ContainerIndexEntry>& index, long int& index_foff)
+{
+  char trailer[CONTAINER_TRAILER_SIZE];
+  if(fh.read_bytes(trailer,tpos,CONTAINER_TRAILER_SIZE)!=CONTAINER_TRAILER_SIZE
+     || memcmp(trailer+24,TRAILER_MAGIC,8)!=0)
+    return false;
+  uint64_t ifoff,nentries;
+  uint32_t crc,version;
+  memcpy(&ifoff,trailer,sizeof(uint64_t));
+  memcpy(&nentries,trailer+8,sizeof(uint64_t));
+  memcpy(&crc,trailer+16,sizeof(uint32_t));
+  memcpy(&version,trailer+20,sizeof(uint32_t));
+  if(version>CONTAINER_VERSION) return false;
+  if(ifoff<CONTAINER_HEADER_SIZE || ifoff>tpos) return false;
+  size_t isize=tpos-ifoff;
+  vector<char> buf(isize);
+  if(fh.read_bytes(buf.data(),ifoff,isize)!=isize
+     || crc32_checksum(buf.data(),isize)!=crc)
+    return false;
+  index.clear();
+  /* nentries is not trusted until the entries are unpacked */
+  index.reserve(std::min(nentries,static_cast<uint64_t>(isize/CONTAINER_MIN_ENTRY_SIZE)));
+  const char *p=buf.data();
+  const char *end=p+isize;
+  for(uint64_t i=0;i<nentries;++i)
+  {
+    ContainerIndexEntry e;
+    if(!unpack_entry(p,end,e)) return false;
+    index.push_back(e);
+  }
+  index_foff=ifoff;
+  return true;
+}
+/* Size of the blocks read when searching for the last good trailer */
+const size_t CONTAINER_SCAN_SIZE(1048576);
+} // End anonymous namespace
+vector<ContainerIndexEntry> read_container_index(const CachedFile& fh, long int& index_foff)
+{
+  struct stat sb;
+  if(fstat(fh.descriptor(),&sb)!=0)
+    throw MsPASSError("read_container_index:  fstat failed on file "+fh.name(),
+      ErrorSeverity::Invalid);
+  const size_t fsize=sb.st_size;
+  if(fsize<CONTAINER_HEADER_SIZE+CONTAINER_TRAILER_SIZE)
+    throw MsPASSError("read_container_index:  file "+fh.name()
+      +" is too small to be a container file",ErrorSeverity::Invalid);
+  vector<ContainerIndexEntry> index;
+  char trailer[CONTAINER_TRAILER_SIZE];
+  if(fh.read_bytes(trailer,fsize-CONTAINER_TRAILER_SIZE,CONTAINER_TRAILER_SIZE)
+        ==CONTAINER_TRAILER_SIZE
+     && memcmp(trailer+24,TRAILER_MAGIC,8)==0)
+  {
+    uint32_t version;
+    memcpy(&version,trailer+20,sizeof(uint32_t));
+    if(version>CONTAINER_VERSION)
+    {
+      stringstream ss;
+      ss << "read_container_index:  file "<<fh.name()<<" has container version "
+         << version<<" which is newer than this reader (version "
+         << CONTAINER_VERSION<<")";
+      throw MsPASSError(ss.str(),ErrorSeverity::Invalid);
+    }
+    if(load_container_index(fh,fsize-CONTAINER_TRAILER_SIZE,index,index_foff))
+      return index;
+    throw MsPASSError("read_container_index:  index is corrupted in file "
+      +fh.name(),ErrorSeverity::Invalid);
+  }
+  /* A writer appending to the file was not closed.  The blocks it wrote
+  follow the last index written by close, so search backward for the
+  last trailer that defines a valid index.  Blocks overlap by 7 bytes
+  so a trailer split between two blocks is found. */
+  const size_t lo_limit=CONTAINER_HEADER_SIZE+24;
+  size_t hi=fsize;
+  vector<char> buf;
+  while(hi>=lo_limit+8)
+  {
+    size_t lo = (hi-lo_limit>CONTAINER_SCAN_SIZE) ? hi-CONTAINER_SCAN_SIZE : lo_limit;
+    buf.resize(hi-lo);
+    if(fh.read_bytes(buf.data(),lo,hi-lo)!=hi-lo) break;
+    /* m is the offset of a possible TRAILER_MAGIC, last one first */
+    for(size_t m=hi-7;m-- > lo;)
+    {
+      if(memcmp(&(buf[m-lo]),TRAILER_MAGIC,8)==0
+         && load_container_index(fh,m-24,index,index_foff))
+        return index;
+    }
+    if(lo==lo_limit) break;
+    hi=lo+7;
+  }
+  throw MsPASSError("read_container_index:  file "+fh.name()
+    +" is not a container file or was not closed properly",ErrorSeverity::Invalid);
+}
+
+ContainerWriter::ContainerWriter(const string dir, const string dfile, const bool append)
+  : fname(build_fname(dir,dfile)),fd(-1),eof(0)
+{
+  int flags=O_RDWR|O_CREAT;
+  if(!append) flags |= O_TRUNC;
+  fd=open(fname.c_str(),flags,0644);
+  if(fd<0)
+    throw MsPASSError(string("ContainerWriter:  open failed on file ")+fname
+      +"\nSystem error message:  "+strerror(errno),ErrorSeverity::Invalid);
+  struct stat sb;
+  fstat(fd,&sb);
+  if(sb.st_size>0)
+  {
+    /* New blocks go after the old index and trailer.  The old index
+    stays valid until close writes the new one after the new blocks. */
+    try{
+      CachedFile fh(fname,false);
+      long int old_index_foff;
+      index=read_container_index(fh,old_index_foff);
+      eof=sb.st_size;
+    }catch(...)
+    {
+      ::close(fd);
+      fd=-1;
+      throw;
+    };
+  }
+  else
+  {
+    char header[CONTAINER_HEADER_SIZE];
+    memset(header,0,CONTAINER_HEADER_SIZE);
+    memcpy(header,HEADER_MAGIC,8);
+    memcpy(header+8,&CONTAINER_VERSION,sizeof(uint32_t));
+    try{
+      container_pwrite(fd,header,CONTAINER_HEADER_SIZE,0,fname);
+    }catch(...)
+    {
+      ::close(fd);
+      fd=-1;
+      throw;
+    };
+    eof=CONTAINER_HEADER_SIZE;
+  }
+}
+ContainerWriter::~ContainerWriter()
+{
+  try{
+    this->close();
+  }catch(...){};
+}
+long int ContainerWriter::write_block(const double *d, const size_t nd,
+  ContainerIndexEntry& entry)
+{
+  if(fd<0)
+    throw MsPASSError("ContainerWriter::write:  file "+fname+" was already closed",
+      ErrorSeverity::Invalid);
+  if(entry.id.size()>std::numeric_limits<uint16_t>::max())
+    throw MsPASSError("ContainerWriter::write:  id "+entry.id.substr(0,64)
+      +"... is too long.  The index limit is 65535 bytes",ErrorSeverity::Invalid);
+  double scale(0.0);
+  vector<char> buf=encode_samples(d,nd,entry.encoding,scale);
+  entry.scale = (entry.encoding==SampleEncoding::int32) ? scale : 1.0;
+  entry.foff=eof;
+  entry.nbytes=buf.size();
+  entry.checksum=crc32_checksum(buf.data(),buf.size());
+  container_pwrite(fd,buf.data(),buf.size(),eof,fname);
+  eof += buf.size();
+  index.push_back(entry);
+  return index.size()-1;
+}
+long int ContainerWriter::write(const TimeSeries& d, const SampleEncoding enc,
+  const string id)
+{
+  if(d.dead()) return -1;
+  ContainerIndexEntry entry;
+  entry.id = id.empty() ? d.id() : id;
+  entry.npts=d.npts();
+  entry.dtype=ContainerDataType::timeseries;
+  entry.encoding=enc;
+  entry.t0=d.t0();
+  entry.dt=d.dt();
+  entry.utc=d.time_is_UTC();
+  try{
+    return this->write_block(d.s.data(),d.npts(),entry);
+  }catch(...){throw;};
+}
+long int ContainerWriter::write(const Seismogram& d, const SampleEncoding enc,
+  const string id)
+{
+  if(d.dead()) return -1;
+  ContainerIndexEntry entry;
+  entry.id = id.empty() ? d.id() : id;
+  entry.npts=d.npts();
+  entry.dtype=ContainerDataType::seismogram;
+  entry.encoding=enc;
+  entry.t0=d.t0();
+  entry.dt=d.dt();
+  entry.utc=d.time_is_UTC();
+  try{
+    /* dmatrix is stored in fortran order so this is the same layout
+    as fwrite_to_file */
+    const double *dptr = (d.npts()>0) ? d.u.get_address(0,0) : NULL;
+    return this->write_block(dptr,3*d.npts(),entry);
+  }catch(...){throw;};
+}
+vector<long int> ContainerWriter::write(const LoggingEnsemble<TimeSeries>& d,
+  const SampleEncoding enc)
+{
+  vector<long int> result;
+  result.reserve(d.member.size());
+  for(auto& m : d.member)
+  {
+    try{
+      result.push_back(this->write(m,enc));
+    }catch(...){throw;};
+  }
+  return result;
+}
+vector<long int> ContainerWriter::write(const LoggingEnsemble<Seismogram>& d,
+  const SampleEncoding enc)
+{
+  vector<long int> result;
+  result.reserve(d.member.size());
+  for(auto& m : d.member)
+  {
+    try{
+      result.push_back(this->write(m,enc));
+    }catch(...){throw;};
+  }
+  return result;
+}
+void ContainerWriter::close()
+{
+  if(fd<0) return;
+  vector<char> buf;
+  for(auto& e : index) pack_entry(buf,e);
+  char trailer[CONTAINER_TRAILER_SIZE];
+  uint64_t ifoff=eof;
+  uint64_t nentries=index.size();
+  uint32_t crc=crc32_checksum(buf.data(),buf.size());
+  memcpy(trailer,&ifoff,sizeof(uint64_t));
+  memcpy(trailer+8,&nentries,sizeof(uint64_t));
+  memcpy(trailer+16,&crc,sizeof(uint32_t));
+  memcpy(trailer+20,&CONTAINER_VERSION,sizeof(uint32_t));
+  memcpy(trailer+24,TRAILER_MAGIC,8);
+  buf.insert(buf.end(),trailer,trailer+CONTAINER_TRAILER_SIZE);
+  int fdsave=fd;
+  fd=-1;
+  try{
+    container_pwrite(fdsave,buf.data(),buf.size(),eof,fname);
+  }catch(...)
+  {
+    ::close(fdsave);
+    throw;
+  };
+  ::close(fdsave);
+}
+
+namespace {
+/* File scope functions used by the reader to build a datum from an
+index entry and the block of bytes read from the file */
+double *container_samples(TimeSeries& d)
+{
+  return d.s.data();
+}
+double *container_samples(Seismogram& d)
+{
+  return (d.npts()>0) ? d.u.get_address(0,0) : NULL;
+}
+size_t container_nsamples(const TimeSeries& d){return d.npts();}
+size_t container_nsamples(const Seismogram& d){return 3*d.npts();}
+template <typename Tdata> Tdata container_datum(const ContainerIndexEntry& e,
+  const string dir, const string dfile)
+{
+  Tdata d(e.npts);
+  d.set_dt(e.dt);
+  d.set_t0(e.t0);
+  d.set_tref(e.utc ? TimeReferenceType::UTC : TimeReferenceType::Relative);
+  d.set_id(e.id);
+  d.put_string(SEISMICMD_dir,dir);
+  d.put_string(SEISMICMD_dfile,dfile);
+  d.put_long(SEISMICMD_foff,e.foff);
+  set_sample_encoding(d,e.encoding,e.scale,e.nbytes);
+  return d;
+}
+/* Verify and decode a block.  Returns an empty string on success and
+an error message otherwise. */
+template <typename Tdata> string container_decode(Tdata& d,
+  const ContainerIndexEntry& e, const char *buf, const size_t nread,
+  const string fname)
+{
+  if(nread!=static_cast<size_t>(e.nbytes))
+    return string("short read for id=")+e.id+" in file "+fname;
+  if(crc32_checksum(buf,nread)!=e.checksum)
+    return string("checksum mismatch for id=")+e.id+" in file "+fname;
+  size_t n=container_nsamples(d);
+  if(n==0) return string();
+  if(decode_samples(buf,nread,e.encoding,e.scale,container_samples(d),n)!=n)
+    return string("decoding failed for id=")+e.id+" in file "+fname;
+  return string();
+}
+template <typename Tdata> LoggingEnsemble<Tdata> container_read_ensemble(
+  const vector<ContainerIndexEntry>& index, const vector<size_t>& which,
+  const ContainerDataType dtype, const string dir, const string dfile,
+  const string caller)
+{
+  const string fname=build_fname(dir,dfile);
+  LoggingEnsemble<Tdata> ens(which.size());
+  for(auto i : which)
+  {
+    if(i>=index.size())
+      throw MsPASSError(caller+":  entry number is outside the index of file "+fname,
+        ErrorSeverity::Invalid);
+    if(index[i].dtype!=dtype)
+      throw MsPASSError(caller+":  entry "+index[i].id+" of file "+fname
+        +" is the wrong data type",ErrorSeverity::Invalid);
+    ens.member.push_back(container_datum<Tdata>(index[i],dir,dfile));
+  }
+  shared_ptr<CachedFile> fh;
+  try{
+    fh=FileHandleCache::instance().get(fname,false);
+  }catch(MsPASSError& err)
+  {
+    throw MsPASSError(caller+":  open failed on file "+fname,ErrorSeverity::Invalid);
+  }
+  /* All blocks are read with one plan.  A container written in one
+  pass is contiguous so this is normally one system call. */
+  ReadPlanner plan;
+  list<vector<char>> buffers;
+  vector<char*> bptr;
+  for(auto i : which)
+  {
+    buffers.push_back(vector<char>(index[i].nbytes));
+    bptr.push_back(buffers.back().data());
+    plan.add_bytes(buffers.back().data(),index[i].foff,index[i].nbytes);
+  }
+  vector<size_t> nread=plan.execute(*fh);
+  for(size_t k=0;k<which.size();++k)
+  {
+    string message=container_decode(ens.member[k],index[which[k]],bptr[k],
+      nread[k],fname);
+    if(message.empty())
+      ens.member[k].set_live();
+    else
+    {
+      ens.member[k].elog.log_error(caller,message,ErrorSeverity::Invalid);
+      ens.member[k].kill();
+    }
+  }
+  ens.set_live();
+  return ens;
+}
+template <typename Tdata> Tdata container_read_datum(
+  const vector<ContainerIndexEntry>& index, const size_t i,
+  const ContainerDataType dtype, const string dir, const string dfile,
+  const string caller)
+{
+  const string fname=build_fname(dir,dfile);
+  if(i>=index.size())
+    throw MsPASSError(caller+":  entry number is outside the index of file "+fname,
+      ErrorSeverity::Invalid);
+  const ContainerIndexEntry& e=index[i];
+  if(e.dtype!=dtype)
+    throw MsPASSError(caller+":  entry "+e.id+" of file "+fname
+      +" is the wrong data type",ErrorSeverity::Invalid);
+  Tdata d=container_datum<Tdata>(e,dir,dfile);
+  shared_ptr<CachedFile> fh;
+  try{
+    fh=FileHandleCache::instance().get(fname,false);
+  }catch(MsPASSError& err)
+  {
+    throw MsPASSError(caller+":  open failed on file "+fname,ErrorSeverity::Invalid);
+  }
+  vector<char> buf(e.nbytes);
+  size_t nread=fh->read_bytes(buf.data(),e.foff,e.nbytes);
+  string message=container_decode(d,e,buf.data(),nread,fname);
+  if(!message.empty())
+    throw MsPASSError(caller+":  "+message,ErrorSeverity::Invalid);
+  d.set_live();
+  return d;
+}
+} // End anonymous namespace
+
+ContainerReader::ContainerReader(const string dirin, const string dfilein)
+  : dir(dirin),dfile(dfilein)
+{
+  const string fname=build_fname(dir,dfile);
+  shared_ptr<CachedFile> fh;
+  try{
+    fh=FileHandleCache::instance().get(fname,false);
+  }catch(MsPASSError& err)
+  {
+    throw MsPASSError("ContainerReader:  open failed on file "+fname,
+      ErrorSeverity::Invalid);
+  }
+  long int ifoff;
+  try{
+    index=read_container_index(*fh,ifoff);
+  }catch(...){throw;};
+  for(size_t i=0;i<index.size();++i)
+    idmap.insert(pair<string,size_t>(index[i].id,i));
+}
+const ContainerIndexEntry& ContainerReader::entry(const size_t i) const
+{
+  if(i>=index.size())
+  {
+    stringstream ss;
+    ss << "ContainerReader::entry:  requested entry "<<i
+       << " is outside the range of the index of size "<<index.size();
+    throw MsPASSError(ss.str(),ErrorSeverity::Invalid);
+  }
+  return index[i];
+}
+long int ContainerReader::find(const string id) const
+{
+  /* std::map::insert does not replace existing keys so this is the
+  first entry with this id */
+  auto iptr=idmap.find(id);
+  if(iptr==idmap.end()) return -1;
+  return iptr->second;
+}
+TimeSeries ContainerReader::read_TimeSeries(const size_t i) const
+{
+  try{
+    return container_read_datum<TimeSeries>(index,i,ContainerDataType::timeseries,
+      dir,dfile,"ContainerReader::read_TimeSeries");
+  }catch(...){throw;};
+}
+Seismogram ContainerReader::read_Seismogram(const size_t i) const
+{
+  try{
+    return container_read_datum<Seismogram>(index,i,ContainerDataType::seismogram,
+      dir,dfile,"ContainerReader::read_Seismogram");
+  }catch(...){throw;};
+}
+LoggingEnsemble<TimeSeries> ContainerReader::read_TimeSeriesEnsemble() const
+{
+  vector<size_t> which;
+  for(size_t i=0;i<index.size();++i)
+    if(index[i].dtype==ContainerDataType::timeseries) which.push_back(i);
+  return this->read_TimeSeriesEnsemble(which);
+}
+LoggingEnsemble<TimeSeries> ContainerReader::read_TimeSeriesEnsemble(
+  const vector<size_t>& which) const
+{
+  try{
+    return container_read_ensemble<TimeSeries>(index,which,
+      ContainerDataType::timeseries,dir,dfile,"ContainerReader::read_TimeSeriesEnsemble");
+  }catch(...){throw;};
+}
+LoggingEnsemble<Seismogram> ContainerReader::read_SeismogramEnsemble() const
+{
+  vector<size_t> which;
+  for(size_t i=0;i<index.size();++i)
+    if(index[i].dtype==ContainerDataType::seismogram) which.push_back(i);
+  return this->read_SeismogramEnsemble(which);
+}
+LoggingEnsemble<Seismogram> ContainerReader::read_SeismogramEnsemble(
+  const vector<size_t>& which) const
+{
+  try{
+    return container_read_ensemble<Seismogram>(index,which,
+      ContainerDataType::seismogram,dir,dfile,"ContainerReader::read_SeismogramEnsemble");
+  }catch(...){throw;};
+}
+} // End namespace mspass::io
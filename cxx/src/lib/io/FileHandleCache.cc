@@ -0,0 +1,268 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <sstream>
+#include <algorithm>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/io/FileHandleCache.h"
+namespace mspass::io
+{
+using namespace std;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+CachedFile::CachedFile(const string name, const bool writable)
+  : write_mode(writable),fname(name)
+{
+  if(writable)
+    /* Same semantics as fopen with "a" */
+    fd=open(fname.c_str(),O_WRONLY|O_CREAT|O_APPEND,0666);
+  else
+    fd=open(fname.c_str(),O_RDONLY);
+  if(fd<0)
+    throw MsPASSError("CachedFile constructor:  Open failed on file "
+      + fname + "\nSystem error message:  " + strerror(errno),
+      ErrorSeverity::Invalid);
+}
+CachedFile::~CachedFile()
+{
+  if(fd>=0) close(fd);
+}
+long int CachedFile::append(const double *dptr, const size_t nd)
+{
+  return this->append_bytes(reinterpret_cast<const char *>(dptr),nd*sizeof(double));
+}
+long int CachedFile::append_bytes(const char *buffer, const size_t nbytes)
+{
+  if(!write_mode)
+    throw MsPASSError("CachedFile::append:  file "+fname+" was not opened for writing",
+      ErrorSeverity::Invalid);
+  /* The lock guarantees the offset we compute is where this block
+  lands when all threads in this process share this handle. */
+  std::lock_guard<std::mutex> guard(append_lock);
+  off_t foff=lseek(fd,0,SEEK_END);
+  if(foff<0)
+    throw MsPASSError("CachedFile::append:  lseek failed on file "+fname,
+      ErrorSeverity::Invalid);
+  const char *cptr=buffer;
+  size_t nleft=nbytes;
+  while(nleft>0)
+  {
+    ssize_t nw=write(fd,cptr,nleft);
+    if(nw<0)
+    {
+      if(errno==EINTR) continue;
+      throw MsPASSError("CachedFile::append:  write error while writing to file "
+        + fname + "\nSystem error message:  " + strerror(errno),
+        ErrorSeverity::Invalid);
+    }
+    cptr += nw;
+    nleft -= nw;
+  }
+  return static_cast<long int>(foff);
+}
+vector<long int> CachedFile::append(const vector<const double*>& blocks,
+  const vector<size_t>& sizes)
+{
+  if(blocks.size()!=sizes.size())
+    throw MsPASSError("CachedFile::append:  size mismatch of blocks and sizes vectors",
+      ErrorSeverity::Invalid);
+  vector<const char*> cblocks;
+  vector<size_t> nbytes;
+  cblocks.reserve(blocks.size());
+  nbytes.reserve(sizes.size());
+  for(size_t i=0;i<blocks.size();++i)
+  {
+    cblocks.push_back(reinterpret_cast<const char *>(blocks[i]));
+    nbytes.push_back(sizes[i]*sizeof(double));
+  }
+  return this->append_bytes(cblocks,nbytes);
+}
+vector<long int> CachedFile::append_bytes(const vector<const char*>& blocks,
+  const vector<size_t>& sizes)
+{
+  if(!write_mode)
+    throw MsPASSError("CachedFile::append:  file "+fname+" was not opened for writing",
+      ErrorSeverity::Invalid);
+  if(blocks.size()!=sizes.size())
+    throw MsPASSError("CachedFile::append:  size mismatch of blocks and sizes vectors",
+      ErrorSeverity::Invalid);
+  vector<long int> foffs;
+  foffs.reserve(blocks.size());
+  vector<struct iovec> iov;
+  iov.reserve(blocks.size());
+  std::lock_guard<std::mutex> guard(append_lock);
+  off_t foff=lseek(fd,0,SEEK_END);
+  if(foff<0)
+    throw MsPASSError("CachedFile::append:  lseek failed on file "+fname,
+      ErrorSeverity::Invalid);
+  for(size_t i=0;i<blocks.size();++i)
+  {
+    foffs.push_back(static_cast<long int>(foff));
+    size_t nb=sizes[i];
+    foff += nb;
+    if(nb==0) continue;
+    struct iovec v;
+    v.iov_base=const_cast<char *>(blocks[i]);
+    v.iov_len=nb;
+    iov.push_back(v);
+  }
+  /* writev can return a short count and is limited to IOV_MAX
+  entries per call so we have to loop */
+  size_t i0(0);
+  while(i0<iov.size())
+  {
+    int niov=static_cast<int>(std::min(iov.size()-i0,static_cast<size_t>(IOV_MAX)));
+    ssize_t nw=writev(fd,&(iov[i0]),niov);
+    if(nw<0)
+    {
+      if(errno==EINTR) continue;
+      throw MsPASSError("CachedFile::append:  writev error while writing to file "
+        + fname + "\nSystem error message:  " + strerror(errno),
+        ErrorSeverity::Invalid);
+    }
+    size_t nleft=static_cast<size_t>(nw);
+    while(i0<iov.size() && nleft>=iov[i0].iov_len)
+    {
+      nleft -= iov[i0].iov_len;
+      ++i0;
+    }
+    if(nleft>0)
+    {
+      iov[i0].iov_base=static_cast<char *>(iov[i0].iov_base)+nleft;
+      iov[i0].iov_len -= nleft;
+    }
+  }
+  return foffs;
+}
+size_t CachedFile::read(double *buffer, const long int foff, const size_t nd) const
+{
+  return this->read_bytes(reinterpret_cast<char *>(buffer),foff,nd*sizeof(double))
+    / sizeof(double);
+}
+size_t CachedFile::read_bytes(char *buffer, const long int foff, const size_t nbytes) const
+{
+  char *cptr=buffer;
+  size_t nleft=nbytes;
+  off_t pos=foff;
+  size_t nbytes_read(0);
+  while(nleft>0)
+  {
+    ssize_t nr=pread(fd,cptr,nleft,pos);
+    if(nr<0)
+    {
+      if(errno==EINTR) continue;
+      break;
+    }
+    /* end of file */
+    if(nr==0) break;
+    cptr += nr;
+    pos += nr;
+    nleft -= nr;
+    nbytes_read += nr;
+  }
+  return nbytes_read;
+}
+void CachedFile::advise_willneed(const long int foff, const size_t nbytes) const
+{
+  /* Only a hint so errors are ignored */
+  posix_fadvise(fd,foff,nbytes,POSIX_FADV_WILLNEED);
+}
+void CachedFile::flush()
+{
+  if(write_mode) fdatasync(fd);
+}
+
+FileHandleCache& FileHandleCache::instance()
+{
+  /* C++11 guarantees thread safe initialization of a function static*/
+  static FileHandleCache cache;
+  return cache;
+}
+shared_ptr<CachedFile> FileHandleCache::get(const string fname, const bool writable)
+{
+  CacheKey key(fname,writable);
+  {
+    std::lock_guard<std::mutex> guard(cache_lock);
+    auto iptr=index.find(key);
+    if(iptr!=index.end())
+    {
+      /* move to the front of the list - most recently used*/
+      lru.splice(lru.begin(),lru,iptr->second);
+      return iptr->second->second;
+    }
+    if(maxsize==0)
+      /* Caching disabled - descriptor is closed when the caller releases it*/
+      return make_shared<CachedFile>(fname,writable);
+  }
+  /* Open outside the lock so a slow open does not block other threads.
+  The cost is a second thread may open the same file.  We handle that
+  below by keeping whichever got into the cache first. */
+  shared_ptr<CachedFile> handle=make_shared<CachedFile>(fname,writable);
+  std::lock_guard<std::mutex> guard(cache_lock);
+  auto iptr=index.find(key);
+  if(iptr!=index.end())
+  {
+    lru.splice(lru.begin(),lru,iptr->second);
+    return iptr->second->second;
+  }
+  if(maxsize==0) return handle;
+  lru.push_front(make_pair(key,handle));
+  index[key]=lru.begin();
+  this->trim();
+  return handle;
+}
+/* Private method - caller must hold cache_lock */
+void FileHandleCache::trim()
+{
+  while(lru.size()>maxsize)
+  {
+    index.erase(lru.back().first);
+    lru.pop_back();
+  }
+}
+void FileHandleCache::set_size(const size_t n)
+{
+  std::lock_guard<std::mutex> guard(cache_lock);
+  maxsize=n;
+  this->trim();
+}
+size_t FileHandleCache::max_size() const
+{
+  std::lock_guard<std::mutex> guard(cache_lock);
+  return maxsize;
+}
+size_t FileHandleCache::size() const
+{
+  std::lock_guard<std::mutex> guard(cache_lock);
+  return lru.size();
+}
+void FileHandleCache::flush()
+{
+  std::lock_guard<std::mutex> guard(cache_lock);
+  for(auto& entry : lru)
+    entry.second->flush();
+}
+void FileHandleCache::close_file(const string fname)
+{
+  std::lock_guard<std::mutex> guard(cache_lock);
+  for(const bool mode : {false,true})
+  {
+    auto iptr=index.find(CacheKey(fname,mode));
+    if(iptr!=index.end())
+    {
+      lru.erase(iptr->second);
+      index.erase(iptr);
+    }
+  }
+}
+void FileHandleCache::close_all()
+{
+  std::lock_guard<std::mutex> guard(cache_lock);
+  index.clear();
+  lru.clear();
+}
+} // End namespace mspass::io
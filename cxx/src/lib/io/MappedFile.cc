@@ -0,0 +1,136 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/io/MappedFile.h"
+namespace mspass::io
+{
+using namespace std;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+MappedFile::MappedFile(const string name) : fname(name),base(NULL),length(0)
+{
+  int fd=open(fname.c_str(),O_RDONLY);
+  if(fd<0)
+    throw MsPASSError("MappedFile constructor:  Open failed on file "
+      + fname + "\nSystem error message:  " + strerror(errno),
+      ErrorSeverity::Invalid);
+  struct stat sbuf;
+  if(fstat(fd,&sbuf))
+  {
+    close(fd);
+    throw MsPASSError("MappedFile constructor:  fstat failed on file "+fname,
+      ErrorSeverity::Invalid);
+  }
+  device=sbuf.st_dev;
+  inode=sbuf.st_ino;
+  mtime=sbuf.st_mtim;
+  length=static_cast<size_t>(sbuf.st_size);
+  /* mmap does not allow a zero length mapping.  An empty file is legal
+  but any request for samples will fail the range test. */
+  if(length>0)
+  {
+    void *addr=mmap(NULL,length,PROT_READ,MAP_SHARED,fd,0);
+    if(addr==MAP_FAILED)
+    {
+      close(fd);
+      throw MsPASSError("MappedFile constructor:  mmap failed on file "
+        + fname + "\nSystem error message:  " + strerror(errno),
+        ErrorSeverity::Invalid);
+    }
+    base=static_cast<char *>(addr);
+  }
+  /* The mapping remains valid after the descriptor is closed */
+  close(fd);
+}
+MappedFile::~MappedFile()
+{
+  if(base!=NULL) munmap(base,length);
+}
+bool MappedFile::is_current(const struct stat& sbuf) const
+{
+  return (sbuf.st_dev==device) && (sbuf.st_ino==inode)
+    && (static_cast<size_t>(sbuf.st_size)==length)
+    && (sbuf.st_mtim.tv_sec==mtime.tv_sec)
+    && (sbuf.st_mtim.tv_nsec==mtime.tv_nsec);
+}
+shared_ptr<MappedFile> MappedFile::get(const string fname)
+{
+  /* Registry of mappings in use.  weak_ptr is used so an entry does not
+  keep a mapping alive after all users release it. */
+  static std::mutex registry_lock;
+  static map<string,weak_ptr<MappedFile>> registry;
+  struct stat sbuf;
+  bool have_stat=(stat(fname.c_str(),&sbuf)==0);
+  {
+    std::lock_guard<std::mutex> guard(registry_lock);
+    auto rptr=registry.find(fname);
+    if(rptr!=registry.end())
+    {
+      shared_ptr<MappedFile> mf=rptr->second.lock();
+      if(mf && have_stat && mf->is_current(sbuf)) return mf;
+      registry.erase(rptr);
+    }
+  }
+  /* Map outside the lock.  If two threads race to map the same file
+  the last one wins the registry entry and the other mapping is freed
+  when its users release it. */
+  shared_ptr<MappedFile> mf=make_shared<MappedFile>(fname);
+  std::lock_guard<std::mutex> guard(registry_lock);
+  /* Drop the entries of mappings no longer in use.  Otherwise the
+  registry grows with every file ever read by the process. */
+  for(auto rptr=registry.begin();rptr!=registry.end();)
+  {
+    if(rptr->second.expired())
+      rptr=registry.erase(rptr);
+    else
+      ++rptr;
+  }
+  registry[fname]=mf;
+  return mf;
+}
+const double *MappedFile::samples(const long int foff, const size_t nd) const
+{
+  if(foff<0 || (foff%sizeof(double))!=0)
+    throw MsPASSError("MappedFile::samples:  illegal foff for file "+fname,
+      ErrorSeverity::Invalid);
+  size_t nbytes=nd*sizeof(double);
+  if(static_cast<size_t>(foff)+nbytes>length)
+    throw MsPASSError("MappedFile::samples:  requested block extends past end of file "+fname,
+      ErrorSeverity::Invalid);
+  /* base is page aligned so an aligned foff produces an aligned pointer */
+  return reinterpret_cast<const double *>(base+foff);
+}
+size_t MappedFile::copy(double *buffer, const long int foff, const size_t nd) const
+{
+  if(foff<0 || static_cast<size_t>(foff)>=length) return 0;
+  size_t nbytes=std::min(nd*sizeof(double),length-static_cast<size_t>(foff));
+  /* memcpy does not care about alignment of the source */
+  memcpy(buffer,base+foff,nbytes);
+  return nbytes/sizeof(double);
+}
+void MappedFile::willneed(const long int foff, const size_t nbytes) const
+{
+  if(base==NULL || foff<0 || static_cast<size_t>(foff)>=length) return;
+  /* madvise requires a page aligned address */
+  static const size_t pagesize=static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t start=static_cast<size_t>(foff);
+  size_t aligned_start=start-(start%pagesize);
+  size_t end=std::min(start+nbytes,length);
+  madvise(base+aligned_start,end-aligned_start,MADV_WILLNEED);
+}
+MappedSampleView::MappedSampleView(shared_ptr<MappedFile> mf,
+  const long int foff, const size_t n) : mapping(mf),nd(n)
+{
+  try{
+    ptr=mapping->samples(foff,nd);
+  }catch(...){throw;};
+}
+} // End namespace mspass::io
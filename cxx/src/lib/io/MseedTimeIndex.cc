@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <set>
+#include "mspass/io/MseedTimeIndex.h"
+namespace mspass::io
+{
+using namespace std;
+
+MseedTimeIndex::MseedTimeIndex(const vector<mseed_index>& ind, const string dir,
+  const string dfile)
+{
+  this->add(ind,dir,dfile);
+}
+string MseedTimeIndex::seed_key(const string net, const string sta,
+  const string loc, const string chan)
+{
+  return net + "." + sta + "." + loc + "." + chan;
+}
+void MseedTimeIndex::ChannelBlocks::sort()
+{
+  std::stable_sort(blocks.begin(),blocks.end(),
+    [](const MseedBlock& a, const MseedBlock& b){
+      return a.index.starttime<b.index.starttime;});
+  maxend.resize(blocks.size());
+  double m(0.0);
+  for(size_t i=0;i<blocks.size();++i)
+  {
+    if(i==0 || blocks[i].index.endtime>m) m=blocks[i].index.endtime;
+    maxend[i]=m;
+  }
+}
+void MseedTimeIndex::add(const vector<mseed_index>& ind, const string dir,
+  const string dfile)
+{
+  set<string> changed;
+  for(auto& m : ind)
+  {
+    string key=seed_key(m.net,m.sta,m.loc,m.chan);
+    blocks[key].blocks.push_back(MseedBlock(dir,dfile,m));
+    changed.insert(key);
+  }
+  /* Resorting is done once per channel for each call to add */
+  for(auto& key : changed) blocks[key].sort();
+}
+vector<MseedBlock> MseedTimeIndex::query(const string net, const string sta,
+  const string loc, const string chan, const double t0, const double t1) const
+{
+  vector<MseedBlock> result;
+  auto cptr=blocks.find(seed_key(net,sta,loc,chan));
+  if(cptr==blocks.end() || t1<t0) return result;
+  const ChannelBlocks& cb=cptr->second;
+  /* Blocks past last start after t1 */
+  auto last=std::upper_bound(cb.blocks.begin(),cb.blocks.end(),t1,
+    [](const double t, const MseedBlock& b){return t<b.index.starttime;});
+  /* maxend is nondecreasing so no block before first can end at or after t0 */
+  size_t first=std::lower_bound(cb.maxend.begin(),cb.maxend.end(),t0)
+    - cb.maxend.begin();
+  size_t nlast=last-cb.blocks.begin();
+  for(size_t i=first;i<nlast;++i)
+    if(cb.blocks[i].index.endtime>=t0) result.push_back(cb.blocks[i]);
+  return result;
+}
+size_t MseedTimeIndex::size() const
+{
+  size_t n(0);
+  for(auto& c : blocks) n += c.second.blocks.size();
+  return n;
+}
+vector<string> MseedTimeIndex::channels() const
+{
+  vector<string> result;
+  for(auto& c : blocks) result.push_back(c.first);
+  return result;
+}
+} // End namespace mspass::io
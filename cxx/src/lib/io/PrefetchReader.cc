@@ -0,0 +1,155 @@
+#include <string.h>
+#include <algorithm>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/io/FileHandleCache.h"
+#include "mspass/io/mseed_index.h"
+#include "mspass/io/SampleEncoding.h"
+#include "mspass/io/fileio.h"
+#include "mspass/io/PrefetchReader.h"
+namespace mspass::io
+{
+using namespace std;
+using mspass::seismic::TimeSeries;
+using mspass::seismic::Seismogram;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+size_t PrefetchResult::load(TimeSeries& d, const double fill_value) const
+{
+  if(!ok)
+    throw MsPASSError("PrefetchResult::load:  read failed for this block\n"+message,
+      ErrorSeverity::Invalid);
+  if(request.format==SampleFormat::mseed)
+  {
+    try{
+      return mseed_decode_block(d,buffer.data(),buffer.size(),fill_value,
+        build_fname(request.dir,request.dfile));
+    }catch(...){throw;};
+  }
+  try{
+    return decode_samples(buffer.data(),buffer.size(),get_sample_encoding(d),
+      get_sample_scale(d),d.s.data(),d.npts());
+  }catch(...){throw;};
+}
+size_t PrefetchResult::load(Seismogram& d) const
+{
+  if(!ok)
+    throw MsPASSError("PrefetchResult::load:  read failed for this block\n"+message,
+      ErrorSeverity::Invalid);
+  if(request.format==SampleFormat::mseed)
+    throw MsPASSError("PrefetchResult::load:  miniseed data cannot be loaded into a Seismogram",
+      ErrorSeverity::Invalid);
+  if(d.npts()==0) return 0;
+  try{
+    return decode_samples(buffer.data(),buffer.size(),get_sample_encoding(d),
+      get_sample_scale(d),d.u.get_address(0,0),3*d.npts());
+  }catch(...){throw;};
+}
+PrefetchReader::PrefetchReader(const vector<PrefetchRequest>& reqs,
+  const size_t nthreads, const size_t qsize)
+  : requests(reqs),queue_size(std::max(qsize,static_cast<size_t>(1))),
+    next_request(0),next_result(0),stopping(false)
+{
+  size_t nt=std::max(nthreads,static_cast<size_t>(1));
+  /* No reason to have more threads than requests */
+  nt=std::min(nt,std::max(requests.size(),static_cast<size_t>(1)));
+  for(size_t i=0;i<nt;++i)
+    workers.emplace_back(&PrefetchReader::worker,this);
+}
+PrefetchReader::~PrefetchReader()
+{
+  this->cancel();
+}
+void PrefetchReader::cancel()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping=true;
+  }
+  work_ready.notify_all();
+  result_ready.notify_all();
+  for(auto& t : workers)
+    if(t.joinable()) t.join();
+}
+size_t PrefetchReader::delivered() const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return next_result;
+}
+bool PrefetchReader::next(PrefetchResult& result)
+{
+  std::unique_lock<std::mutex> guard(lock);
+  if(next_result>=requests.size()) return false;
+  result_ready.wait(guard,[this]{
+    return stopping || ready.count(next_result)>0;});
+  auto rptr=ready.find(next_result);
+  if(rptr==ready.end()) return false;
+  result=std::move(rptr->second);
+  ready.erase(rptr);
+  ++next_result;
+  guard.unlock();
+  work_ready.notify_all();
+  return true;
+}
+void PrefetchReader::worker()
+{
+  std::unique_lock<std::mutex> guard(lock);
+  while(true)
+  {
+    /* The bound on the queue is defined relative to the next result the
+    caller will consume.  That bounds memory use even if a slow request
+    holds up delivery of those after it.  */
+    work_ready.wait(guard,[this]{
+      return stopping || next_request>=requests.size()
+        || next_request<next_result+queue_size;});
+    if(stopping || next_request>=requests.size()) return;
+    size_t i=next_request;
+    ++next_request;
+    guard.unlock();
+    if(i+queue_size<requests.size()) this->advise(i+queue_size);
+    PrefetchResult r=this->read_block(i);
+    guard.lock();
+    ready.emplace(i,std::move(r));
+    result_ready.notify_all();
+  }
+}
+void PrefetchReader::advise(const size_t i) const
+{
+  const PrefetchRequest& r=requests[i];
+  if(r.foff<0 || r.nbytes<=0) return;
+  try{
+    shared_ptr<CachedFile> fh=FileHandleCache::instance().get(build_fname(r.dir,r.dfile),false);
+    fh->advise_willneed(r.foff,r.nbytes);
+  }catch(MsPASSError& err)
+  {
+    /* Silently ignore - the error will be reported when the block is read */
+  }
+}
+PrefetchResult PrefetchReader::read_block(const size_t i) const
+{
+  PrefetchResult result;
+  result.index=i;
+  result.request=requests[i];
+  const PrefetchRequest& r=requests[i];
+  if(r.foff<0 || r.nbytes<0)
+  {
+    result.message="PrefetchReader:  illegal foff or nbytes value for file "
+      + build_fname(r.dir,r.dfile);
+    return result;
+  }
+  try{
+    shared_ptr<CachedFile> fh=FileHandleCache::instance().get(build_fname(r.dir,r.dfile),false);
+    result.buffer.resize(r.nbytes);
+    size_t nread=fh->read_bytes(result.buffer.data(),r.foff,r.nbytes);
+    result.buffer.resize(nread);
+    if(nread==0 && r.nbytes>0)
+      result.message="PrefetchReader:  read failed on file "+build_fname(r.dir,r.dfile);
+    else
+      result.ok=true;
+  }catch(MsPASSError& err)
+  {
+    result.message=err.what();
+  }
+  return result;
+}
+} // End namespace mspass::io
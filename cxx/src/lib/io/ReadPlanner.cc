@@ -0,0 +1,155 @@
+#include <unistd.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <algorithm>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/io/ReadPlanner.h"
+namespace mspass::io
+{
+using namespace std;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+ReadPlanner::ReadPlanner(const size_t maxgap, const size_t maxrange)
+  : max_gap(maxgap),max_range(maxrange)
+{
+}
+size_t ReadPlanner::add(double *buffer, const long int foff, const size_t nd)
+{
+  return this->add_request(reinterpret_cast<char *>(buffer),foff,
+    nd*sizeof(double),sizeof(double));
+}
+size_t ReadPlanner::add_bytes(char *buffer, const long int foff, const size_t nbytes)
+{
+  return this->add_request(buffer,foff,nbytes,1);
+}
+size_t ReadPlanner::add_request(char *buffer, const long int foff,
+  const size_t nbytes, const size_t unit)
+{
+  if(foff<0)
+    throw MsPASSError("ReadPlanner::add:  illegal negative foff",ErrorSeverity::Invalid);
+  ReadRequest r;
+  r.buffer=buffer;
+  r.foff=foff;
+  r.nbytes=nbytes;
+  r.unit=unit;
+  requests.push_back(r);
+  return requests.size()-1;
+}
+void ReadPlanner::clear()
+{
+  requests.clear();
+  stats=ReadStatistics();
+}
+/* File scope function to load one contiguous range with preadv.
+preadv can return a short count and is limited to IOV_MAX entries per
+call so we loop until the range is filled or we hit end of file.  Returns
+the number of bytes read.  iov is altered. */
+static size_t preadv_range(const int fd, vector<struct iovec>& iov, const off_t start,
+  ReadStatistics& stats)
+{
+  size_t i0(0),nbytes_read(0);
+  off_t pos=start;
+  while(i0<iov.size())
+  {
+    int niov=static_cast<int>(std::min(iov.size()-i0,static_cast<size_t>(IOV_MAX)));
+    ssize_t nr=preadv(fd,&(iov[i0]),niov,pos);
+    ++stats.syscalls;
+    if(nr<0)
+    {
+      if(errno==EINTR) continue;
+      break;
+    }
+    /* end of file */
+    if(nr==0) break;
+    pos += nr;
+    nbytes_read += nr;
+    size_t nleft=static_cast<size_t>(nr);
+    while(i0<iov.size() && nleft>=iov[i0].iov_len)
+    {
+      nleft -= iov[i0].iov_len;
+      ++i0;
+    }
+    if(nleft>0)
+    {
+      iov[i0].iov_base=static_cast<char *>(iov[i0].iov_base)+nleft;
+      iov[i0].iov_len -= nleft;
+    }
+  }
+  stats.bytes_read += nbytes_read;
+  return nbytes_read;
+}
+vector<size_t> ReadPlanner::execute(const CachedFile& fh)
+{
+  stats=ReadStatistics();
+  stats.nrequests=requests.size();
+  vector<size_t> nread(requests.size(),0);
+  vector<size_t> order;
+  order.reserve(requests.size());
+  for(size_t i=0;i<requests.size();++i)
+    if(requests[i].nbytes>0) order.push_back(i);
+  std::stable_sort(order.begin(),order.end(),
+    [this](const size_t a, const size_t b){
+      return requests[a].foff<requests[b].foff;});
+  /* Scratch space for gap bytes.  All gaps can share the same memory
+  because the contents are discarded. */
+  vector<char> scratch;
+  vector<struct iovec> iov;
+  vector<size_t> members;
+  vector<size_t> gap_iov;
+  size_t k(0);
+  while(k<order.size())
+  {
+    const long int range_start=requests[order[k]].foff;
+    long int range_end=range_start+requests[order[k]].nbytes;
+    iov.clear();
+    members.clear();
+    gap_iov.clear();
+    struct iovec v;
+    v.iov_base=requests[order[k]].buffer;
+    v.iov_len=requests[order[k]].nbytes;
+    iov.push_back(v);
+    members.push_back(order[k]);
+    size_t range_gap_bytes(0);
+    for(++k;k<order.size();++k)
+    {
+      const ReadRequest& r=requests[order[k]];
+      /* Overlapping requests cannot be scattered into two buffers
+      by one read so they always start a new range */
+      if(r.foff<range_end) break;
+      size_t gap=static_cast<size_t>(r.foff-range_end);
+      if(gap>max_gap) break;
+      if(static_cast<size_t>(r.foff+r.nbytes-range_start)>max_range) break;
+      if(gap>0)
+      {
+        if(scratch.size()<gap) scratch.resize(gap);
+        /* base is set below because scratch may be reallocated */
+        v.iov_base=NULL;
+        v.iov_len=gap;
+        gap_iov.push_back(iov.size());
+        iov.push_back(v);
+        range_gap_bytes += gap;
+      }
+      v.iov_base=r.buffer;
+      v.iov_len=r.nbytes;
+      iov.push_back(v);
+      members.push_back(order[k]);
+      range_end=r.foff+r.nbytes;
+    }
+    for(auto j : gap_iov) iov[j].iov_base=scratch.data();
+    /* If we hit end of file the last members of the range get a short
+    count just like fread would return */
+    size_t nbytes_read=preadv_range(fh.descriptor(),iov,range_start,stats);
+    for(auto i : members)
+    {
+      size_t rel=static_cast<size_t>(requests[i].foff-range_start);
+      if(nbytes_read>rel)
+        nread[i]=std::min(nbytes_read-rel,requests[i].nbytes)/requests[i].unit;
+    }
+    stats.gap_bytes += range_gap_bytes;
+    ++stats.nranges;
+  }
+  return nread;
+}
+} // End namespace mspass::io
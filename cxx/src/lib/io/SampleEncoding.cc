@@ -0,0 +1,522 @@
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/seismic/keywords.h"
+#include "mspass/io/SampleEncoding.h"
+namespace mspass::io
+{
+using namespace std;
+using mspass::utility::Metadata;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+using namespace mspass::seismic;
+
+/* The delta encoding is a sequence of independent blocks.  Each block
+begins with a fixed header of two 32 bit integers (number of samples
+and number of payload bytes) and a one byte mode.  Integer valued
+samples are stored as first differences mapped to unsigned integers
+with the zigzag transform.  Those are then entropy coded with the
+shorter of two codes:
+  DELTA_INTEGER - bytes of 7 bit groups (varint).
+  DELTA_RICE - Rice codes (Golomb codes with a power of 2 divisor).
+     The first payload byte is the number of low order bits k.  Each
+     value u is the unary code of u>>k (that many 1 bits and a 0 bit)
+     followed by the k low bits of u.  Values with u>>k of RICE_ESCAPE
+     or more are written as RICE_ESCAPE 1 bits and all 64 bits of u.
+     Bits are packed starting from the least significant bit of each byte.
+Rice codes adapt to the amplitude of the block and approach the entropy
+of differences with a two sided exponential distribution, which is
+typical of seismic data.  Blocks with any sample that is not an exact
+integer are stored as raw doubles (mode DELTA_RAW) so the encoding is
+always lossless. */
+const size_t DELTA_BLOCK_SIZE(4096);
+const size_t DELTA_HEADER_SIZE(2*sizeof(uint32_t)+1);
+const char DELTA_INTEGER(0);
+const char DELTA_RAW(1);
+const char DELTA_RICE(2);
+const uint32_t RICE_ESCAPE(32);
+/* Largest k allowed.  Keeps (u>>k)<<k in range for u>>k<RICE_ESCAPE */
+const int RICE_MAX_K(58);
+/* Largest magnitude for which every integer is exactly a double */
+const double MAX_EXACT_INTEGER(9007199254740992.0);
+
+string encoding_name(const SampleEncoding enc)
+{
+  switch(enc)
+  {
+    case SampleEncoding::float32:
+      return string("float32");
+    case SampleEncoding::int32:
+      return string("int32");
+    case SampleEncoding::delta:
+      return string("delta");
+    default:
+      return string("float64");
+  };
+}
+SampleEncoding parse_encoding(const string name)
+{
+  if(name=="float64") return SampleEncoding::float64;
+  if(name=="float32") return SampleEncoding::float32;
+  if(name=="int32") return SampleEncoding::int32;
+  if(name=="delta") return SampleEncoding::delta;
+  throw MsPASSError("parse_encoding:  unknown sample encoding name="+name,
+    ErrorSeverity::Invalid);
+}
+namespace {
+/* File scope functions for the variable length integer encoding */
+void put_varint(vector<char>& buf, uint64_t v)
+{
+  while(v>=0x80)
+  {
+    buf.push_back(static_cast<char>((v&0x7F)|0x80));
+    v >>= 7;
+  }
+  buf.push_back(static_cast<char>(v));
+}
+/* Returns false if the buffer ends before the integer is complete */
+bool get_varint(const unsigned char *& p, const unsigned char *end, uint64_t& v)
+{
+  v=0;
+  int shift(0);
+  while(p<end && shift<64)
+  {
+    uint64_t byte=*p;
+    ++p;
+    v |= (byte&0x7F)<<shift;
+    if(!(byte&0x80)) return true;
+    shift += 7;
+  }
+  return false;
+}
+inline uint64_t zigzag(const int64_t i)
+{
+  return (static_cast<uint64_t>(i)<<1) ^ static_cast<uint64_t>(i>>63);
+}
+inline int64_t unzigzag(const uint64_t u)
+{
+  return static_cast<int64_t>(u>>1) ^ -static_cast<int64_t>(u&1);
+}
+inline bool is_exact_integer(const double x)
+{
+  /* -0.0 is excluded because it would not survive a round trip */
+  return (fabs(x)<MAX_EXACT_INTEGER) && (x==floor(x)) && !(x==0.0 && signbit(x));
+}
+void put_uint32(vector<char>& buf, const size_t pos, const uint32_t v)
+{
+  memcpy(&(buf[pos]),&v,sizeof(uint32_t));
+}
+size_t varint_size(uint64_t v)
+{
+  size_t n(1);
+  while(v>=0x80)
+  {
+    v >>= 7;
+    ++n;
+  }
+  return n;
+}
+/* Number of bits used by the Rice codes of u with parameter k */
+size_t rice_bits(const vector<uint64_t>& u, const int k)
+{
+  size_t nbits(0);
+  for(auto v : u)
+  {
+    uint64_t q=v>>k;
+    nbits += (q<RICE_ESCAPE) ? q+1+k : RICE_ESCAPE+64;
+  }
+  return nbits;
+}
+/* Bit packing for the Rice codes */
+class BitWriter
+{
+public:
+  BitWriter(vector<char>& b) : buf(b),acc(0),nacc(0){};
+  /* Append the nbits low bits of v */
+  void put(uint64_t v, int nbits)
+  {
+    while(nbits>0)
+    {
+      int n=std::min(nbits,32);
+      acc |= (v&((uint64_t(1)<<n)-1))<<nacc;
+      nacc += n;
+      v >>= n;
+      nbits -= n;
+      while(nacc>=8)
+      {
+        buf.push_back(static_cast<char>(acc&0xFF));
+        acc >>= 8;
+        nacc -= 8;
+      }
+    }
+  };
+  void flush()
+  {
+    if(nacc>0) buf.push_back(static_cast<char>(acc&0xFF));
+    acc=0;
+    nacc=0;
+  };
+private:
+  vector<char>& buf;
+  uint64_t acc;
+  int nacc;
+};
+class BitReader
+{
+public:
+  BitReader(const unsigned char *pin, const unsigned char *endin)
+    : p(pin),end(endin),acc(0),nacc(0){};
+  /* Read nbits into v.  Returns false at the end of the buffer. */
+  bool get(uint64_t& v, int nbits)
+  {
+    v=0;
+    int shift(0);
+    while(nbits>0)
+    {
+      int n=std::min(nbits,32);
+      while(nacc<n)
+      {
+        if(p==end) return false;
+        acc |= static_cast<uint64_t>(*p)<<nacc;
+        ++p;
+        nacc += 8;
+      }
+      v |= (acc&((uint64_t(1)<<n)-1))<<shift;
+      acc >>= n;
+      nacc -= n;
+      shift += n;
+      nbits -= n;
+    }
+    return true;
+  };
+  /* Read a unary code of at most limit 1 bits. */
+  bool get_unary(uint32_t& q, const uint32_t limit)
+  {
+    q=0;
+    while(q<limit)
+    {
+      if(nacc==0)
+      {
+        if(p==end) return false;
+        acc=*p;
+        ++p;
+        nacc=8;
+      }
+      /* Number of 1 bits before the first 0 bit in acc */
+      uint64_t zeros=(~acc)&((uint64_t(1)<<nacc)-1);
+      uint32_t t = zeros ? static_cast<uint32_t>(__builtin_ctzll(zeros))
+                         : static_cast<uint32_t>(nacc);
+      if(q+t>=limit)
+      {
+        int take=static_cast<int>(limit-q);
+        acc >>= take;
+        nacc -= take;
+        q=limit;
+        return true;
+      }
+      q += t;
+      if(zeros)
+      {
+        acc >>= t+1;
+        nacc -= t+1;
+        return true;
+      }
+      acc=0;
+      nacc=0;
+    }
+    return true;
+  };
+private:
+  const unsigned char *p;
+  const unsigned char *end;
+  uint64_t acc;
+  int nacc;
+};
+void encode_delta_block(vector<char>& buf, const double *d, const size_t n)
+{
+  size_t hpos=buf.size();
+  buf.resize(hpos+DELTA_HEADER_SIZE);
+  put_uint32(buf,hpos,static_cast<uint32_t>(n));
+  bool all_integer(true);
+  for(size_t i=0;i<n;++i)
+  {
+    if(!is_exact_integer(d[i]))
+    {
+      all_integer=false;
+      break;
+    }
+  }
+  size_t payload_start=buf.size();
+  if(all_integer)
+  {
+    vector<uint64_t> u(n);
+    int64_t last(0);
+    double sum(0.0);
+    size_t nvarint(0);
+    for(size_t i=0;i<n;++i)
+    {
+      int64_t ival=static_cast<int64_t>(d[i]);
+      u[i]=zigzag(ival-last);
+      last=ival;
+      sum += static_cast<double>(u[i]);
+      nvarint += varint_size(u[i]);
+    }
+    /* The best k is close to log2 of the mean */
+    int kmean = (sum>n) ? static_cast<int>(log2(sum/n)) : 0;
+    int kbest(0);
+    size_t nbits_best(std::numeric_limits<size_t>::max());
+    for(int k=std::max(kmean-1,0);k<=std::min(kmean+1,RICE_MAX_K);++k)
+    {
+      size_t nbits=rice_bits(u,k);
+      if(nbits<nbits_best)
+      {
+        nbits_best=nbits;
+        kbest=k;
+      }
+    }
+    if(1+(nbits_best+7)/8 < nvarint)
+    {
+      buf[hpos+2*sizeof(uint32_t)]=DELTA_RICE;
+      buf.reserve(payload_start+1+(nbits_best+7)/8);
+      buf.push_back(static_cast<char>(kbest));
+      BitWriter bw(buf);
+      for(auto v : u)
+      {
+        uint64_t q=v>>kbest;
+        if(q<RICE_ESCAPE)
+        {
+          /* q 1 bits and a 0 bit */
+          bw.put((uint64_t(1)<<q)-1,q+1);
+          bw.put(v,kbest);
+        }
+        else
+        {
+          bw.put((uint64_t(1)<<RICE_ESCAPE)-1,RICE_ESCAPE);
+          bw.put(v,64);
+        }
+      }
+      bw.flush();
+    }
+    else
+    {
+      buf[hpos+2*sizeof(uint32_t)]=DELTA_INTEGER;
+      for(auto v : u) put_varint(buf,v);
+    }
+  }
+  else
+  {
+    buf[hpos+2*sizeof(uint32_t)]=DELTA_RAW;
+    buf.resize(payload_start+n*sizeof(double));
+    memcpy(&(buf[payload_start]),d,n*sizeof(double));
+  }
+  put_uint32(buf,hpos+sizeof(uint32_t),static_cast<uint32_t>(buf.size()-payload_start));
+}
+} // End anonymous namespace
+vector<char> encode_samples(const double *d, const size_t n,
+  const SampleEncoding enc, double& scale)
+{
+  vector<char> buf;
+  switch(enc)
+  {
+    case SampleEncoding::float32:
+      {
+        buf.resize(n*sizeof(float));
+        float *fptr=reinterpret_cast<float *>(buf.data());
+        for(size_t i=0;i<n;++i) fptr[i]=static_cast<float>(d[i]);
+      }
+      break;
+    case SampleEncoding::int32:
+      {
+        if(scale<=0.0)
+        {
+          double dmax(0.0);
+          for(size_t i=0;i<n;++i) dmax=std::max(dmax,fabs(d[i]));
+          /* Integer data that fit are stored exactly */
+          if(dmax<=2147483647.0)
+          {
+            bool all_integer(true);
+            for(size_t i=0;i<n && all_integer;++i)
+              all_integer=is_exact_integer(d[i]);
+            scale = all_integer ? 1.0 : dmax/2147483647.0;
+          }
+          else
+            scale=dmax/2147483647.0;
+          if(scale<=0.0) scale=1.0;
+        }
+        buf.resize(n*sizeof(int32_t));
+        int32_t *iptr=reinterpret_cast<int32_t *>(buf.data());
+        for(size_t i=0;i<n;++i)
+        {
+          double x=round(d[i]/scale);
+          /* clip rather than overflow when the caller gives a bad scale */
+          x=std::min(std::max(x,-2147483648.0),2147483647.0);
+          iptr[i]=static_cast<int32_t>(x);
+        }
+      }
+      break;
+    case SampleEncoding::delta:
+      for(size_t i=0;i<n;i+=DELTA_BLOCK_SIZE)
+        encode_delta_block(buf,d+i,std::min(DELTA_BLOCK_SIZE,n-i));
+      break;
+    default:
+      buf.resize(n*sizeof(double));
+      memcpy(buf.data(),d,n*sizeof(double));
+  };
+  return buf;
+}
+size_t decode_samples(const char *buffer, const size_t nbytes,
+  const SampleEncoding enc, const double scale, double *d, const size_t n)
+{
+  size_t nd(0);
+  switch(enc)
+  {
+    case SampleEncoding::float32:
+      {
+        nd=std::min(n,nbytes/sizeof(float));
+        float f;
+        for(size_t i=0;i<nd;++i)
+        {
+          /* memcpy avoids alignment assumptions on buffer */
+          memcpy(&f,buffer+i*sizeof(float),sizeof(float));
+          d[i]=static_cast<double>(f);
+        }
+      }
+      break;
+    case SampleEncoding::int32:
+      {
+        nd=std::min(n,nbytes/sizeof(int32_t));
+        int32_t ival;
+        for(size_t i=0;i<nd;++i)
+        {
+          memcpy(&ival,buffer+i*sizeof(int32_t),sizeof(int32_t));
+          d[i]=scale*static_cast<double>(ival);
+        }
+      }
+      break;
+    case SampleEncoding::delta:
+      {
+        const unsigned char *p=reinterpret_cast<const unsigned char *>(buffer);
+        const unsigned char *end=p+nbytes;
+        while(nd<n && static_cast<size_t>(end-p)>=DELTA_HEADER_SIZE)
+        {
+          uint32_t ns,payload;
+          memcpy(&ns,p,sizeof(uint32_t));
+          memcpy(&payload,p+sizeof(uint32_t),sizeof(uint32_t));
+          char mode=static_cast<char>(p[2*sizeof(uint32_t)]);
+          p += DELTA_HEADER_SIZE;
+          const unsigned char *block_end=std::min(p+payload,end);
+          size_t nblock=std::min(static_cast<size_t>(ns),n-nd);
+          if(mode==DELTA_RAW)
+          {
+            nblock=std::min(nblock,static_cast<size_t>(block_end-p)/sizeof(double));
+            memcpy(d+nd,p,nblock*sizeof(double));
+            nd += nblock;
+          }
+          else if(mode==DELTA_RICE)
+          {
+            if(p==block_end) return nd;
+            const int k=*p;
+            if(k>RICE_MAX_K) return nd;
+            BitReader br(p+1,block_end);
+            int64_t last(0);
+            for(size_t i=0;i<nblock;++i)
+            {
+              uint32_t q;
+              uint64_t u;
+              if(!br.get_unary(q,RICE_ESCAPE)) return nd;
+              if(q==RICE_ESCAPE)
+              {
+                if(!br.get(u,64)) return nd;
+              }
+              else
+              {
+                if(!br.get(u,k)) return nd;
+                u |= static_cast<uint64_t>(q)<<k;
+              }
+              last += unzigzag(u);
+              d[nd]=static_cast<double>(last);
+              ++nd;
+            }
+          }
+          else
+          {
+            int64_t last(0);
+            const unsigned char *q=p;
+            for(size_t i=0;i<nblock;++i)
+            {
+              uint64_t u;
+              if(!get_varint(q,block_end,u)) return nd;
+              last += unzigzag(u);
+              d[nd]=static_cast<double>(last);
+              ++nd;
+            }
+          }
+          /* A truncated block terminates decoding */
+          if(block_end<p+payload) break;
+          p=block_end;
+        }
+      }
+      break;
+    default:
+      nd=std::min(n,nbytes/sizeof(double));
+      memcpy(d,buffer,nd*sizeof(double));
+  };
+  return nd;
+}
+SampleEncoding get_sample_encoding(const Metadata& md)
+{
+  if(md.is_defined(SEISMICMD_sample_encoding))
+    return parse_encoding(md.get_string(SEISMICMD_sample_encoding));
+  else
+    return SampleEncoding::float64;
+}
+double get_sample_scale(const Metadata& md)
+{
+  if(md.is_defined(SEISMICMD_sample_scale))
+    return md.get_double(SEISMICMD_sample_scale);
+  else
+    return 1.0;
+}
+void set_sample_encoding(Metadata& md, const SampleEncoding enc,
+  const double scale, const size_t nbytes)
+{
+  if(enc==SampleEncoding::float64)
+  {
+    md.erase(SEISMICMD_sample_encoding);
+    md.erase(SEISMICMD_sample_scale);
+    md.erase(SEISMICMD_nbytes);
+    return;
+  }
+  md.put_string(SEISMICMD_sample_encoding,encoding_name(enc));
+  /* The size of fixed width encodings is computed from npts so a value
+  left from an earlier delta save must not survive */
+  if(enc==SampleEncoding::delta)
+    md.put_long(SEISMICMD_nbytes,static_cast<long int>(nbytes));
+  else
+    md.erase(SEISMICMD_nbytes);
+  if(enc==SampleEncoding::int32)
+    md.put_double(SEISMICMD_sample_scale,scale);
+  else
+    md.erase(SEISMICMD_sample_scale);
+}
+size_t encoded_size(const Metadata& md, const SampleEncoding enc, const size_t n)
+{
+  switch(enc)
+  {
+    case SampleEncoding::float32:
+      return n*sizeof(float);
+    case SampleEncoding::int32:
+      return n*sizeof(int32_t);
+    case SampleEncoding::delta:
+      if(md.is_defined(SEISMICMD_nbytes))
+        return static_cast<size_t>(md.get_long(SEISMICMD_nbytes));
+      throw MsPASSError("encoded_size:  nbytes must be defined to read delta encoded data",
+        ErrorSeverity::Invalid);
+    default:
+      return n*sizeof(double);
+  };
+}
+} // End namespace mspass::io
@@ -1,4 +1,6 @@
 #include <memory>
+#include <list>
+#include <algorithm>
 #include <vector>
 #include <stdio.h>
 #include <string>
@@ -9,52 +11,100 @@
 #include "mspass/seismic/Seismogram.h"
 #include "mspass/seismic/Ensemble.h"
 #include "mspass/io/fileio.h"
+#include "mspass/io/FileHandleCache.h"
+#include "mspass/io/ReadPlanner.h"
+#include "mspass/io/MappedFile.h"
+#include "mspass/io/SampleEncoding.h"
+#include "mspass/io/ConcurrentAppender.h"
 namespace mspass::io
 {
 //using namespace mspass::io;
 using namespace mspass::seismic;
+using mspass::utility::Metadata;
 using mspass::utility::MsPASSError;
 using mspass::utility::ErrorSeverity;
+using mspass::algorithms::TimeWindow;
 using namespace std;
 
-/*This is a file scope function to allow the overlaoded fwrite_to_file
-functions to share this common code to write a contiguous buffer of data.
-to a file.
+/* For expected context for use in python we will assume dir does not
+have a trailing path separator so we always insert /.  A null dir as
+always in unix means use current directory.*/
+string build_fname(const string dir, const string dfile)
+{
+	if(dir.length()>0)
+		return dir + "/" + dfile;
+	else
+		return dfile;
+}
+/*This is a file scope function used by all the fwrite_to_file functions
+to append a set of contiguous blocks of data to a file.  It returns
+foff of each block.  type_name is used only in error messages.
 
-Note I considered adding an old school call to lockf to assure this
-function would be thread safe.   However, the man page for the posix
-function lockffile says that is no longer necessary and stdio is
-now tread safe - fopen creates an intrinsic lock that is not released
-until fclose is called.  That is important for mspass as multiple threads
-writing to the same file can be expected to be common. */
-long int fwrite_sample_data(const string dir, const string dfile, double *dptr, const size_t nd)
+Files are normally opened through the process wide FileHandleCache.  When
+the cache is enabled repeated saves to the same file reuse one descriptor
+instead of an open/close cycle for every datum.   The CachedFile append
+method serializes writers in this process so the foff returned is
+always where the data landed.   When the ConcurrentAppender registry is
+enabled the blocks are instead written to a byte range reserved
+through the lock file protocol of that class.  That makes foff correct
+when multiple processes write the same file. */
+static vector<long int> append_blocks(const string fname, const vector<const char*>& blocks,
+	const vector<size_t>& sizes, const string type_name)
 {
-	try{
-		FILE *fp;
-		long int foff;
-		string fname;
-		if(dir.length()>0)
-		  /* for expected context for use in python we will assume dir does not
-			have a trailing path separator so we always insert / */
-			fname = dir + "/" + dfile;
-		else
-		  /* Null as always in unix means use current directory*/
-			fname=dfile;
-		if((fp=fopen(fname.c_str(),"a")) == NULL)
-		  /* use the name of the overloaded parent instead of the actual function - intentional*/
-			throw MsPASSError("fwrite_to_file:  Open failed on file "+fname,ErrorSeverity::Invalid);
-	  /* Both fseek and ftell can fail in weird circumstances, but I intentionally
-		do not trap that condition as if either have issues I am quite sure
-		the fwrite will fail */
-		fseek(fp,0L,2);
-		foff = ftell(fp);
-		if( fwrite((void*)dptr,sizeof(double),nd,fp) != nd)
+	string caller("fwrite_to_file");
+	if(type_name.length()>0) caller += " ("+type_name+")";
+	if(ConcurrentAppender::enabled())
+	{
+		shared_ptr<ConcurrentAppender> a;
+		try{
+			a=ConcurrentAppender::get(fname);
+		}catch(MsPASSError& err)
 		{
-			fclose(fp);
-			throw MsPASSError("fwrite_to_file:  fwrite error while writing to file "+fname,ErrorSeverity::Invalid);
+			throw MsPASSError(caller+":  Open failed on file "+fname,ErrorSeverity::Invalid);
 		}
-		fclose(fp);
-		return foff;
+		try{
+			return a->write_bytes(blocks,sizes);
+		}catch(MsPASSError& err)
+		{
+			throw MsPASSError(caller+":  write error while writing to file "+fname
+				+"\n"+err.what(),ErrorSeverity::Invalid);
+		}
+	}
+	shared_ptr<CachedFile> fh;
+	try{
+		fh=FileHandleCache::instance().get(fname,true);
+	}catch(MsPASSError& err)
+	{
+		/* use the name of the overloaded parent instead of the actual function - intentional*/
+		throw MsPASSError(caller+":  Open failed on file "+fname,ErrorSeverity::Invalid);
+	}
+	try{
+		return fh->append_bytes(blocks,sizes);
+	}catch(MsPASSError& err)
+	{
+		throw MsPASSError(caller+":  fwrite error while writing to file "+fname,ErrorSeverity::Invalid);
+	}
+}
+static long int fwrite_sample_data(const string dir, const string dfile, const double *dptr, const size_t nd)
+{
+	vector<const char*> blocks(1,reinterpret_cast<const char *>(dptr));
+	vector<size_t> sizes(1,nd*sizeof(double));
+	try{
+		return append_blocks(build_fname(dir,dfile),blocks,sizes,"")[0];
+	}catch(...){throw;};
+}
+/* File scope function to write an encoded buffer of samples.  Returns
+foff and sets nbytes to the number of bytes written.  scale is used
+for int32 and may be computed by the encoder.*/
+static long int fwrite_encoded_data(const string dir, const string dfile, const double *dptr,
+	const size_t nd, const SampleEncoding enc, double& scale, size_t& nbytes)
+{
+	vector<char> buf=encode_samples(dptr,nd,enc,scale);
+	nbytes=buf.size();
+	vector<const char*> blocks(1,buf.data());
+	vector<size_t> sizes(1,buf.size());
+	try{
+		return append_blocks(build_fname(dir,dfile),blocks,sizes,"")[0];
 	}catch(...){throw;};
 }
 /*! Write sample data for a TimeSeries to a file with fwrite.  Always
@@ -62,12 +112,24 @@ appends and returns foff of the position where fwrite wrote these data.
 Returns -1 if it receives a datum marked dead.
 */
 long int fwrite_to_file(TimeSeries& d,const string dir,const string dfile)
+{
+	try{
+		return fwrite_to_file(d,dir,dfile,SampleEncoding::float64);
+	}catch(...){throw;};
+}
+long int fwrite_to_file(TimeSeries& d,const string dir,const string dfile,
+	const SampleEncoding enc, const double scale)
 {
 	if(d.dead()) return -1;
 	/* Using this function avoids repetitious code with Seismogram version. */
 	long int foff;
+	double scale_used(scale);
+	size_t nbytes(d.npts()*sizeof(double));
 	try{
-	  foff = fwrite_sample_data(dir,dfile,d.s.data(),d.npts());
+		if(enc==SampleEncoding::float64)
+			foff = fwrite_sample_data(dir,dfile,std::as_const(d).s.data(),d.npts());
+		else
+			foff = fwrite_encoded_data(dir,dfile,std::as_const(d).s.data(),d.npts(),enc,scale_used,nbytes);
 	}catch(...){throw;};
 	/* We always set these 3 attributes in Metadata so they can be properly
 	saved to the database after a successful write.  Repetitious with Seismogram
@@ -75,6 +137,7 @@ long int fwrite_to_file(TimeSeries& d,const string dir,const string dfile)
 	d.put_string(SEISMICMD_dir,dir);
 	d.put_string(SEISMICMD_dfile,dfile);
 	d.put_long(SEISMICMD_foff,foff);
+	set_sample_encoding(d,enc,scale_used,nbytes);
 	return(foff);
 }
 /*! Write sample data for a Seismogram to a file with fwrite.  Always
@@ -85,20 +148,112 @@ sample matrix.
 Returns -1 if it receives a datum marked dead.
 */
 long int fwrite_to_file(Seismogram& d, const string dir,const string dfile)
+{
+	try{
+		return fwrite_to_file(d,dir,dfile,SampleEncoding::float64);
+	}catch(...){throw;};
+}
+long int fwrite_to_file(Seismogram& d, const string dir,const string dfile,
+	const SampleEncoding enc, const double scale)
 {
 	if(d.dead()) return(-1);
 	/* Using this function avoids repetitious code with TimeSeries version.
 	Note use of 3*npts as the buffer size*/
 	long int foff;
+	double scale_used(scale);
+	size_t nbytes(3*d.npts()*sizeof(double));
 	try{
-		foff = fwrite_sample_data(dir,dfile,d.u.get_address(0,0),3*d.npts());
+		if(enc==SampleEncoding::float64)
+			foff = fwrite_sample_data(dir,dfile,std::as_const(d).u.get_address(0,0),3*d.npts());
+		else
+			foff = fwrite_encoded_data(dir,dfile,std::as_const(d).u.get_address(0,0),3*d.npts(),
+				enc,scale_used,nbytes);
 	}catch(...){throw;};
 	d.put_string(SEISMICMD_dir,dir);
 	d.put_string(SEISMICMD_dfile,dfile);
 	d.put_long(SEISMICMD_foff,foff);
+	set_sample_encoding(d,enc,scale_used,nbytes);
 
 	return(foff);
 }
+/* The ensemble versions use templates as the only difference between
+TimeSeries and Seismogram is the buffer address and size*/
+static double *sample_buffer(TimeSeries& d){return d.s.data();}
+static size_t sample_buffer_size(const TimeSeries& d){return d.npts();}
+static double *sample_buffer(Seismogram& d)
+{
+	/* get_address throws on an empty matrix */
+	if(d.npts()==0) return NULL;
+	return d.u.get_address(0,0);
+}
+static size_t sample_buffer_size(const Seismogram& d){return 3*d.npts();}
+/* Read only versions for writers.  Samples shared with copies of d are
+not copied by these. */
+static const double *sample_data(const TimeSeries& d){return d.s.data();}
+static const double *sample_data(const Seismogram& d)
+{
+	if(d.npts()==0) return NULL;
+	return d.u.get_address(0,0);
+}
+/* Ensemble writer.  All live members are written with one gathered write
+so they are guaranteed to be contiguous in the file.  typename is used
+only in error messages. */
+template <typename Tdata> static vector<long int> fwrite_ensemble(LoggingEnsemble<Tdata>& d,
+	const string dir, const string dfile, const SampleEncoding enc,
+	const double scale, const string type_name)
+{
+	vector<long int> foffs;
+	/* This will return an empty vector if the ensemble is marked dead - callers should handle this condition
+	but they normally shouldn't be calling this function if the entire ensemble is marked dead anyway.*/
+	if(d.dead()) return(foffs);
+	string fname=build_fname(dir,dfile);
+	vector<const char*> blocks;
+	vector<size_t> sizes;
+	vector<double> scales;
+	vector<size_t> live_members;
+	/* holds the encoded data when enc is not float64 */
+	vector<vector<char>> encoded;
+	for (size_t i = 0; i < d.member.size(); ++i) {
+		/* Test for npts is needed for Seismogram because get_address throws on an empty matrix*/
+		if(d.member[i].live() && sample_buffer_size(d.member[i])>0)
+		{
+			const double *dptr=sample_data(d.member[i]);
+			size_t nd=sample_buffer_size(d.member[i]);
+			double scale_used(scale);
+			if(enc==SampleEncoding::float64)
+			{
+				blocks.push_back(reinterpret_cast<const char *>(dptr));
+				sizes.push_back(nd*sizeof(double));
+			}
+			else
+			{
+				/* Each member gets its own scale if the caller asked for automatic scaling*/
+				encoded.push_back(encode_samples(dptr,nd,enc,scale_used));
+				blocks.push_back(encoded.back().data());
+				sizes.push_back(encoded.back().size());
+			}
+			scales.push_back(scale_used);
+			live_members.push_back(i);
+		}
+	}
+	vector<long int> live_foffs;
+	try{
+		live_foffs=append_blocks(fname,blocks,sizes,type_name);
+	}catch(...){throw;};
+	foffs.assign(d.member.size(),-1);
+	for(size_t k=0;k<live_members.size();++k)
+	{
+		Tdata& t = d.member[live_members[k]];
+		foffs[live_members[k]]=live_foffs[k];
+		/* We always set these 3 attributes in Metadata so they can be properly
+		saved to the database after a successful write. */
+		t.put_string(SEISMICMD_dir, dir);
+		t.put_string(SEISMICMD_dfile, dfile);
+		t.put_long(SEISMICMD_foff, live_foffs[k]);
+		set_sample_encoding(t,enc,scales[k],sizes[k]);
+	}
+	return foffs;
+}
 /*! Write sample data for an Ensemble of TimeSeries to a single file.
 
 Writing ensemble data with this function is more efficient than writing atomic
@@ -121,52 +276,17 @@ std::vector<long int> fwrite_to_file(
 		  const std::string dfile)
 {
 	try{
-		FILE *fp;
-		vector<long int> foffs;
-		/* This will return an empty vector if the ensemble is marked dead - callers should handle this condition
-		but they normally shouldn't be calling this function if the entire ensemble is marked dead anyway.*/
-		if(d.dead()) return(foffs);
-		string fname;
-		if(dir.length()>0)
-		  /* for expected context for use in python we will assume dir does not
-			have a trailing path separator so we always insert / */
-			fname = dir + "/" + dfile;
-		else
-		  /* Null as always in unix means use current directory*/
-			fname=dfile;
-		if((fp=fopen(fname.c_str(),"a")) == NULL)
-		  /* use the name of the overloaded parent instead of the actual function - intentional*/
-			throw MsPASSError("fwrite_to_file (TimeSeriesEnsemble):  Open failed on file "+fname,ErrorSeverity::Invalid);
-		/* This guarantees appending - not essential since we open in "a" mode but
-		clearer */
-		fseek(fp,0L,2);
-
-		for (int i = 0; i < d.member.size(); ++i) {
-			if(d.member[i].dead())
-			    foffs.push_back(-1);
-			else
-			{
-				long int foff = ftell(fp);
-				foffs.push_back(foff);
-				TimeSeries& t = d.member[i];
-				if (fwrite((void *)t.s.data(), sizeof(double), t.npts(), fp) != t.npts())
-				{
-					fclose(fp);
-					stringstream ss;
-					ss << "fwrite_to_file (TimeSeriesEnsemble):  fwrite error while writing ensemble member "
-				   	<< i << " to file="<<fname<<endl;
-					throw MsPASSError(ss.str(), ErrorSeverity::Invalid);
-				}
-				/* We always set these 3 attributes in Metadata so they can be properly
-				saved to the database after a successful write.  Repetitious with Seismogram
-				but a function to do this would be more confusing that helpful */
-				t.put_string(SEISMICMD_dir, dir);
-				t.put_string(SEISMICMD_dfile, dfile);
-				t.put_long(SEISMICMD_foff, foff);
-			}
-		}
-		fclose(fp);
-		return foffs;
+		return fwrite_ensemble<TimeSeries>(d,dir,dfile,SampleEncoding::float64,0.0,
+			"TimeSeriesEnsemble");
+	}catch(...){throw;};
+}
+std::vector<long int> fwrite_to_file(
+	mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries>& d,
+	const std::string dir, const std::string dfile,
+	const SampleEncoding enc, const double scale)
+{
+	try{
+		return fwrite_ensemble<TimeSeries>(d,dir,dfile,enc,scale,"TimeSeriesEnsemble");
 	}catch(...){throw;};
 }
 /*! Write sample data for an Ensemble of Seismogram objects to a single file.
@@ -188,87 +308,63 @@ If entire ensemble is marked dead it will return an empty vector container.
 std::vector<long int> fwrite_to_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& d, const std::string dir,const std::string dfile)
 {
 	try{
-		FILE *fp;
-		vector<long int> foffs;
-		if(d.dead()) return(foffs);
-		string fname;
-		if(dir.length()>0)
-		  /* for expected context for use in python we will assume dir does not
-			have a trailing path separator so we always insert / */
-			fname = dir + "/" + dfile;
-		else
-		  /* Null as always in unix means use current directory*/
-			fname=dfile;
-		if((fp=fopen(fname.c_str(),"a")) == NULL)
-		  /* use the name of the overloaded parent instead of the actual function - intentional*/
-			throw MsPASSError("fwrite_to_file (SeismogramEnsemble):  Open failed on file "+fname,ErrorSeverity::Invalid);
-		/* This guarantees appending - not essential since we open in "a" mode but
-		clearer */
-		fseek(fp,0L,2);
-
-		for (int i = 0; i < d.member.size(); ++i) {
-			if(d.member[i].dead())
-			    foffs.push_back(-1);
-			else
-			{
-				if(d.member[i].dead()) continue;
-				long int foff = ftell(fp);
-				foffs.push_back(foff);
-				Seismogram& t = d.member[i];
-				if (fwrite((void *)t.u.get_address(0,0), sizeof(double), 3*t.npts(), fp) != 3*t.npts())
-				{
-					fclose(fp);
-					stringstream ss;
-					ss << "fwrite_to_file (SeismogramEnsemble):  fwrite error while writing ensemble member "
-				   << i << " to file="<<fname<<endl;
-				  throw MsPASSError(ss.str(), ErrorSeverity::Invalid);
-				}
-				/* We always set these 3 attributes in Metadata so they can be properly
-				saved to the database after a successful write.  Repetitious with Seismogram
-				but a function to do this would be more confusing that helpful */
-				t.put_string(SEISMICMD_dir, dir);
-				t.put_string(SEISMICMD_dfile, dfile);
-				t.put_long(SEISMICMD_foff, foff);
-			}
-		}
-		fclose(fp);
-		return foffs;
+		return fwrite_ensemble<Seismogram>(d,dir,dfile,SampleEncoding::float64,0.0,
+			"SeismogramEnsemble");
+	}catch(...){throw;};
+}
+std::vector<long int> fwrite_to_file(
+	mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram>& d,
+	const std::string dir, const std::string dfile,
+	const SampleEncoding enc, const double scale)
+{
+	try{
+		return fwrite_ensemble<Seismogram>(d,dir,dfile,enc,scale,"SeismogramEnsemble");
 	}catch(...){throw;};
 }
 
-size_t fread_sample_data(double *buffer,const string dir, const string dfile,
+static size_t fread_sample_data(double *buffer,const string dir, const string dfile,
      const long int foff,const int nsamples)
 {
-	FILE *fp;
-	string fname;
-	if(dir.length()>0)
-	  /* for expected context for use in python we will assume dir does not
-		have a trailing path separator so we always insert / */
-		fname = dir + "/" + dfile;
-	else
-	  /* Null as always in unix means use current directory*/
-		fname=dfile;
-	if((fp=fopen(fname.c_str(),"r")) == NULL)
+	string fname=build_fname(dir,dfile);
+	shared_ptr<CachedFile> fh;
+	try{
+		fh=FileHandleCache::instance().get(fname,false);
+	}catch(MsPASSError& err)
+	{
 		throw MsPASSError("fread_data_from_file:  Open failed on file "+fname,ErrorSeverity::Invalid);
-	if(foff>0)
+	}
+	if(foff<0)
+		throw MsPASSError("fread_data_from_file:  fseek failure on file="+fname,ErrorSeverity::Invalid);
+	return fh->read(buffer,foff,nsamples);
+}
+/* File scope function to read and decode encoded sample data.  md is
+the Metadata of the datum that defines the encoding.*/
+static size_t fread_encoded_data(const Metadata& md, double *buffer, const string dir,
+	const string dfile, const long int foff, const size_t nd)
+{
+	SampleEncoding enc=get_sample_encoding(md);
+	if(enc==SampleEncoding::float64)
+		return fread_sample_data(buffer,dir,dfile,foff,nd);
+	string fname=build_fname(dir,dfile);
+	shared_ptr<CachedFile> fh;
+	try{
+		fh=FileHandleCache::instance().get(fname,false);
+	}catch(MsPASSError& err)
 	{
-		if(fseek(fp,foff,SEEK_SET))
-		{
-			fclose(fp);
-		  throw MsPASSError("fread_data_from_file:  fseek failure on file="+fname,ErrorSeverity::Invalid);
-		}
+		throw MsPASSError("fread_data_from_file:  Open failed on file "+fname,ErrorSeverity::Invalid);
 	}
-	size_t retcount;
-	retcount = fread((void*)buffer,sizeof(double),nsamples,fp);
-	fclose(fp);
-	return retcount;
+	if(foff<0)
+		throw MsPASSError("fread_data_from_file:  fseek failure on file="+fname,ErrorSeverity::Invalid);
+	vector<char> raw(encoded_size(md,enc,nd));
+	size_t nbytes=fh->read_bytes(raw.data(),foff,raw.size());
+	return decode_samples(raw.data(),nbytes,enc,get_sample_scale(md),buffer,nd);
 }
 size_t fread_from_file(Seismogram& d,const string dir, const string dfile,
      const long int foff)
 {
 	size_t ns_read;
 	try{
-		ns_read = fread_sample_data(d.u.get_address(0,0),dir,dfile,foff,3*d.npts());
+		ns_read = fread_encoded_data(d,d.u.get_address(0,0),dir,dfile,foff,3*d.npts());
 		return ns_read;
 	}catch(...){throw;};
 }
@@ -277,138 +373,345 @@ size_t fread_from_file(TimeSeries& d,const string dir, const string dfile,
 {
 	size_t ns_read;
 	try{
-		ns_read = fread_sample_data(&(d.s[0]),dir,dfile,foff,d.npts());
+		ns_read = fread_encoded_data(d,d.s.data(),dir,dfile,foff,d.npts());
 		return ns_read;
 	}catch(...){throw;};
 }
-size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &de,
- const std::string dir, const std::string dfile, std::vector<long int> indexes)
+/* The ensemble readers load all members from a file with a ReadPlanner.
+The planner sorts the members by foff and merges adjacent blocks into
+large preadv calls that scatter directly into each member's sample buffer.
+Encoded members are read into a temporary buffer and decoded after the
+read.  Members are validated in the order given by indexes so error
+handling is the same as the older one read per member algorithm. */
+template <typename Tdata> static size_t fread_ensemble(LoggingEnsemble<Tdata>& de,
+	const string dir, const string dfile, const vector<long int>& indexes,
+	ReadStatistics& stats)
 {
-	size_t ns_read_sum;
+	size_t ns_read_sum(0);
 	int n = indexes.size();
-	FILE *fp;
-	string fname;
-	if(dir.length()>0)
-	  /* for expected context for use in python we will assume dir does not
-		have a trailing path separator so we always insert / */
-		fname = dir + "/" + dfile;
-	else
-	  /* Null as always in unix means use current directory*/
-		fname=dfile;
-	if((fp=fopen(fname.c_str(),"r")) == NULL) {
+	string fname=build_fname(dir,dfile);
+	shared_ptr<CachedFile> fh;
+	try{
+		fh=FileHandleCache::instance().get(fname,false);
+	}catch(MsPASSError& err)
+	{
 		de.kill();
 		stringstream ss;
 		ss << "can not open file in " << fname << endl;
 		de.elog.log_error(ss.str());
 		return -1;
 	}
-
+	ReadPlanner plan;
+	/* members holds the ensemble index of each request added to plan*/
+	vector<int> members;
+	vector<SampleEncoding> encodings;
+	/* Raw data for encoded members.  A list is used so the buffers
+	never move after their address is given to the planner. */
+	list<vector<char>> raw;
+	vector<vector<char>*> rawptr;
 	for (int ind = 0; ind < n; ++ind) {
-		size_t ns_read;
 		int i = indexes[ind];
+		Tdata& d = de.member[i];
 		long int foff;
-		if (de.member[i].is_defined(SEISMICMD_foff))
+		if (d.is_defined(SEISMICMD_foff))
 		{
-		  foff = de.member[i].get_long(SEISMICMD_foff);
+		  foff = d.get_long(SEISMICMD_foff);
 		}
 		else
 		{
-		  de.member[i].kill();
+		  d.kill();
 		  stringstream ss;
 		  ss << "foff not defined for " << i << " member in ensemble" << endl;
-		  de.member[i].elog.log_error(ss.str());
+		  d.elog.log_error(ss.str());
 		  continue;
 		}
+		if(foff<0)
+		{
+			d.kill();
+			stringstream ss;
+			ss << "can not fseek in " << foff << endl;
+			d.elog.log_error(ss.str());
+			continue;
+		}
+		SampleEncoding enc;
+		size_t nbytes;
 		try{
-			if(fseek(fp,foff,SEEK_SET))
-			{
-				fclose(fp);
-				de.member[i].kill();
-				stringstream ss;
-		  		ss << "can not fseek in " << foff << endl;
-				     de.member[i].elog.log_error(ss.str());
-				continue;
-			}
-			ns_read = fread((void*)de.member[i].u.get_address(0, 0), sizeof(double), 3 * de.member[i].npts(), fp);
-			if (ns_read != 3 * de.member[i].npts())
-			{
-				de.member[i].elog.log_error(string("read error: npts not equal"));
-				de.member[i].kill();
-			}
-			else
-			{
-				de.member[i].set_live();
-			}
-			ns_read_sum += ns_read;
-		}catch(...){throw;};
+			enc=get_sample_encoding(d);
+			nbytes=encoded_size(d,enc,sample_buffer_size(d));
+		}catch(MsPASSError& err)
+		{
+			d.kill();
+			d.elog.log_error(err);
+			continue;
+		}
+		if(enc==SampleEncoding::float64)
+		{
+			plan.add(sample_buffer(d), foff, sample_buffer_size(d));
+			rawptr.push_back(NULL);
+		}
+		else
+		{
+			raw.push_back(vector<char>(nbytes));
+			plan.add_bytes(raw.back().data(),foff,nbytes);
+			rawptr.push_back(&(raw.back()));
+		}
+		encodings.push_back(enc);
+		members.push_back(i);
+	}
+	vector<size_t> nread=plan.execute(*fh);
+	for(size_t k=0;k<members.size();++k)
+	{
+		Tdata& d = de.member[members[k]];
+		size_t ns_read=nread[k];
+		if(encodings[k]!=SampleEncoding::float64)
+			ns_read=decode_samples(rawptr[k]->data(),nread[k],encodings[k],
+				get_sample_scale(d),sample_buffer(d),sample_buffer_size(d));
+		if (ns_read != sample_buffer_size(d))
+		{
+			d.elog.log_error(string("read error: npts not equal"));
+			d.kill();
+		}
+		else
+		{
+			d.set_live();
+		}
+		ns_read_sum += ns_read;
 	}
-	fclose(fp);
+	stats=plan.statistics();
 	de.set_live();
 	return ns_read_sum;
 }
+size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes,
+ ReadStatistics& stats)
+{
+	try{
+		return fread_ensemble<Seismogram>(de,dir,dfile,indexes,stats);
+	}catch(...){throw;};
+}
+size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes)
+{
+	ReadStatistics stats;
+	try{
+		return fread_ensemble<Seismogram>(de,dir,dfile,indexes,stats);
+	}catch(...){throw;};
+}
+size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes,
+ ReadStatistics& stats)
+{
+	try{
+		return fread_ensemble<TimeSeries>(de,dir,dfile,indexes,stats);
+	}catch(...){throw;};
+}
 size_t fread_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> &de,
  const std::string dir, const std::string dfile, std::vector<long int> indexes)
-
 {
-	size_t ns_read_sum;
-	int n = indexes.size();
-	FILE *fp;
-	string fname;
-	if(dir.length()>0)
-	  /* for expected context for use in python we will assume dir does not
-		have a trailing path separator so we always insert / */
-		fname = dir + "/" + dfile;
-	else
-	  /* Null as always in unix means use current directory*/
-		fname=dfile;
-	if((fp=fopen(fname.c_str(),"r")) == NULL) {
+	ReadStatistics stats;
+	try{
+		return fread_ensemble<TimeSeries>(de,dir,dfile,indexes,stats);
+	}catch(...){throw;};
+}
+/* File scope function to fetch a shared mapping with an error message
+consistent with the other readers. */
+static shared_ptr<MappedFile> map_file(const string alg,const string dir, const string dfile)
+{
+	string fname=build_fname(dir,dfile);
+	try{
+		return MappedFile::get(fname);
+	}catch(MsPASSError& err)
+	{
+		throw MsPASSError(alg+":  mmap failed on file "+fname+"\n"+err.what(),
+			ErrorSeverity::Invalid);
+	}
+}
+/* File scope function to copy or decode nd samples starting at foff from a
+mapped file.   md defines the encoding as in fread_encoded_data*/
+static size_t mmap_copy(const MappedFile& mf, const Metadata& md, double *buffer,
+	const long int foff, const size_t nd)
+{
+	SampleEncoding enc=get_sample_encoding(md);
+	if(enc==SampleEncoding::float64)
+		return mf.copy(buffer,foff,nd);
+	if(foff<0 || static_cast<size_t>(foff)>=mf.size()) return 0;
+	size_t nbytes=std::min(encoded_size(md,enc,nd),mf.size()-foff);
+	return decode_samples(mf.data()+foff,nbytes,enc,get_sample_scale(md),buffer,nd);
+}
+size_t mmap_read_from_file(TimeSeries& d,const string dir, const string dfile,
+     const long int foff)
+{
+	shared_ptr<MappedFile> mf=map_file("mmap_read_from_file",dir,dfile);
+	try{
+		return mmap_copy(*mf,d,d.s.data(),foff,d.npts());
+	}catch(...){throw;};
+}
+size_t mmap_read_from_file(Seismogram& d,const string dir, const string dfile,
+     const long int foff)
+{
+	shared_ptr<MappedFile> mf=map_file("mmap_read_from_file",dir,dfile);
+	/* get_address throws on an empty matrix */
+	if(d.npts()==0) return 0;
+	try{
+		return mmap_copy(*mf,d,d.u.get_address(0,0),foff,3*d.npts());
+	}catch(...){throw;};
+}
+/* File scope function for windowed reads.  Copies nwin values starting at
+value i0 of a datum of ntotal values saved at foff. Fixed width encodings
+are decoded in place.  Delta encoded data have to be decoded from the
+beginning so the full datum is decoded into a scratch buffer. */
+static size_t mmap_window_copy(const MappedFile& mf, const Metadata& md, double *buffer,
+	const long int foff, const size_t i0, const size_t nwin, const size_t ntotal)
+{
+	SampleEncoding enc=get_sample_encoding(md);
+	switch(enc)
+	{
+		case SampleEncoding::float64:
+			return mf.copy(buffer,foff+sizeof(double)*i0,nwin);
+		case SampleEncoding::float32:
+		case SampleEncoding::int32:
+			{
+				/* both are 4 bytes per sample */
+				long int wfoff=foff+4*i0;
+				if(wfoff<0 || static_cast<size_t>(wfoff)>=mf.size()) return 0;
+				size_t nbytes=std::min(4*nwin,mf.size()-wfoff);
+				return decode_samples(mf.data()+wfoff,nbytes,enc,get_sample_scale(md),
+					buffer,nwin);
+			}
+		default:
+			{
+				vector<double> work(ntotal);
+				size_t nd=mmap_copy(mf,md,work.data(),foff,ntotal);
+				if(nd<=i0) return 0;
+				size_t ncopy=std::min(nwin,nd-i0);
+				std::copy(work.begin()+i0,work.begin()+i0+ncopy,buffer);
+				return ncopy;
+			}
+	};
+}
+/* File scope function used by the windowed readers to compute the range
+of samples spanned by tw.   Throws with the same conditions as WindowData*/
+static void window_sample_range(const string alg,const mspass::seismic::BasicTimeSeries& d,
+	const TimeWindow& tw, int& is, int& ie)
+{
+	is=d.sample_number(tw.start);
+	ie=d.sample_number(tw.end);
+	if( (is<0) || (ie>=((int)d.npts())) || (ie<is) )
+	{
+		ostringstream mess;
+		mess << alg<<":  Window mismatch"<<endl
+			<< "Window start time="<<tw.start<< " is sample number "
+			<< is<<endl
+			<< "Window end time="<<tw.end<< " is sample number "
+			<< ie<<endl
+			<< "Data have "<<d.npts()<<" samples"<<endl;
+		throw MsPASSError(mess.str(),ErrorSeverity::Invalid);
+	}
+}
+size_t mmap_read_from_file(TimeSeries& d,const string dir, const string dfile,
+     const long int foff, const TimeWindow& tw)
+{
+	const string alg("mmap_read_from_file (TimeSeries window)");
+	int is,ie;
+	window_sample_range(alg,d,tw,is,ie);
+	shared_ptr<MappedFile> mf=map_file(alg,dir,dfile);
+	double t0=d.time(is);
+	size_t ntotal=d.npts();
+	d.set_npts(ie-is+1);
+	d.set_t0(t0);
+	try{
+		return mmap_window_copy(*mf,d,d.s.data(),foff,is,d.npts(),ntotal);
+	}catch(...){throw;};
+}
+size_t mmap_read_from_file(Seismogram& d,const string dir, const string dfile,
+     const long int foff, const TimeWindow& tw)
+{
+	const string alg("mmap_read_from_file (Seismogram window)");
+	int is,ie;
+	window_sample_range(alg,d,tw,is,ie);
+	shared_ptr<MappedFile> mf=map_file(alg,dir,dfile);
+	double t0=d.time(is);
+	size_t ntotal=3*d.npts();
+	d.set_npts(ie-is+1);
+	d.set_t0(t0);
+	try{
+		return mmap_window_copy(*mf,d,d.u.get_address(0,0),foff,3*is,3*d.npts(),ntotal);
+	}catch(...){throw;};
+}
+template <typename Tdata> static size_t mmap_read_ensemble(LoggingEnsemble<Tdata>& de,
+	const string dir, const string dfile, const vector<long int>& indexes)
+{
+	size_t ns_read_sum(0);
+	shared_ptr<MappedFile> mf;
+	try{
+		mf=MappedFile::get(build_fname(dir,dfile));
+	}catch(MsPASSError& err)
+	{
 		de.kill();
 		stringstream ss;
-		ss << "can not open file in " << fname << endl;
+		ss << "can not map file " << build_fname(dir,dfile) << endl;
 		de.elog.log_error(ss.str());
 		return -1;
 	}
-	for (int ind = 0; ind < n; ++ind) {
+	for(auto i : indexes)
+	{
+		Tdata& d=de.member[i];
+		if(!d.is_defined(SEISMICMD_foff))
+		{
+			d.kill();
+			stringstream ss;
+			ss << "foff not defined for " << i << " member in ensemble" << endl;
+			d.elog.log_error(ss.str());
+			continue;
+		}
+		long int foff=d.get_long(SEISMICMD_foff);
+		if(foff<0)
+		{
+			d.kill();
+			stringstream ss;
+			ss << "can not fseek in " << foff << endl;
+			d.elog.log_error(ss.str());
+			continue;
+		}
 		size_t ns_read;
-		int i = indexes[ind];
-		long int foff;
-		if (de.member[i].is_defined(SEISMICMD_foff))
+		try{
+			ns_read=mmap_copy(*mf,d,sample_buffer(d),foff,sample_buffer_size(d));
+		}catch(MsPASSError& err)
 		{
-		  foff = de.member[i].get_long(SEISMICMD_foff);
+			d.kill();
+			d.elog.log_error(err);
+			continue;
+		}
+		if(ns_read!=sample_buffer_size(d))
+		{
+			d.elog.log_error(string("read error: npts not equal"));
+			d.kill();
 		}
 		else
 		{
-		  de.member[i].kill();
-		  stringstream ss;
-		  ss << "foff not defined for " << i << " member in ensemble" << endl;
-		  de.member[i].elog.log_error(ss.str());
-		  continue;
+			d.set_live();
 		}
-		try{
-			if(fseek(fp,foff,SEEK_SET))
-			{
-				fclose(fp);
-				de.member[i].kill();
-				stringstream ss;
-		  		ss << "can not fseek in " << foff << endl;
-				de.member[i].elog.log_error(ss.str());
-				continue;
-			}
-			ns_read = fread((void*)(&(de.member[i].s[0])), sizeof(double), de.member[i].npts(), fp);
-			if (ns_read != de.member[i].npts())
-			{
-				de.member[i].elog.log_error(string("read error: npts not equal"));
-				de.member[i].kill();
-			}
-			else
-			{
-				de.member[i].set_live();
-			}
-			ns_read_sum += ns_read;
-		}catch(...){throw;};
+		ns_read_sum += ns_read;
 	}
-	fclose(fp);
 	de.set_live();
 	return ns_read_sum;
 }
+size_t mmap_read_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::TimeSeries> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes)
+{
+	return mmap_read_ensemble<TimeSeries>(de,dir,dfile,indexes);
+}
+size_t mmap_read_from_file(mspass::seismic::LoggingEnsemble<mspass::seismic::Seismogram> &de,
+ const std::string dir, const std::string dfile, std::vector<long int> indexes)
+{
+	return mmap_read_ensemble<Seismogram>(de,dir,dfile,indexes);
+}
+MappedSampleView mmap_sample_view(const string dir, const string dfile,
+	const long int foff, const size_t nd)
+{
+	shared_ptr<MappedFile> mf=map_file("mmap_sample_view",dir,dfile);
+	try{
+		return MappedSampleView(mf,foff,nd);
+	}catch(...){throw;};
+}
 } // Termination of namespace definitions
@@ -0,0 +1,233 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <algorithm>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/ErrorLogger.h"
+#include "mspass/io/ContainerFile.h"
+#include "mspass/io/mseed_index.h"
+namespace mspass::io
+{
+using namespace std;
+using mspass::utility::ErrorLogger;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+typedef std::pair<std::vector<mseed_index>,mspass::utility::ErrorLogger> MSDINDEX_returntype;
+
+/* A sidecar file is:
+  8 byte magic SIDECAR_MAGIC
+  uint32 version
+  uint32 segment_timetears flag
+  uint64 size of the data file
+  int64  mtime of the data file (seconds)
+  int64  mtime of the data file (nanoseconds)
+  uint64 number of entries
+  entries (see pack_index)
+  uint32 CRC32 of everything before it
+Values are in host byte order.*/
+const char SIDECAR_MAGIC[8]={'M','S','P','M','S','I','D','X'};
+const uint32_t SIDECAR_VERSION(1);
+const size_t SIDECAR_HEADER_SIZE(48);
+
+string mseed_sidecar_name(const string fname, const string cache_dir)
+{
+  if(cache_dir.empty())
+    return fname + ".msidx";
+  string leaf(fname);
+  std::replace(leaf.begin(),leaf.end(),'/','_');
+  return cache_dir + "/" + leaf + ".msidx";
+}
+namespace {
+/* File scope functions to pack and unpack the sidecar */
+template <typename T> void sidecar_put(vector<char>& buf, const T val)
+{
+  size_t pos=buf.size();
+  buf.resize(pos+sizeof(T));
+  memcpy(&(buf[pos]),&val,sizeof(T));
+}
+void sidecar_put_string(vector<char>& buf, const string s)
+{
+  sidecar_put<uint16_t>(buf,static_cast<uint16_t>(s.size()));
+  buf.insert(buf.end(),s.begin(),s.end());
+}
+template <typename T> bool sidecar_get(const char *& p, const char *end, T& val)
+{
+  if(static_cast<size_t>(end-p)<sizeof(T)) return false;
+  memcpy(&val,p,sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+bool sidecar_get_string(const char *& p, const char *end, string& s)
+{
+  uint16_t n;
+  if(!sidecar_get(p,end,n)) return false;
+  if(static_cast<size_t>(end-p)<n) return false;
+  s.assign(p,n);
+  p += n;
+  return true;
+}
+void pack_index(vector<char>& buf, const mseed_index& ind)
+{
+  sidecar_put_string(buf,ind.net);
+  sidecar_put_string(buf,ind.sta);
+  sidecar_put_string(buf,ind.loc);
+  sidecar_put_string(buf,ind.chan);
+  sidecar_put<uint64_t>(buf,ind.foff);
+  sidecar_put<uint64_t>(buf,ind.nbytes);
+  sidecar_put<uint64_t>(buf,ind.npts);
+  sidecar_put<double>(buf,ind.samprate);
+  sidecar_put<double>(buf,ind.starttime);
+  sidecar_put<double>(buf,ind.endtime);
+  sidecar_put<double>(buf,ind.last_packet_time);
+}
+bool unpack_index(const char *& p, const char *end, mseed_index& ind)
+{
+  uint64_t foff,nbytes,npts;
+  if(!(sidecar_get_string(p,end,ind.net) && sidecar_get_string(p,end,ind.sta)
+     && sidecar_get_string(p,end,ind.loc) && sidecar_get_string(p,end,ind.chan)))
+    return false;
+  if(!(sidecar_get(p,end,foff) && sidecar_get(p,end,nbytes)
+     && sidecar_get(p,end,npts))) return false;
+  ind.foff=foff;
+  ind.nbytes=nbytes;
+  ind.npts=npts;
+  return sidecar_get(p,end,ind.samprate) && sidecar_get(p,end,ind.starttime)
+     && sidecar_get(p,end,ind.endtime) && sidecar_get(p,end,ind.last_packet_time);
+}
+/* Builds the sidecar header for a data file with stat results sb */
+vector<char> sidecar_header(const struct stat& sb, const bool segment_timetears,
+  const size_t nentries)
+{
+  vector<char> buf(SIDECAR_MAGIC,SIDECAR_MAGIC+8);
+  sidecar_put<uint32_t>(buf,SIDECAR_VERSION);
+  sidecar_put<uint32_t>(buf,segment_timetears ? 1 : 0);
+  sidecar_put<uint64_t>(buf,sb.st_size);
+  sidecar_put<int64_t>(buf,sb.st_mtim.tv_sec);
+  sidecar_put<int64_t>(buf,sb.st_mtim.tv_nsec);
+  sidecar_put<uint64_t>(buf,nentries);
+  return buf;
+}
+/* Returns true and fills ind if sidecar exists and matches the data file
+defined by sb.  Any problem with the sidecar is treated as a cache miss. */
+bool read_sidecar(const string sidecar, const struct stat& sb,
+  const bool segment_timetears, vector<mseed_index>& ind)
+{
+  FILE *fp=fopen(sidecar.c_str(),"r");
+  if(fp==NULL) return false;
+  vector<char> buf;
+  char chunk[65536];
+  size_t n;
+  while((n=fread(chunk,1,sizeof(chunk),fp))>0)
+    buf.insert(buf.end(),chunk,chunk+n);
+  fclose(fp);
+  if(buf.size()<SIDECAR_HEADER_SIZE+sizeof(uint32_t)) return false;
+  size_t nbody=buf.size()-sizeof(uint32_t);
+  uint32_t crc;
+  memcpy(&crc,&(buf[nbody]),sizeof(uint32_t));
+  if(crc32_checksum(buf.data(),nbody)!=crc) return false;
+  vector<char> expected=sidecar_header(sb,segment_timetears,0);
+  /* Compare everything but the entry count */
+  if(memcmp(buf.data(),expected.data(),SIDECAR_HEADER_SIZE-sizeof(uint64_t))!=0)
+    return false;
+  uint64_t nentries;
+  memcpy(&nentries,&(buf[SIDECAR_HEADER_SIZE-sizeof(uint64_t)]),sizeof(uint64_t));
+  const char *p=buf.data()+SIDECAR_HEADER_SIZE;
+  const char *end=buf.data()+nbody;
+  vector<mseed_index> result;
+  for(uint64_t i=0;i<nentries;++i)
+  {
+    mseed_index m;
+    if(!unpack_index(p,end,m)) return false;
+    result.push_back(m);
+  }
+  ind=std::move(result);
+  return true;
+}
+/* Writes to a temporary file and renames so readers never see a partial
+sidecar.  Errors are ignored because the cache is only an optimization. */
+void write_sidecar(const string sidecar, const struct stat& sb,
+  const bool segment_timetears, const vector<mseed_index>& ind)
+{
+  vector<char> buf=sidecar_header(sb,segment_timetears,ind.size());
+  for(auto& m : ind) pack_index(buf,m);
+  sidecar_put<uint32_t>(buf,crc32_checksum(buf.data(),buf.size()));
+  stringstream ss;
+  ss << sidecar << ".tmp." << getpid() << "." << std::this_thread::get_id();
+  string tmpname=ss.str();
+  FILE *fp=fopen(tmpname.c_str(),"w");
+  if(fp==NULL) return;
+  size_t nwrite=fwrite(buf.data(),1,buf.size(),fp);
+  int iret=fclose(fp);
+  if(nwrite!=buf.size() || iret!=0 || rename(tmpname.c_str(),sidecar.c_str())!=0)
+    unlink(tmpname.c_str());
+}
+MSDINDEX_returntype index_one_file(const string fname, const bool segment_timetears,
+  const bool Verbose, const bool use_cache, const string cache_dir)
+{
+  const string function_name("mseed_index_files");
+  struct stat sb;
+  bool have_stat=(stat(fname.c_str(),&sb)==0);
+  string sidecar;
+  if(use_cache && have_stat)
+  {
+    sidecar=mseed_sidecar_name(fname,cache_dir);
+    vector<mseed_index> ind;
+    if(read_sidecar(sidecar,sb,segment_timetears,ind))
+      return MSDINDEX_returntype(ind,ErrorLogger());
+  }
+  MSDINDEX_returntype result;
+  try{
+    result=mseed_file_indexer(fname,segment_timetears,Verbose);
+  }catch(MsPASSError& err)
+  {
+    result.second.log_error(err);
+    return result;
+  }catch(std::exception& err)
+  {
+    result.second.log_error(function_name,string("Error indexing file ")+fname
+      +"\nMessage="+err.what(),ErrorSeverity::Invalid);
+    return result;
+  }
+  /* Only clean results are cached.   The file is checked again in case it
+  was modified while it was being indexed */
+  struct stat sbafter;
+  if(use_cache && have_stat && result.second.size()==0 && result.first.size()>0
+     && stat(fname.c_str(),&sbafter)==0 && sbafter.st_size==sb.st_size
+     && sbafter.st_mtim.tv_sec==sb.st_mtim.tv_sec
+     && sbafter.st_mtim.tv_nsec==sb.st_mtim.tv_nsec)
+    write_sidecar(sidecar,sb,segment_timetears,result.first);
+  return result;
+}
+} // End anonymous namespace
+vector<MSDINDEX_returntype> mseed_index_files(const vector<string>& files,
+  const size_t nthreads, const bool segment_timetears, const bool Verbose,
+  const bool use_cache, const string cache_dir)
+{
+  vector<MSDINDEX_returntype> results(files.size());
+  /* Threads take the next file from a shared counter.  That balances the
+  load when file sizes are very different. */
+  std::atomic<size_t> next_file(0);
+  auto worker=[&](){
+    size_t i;
+    while((i=next_file.fetch_add(1))<files.size())
+      results[i]=index_one_file(files[i],segment_timetears,Verbose,
+        use_cache,cache_dir);
+  };
+  size_t nt=std::min(std::max(nthreads,static_cast<size_t>(1)),
+    std::max(files.size(),static_cast<size_t>(1)));
+  if(nt==1)
+  {
+    worker();
+    return results;
+  }
+  vector<std::thread> pool;
+  for(size_t k=0;k<nt;++k) pool.emplace_back(worker);
+  for(auto& t : pool) t.join();
+  return results;
+}
+} // End namespace mspass::io
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <sstream>
+
+#include "libmseed.h"
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/ErrorLogger.h"
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/io/mseed_index.h"
+
+using namespace std;
+namespace mspass::io
+{
+using namespace mspass::io;
+using mspass::seismic::TimeSeries;
+using mspass::utility::MsPASSError;
+using mspass::utility::ErrorSeverity;
+
+/* File scope function to copy the decoded samples from a libmseed record
+into a double buffer.  libmseed returns samples in the type defined by
+the sampletype character.  We only support the numeric types.  Returns
+the number of samples copied or -1 if the type is not numeric. */
+static int64_t copy_mseed_samples(const MS3Record *msr, double *dptr, const int64_t ns)
+{
+  int64_t i;
+  switch(msr->sampletype)
+  {
+    case 'i':
+      {
+        const int32_t *iptr=static_cast<const int32_t *>(msr->datasamples);
+        for(i=0;i<ns;++i) dptr[i]=static_cast<double>(iptr[i]);
+      }
+      break;
+    case 'f':
+      {
+        const float *fptr=static_cast<const float *>(msr->datasamples);
+        for(i=0;i<ns;++i) dptr[i]=static_cast<double>(fptr[i]);
+      }
+      break;
+    case 'd':
+      {
+        const double *ddptr=static_cast<const double *>(msr->datasamples);
+        for(i=0;i<ns;++i) dptr[i]=ddptr[i];
+      }
+      break;
+    default:
+      return -1;
+  };
+  return ns;
+}
+size_t mseed_fread_from_file(TimeSeries& d, const string dir, const string dfile,
+  const long int foff, const long int nbytes, const double fill_value)
+{
+  const string alg("mseed_fread_from_file");
+  string fname;
+  if(dir.length()>0)
+    /* for expected context for use in python we will assume dir does not
+    have a trailing path separator so we always insert / */
+    fname = dir + "/" + dfile;
+  else
+    /* Null as always in unix means use current directory*/
+    fname=dfile;
+  if(nbytes<=0)
+    throw MsPASSError(alg+":  illegal nbytes value for block in file "+fname,
+        ErrorSeverity::Invalid);
+  /* We read the entire block with one fread.   Blocks defined by the
+  indexer are always contiguous packets of one channel so this is
+  much faster than letting libmseed walk the file one record at a time. */
+  vector<char> buffer(nbytes);
+  FILE *fp;
+  if((fp=fopen(fname.c_str(),"r")) == NULL)
+    throw MsPASSError(alg+":  Open failed on file "+fname,ErrorSeverity::Invalid);
+  if(foff>0)
+  {
+    if(fseek(fp,foff,SEEK_SET))
+    {
+      fclose(fp);
+      throw MsPASSError(alg+":  fseek failure on file="+fname,ErrorSeverity::Invalid);
+    }
+  }
+  size_t nread=fread((void*)buffer.data(),sizeof(char),nbytes,fp);
+  fclose(fp);
+  if(nread==0)
+    throw MsPASSError(alg+":  fread failed on file="+fname,ErrorSeverity::Invalid);
+  if(nread<static_cast<size_t>(nbytes))
+  {
+    stringstream ss;
+    ss << "Short read from file="<<fname<<endl
+       << "Expected "<<nbytes<<" bytes but fread returned "<<nread<<endl
+       << "Data may be truncated"<<endl;
+    d.elog.log_error(alg,ss.str(),ErrorSeverity::Complaint);
+  }
+  try{
+    return mseed_decode_block(d,buffer.data(),nread,fill_value,fname);
+  }catch(...){throw;};
+}
+size_t mseed_decode_block(TimeSeries& d, const char *buffer, const size_t nread,
+  const double fill_value, const string fname)
+{
+  /* Use the name of the file reader for consistency of error messages */
+  const string alg("mseed_fread_from_file");
+  MS3Record *msr=NULL;
+  size_t npts=d.npts();
+  /* d.s is not resized until all packets are decoded */
+  double *sptr=d.s.data();
+  size_t nexpected(0),nloaded(0),nmax(0);
+  uint64_t offset(0);
+  size_t number_packets(0);
+  bool gap_logged(false),overlap_logged(false),overflow_logged(false);
+  while(offset<nread)
+  {
+    int retcode=msr3_parse(const_cast<char *>(buffer)+offset,nread-offset,&msr,MSF_UNPACKDATA,0);
+    if(retcode!=MS_NOERROR)
+    {
+      /* A positive return means the last record was truncated.   Negative
+      returns are libmseed error codes.  In either case we salvage what
+      was already decoded. */
+      stringstream ss;
+      ss << "libmseed function msr3_parse returned error code "<<retcode
+         << " decoding packet number "<<number_packets
+         << " at byte offset "<<offset<<" of block read from "<<fname<<endl
+         << "Data from that point forward were dropped"<<endl;
+      d.elog.log_error(alg,ss.str(),ErrorSeverity::Complaint);
+      break;
+    }
+    double pkt_time=MS_NSTIME2EPOCH(static_cast<double>(msr->starttime));
+    if(number_packets==0)
+    {
+      /* Trust the packet headers over the database for dt and t0*/
+      if(msr->samprate>0.0)
+      {
+        double pkt_dt=1.0/msr->samprate;
+        if(fabs(pkt_dt-d.dt())>0.0001*pkt_dt)
+        {
+          stringstream ss;
+          ss << "Sample interval of data object="<<d.dt()
+             << " does not match packet sample interval="<<pkt_dt<<endl
+             << "Set to value in packet headers"<<endl;
+          d.elog.log_error(alg,ss.str(),ErrorSeverity::Complaint);
+          d.set_dt(pkt_dt);
+        }
+      }
+      if(fabs(pkt_time-d.t0())>0.5*d.dt())
+      {
+        stringstream ss;
+        ss << std::setprecision(17);
+        ss << "Start time of data object="<<d.t0()
+           << " does not match time of first packet="<<pkt_time<<endl
+           << "Set to time of first packet"<<endl;
+        d.elog.log_error(alg,ss.str(),ErrorSeverity::Complaint);
+        d.set_t0(pkt_time);
+      }
+      if(d.dt()<=0.0)
+      {
+        msr3_free(&msr);
+        throw MsPASSError(alg+":  invalid sample interval for data read from file "+fname,
+            ErrorSeverity::Invalid);
+      }
+    }
+    int64_t i0=static_cast<int64_t>(round((pkt_time-d.t0())/d.dt()));
+    if(i0<0)
+    {
+      stringstream ss;
+      ss << "Packet number "<<number_packets<<" has a start time before the "
+         << "first packet - packet was dropped"<<endl;
+      d.elog.log_error(alg,ss.str(),ErrorSeverity::Complaint);
+    }
+    else
+    {
+      size_t istart=static_cast<size_t>(i0);
+      if(istart>nexpected)
+      {
+        for(size_t i=nexpected;i<istart && i<npts;++i) sptr[i]=fill_value;
+        if(!gap_logged)
+        {
+          stringstream ss;
+          ss << "Gap detected in packet sequence starting at sample "<<nexpected<<endl
+             << "Gaps were filled with constant value="<<fill_value<<endl;
+          d.elog.log_error(alg,ss.str(),ErrorSeverity::Complaint);
+          gap_logged=true;
+        }
+      }
+      else if(istart<nexpected && !overlap_logged)
+      {
+        d.elog.log_error(alg,
+          string("Overlapping packets detected - later packets overwrite earlier samples"),
+          ErrorSeverity::Complaint);
+        overlap_logged=true;
+      }
+      int64_t ns=msr->numsamples;
+      if(istart+ns>npts)
+      {
+        if(!overflow_logged)
+        {
+          stringstream ss;
+          ss << "Packets contain more samples than the data buffer size="<<npts<<endl
+             << "Excess samples were discarded"<<endl;
+          d.elog.log_error(alg,ss.str(),ErrorSeverity::Complaint);
+          overflow_logged=true;
+        }
+        ns = (istart<npts) ? static_cast<int64_t>(npts-istart) : 0;
+      }
+      if(ns>0)
+      {
+        if(copy_mseed_samples(msr,sptr+istart,ns)<0)
+        {
+          d.elog.log_error(alg,
+            string("Packet with non-numeric sample type found - packet dropped"),
+            ErrorSeverity::Complaint);
+        }
+        else
+        {
+          nloaded += ns;
+          if(istart+ns>nmax) nmax=istart+ns;
+        }
+      }
+      nexpected=istart+msr->numsamples;
+    }
+    ++number_packets;
+    offset += msr->reclen;
+  }
+  msr3_free(&msr);
+  /* Shorten the vector if the packets held fewer samples than expected.
+  Note we intentionally do not use set_npts as it clears the vector*/
+  if(nmax<npts)
+  {
+    d.s.resize(nmax);
+    d.sync_npts();
+  }
+  return nloaded;
+}
+size_t mseed_fread_from_file(TimeSeries& d, const string dir, const string dfile,
+  const mseed_index& ind, const double fill_value)
+{
+  try{
+    if(d.npts()!=ind.npts) d.set_npts(ind.npts);
+    return mseed_fread_from_file(d,dir,dfile,ind.foff,ind.nbytes,fill_value);
+  }catch(...){throw;};
+}
+} // End namespace mspass::io
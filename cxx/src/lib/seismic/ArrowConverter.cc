@@ -0,0 +1,729 @@
+#include <string.h>
+#include <limits>
+#include <map>
+#include <vector>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/Metadata.h"
+#include "mspass/utility/BinaryArchive.h"
+#include "mspass/seismic/keywords.h"
+#include "mspass/seismic/ArrowConverter.h"
+namespace mspass::seismic
+{
+using namespace std;
+using namespace mspass::utility;
+
+namespace {
+/* Types of the Metadata columns of an exported ensemble */
+enum class ArrowColumnType
+{
+  Boolean,
+  Int32,
+  Int64,
+  Float32,
+  Float64,
+  Utf8
+};
+const char *arrow_format(const ArrowColumnType t)
+{
+  switch(t)
+  {
+    case ArrowColumnType::Boolean:
+      return "b";
+    case ArrowColumnType::Int32:
+      return "i";
+    case ArrowColumnType::Int64:
+      return "l";
+    case ArrowColumnType::Float32:
+      return "f";
+    case ArrowColumnType::Float64:
+      return "g";
+    default:
+      return "u";
+  }
+}
+ArrowColumnType arrow_column_type(const boost::any& a, const string& key)
+{
+  const std::type_info& ti=a.type();
+  if(ti==typeid(double)) return ArrowColumnType::Float64;
+  if(ti==typeid(long)) return ArrowColumnType::Int64;
+  if(ti==typeid(string)) return ArrowColumnType::Utf8;
+  if(ti==typeid(bool)) return ArrowColumnType::Boolean;
+  if(ti==typeid(int)) return ArrowColumnType::Int32;
+  if(ti==typeid(float)) return ArrowColumnType::Float32;
+  throw MsPASSError("export_to_arrow:  value for key="+key+" has type "
+    +demangled_name(a)+" that cannot be stored in an arrow column",
+    ErrorSeverity::Invalid);
+}
+/* Returns the type of a column holding values of types a and b */
+ArrowColumnType merge_column_types(const ArrowColumnType a,
+  const ArrowColumnType b, const string& key)
+{
+  if(a==b) return a;
+  if(a==ArrowColumnType::Boolean || a==ArrowColumnType::Utf8
+     || b==ArrowColumnType::Boolean || b==ArrowColumnType::Utf8)
+    throw MsPASSError("export_to_arrow:  values for key="+key
+      +" have incompatible types in different members",ErrorSeverity::Invalid);
+  if((a==ArrowColumnType::Int32 || a==ArrowColumnType::Int64)
+     && (b==ArrowColumnType::Int32 || b==ArrowColumnType::Int64))
+    return ArrowColumnType::Int64;
+  return ArrowColumnType::Float64;
+}
+template <typename T> T arrow_numeric_value(const boost::any& a)
+{
+  const std::type_info& ti=a.type();
+  if(ti==typeid(double)) return static_cast<T>(boost::any_cast<double>(a));
+  if(ti==typeid(long)) return static_cast<T>(boost::any_cast<long>(a));
+  if(ti==typeid(int)) return static_cast<T>(boost::any_cast<int>(a));
+  return static_cast<T>(boost::any_cast<float>(a));
+}
+
+/* Owners of the memory of exported schemas and arrays.  Each exported
+schema and array node has its own owner so a consumer can move children
+out of their parents as allowed by the C data interface. */
+class ExportedSchema
+{
+public:
+  string format;
+  string name;
+  string metadata;
+  vector<ArrowSchema> children;
+  vector<ArrowSchema*> child_pointers;
+};
+class ExportedArray
+{
+public:
+  vector<vector<uint8_t>> data;
+  vector<const void*> buffers;
+  vector<ArrowArray> children;
+  vector<ArrowArray*> child_pointers;
+};
+void release_exported_schema(ArrowSchema *schema)
+{
+  for(int64_t i=0;i<schema->n_children;++i)
+  {
+    ArrowSchema *child=schema->children[i];
+    if(child->release!=NULL) child->release(child);
+  }
+  delete static_cast<ExportedSchema*>(schema->private_data);
+  schema->release=NULL;
+}
+void release_exported_array(ArrowArray *array)
+{
+  for(int64_t i=0;i<array->n_children;++i)
+  {
+    ArrowArray *child=array->children[i];
+    if(child->release!=NULL) child->release(child);
+  }
+  delete static_cast<ExportedArray*>(array->private_data);
+  array->release=NULL;
+}
+ExportedSchema *init_schema(ArrowSchema *schema, const string& format,
+  const string& name, const size_t nchildren)
+{
+  ExportedSchema *owner=new ExportedSchema();
+  owner->format=format;
+  owner->name=name;
+  owner->children.resize(nchildren);
+  for(auto& c : owner->children) c.release=NULL;
+  for(auto& c : owner->children) owner->child_pointers.push_back(&c);
+  schema->format=owner->format.c_str();
+  schema->name=owner->name.c_str();
+  schema->metadata=NULL;
+  schema->flags=ARROW_FLAG_NULLABLE;
+  schema->n_children=nchildren;
+  schema->children= nchildren>0 ? owner->child_pointers.data() : NULL;
+  schema->dictionary=NULL;
+  schema->release=release_exported_schema;
+  schema->private_data=owner;
+  return owner;
+}
+/* Sets array to hold the buffers in data.   Empty buffers are passed as
+NULL only for the validity bitmap (first buffer).  Others are given one
+byte so consumers never see a NULL data buffer for zero length arrays.*/
+ExportedArray *init_array(ArrowArray *array, const int64_t length,
+  const int64_t null_count, vector<vector<uint8_t>>&& data,
+  const size_t nchildren)
+{
+  ExportedArray *owner=new ExportedArray();
+  owner->data=std::move(data);
+  for(size_t i=0;i<owner->data.size();++i)
+  {
+    if(owner->data[i].empty())
+    {
+      if(i==0)
+      {
+        owner->buffers.push_back(NULL);
+        continue;
+      }
+      owner->data[i].push_back(0);
+    }
+    owner->buffers.push_back(owner->data[i].data());
+  }
+  owner->children.resize(nchildren);
+  for(auto& c : owner->children) c.release=NULL;
+  for(auto& c : owner->children) owner->child_pointers.push_back(&c);
+  array->length=length;
+  array->null_count=null_count;
+  array->offset=0;
+  array->n_buffers=owner->buffers.size();
+  array->n_children=nchildren;
+  array->buffers=owner->buffers.data();
+  array->children= nchildren>0 ? owner->child_pointers.data() : NULL;
+  array->dictionary=NULL;
+  array->release=release_exported_array;
+  array->private_data=owner;
+  return owner;
+}
+/* Bitmaps of arrow are least significant bit first */
+inline void set_bit(vector<uint8_t>& bits, const size_t i)
+{
+  bits[i/8] |= static_cast<uint8_t>(1<<(i%8));
+}
+inline bool get_bit(const void *bits, const int64_t i)
+{
+  return (static_cast<const uint8_t*>(bits)[i/8] >> (i%8)) & 1;
+}
+/* Exports one fixed width column computed by f(member) */
+template <typename T, typename Function>
+  void export_fixed_column(const vector<TimeSeries>& member, const string& name,
+    const char *format, ArrowSchema *schema, ArrowArray *array, Function f)
+{
+  init_schema(schema,format,name,0);
+  vector<vector<uint8_t>> data(2);
+  data[1].resize(member.size()*sizeof(T));
+  T *p=reinterpret_cast<T*>(data[1].data());
+  for(size_t i=0;i<member.size();++i) p[i]=f(member[i]);
+  init_array(array,member.size(),0,std::move(data),0);
+}
+/* Exports one boolean column computed by f(member) */
+template <typename Function>
+  void export_boolean_column(const vector<TimeSeries>& member, const string& name,
+    ArrowSchema *schema, ArrowArray *array, Function f)
+{
+  init_schema(schema,"b",name,0);
+  vector<vector<uint8_t>> data(2);
+  data[1].resize((member.size()+7)/8,0);
+  for(size_t i=0;i<member.size();++i)
+    if(f(member[i])) set_bit(data[1],i);
+  init_array(array,member.size(),0,std::move(data),0);
+}
+/* Values of one Metadata column.  values[i] is NULL for members that do
+not define the key. */
+class MetadataColumn
+{
+public:
+  ArrowColumnType type;
+  vector<const boost::any*> values;
+};
+/* Exports the column of Metadata key */
+void export_metadata_column(const string& key, const MetadataColumn& column,
+  ArrowSchema *schema, ArrowArray *array)
+{
+  const ArrowColumnType t=column.type;
+  const vector<const boost::any*>& values=column.values;
+  init_schema(schema,arrow_format(t),key,0);
+  const size_t n=values.size();
+  vector<vector<uint8_t>> data(t==ArrowColumnType::Utf8 ? 3 : 2);
+  data[0].resize((n+7)/8,0);
+  int64_t null_count(0);
+  for(size_t i=0;i<n;++i)
+  {
+    if(values[i]==NULL)
+      ++null_count;
+    else
+      set_bit(data[0],i);
+  }
+  if(null_count==0) data[0].clear();
+  switch(t)
+  {
+    case ArrowColumnType::Boolean:
+      data[1].resize((n+7)/8,0);
+      for(size_t i=0;i<n;++i)
+        if(values[i]!=NULL && boost::any_cast<bool>(*values[i])) set_bit(data[1],i);
+      break;
+    case ArrowColumnType::Int32:
+    {
+      data[1].resize(n*sizeof(int32_t),0);
+      int32_t *p=reinterpret_cast<int32_t*>(data[1].data());
+      for(size_t i=0;i<n;++i)
+        if(values[i]!=NULL) p[i]=boost::any_cast<int>(*values[i]);
+      break;
+    }
+    case ArrowColumnType::Int64:
+    {
+      data[1].resize(n*sizeof(int64_t),0);
+      int64_t *p=reinterpret_cast<int64_t*>(data[1].data());
+      for(size_t i=0;i<n;++i)
+        if(values[i]!=NULL) p[i]=arrow_numeric_value<int64_t>(*values[i]);
+      break;
+    }
+    case ArrowColumnType::Float32:
+    {
+      data[1].resize(n*sizeof(float),0);
+      float *p=reinterpret_cast<float*>(data[1].data());
+      for(size_t i=0;i<n;++i)
+        if(values[i]!=NULL) p[i]=boost::any_cast<float>(*values[i]);
+      break;
+    }
+    case ArrowColumnType::Float64:
+    {
+      data[1].resize(n*sizeof(double),0);
+      double *p=reinterpret_cast<double*>(data[1].data());
+      for(size_t i=0;i<n;++i)
+        if(values[i]!=NULL) p[i]=arrow_numeric_value<double>(*values[i]);
+      break;
+    }
+    case ArrowColumnType::Utf8:
+    {
+      data[1].resize((n+1)*sizeof(int32_t));
+      int32_t *offsets=reinterpret_cast<int32_t*>(data[1].data());
+      size_t nbytes(0);
+      offsets[0]=0;
+      for(size_t i=0;i<n;++i)
+      {
+        if(values[i]!=NULL)
+        {
+          const string& s=boost::any_cast<const string&>(*values[i]);
+          data[2].insert(data[2].end(),s.begin(),s.end());
+          nbytes+=s.size();
+          if(nbytes>static_cast<size_t>(numeric_limits<int32_t>::max()))
+            throw MsPASSError("export_to_arrow:  total size of the strings for key="
+              +key+" is too large for an arrow utf8 column",ErrorSeverity::Invalid);
+        }
+        offsets[i+1]=static_cast<int32_t>(nbytes);
+      }
+      break;
+    }
+  }
+  init_array(array,n,null_count,std::move(data),0);
+}
+/* Exports the samples of all members as a list<double> column */
+void export_samples_column(const vector<TimeSeries>& member,
+  ArrowSchema *schema, ArrowArray *array)
+{
+  ExportedSchema *sowner=init_schema(schema,"+l",ARROW_SAMPLES_COLUMN,1);
+  init_schema(sowner->child_pointers[0],"g","item",0);
+  const size_t n=member.size();
+  vector<vector<uint8_t>> data(2);
+  data[1].resize((n+1)*sizeof(int32_t));
+  int32_t *offsets=reinterpret_cast<int32_t*>(data[1].data());
+  size_t nsamples(0);
+  offsets[0]=0;
+  for(size_t i=0;i<n;++i)
+  {
+    nsamples+=member[i].s.size();
+    if(nsamples>static_cast<size_t>(numeric_limits<int32_t>::max()))
+      throw MsPASSError("export_to_arrow:  total number of samples is too large for an arrow list column",
+        ErrorSeverity::Invalid);
+    offsets[i+1]=static_cast<int32_t>(nsamples);
+  }
+  ExportedArray *aowner=init_array(array,n,0,std::move(data),1);
+  vector<vector<uint8_t>> values(2);
+  values[1].resize(nsamples*sizeof(double));
+  uint8_t *p=values[1].data();
+  for(auto& d : member)
+  {
+    if(d.s.empty()) continue;
+    memcpy(p,d.s.data(),d.s.size()*sizeof(double));
+    p+=d.s.size()*sizeof(double);
+  }
+  init_array(aowner->child_pointers[0],nsamples,0,std::move(values),0);
+}
+/* Encodes key-value pairs in the format of the schema metadata field */
+string encode_schema_metadata(const vector<pair<string,string>>& kv)
+{
+  vector<char> buf;
+  BinaryOArchive ar(buf);
+  int32_t n=kv.size();
+  ar.write(&n,sizeof(int32_t));
+  for(auto& p : kv)
+  {
+    int32_t nkey=p.first.size();
+    int32_t nval=p.second.size();
+    ar.write(&nkey,sizeof(int32_t));
+    ar.write(p.first.data(),nkey);
+    ar.write(&nval,sizeof(int32_t));
+    ar.write(p.second.data(),nval);
+  }
+  return string(buf.begin(),buf.end());
+}
+/* The C data interface does not give the size of the schema metadata, so
+the counts and lengths it contains are checked against this limit rather
+than the true buffer size.  Arrow itself cannot write a schema larger
+than 2 GB. */
+const size_t MAX_SCHEMA_METADATA_SIZE(numeric_limits<int32_t>::max());
+/* Decodes the schema metadata field.  Every count and length is checked
+against the bytes remaining so a corrupt field throws instead of driving
+reads past the end of the buffer. */
+map<string,string> decode_schema_metadata(const char *md)
+{
+  map<string,string> result;
+  if(md==NULL) return result;
+  size_t remaining(MAX_SCHEMA_METADATA_SIZE);
+  auto read_length=[&md,&remaining]()
+  {
+    int32_t nbytes;
+    if(remaining<sizeof(int32_t))
+      throw MsPASSError("import_from_arrow:  schema metadata is truncated",
+        ErrorSeverity::Invalid);
+    memcpy(&nbytes,md,sizeof(int32_t));
+    md+=sizeof(int32_t);
+    remaining-=sizeof(int32_t);
+    if(nbytes<0)
+      throw MsPASSError("import_from_arrow:  schema metadata has a negative count or length",
+        ErrorSeverity::Invalid);
+    return static_cast<size_t>(nbytes);
+  };
+  auto read_string=[&md,&remaining,&read_length]()
+  {
+    const size_t nbytes=read_length();
+    if(nbytes>remaining)
+      throw MsPASSError("import_from_arrow:  schema metadata has a length past the end of the field",
+        ErrorSeverity::Invalid);
+    string str(md,nbytes);
+    md+=nbytes;
+    remaining-=nbytes;
+    return str;
+  };
+  const size_t n=read_length();
+  /* Each pair is at least two lengths */
+  if(n>remaining/(2*sizeof(int32_t)))
+    throw MsPASSError("import_from_arrow:  schema metadata has more pairs than fit in the field",
+      ErrorSeverity::Invalid);
+  for(size_t i=0;i<n;++i)
+  {
+    string key=read_string();
+    result[key]=read_string();
+  }
+  return result;
+}
+bool reserved_arrow_column(const string& key)
+{
+  return key==SEISMICMD_t0 || key==SEISMICMD_dt || key==SEISMICMD_npts
+    || key==ARROW_LIVE_COLUMN || key==ARROW_UTC_COLUMN
+    || key==ARROW_T0SHIFT_COLUMN || key==ARROW_SAMPLES_COLUMN;
+}
+}  // End anonymous namespace
+void export_to_arrow(const LoggingEnsemble<TimeSeries>& d,
+  ArrowSchema *schema, ArrowArray *array)
+{
+  const vector<TimeSeries>& member=d.member;
+  /* The keys starttime, delta, and npts are posted to Metadata by the
+  TimeSeries setters, so those columns are written from the attributes
+  and the Metadata copies are skipped. */
+  map<string,MetadataColumn> columns;
+  for(size_t i=0;i<member.size();++i)
+  {
+    const TimeSeries& m=member[i];
+    for(auto mdptr=m.begin();mdptr!=m.end();++mdptr)
+    {
+      const string& key=mdptr->first;
+      if(key==SEISMICMD_t0 || key==SEISMICMD_dt || key==SEISMICMD_npts)
+        continue;
+      if(reserved_arrow_column(key))
+        throw MsPASSError("export_to_arrow:  Metadata key="+key
+          +" conflicts with a reserved column name",ErrorSeverity::Invalid);
+      ArrowColumnType t=arrow_column_type(mdptr->second,key);
+      auto cptr=columns.find(key);
+      if(cptr==columns.end())
+      {
+        cptr=columns.emplace_hint(cptr,key,MetadataColumn());
+        cptr->second.type=t;
+        cptr->second.values.resize(member.size(),NULL);
+      }
+      else
+        cptr->second.type=merge_column_types(cptr->second.type,t,key);
+      cptr->second.values[i]=&(mdptr->second);
+    }
+  }
+  const size_t nfixed(6);
+  const size_t ncolumns=nfixed+columns.size()+1;
+  vector<char> mdbuf;
+  BinaryOArchive ar(mdbuf);
+  serialize_metadata_binary(d,ar);
+  vector<pair<string,string>> kv;
+  kv.push_back(make_pair(ARROW_ENSEMBLE_METADATA_KEY,string(mdbuf.begin(),mdbuf.end())));
+  kv.push_back(make_pair(ARROW_ENSEMBLE_LIVE_KEY,string(d.live() ? "true" : "false")));
+  ExportedSchema *sowner=init_schema(schema,"+s","",ncolumns);
+  schema->flags=0;
+  sowner->metadata=encode_schema_metadata(kv);
+  schema->metadata=sowner->metadata.c_str();
+  ExportedArray *aowner=init_array(array,member.size(),0,
+    vector<vector<uint8_t>>(1),ncolumns);
+  /* The consumer never sees a partial result.  Columns not yet built
+  have a NULL release callback and are skipped by the release functions.*/
+  try{
+    vector<ArrowSchema*>& cs=sowner->child_pointers;
+    vector<ArrowArray*>& ca=aowner->child_pointers;
+    export_fixed_column<double>(member,SEISMICMD_t0,"g",cs[0],ca[0],
+      [](const TimeSeries& m){return m.t0();});
+    export_fixed_column<double>(member,SEISMICMD_dt,"g",cs[1],ca[1],
+      [](const TimeSeries& m){return m.dt();});
+    export_fixed_column<int64_t>(member,SEISMICMD_npts,"l",cs[2],ca[2],
+      [](const TimeSeries& m){return static_cast<int64_t>(m.npts());});
+    export_boolean_column(member,ARROW_LIVE_COLUMN,cs[3],ca[3],
+      [](const TimeSeries& m){return m.live();});
+    export_boolean_column(member,ARROW_UTC_COLUMN,cs[4],ca[4],
+      [](const TimeSeries& m){return m.time_is_UTC();});
+    /* t0shift is null when the shift is not valid */
+    export_fixed_column<double>(member,ARROW_T0SHIFT_COLUMN,"g",cs[5],ca[5],
+      [](const TimeSeries& m){return m.shifted() ? m.time_reference() : 0.0;});
+    ExportedArray *t0shift=static_cast<ExportedArray*>(ca[5]->private_data);
+    t0shift->data[0].resize((member.size()+7)/8,0);
+    int64_t nshift(0);
+    for(size_t i=0;i<member.size();++i)
+    {
+      if(member[i].shifted())
+      {
+        set_bit(t0shift->data[0],i);
+        ++nshift;
+      }
+    }
+    if(nshift<static_cast<int64_t>(member.size()))
+    {
+      t0shift->buffers[0]=t0shift->data[0].data();
+      ca[5]->null_count=member.size()-nshift;
+    }
+    size_t k(nfixed);
+    for(auto& c : columns)
+    {
+      export_metadata_column(c.first,c.second,cs[k],ca[k]);
+      ++k;
+    }
+    export_samples_column(member,cs[k],ca[k]);
+  }catch(...)
+  {
+    schema->release(schema);
+    array->release(array);
+    throw;
+  }
+}
+
+namespace {
+/* Read access to one child column of an imported struct array.  The
+offset of the parent applies to the children as well as their own. */
+class ArrowColumnReader
+{
+public:
+  const ArrowSchema *schema;
+  const ArrowArray *array;
+  int64_t offset;
+  string name;
+  string format;
+  ArrowColumnReader(const ArrowSchema *s, const ArrowArray *a,
+    const int64_t parent_offset)
+    : schema(s),array(a),offset(parent_offset+a->offset),
+      name(s->name==NULL ? "" : s->name),format(s->format)
+  {
+    size_t nbuffers(2);
+    if(format=="u" || format=="U") nbuffers=3;
+    if(format=="+l" || format=="+L")
+    {
+      if(a->n_children!=1 || s->n_children!=1)
+        throw MsPASSError("import_from_arrow:  list column "+name
+          +" does not have one child array",ErrorSeverity::Invalid);
+    }
+    if(a->n_buffers!=static_cast<int64_t>(nbuffers))
+      throw MsPASSError("import_from_arrow:  column "+name+" with format "
+        +format+" has the wrong number of buffers",ErrorSeverity::Invalid);
+  };
+  bool valid(const int64_t i) const
+  {
+    if(array->null_count==0 || array->buffers[0]==NULL) return true;
+    return get_bit(array->buffers[0],offset+i);
+  };
+  template <typename T> T value(const int64_t i) const
+  {
+    return static_cast<const T*>(array->buffers[1])[offset+i];
+  };
+  bool bool_value(const int64_t i) const
+  {
+    return get_bit(array->buffers[1],offset+i);
+  };
+  double double_value(const int64_t i) const
+  {
+    if(format=="f") return this->value<float>(i);
+    return this->value<double>(i);
+  };
+  string string_value(const int64_t i) const
+  {
+    const char *chars=static_cast<const char*>(array->buffers[2]);
+    if(format=="U")
+    {
+      const int64_t *offsets=static_cast<const int64_t*>(array->buffers[1]);
+      return string(chars+offsets[offset+i],offsets[offset+i+1]-offsets[offset+i]);
+    }
+    const int32_t *offsets=static_cast<const int32_t*>(array->buffers[1]);
+    return string(chars+offsets[offset+i],offsets[offset+i+1]-offsets[offset+i]);
+  };
+  /* Copies the list of row i to d.s.  Only valid for the samples column. */
+  void load_samples(const int64_t i, TimeSeries& d) const
+  {
+    int64_t start,end;
+    if(format=="+L")
+    {
+      const int64_t *offsets=static_cast<const int64_t*>(array->buffers[1]);
+      start=offsets[offset+i];
+      end=offsets[offset+i+1];
+    }
+    else
+    {
+      const int32_t *offsets=static_cast<const int32_t*>(array->buffers[1]);
+      start=offsets[offset+i];
+      end=offsets[offset+i+1];
+    }
+    const ArrowArray *values=array->children[0];
+    d.set_npts(end-start);
+    if(end>start)
+      memcpy(d.s.data(),static_cast<const double*>(values->buffers[1])
+        +values->offset+start,(end-start)*sizeof(double));
+  };
+  /* Posts the value of row i to the Metadata of d */
+  void load_metadata(const int64_t i, TimeSeries& d) const
+  {
+    if(!this->valid(i)) return;
+    switch(format[0])
+    {
+      case 'b':
+        d.put(name,this->bool_value(i));
+        break;
+      case 'c':
+        d.put(name,static_cast<int>(this->value<int8_t>(i)));
+        break;
+      case 's':
+        d.put(name,static_cast<int>(this->value<int16_t>(i)));
+        break;
+      case 'i':
+        d.put(name,static_cast<int>(this->value<int32_t>(i)));
+        break;
+      case 'l':
+        d.put(name,static_cast<long>(this->value<int64_t>(i)));
+        break;
+      case 'C':
+        d.put(name,static_cast<int>(this->value<uint8_t>(i)));
+        break;
+      case 'S':
+        d.put(name,static_cast<int>(this->value<uint16_t>(i)));
+        break;
+      case 'I':
+        d.put(name,static_cast<long>(this->value<uint32_t>(i)));
+        break;
+      case 'f':
+        d.put(name,this->value<float>(i));
+        break;
+      case 'g':
+        d.put(name,this->value<double>(i));
+        break;
+      default:
+        d.put(name,this->string_value(i));
+    }
+  };
+};
+/* Formats of the columns import_from_arrow can load into Metadata */
+bool metadata_column_format(const string& format)
+{
+  return format=="b" || format=="c" || format=="s" || format=="i"
+    || format=="l" || format=="C" || format=="S" || format=="I"
+    || format=="f" || format=="g" || format=="u" || format=="U";
+}
+}  // End anonymous namespace
+LoggingEnsemble<TimeSeries> import_from_arrow(const ArrowSchema *schema,
+  const ArrowArray *array)
+{
+  if(schema->release==NULL || array->release==NULL)
+    throw MsPASSError("import_from_arrow:  schema or array was already released",
+      ErrorSeverity::Invalid);
+  if(string(schema->format)!="+s")
+    throw MsPASSError("import_from_arrow:  input is not a struct array (record batch)",
+      ErrorSeverity::Invalid);
+  if(schema->n_children!=array->n_children)
+    throw MsPASSError("import_from_arrow:  schema and array have different numbers of columns",
+      ErrorSeverity::Invalid);
+  if(array->null_count!=0)
+    throw MsPASSError("import_from_arrow:  input has null rows",
+      ErrorSeverity::Invalid);
+  const int64_t n=array->length;
+  vector<ArrowColumnReader> metadata_columns;
+  const ArrowColumnReader *samples(NULL),*t0(NULL),*dt(NULL),*live(NULL),
+    *utc(NULL),*t0shift(NULL);
+  vector<ArrowColumnReader> columns;
+  columns.reserve(schema->n_children);
+  for(int64_t k=0;k<schema->n_children;++k)
+    columns.push_back(ArrowColumnReader(schema->children[k],array->children[k],
+      array->offset));
+  for(auto& c : columns)
+  {
+    if(c.name==ARROW_SAMPLES_COLUMN)
+    {
+      if(!(c.format=="+l" || c.format=="+L")
+          || string(c.schema->children[0]->format)!="g")
+        throw MsPASSError("import_from_arrow:  samples column must have type list<double>",
+          ErrorSeverity::Invalid);
+      if(c.array->null_count!=0 || c.array->children[0]->null_count!=0)
+        throw MsPASSError("import_from_arrow:  samples column cannot have null values",
+          ErrorSeverity::Invalid);
+      samples=&c;
+    }
+    else if(c.name==SEISMICMD_npts)
+      continue;
+    else if(c.name==SEISMICMD_t0 || c.name==SEISMICMD_dt
+         || c.name==ARROW_T0SHIFT_COLUMN)
+    {
+      if(!(c.format=="g" || c.format=="f"))
+        throw MsPASSError("import_from_arrow:  column "+c.name
+          +" must have a floating point type",ErrorSeverity::Invalid);
+      if(c.name==SEISMICMD_t0)
+        t0=&c;
+      else if(c.name==SEISMICMD_dt)
+        dt=&c;
+      else
+        t0shift=&c;
+    }
+    else if(c.name==ARROW_LIVE_COLUMN || c.name==ARROW_UTC_COLUMN)
+    {
+      if(c.format!="b")
+        throw MsPASSError("import_from_arrow:  column "+c.name
+          +" must have boolean type",ErrorSeverity::Invalid);
+      if(c.name==ARROW_LIVE_COLUMN)
+        live=&c;
+      else
+        utc=&c;
+    }
+    else if(metadata_column_format(c.format))
+      metadata_columns.push_back(c);
+    else
+      throw MsPASSError("import_from_arrow:  column "+c.name+" has format "
+        +c.format+" that cannot be loaded to Metadata",ErrorSeverity::Invalid);
+  }
+  if(samples==NULL)
+    throw MsPASSError("import_from_arrow:  input has no "+ARROW_SAMPLES_COLUMN
+      +" column",ErrorSeverity::Invalid);
+  LoggingEnsemble<TimeSeries> result;
+  map<string,string> kv=decode_schema_metadata(schema->metadata);
+  auto kvptr=kv.find(ARROW_ENSEMBLE_METADATA_KEY);
+  if(kvptr!=kv.end())
+  {
+    BinaryIArchive ar(kvptr->second.data(),kvptr->second.size());
+    restore_metadata_binary(ar,result);
+  }
+  result.member.resize(n);
+  for(int64_t i=0;i<n;++i)
+  {
+    TimeSeries& d=result.member[i];
+    for(auto& c : metadata_columns) c.load_metadata(i,d);
+    if(dt!=NULL && dt->valid(i)) d.set_dt(dt->double_value(i));
+    if(t0!=NULL && t0->valid(i)) d.set_t0(t0->double_value(i));
+    if(utc!=NULL && utc->valid(i) && utc->bool_value(i))
+      d.set_tref(TimeReferenceType::UTC);
+    if(t0shift!=NULL && t0shift->valid(i))
+      d.force_t0_shift(t0shift->double_value(i));
+    samples->load_samples(i,d);
+    if(live==NULL || (live->valid(i) && live->bool_value(i)))
+      d.set_live();
+  }
+  /* set_live validates the members so it must follow the loop */
+  kvptr=kv.find(ARROW_ENSEMBLE_LIVE_KEY);
+  if(kvptr==kv.end() || kvptr->second=="true") result.set_live();
+  return result;
+}
+}  // End namespace mspass::seismic
@@ -0,0 +1,376 @@
+#include <string.h>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/BinaryArchive.h"
+#include "mspass/seismic/BinarySerialization.h"
+namespace mspass::seismic
+{
+using namespace std;
+using namespace mspass::utility;
+
+BinarySerializationHeader::BinarySerializationHeader()
+  : version(BINARY_SERIALIZATION_VERSION),type(SerializedDataType::timeseries),
+    flags(0),npts(0),bts_size(0),md_size(0),history_size(0),sample_size(0)
+{
+}
+namespace {
+/* File scope functions shared by the TimeSeries and Seismogram versions */
+void write_binary_header(const BinarySerializationHeader& h, char *p)
+{
+  vector<char> buf;
+  buf.reserve(BINARY_SERIALIZATION_HEADER_SIZE);
+  BinaryOArchive ar(buf);
+  ar.write(BINARY_SERIALIZATION_MAGIC,4);
+  uint32_t reserved(0);
+  ar << h.version << h.type << h.flags << reserved << h.npts << h.bts_size
+     << h.md_size << h.history_size << h.sample_size;
+  memcpy(p,buf.data(),BINARY_SERIALIZATION_HEADER_SIZE);
+}
+/* Reads the fixed header at buf.  Throws if n is smaller than the header,
+the magic string does not match, or the version is not supported. */
+BinarySerializationHeader read_binary_header(const char *buf, const size_t n)
+{
+  if(n<BINARY_SERIALIZATION_HEADER_SIZE)
+    throw MsPASSError("read_binary_header:  buffer is smaller than the header size",
+      ErrorSeverity::Invalid);
+  if(memcmp(buf,BINARY_SERIALIZATION_MAGIC,4)!=0)
+    throw MsPASSError("read_binary_header:  magic string mismatch - data are not in the mspass binary format",
+      ErrorSeverity::Invalid);
+  BinaryIArchive ar(buf+4,BINARY_SERIALIZATION_HEADER_SIZE-4);
+  BinarySerializationHeader h;
+  uint32_t reserved;
+  ar >> h.version >> h.type >> h.flags >> reserved >> h.npts >> h.bts_size
+     >> h.md_size >> h.history_size >> h.sample_size;
+  if(h.version!=BINARY_SERIALIZATION_VERSION)
+    throw MsPASSError("read_binary_header:  unsupported format version "
+      + to_string(h.version),ErrorSeverity::Invalid);
+  /* Sizes are compared one at a time to avoid overflow with corrupted data */
+  size_t nleft=n-BINARY_SERIALIZATION_HEADER_SIZE;
+  for(auto bsize : {h.bts_size,h.md_size,h.history_size,h.sample_size})
+  {
+    if(bsize>nleft)
+      throw MsPASSError("read_binary_header:  block sizes exceed the buffer size - serialized data are truncated",
+        ErrorSeverity::Invalid);
+    nleft -= bsize;
+  }
+  return h;
+}
+/* Writes the Metadata and history blocks and the samples.  The caller
+has already appended the header placeholder and the BasicTimeSeries block.
+The header is written last when all block sizes are known. */
+template <typename Tdata> size_t finish_serialize(const Tdata& d,
+  BinarySerializationHeader& h, const size_t hpos, const double *samples,
+  const size_t nsamples, vector<char>& buf)
+{
+  BinaryOArchive ar(buf);
+  size_t pos=buf.size();
+  h.bts_size=pos-hpos-BINARY_SERIALIZATION_HEADER_SIZE;
+  serialize_metadata_binary(dynamic_cast<const Metadata&>(d),ar);
+  h.md_size=buf.size()-pos;
+  pos=buf.size();
+  ar << dynamic_cast<const ProcessingHistory&>(d);
+  h.history_size=buf.size()-pos;
+  if(h.flags & BINARY_SAMPLES_OUT_OF_BAND)
+    h.sample_size=0;
+  else
+  {
+    h.sample_size=sizeof(double)*nsamples;
+    ar.write(samples,h.sample_size);
+  }
+  write_binary_header(h,&(buf[hpos]));
+  return buf.size()-hpos;
+}
+}  // End anonymous namespace
+size_t serialize_binary(const TimeSeries& d, vector<char>& buf,
+  const bool samples_out_of_band)
+{
+  BinarySerializationHeader h;
+  h.type=SerializedDataType::timeseries;
+  if(samples_out_of_band) h.flags |= BINARY_SAMPLES_OUT_OF_BAND;
+  h.npts=d.npts();
+  if(d.s.size()!=d.npts())
+    throw MsPASSError("serialize_binary:  TimeSeries npts does not match the size of the sample vector",
+      ErrorSeverity::Invalid);
+  size_t hpos=buf.size();
+  buf.resize(hpos+BINARY_SERIALIZATION_HEADER_SIZE);
+  BinaryOArchive ar(buf);
+  ar << dynamic_cast<const BasicTimeSeries&>(d);
+  return finish_serialize(d,h,hpos,d.s.data(),d.s.size(),buf);
+}
+size_t serialize_binary(const Seismogram& d, vector<char>& buf,
+  const bool samples_out_of_band)
+{
+  BinarySerializationHeader h;
+  h.type=SerializedDataType::seismogram;
+  if(samples_out_of_band) h.flags |= BINARY_SAMPLES_OUT_OF_BAND;
+  h.npts=d.npts();
+  if(d.u.columns()!=d.npts())
+    throw MsPASSError("serialize_binary:  Seismogram npts does not match the number of columns of the u matrix",
+      ErrorSeverity::Invalid);
+  size_t hpos=buf.size();
+  buf.resize(hpos+BINARY_SERIALIZATION_HEADER_SIZE);
+  BinaryOArchive ar(buf);
+  ar << dynamic_cast<const BasicTimeSeries&>(d);
+  ar << d.cardinal() << d.orthogonal();
+  dmatrix tm=d.get_transformation_matrix();
+  for(int i=0;i<3;++i)
+    for(int j=0;j<3;++j) ar << tm(i,j);
+  SampleBufferView sb=sample_buffer(d);
+  return finish_serialize(d,h,hpos,reinterpret_cast<const double*>(sb.first),
+    sb.second/sizeof(double),buf);
+}
+SampleBufferView sample_buffer(const TimeSeries& d)
+{
+  return SampleBufferView(reinterpret_cast<const char*>(d.s.data()),
+    sizeof(double)*d.s.size());
+}
+SampleBufferView sample_buffer(const Seismogram& d)
+{
+  size_t ns=3*d.u.columns();
+  if(ns==0) return SampleBufferView(NULL,0);
+  return SampleBufferView(reinterpret_cast<const char*>(d.u.get_address(0,0)),
+    sizeof(double)*ns);
+}
+namespace {
+/* Verifies the type and sizes recorded in the header for a data type with
+ncomponents samples per time step.  Returns the location of the samples,
+which is either inside buf or the out-of-band buffer oob. */
+const char *check_header(const BinarySerializationHeader& h, const char *buf,
+  const SerializedDataType type, const size_t ncomponents,
+  const SampleBufferView oob, const string fname)
+{
+  if(h.type!=type)
+    throw MsPASSError(fname+":  serialized data hold a different data type",
+      ErrorSeverity::Invalid);
+  size_t nbytes=sizeof(double)*ncomponents*h.npts;
+  if(h.flags & BINARY_SAMPLES_OUT_OF_BAND)
+  {
+    if(h.sample_size!=0 || oob.second!=nbytes || (nbytes>0 && oob.first==NULL))
+      throw MsPASSError(fname+":  out-of-band sample buffer is missing or does not match npts",
+        ErrorSeverity::Invalid);
+    return oob.first;
+  }
+  if(h.sample_size!=nbytes)
+    throw MsPASSError(fname+":  sample block size does not match npts - serialized data are corrupted",
+      ErrorSeverity::Invalid);
+  return buf+BINARY_SERIALIZATION_HEADER_SIZE+h.bts_size+h.md_size+h.history_size;
+}
+/* Restores the Metadata, history, and sample blocks into d.  p is the
+first byte of the Metadata block and src the location of the nbytes of
+samples copied to samples. */
+template <typename Tdata> void restore_common(const char *p,
+  const BinarySerializationHeader& h, Tdata& d, const char *src, double *samples,
+  const size_t nbytes)
+{
+  Metadata& md=dynamic_cast<Metadata&>(d);
+  md=Metadata();
+  BinaryIArchive armd(p,h.md_size);
+  restore_metadata_binary(armd,md);
+  p += h.md_size;
+  BinaryIArchive arhis(p,h.history_size);
+  arhis >> dynamic_cast<ProcessingHistory&>(d);
+  if(nbytes>0) memcpy(samples,src,nbytes);
+}
+}  // End anonymous namespace
+void deserialize_binary(const char *buf, const size_t n, TimeSeries& d,
+  size_t *nused, const SampleBufferView oob)
+{
+  BinarySerializationHeader h=read_binary_header(buf,n);
+  const char *src=check_header(h,buf,SerializedDataType::timeseries,1,oob,
+    "deserialize_TimeSeries");
+  /* All blocks are restored directly into d */
+  const char *p=buf+BINARY_SERIALIZATION_HEADER_SIZE;
+  BinaryIArchive arbts(p,h.bts_size);
+  arbts >> dynamic_cast<BasicTimeSeries&>(d);
+  d.s.resize(h.npts);
+  restore_common(p+h.bts_size,h,d,src,d.s.data(),sizeof(double)*h.npts);
+  if(nused!=NULL) *nused=h.total_size();
+}
+void deserialize_binary(const char *buf, const size_t n, Seismogram& d,
+  size_t *nused, const SampleBufferView oob)
+{
+  BinarySerializationHeader h=read_binary_header(buf,n);
+  const char *src=check_header(h,buf,SerializedDataType::seismogram,3,oob,
+    "deserialize_Seismogram");
+  const char *p=buf+BINARY_SERIALIZATION_HEADER_SIZE;
+  BinaryIArchive arbts(p,h.bts_size);
+  BasicTimeSeries bts;
+  bool cardinal,orthogonal;
+  dmatrix tm(3,3);
+  arbts >> bts >> cardinal >> orthogonal;
+  for(int i=0;i<3;++i)
+    for(int j=0;j<3;++j) arbts >> tm(i,j);
+  /* The constructor is the only way to set cardinal, orthogonal, and the
+  transformation matrix without touching Metadata.  It is called with empty
+  Metadata, history, and sample data that are then restored in place. */
+  d=Seismogram(bts,Metadata(),ProcessingHistory(),cardinal,orthogonal,tm,dmatrix());
+  double *samples(NULL);
+  if(h.npts>0)
+  {
+    d.u=dmatrix(3,h.npts);
+    samples=d.u.get_address(0,0);
+  }
+  restore_common(p+h.bts_size,h,d,src,samples,3*sizeof(double)*h.npts);
+  if(nused!=NULL) *nused=h.total_size();
+}
+TimeSeries deserialize_TimeSeries(const char *buf, const size_t n, size_t *nused)
+{
+  TimeSeries d;
+  deserialize_binary(buf,n,d,nused);
+  return d;
+}
+Seismogram deserialize_Seismogram(const char *buf, const size_t n, size_t *nused)
+{
+  Seismogram d;
+  deserialize_binary(buf,n,d,nused);
+  return d;
+}
+
+BinaryEnsembleHeader::BinaryEnsembleHeader()
+  : version(BINARY_SERIALIZATION_VERSION),type(SerializedDataType::timeseries),
+    flags(0),nmembers(0),md_size(0),elog_size(0),table_size(0),member_size(0)
+{
+}
+namespace {
+void write_binary_ensemble_header(const BinaryEnsembleHeader& h, char *p)
+{
+  vector<char> buf;
+  buf.reserve(BINARY_SERIALIZATION_HEADER_SIZE);
+  BinaryOArchive ar(buf);
+  ar.write(BINARY_ENSEMBLE_MAGIC,4);
+  uint32_t reserved(0);
+  ar << h.version << h.type << h.flags << reserved << h.nmembers << h.md_size
+     << h.elog_size << h.table_size << h.member_size;
+  memcpy(p,buf.data(),BINARY_SERIALIZATION_HEADER_SIZE);
+}
+/* Ensemble version of read_binary_header.  Also throws if the offset
+table size does not match the number of members. */
+BinaryEnsembleHeader read_binary_ensemble_header(const char *buf, const size_t n)
+{
+  if(n<BINARY_SERIALIZATION_HEADER_SIZE)
+    throw MsPASSError("read_binary_ensemble_header:  buffer is smaller than the header size",
+      ErrorSeverity::Invalid);
+  if(memcmp(buf,BINARY_ENSEMBLE_MAGIC,4)!=0)
+    throw MsPASSError("read_binary_ensemble_header:  magic string mismatch - data are not an ensemble in the mspass binary format",
+      ErrorSeverity::Invalid);
+  BinaryIArchive ar(buf+4,BINARY_SERIALIZATION_HEADER_SIZE-4);
+  BinaryEnsembleHeader h;
+  uint32_t reserved;
+  ar >> h.version >> h.type >> h.flags >> reserved >> h.nmembers >> h.md_size
+     >> h.elog_size >> h.table_size >> h.member_size;
+  if(h.version!=BINARY_SERIALIZATION_VERSION)
+    throw MsPASSError("read_binary_ensemble_header:  unsupported format version "
+      + to_string(h.version),ErrorSeverity::Invalid);
+  size_t nleft=n-BINARY_SERIALIZATION_HEADER_SIZE;
+  for(auto bsize : {h.md_size,h.elog_size,h.table_size,h.member_size})
+  {
+    if(bsize>nleft)
+      throw MsPASSError("read_binary_ensemble_header:  block sizes exceed the buffer size - serialized data are truncated",
+        ErrorSeverity::Invalid);
+    nleft -= bsize;
+  }
+  if(h.table_size!=sizeof(uint64_t)*h.nmembers)
+    throw MsPASSError("read_binary_ensemble_header:  offset table size does not match the number of members",
+      ErrorSeverity::Invalid);
+  return h;
+}
+template <typename Tdata> size_t serialize_ensemble(const LoggingEnsemble<Tdata>& d,
+  const SerializedDataType type, vector<char>& buf, const bool samples_out_of_band)
+{
+  BinaryEnsembleHeader h;
+  h.type=type;
+  h.flags = d.live() ? 1 : 0;
+  if(samples_out_of_band) h.flags |= BINARY_SAMPLES_OUT_OF_BAND;
+  h.nmembers=d.member.size();
+  size_t hpos=buf.size();
+  buf.resize(hpos+BINARY_SERIALIZATION_HEADER_SIZE);
+  BinaryOArchive ar(buf);
+  size_t pos=buf.size();
+  serialize_metadata_binary(dynamic_cast<const Metadata&>(d),ar);
+  h.md_size=buf.size()-pos;
+  pos=buf.size();
+  ar << d.elog;
+  h.elog_size=buf.size()-pos;
+  /* The offset table is filled in as the members are written */
+  size_t tpos=buf.size();
+  h.table_size=sizeof(uint64_t)*h.nmembers;
+  buf.resize(tpos+h.table_size);
+  size_t mpos=buf.size();
+  for(size_t i=0;i<d.member.size();++i)
+  {
+    uint64_t offset=buf.size()-mpos;
+    memcpy(&(buf[tpos+i*sizeof(uint64_t)]),&offset,sizeof(uint64_t));
+    serialize_binary(d.member[i],buf,samples_out_of_band);
+  }
+  h.member_size=buf.size()-mpos;
+  write_binary_ensemble_header(h,&(buf[hpos]));
+  return buf.size()-hpos;
+}
+}  // End anonymous namespace
+size_t serialize_binary(const LoggingEnsemble<TimeSeries>& d, vector<char>& buf,
+  const bool samples_out_of_band)
+{
+  return serialize_ensemble(d,SerializedDataType::timeseries,buf,samples_out_of_band);
+}
+size_t serialize_binary(const LoggingEnsemble<Seismogram>& d, vector<char>& buf,
+  const bool samples_out_of_band)
+{
+  return serialize_ensemble(d,SerializedDataType::seismogram,buf,samples_out_of_band);
+}
+namespace {
+template <typename Tdata> LoggingEnsemble<Tdata> deserialize_ensemble(const char *buf,
+  const size_t n, const SerializedDataType type, size_t *nused,
+  const vector<SampleBufferView>& samples)
+{
+  BinaryEnsembleHeader h=read_binary_ensemble_header(buf,n);
+  if(h.type!=type)
+    throw MsPASSError("deserialize_ensemble:  serialized data hold an ensemble of a different data type",
+      ErrorSeverity::Invalid);
+  bool oob=(h.flags & BINARY_SAMPLES_OUT_OF_BAND)!=0;
+  if(oob && samples.size()!=h.nmembers)
+    throw MsPASSError("deserialize_ensemble:  number of out-of-band sample buffers does not match the number of members",
+      ErrorSeverity::Invalid);
+  LoggingEnsemble<Tdata> result;
+  const char *p=buf+BINARY_SERIALIZATION_HEADER_SIZE;
+  BinaryIArchive armd(p,h.md_size);
+  restore_metadata_binary(armd,dynamic_cast<Metadata&>(result));
+  p += h.md_size;
+  BinaryIArchive arelog(p,h.elog_size);
+  arelog >> result.elog;
+  p += h.elog_size;
+  const char *table=p;
+  const char *members=p+h.table_size;
+  /* Members are built in place.  The reserve is required so the vector
+  is never reallocated (a reallocation would copy every member). */
+  result.member.reserve(h.nmembers);
+  for(uint64_t i=0;i<h.nmembers;++i)
+  {
+    uint64_t offset;
+    memcpy(&offset,table+i*sizeof(uint64_t),sizeof(uint64_t));
+    if(offset>h.member_size)
+      throw MsPASSError("deserialize_ensemble:  member offset is outside the member blocks - serialized data are corrupted",
+        ErrorSeverity::Invalid);
+    result.member.emplace_back();
+    deserialize_binary(members+offset,h.member_size-offset,result.member.back(),
+      NULL,oob ? samples[i] : SampleBufferView(NULL,0));
+  }
+  if(h.live())
+    result.set_live();
+  else
+    result.kill();
+  if(nused!=NULL) *nused=h.total_size();
+  return result;
+}
+}  // End anonymous namespace
+LoggingEnsemble<TimeSeries> deserialize_TimeSeriesEnsemble(const char *buf,
+  const size_t n, size_t *nused, const vector<SampleBufferView>& samples)
+{
+  return deserialize_ensemble<TimeSeries>(buf,n,SerializedDataType::timeseries,
+    nused,samples);
+}
+LoggingEnsemble<Seismogram> deserialize_SeismogramEnsemble(const char *buf,
+  const size_t n, size_t *nused, const vector<SampleBufferView>& samples)
+{
+  return deserialize_ensemble<Seismogram>(buf,n,SerializedDataType::seismogram,
+    nused,samples);
+}
+}  // End namespace mspass::seismic
@@ -1,5 +1,6 @@
 #include <float.h>
 #include <math.h>
+#include <algorithm>
 #include <sstream>
 #include <boost/any.hpp>
 #include <pybind11/pybind11.h>
@@ -9,6 +10,7 @@
 #include "mspass/seismic/CoreSeismogram.h"
 #include "mspass/utility/MsPASSError.h"
 #include "mspass/utility/SphericalCoordinate.h"
+#include "mspass/utility/sample_kernels.h"
 
 
 namespace mspass::seismic
@@ -16,6 +18,13 @@ namespace mspass::seismic
 using namespace std;
 using namespace mspass::utility;
 namespace py=pybind11;
+/* Hard coded aliases of the keys posted by the set methods.   They are
+key handles because the is_defined test runs on every set call. */
+const MetadataKey<double> DT_ALIASES[]={MetadataKey<double>("dt")};
+const MetadataKey<double> T0_ALIASES[]={MetadataKey<double>("t0"),
+  MetadataKey<double>("time")};
+const MetadataKey<long> NPTS_ALIASES[]={MetadataKey<long>("nsamp"),
+  MetadataKey<long>("wfdisc.nsamp")};
 /*
  *  Start with all the constructors.
  *
@@ -916,17 +925,16 @@ CoreSeismogram& CoreSeismogram::operator*=(const double scale)
 {
   /* do nothing to empty data or data marked dead*/
   if((this->npts()==0) || (this->dead())) return(*this);
-  /* We can use this dscal blas function because dmatrix puts all the data
-  in a continguous block. Beware if there is am implementation change for
-  the matrix data*/
+  /* This works because dmatrix puts all the data in a continguous block.
+  Beware if there is am implementation change for the matrix data*/
   double *ptr=this->u.get_address(0,0);
-  dscal(3*this->npts(),scale,ptr,1);
+  mspass::utility::scale_samples(ptr,3*this->npts(),scale);
   return(*this);
 }
 CoreSeismogram& CoreSeismogram::operator+=(const CoreSeismogram& d)
 {
     int i,iend,jend;
-    size_t j,i0,j0;
+    size_t i0,j0;
     // Silently do nothing if d or lhs is marked dead
     if( d.dead() || (this->dead()) ) return(*this);
     // Silently do nothing if d does not overlap with data to contain sum
@@ -957,24 +965,30 @@ CoreSeismogram& CoreSeismogram::operator+=(const CoreSeismogram& d)
     {
       jend=this->npts()-1;
     }
-    for(i=i0,j=j0; i<=iend && j<=jend; ++i,++j)
+    /* The ranges computed above are inside both matrices.  dmatrix
+    columns are contiguous so the overlap is one block of 3*nsum samples
+    in each matrix.  Get the access for this first so it is also correct
+    for d when d is *this. */
+    const int nsum=std::min(iend-static_cast<int>(i0),jend-static_cast<int>(j0))+1;
+    if(nsum>0)
     {
-        this->u(0,j)+=d.u(0,i);
-        this->u(1,j)+=d.u(1,i);
-        this->u(2,j)+=d.u(2,i);
+      UncheckedMatrix<double> sum=this->u.unchecked();
+      UncheckedMatrix<const double> dterm=d.u.unchecked();
+      mspass::utility::add_samples(sum.column(j0),dterm.column(i0),3*nsum);
     }
     return(*this);
 }
 /* IMPORTANT:  this code is absolutely identical to that for operator+=
-except the += in the last loop becomes -=.  Any changes in operator+=
+except add_samples becomes subtract_samples.  Any changes in operator+=
 must have exactly the same change here (other than a message with a
 tag to the function)*/
 CoreSeismogram& CoreSeismogram::operator-=(const CoreSeismogram& data)
 {
     int i,iend,jend;
-    size_t j,i0,j0;
-    // Sun's compiler complains about const objects without this.
-    CoreSeismogram& d=const_cast<CoreSeismogram&>(data);
+    size_t i0,j0;
+    /* d must stay const.   Non-const access to its samples would copy
+    them if they are shared with another object. */
+    const CoreSeismogram& d=data;
     // Silently do nothing if d is marked dead
     if(!d.mlive) return(*this);
     // Silently do nothing if d does not overlap with data to contain sum
@@ -1005,11 +1019,16 @@ CoreSeismogram& CoreSeismogram::operator-=(const CoreSeismogram& data)
     {
       jend=this->npts()-1;
     }
-    for(i=i0,j=j0; i<=iend && j<=jend; ++i,++j)
+    /* The ranges computed above are inside both matrices.  dmatrix
+    columns are contiguous so the overlap is one block of 3*nsum samples
+    in each matrix.  Get the access for this first so it is also correct
+    for d when d is *this. */
+    const int nsum=std::min(iend-static_cast<int>(i0),jend-static_cast<int>(j0))+1;
+    if(nsum>0)
     {
-        this->u(0,j)-=d.u(0,i);
-        this->u(1,j)-=d.u(1,i);
-        this->u(2,j)-=d.u(2,i);
+      UncheckedMatrix<double> sum=this->u.unchecked();
+      UncheckedMatrix<const double> dterm=d.u.unchecked();
+      mspass::utility::subtract_samples(sum.column(j0),dterm.column(i0),3*nsum);
     }
     return(*this);
 }
@@ -1029,19 +1048,13 @@ void CoreSeismogram::set_dt(const double sample_interval)
 {
   this->BasicTimeSeries::set_dt(sample_interval);
   /* This is the unique name defined in the mspass schema - we always set it. */
-  this->put(SEISMICMD_dt,sample_interval);
+  this->put(SEISMICMD_dt_key,sample_interval);
   /* these are hard coded aliases for sample_interval */
-  std::set<string> aliases;
-  std::set<string>::iterator aptr;
   /* Note these aren't set in keywords - aliases are flexible and this
   can allow another way to make these attribute names more flexible. */
-  aliases.insert("dt");
-  for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+  for(auto& alias : DT_ALIASES)
   {
-    if(this->is_defined(*aptr))
-    {
-      this->put(*aptr,sample_interval);
-    }
+    if(this->is_defined(alias)) this->put(alias,sample_interval);
   }
 }
 void CoreSeismogram::set_t0(const double t0in)
@@ -1050,18 +1063,11 @@ void CoreSeismogram::set_t0(const double t0in)
   /* This is the unique name - we always set it.  Pulled from keywords.h
   which should match the schema.  aliases are hard coded not defined as
   keywords */
-  this->put(SEISMICMD_t0,t0in);
+  this->put(SEISMICMD_t0_key,t0in);
   /* these are hard coded aliases for sample_interval */
-  std::set<string> aliases;
-  std::set<string>::iterator aptr;
-  aliases.insert("t0");
-  aliases.insert("time");
-  for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+  for(auto& alias : T0_ALIASES)
   {
-    if(this->is_defined(*aptr))
-    {
-      this->put(*aptr,t0in);
-    }
+    if(this->is_defined(alias)) this->put(alias,t0in);
   }
 }
 void CoreSeismogram::set_npts(const size_t npts)
@@ -1071,18 +1077,11 @@ void CoreSeismogram::set_npts(const size_t npts)
   cast is necessary to avoid type mismatch with unsigned.
   We use the name defined in keywords.h which we can always assume
   matches the schema for the unique name*/
-  this->put(SEISMICMD_npts,(long int)npts);
+  this->put(SEISMICMD_npts_key,(long int)npts);
   /* these are hard coded aliases for sample_interval */
-  std::set<string> aliases;
-  std::set<string>::iterator aptr;
-  aliases.insert("nsamp");
-  aliases.insert("wfdisc.nsamp");
-  for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+  for(auto& alias : NPTS_ALIASES)
   {
-    if(this->is_defined(*aptr))
-    {
-      this->put(*aptr,(long int)npts);
-    }
+    if(this->is_defined(alias)) this->put(alias,(long int)npts);
   }
   /* this method has the further complication that npts sets the size of the
   data matrix.   Here we resize the matrix and initialize it to 0s.*/
@@ -1104,18 +1103,11 @@ void CoreSeismogram::sync_npts()
     cast is necessary to avoid type mismatch with unsigned.
     As above converted to keywords.h const string to make
     this easier to maintain*/
-    this->put(SEISMICMD_npts,(long int)nsamp);
+    this->put(SEISMICMD_npts_key,(long int)nsamp);
     /* these are hard coded aliases for sample_interval */
-    std::set<string> aliases;
-    std::set<string>::iterator aptr;
-    aliases.insert("nsamp");
-    aliases.insert("wfdisc.nsamp");
-    for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+    for(auto& alias : NPTS_ALIASES)
     {
-        if(this->is_defined(*aptr))
-        {
-          this->put(*aptr,(long int)nsamp);
-        }
+      if(this->is_defined(alias)) this->put(alias,(long int)nsamp);
     }
   }
 }
@@ -1,13 +1,21 @@
+#include <algorithm>
 #include <vector>
-#include "misc/blas.h"
 #include "mspass/utility/MsPASSError.h"
 #include "mspass/seismic/keywords.h"
 #include "mspass/seismic/CoreTimeSeries.h"
 #include "mspass/utility/Metadata.h"
+#include "mspass/utility/sample_kernels.h"
 namespace mspass::seismic
 {
 using namespace std;
 using namespace mspass::utility;
+/* Hard coded aliases of the keys posted by the set methods.   They are
+key handles because the is_defined test runs on every set call. */
+const MetadataKey<double> DT_ALIASES[]={MetadataKey<double>("dt")};
+const MetadataKey<double> T0_ALIASES[]={MetadataKey<double>("t0"),
+  MetadataKey<double>("time")};
+const MetadataKey<long> NPTS_ALIASES[]={MetadataKey<long>("nsamp"),
+  MetadataKey<long>("wfdisc.nsamp")};
 //
 // simple constructors for the CoreTimeSeries object are defined inline
 // in seispp.h.
@@ -79,9 +87,10 @@ CoreTimeSeries& CoreTimeSeries::operator+=(const CoreTimeSeries& data)
 {
     int i,iend,jend;
     size_t i0;
-    size_t j,j0;
-    // Sun's compiler complains about const objects without this.
-    CoreTimeSeries& d=const_cast<CoreTimeSeries&>(data);
+    size_t j0;
+    /* d must stay const.   Non-const access to its samples would copy
+    them if they are shared with another object. */
+    const CoreTimeSeries& d=data;
     // Silently do nothing if d is marked dead
     if(!d.mlive) return(*this);
     // Silently do nothing if d does not overlap with data to contain sum
@@ -114,21 +123,29 @@ CoreTimeSeries& CoreTimeSeries::operator+=(const CoreTimeSeries& data)
     }
     //cout << "i0="<<i0<<" j0="<<j0<<" iend="<<iend<<" jend="<<jend<<endl;
     /*  Now do the actual sum using the computed ranges */
-    for(i=i0,j=j0; i<=iend && j<=jend; ++i,++j)
-        this->s[j]+=d.s[i];
+    /* Get the pointer for this first.  It makes the samples private to
+    this object and is then also correct for d if d is *this. */
+    const int nsum=std::min(iend-static_cast<int>(i0),jend-static_cast<int>(j0))+1;
+    if(nsum>0)
+    {
+      double *sptr=this->s.data();
+      const double *dptr=d.s.data();
+      mspass::utility::add_samples(sptr+j0,dptr+i0,nsum);
+    }
     return(*this);
 }
 /* IMPORTANT:  this code is absolutely identical to that for operator+=
-except the += in the last loop becomes -=.  Any changes in operator+=
+except add_samples becomes subtract_samples.  Any changes in operator+=
 must have exactly the same change here (other than a message with a
 tag to the function)*/
 CoreTimeSeries& CoreTimeSeries::operator-=(const CoreTimeSeries& data)
 {
     int i,iend,jend;
     size_t i0;
-    size_t j,j0;
-    // Sun's compiler complains about const objects without this.
-    CoreTimeSeries& d=const_cast<CoreTimeSeries&>(data);
+    size_t j0;
+    /* d must stay const.   Non-const access to its samples would copy
+    them if they are shared with another object. */
+    const CoreTimeSeries& d=data;
     // Silently do nothing if d is marked dead
     if(!d.mlive) return(*this);
     // Silently do nothing if d does not overlap with data to contain sum
@@ -161,8 +178,15 @@ CoreTimeSeries& CoreTimeSeries::operator-=(const CoreTimeSeries& data)
     }
     //cout << "i0="<<i0<<" j0="<<j0<<" iend="<<iend<<" jend="<<jend<<endl;
     /*  Now do the actual sum using the computed ranges */
-    for(i=i0,j=j0; i<=iend && j<=jend; ++i,++j)
-        this->s[j]-=d.s[i];
+    /* Get the pointer for this first.  It makes the samples private to
+    this object and is then also correct for d if d is *this. */
+    const int nsum=std::min(iend-static_cast<int>(i0),jend-static_cast<int>(j0))+1;
+    if(nsum>0)
+    {
+      double *sptr=this->s.data();
+      const double *dptr=d.s.data();
+      mspass::utility::subtract_samples(sptr+j0,dptr+i0,nsum);
+    }
     return(*this);
 }
 const CoreTimeSeries CoreTimeSeries::operator+(const CoreTimeSeries& other) const
@@ -179,7 +203,8 @@ const CoreTimeSeries CoreTimeSeries::operator-(const CoreTimeSeries& other) cons
 }
 CoreTimeSeries& CoreTimeSeries::operator*=(const double scale)
 {
-  dscal(this->npts(),scale,&(this->s[0]),1);
+  if(this->npts()>0)
+    mspass::utility::scale_samples(this->s.data(),this->npts(),scale);
   return *this;
 }
 void CoreTimeSeries::set_dt(const double sample_interval)
@@ -187,17 +212,11 @@ void CoreTimeSeries::set_dt(const double sample_interval)
   this->BasicTimeSeries::set_dt(sample_interval);
   /* This is the unique name - we always set it.
   Feb 2021 - changed to used const string value set in keywords.h*/
-  this->put(SEISMICMD_dt,sample_interval);
+  this->put(SEISMICMD_dt_key,sample_interval);
   /* these are hard coded aliases for sample_interval */
-  std::set<string> aliases;
-  std::set<string>::iterator aptr;
-  aliases.insert("dt");
-  for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+  for(auto& alias : DT_ALIASES)
   {
-    if(this->is_defined(*aptr))
-    {
-      this->put(*aptr,sample_interval);
-    }
+    if(this->is_defined(alias)) this->put(alias,sample_interval);
   }
 }
 void CoreTimeSeries::set_t0(const double t0in)
@@ -205,18 +224,11 @@ void CoreTimeSeries::set_t0(const double t0in)
   this->BasicTimeSeries::set_t0(t0in);
   /* This is the unique name - we always set it.
   Changed Feb 2021 to use const string value defined in keywords.h*/
-  this->put(SEISMICMD_t0,t0in);
+  this->put(SEISMICMD_t0_key,t0in);
   /* these are hard coded aliases for sample_interval */
-  std::set<string> aliases;
-  std::set<string>::iterator aptr;
-  aliases.insert("t0");
-  aliases.insert("time");
-  for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+  for(auto& alias : T0_ALIASES)
   {
-    if(this->is_defined(*aptr))
-    {
-      this->put(*aptr,t0in);
-    }
+    if(this->is_defined(alias)) this->put(alias,t0in);
   }
 }
 void CoreTimeSeries::set_npts(const size_t npts)
@@ -225,25 +237,16 @@ void CoreTimeSeries::set_npts(const size_t npts)
   /* This is the unique name - we always set it. Cast is necessary to
   avoid type mismatch in python for unsigned.
   Changed Feb 2021 to use key defined in in keywords.h*/
-  this->put(SEISMICMD_npts,(long int)npts);
+  this->put(SEISMICMD_npts_key,(long int)npts);
   /* these are hard coded aliases for sample_interval */
-  std::set<string> aliases;
-  std::set<string>::iterator aptr;
-  aliases.insert("nsamp");
-  aliases.insert("wfdisc.nsamp");
-  for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+  for(auto& alias : NPTS_ALIASES)
   {
-    if(this->is_defined(*aptr))
-    {
-      this->put(*aptr,(long int)npts);
-    }
+    if(this->is_defined(alias)) this->put(alias,(long int)npts);
   }
   /* this method has the further complication that npts sets the size of the
   data buffer.  We clear it an initialize it to 0 to be consistent with
   how constructors handle this. */
-  std::vector<double>().swap(this->s);  //  Clear the memory allocation of s
-  this->s.reserve(npts);
-  for(size_t i=0;i<npts;++i)this->s.push_back(0.0);
+  this->s=mspass::utility::SampleVector(npts,0.0);
 }
 void CoreTimeSeries::sync_npts()
 {
@@ -252,18 +255,11 @@ void CoreTimeSeries::sync_npts()
     /* This is the unique name - we always set it.  The weird
     cast is necessary to avoid type mismatch with unsigned
     Changed Feb 2021 to use key defined in keywords.h*/
-    this->put(SEISMICMD_npts,(long int)nsamp);
+    this->put(SEISMICMD_npts_key,(long int)nsamp);
     /* these are hard coded aliases for sample_interval */
-    std::set<string> aliases;
-    std::set<string>::iterator aptr;
-    aliases.insert("nsamp");
-    aliases.insert("wfdisc.nsamp");
-    for(aptr=aliases.begin();aptr!=aliases.end();++aptr)
+    for(auto& alias : NPTS_ALIASES)
     {
-        if(this->is_defined(*aptr))
-        {
-          this->put(*aptr,(long int)nsamp);
-        }
+      if(this->is_defined(alias)) this->put(alias,(long int)nsamp);
     }
   }
 }
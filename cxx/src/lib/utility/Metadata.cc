@@ -1,4 +1,7 @@
 #include <iomanip>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <boost/core/demangle.hpp>
 #include <pybind11/stl.h>
 #include "misc/base64.h"
@@ -8,6 +11,52 @@ namespace mspass::utility
 {
 using namespace std;
 
+namespace
+{
+/* Ids interned by one thread.  The flag is trivially destructible so it
+can still be tested if a key is interned during thread or program exit
+after the cache was destroyed. */
+thread_local bool key_cache_destroyed=false;
+struct KeyCache
+{
+  unordered_map<string,uint32_t> ids;
+  ~KeyCache(){key_cache_destroyed=true;};
+};
+} // End anonymous namespace
+uint32_t intern_metadata_key(const string& key)
+{
+  /* The table is never destroyed so handles in static objects remain
+  valid during program exit.  Entries are never removed because ids are
+  compared for the life of the process (see the header for the cost).
+  Keys are looked up in the cache of the calling thread first.  A miss
+  looks in the table with a shared lock.  The exclusive lock is only
+  taken the first time a key is seen by any thread. */
+  static unordered_map<string,uint32_t> *table=new unordered_map<string,uint32_t>();
+  static shared_mutex *table_lock=new shared_mutex();
+  KeyCache *cache(nullptr);
+  if(!key_cache_destroyed)
+  {
+    thread_local KeyCache thread_cache;
+    cache=&thread_cache;
+    auto cptr=cache->ids.find(key);
+    if(cptr!=cache->ids.end()) return cptr->second;
+  }
+  uint32_t id(0);
+  {
+    shared_lock<shared_mutex> guard(*table_lock);
+    auto ptr=table->find(key);
+    if(ptr!=table->end()) id=ptr->second;
+  }
+  if(id==0)
+  {
+    unique_lock<shared_mutex> guard(*table_lock);
+    auto result=table->emplace(key,static_cast<uint32_t>(table->size()+1));
+    id=result.first->second;
+  }
+  if(cache) cache->ids.emplace(key,id);
+  return id;
+}
+
 Metadata::Metadata(ifstream& ifs, const string form)
 {
   try{
@@ -25,7 +74,7 @@ Metadata::Metadata(ifstream& ifs, const string form)
         double dval;
         dval=atof(s2.c_str());
         a=dval;
-        md[s1]=a;
+        md.insert_or_assign(s1,a);
         changed_or_set.insert(s1);
       }
       else if(s3=="integer")
@@ -33,14 +82,14 @@ Metadata::Metadata(ifstream& ifs, const string form)
         long ival;
         ival=atol(s2.c_str());
         a=ival;
-        md[s1]=a;
+        md.insert_or_assign(s1,a);
         changed_or_set.insert(s1);
       }
       else if(s3=="string")
       {
         string sval;
         a=sval;
-        md[s1]=a;
+        md.insert_or_assign(s1,a);
         changed_or_set.insert(s1);
       }
       else if(s3=="bool")
@@ -51,7 +100,7 @@ Metadata::Metadata(ifstream& ifs, const string form)
         else
           bval=false;
         a=bval;
-        md[s1]=a;
+        md.insert_or_assign(s1,a);
         changed_or_set.insert(s1);
       }
       else
@@ -72,16 +121,7 @@ Metadata::Metadata(const Metadata& parent)
 }
 bool Metadata::is_defined(const string key) const noexcept
 {
-  map<string,boost::any>::const_iterator mptr;
-  mptr=md.find(key);
-  if(mptr!=md.end())
-  {
-    return true;
-  }
-  else
-  {
-    return false;
-  }
+  return md.find(key)!=nullptr;
 }
 void Metadata::append_chain(const std::string key, const std::string val,
                   const std::string separator)
@@ -122,15 +162,25 @@ Metadata& Metadata::operator+=(const Metadata& rhs) noexcept
     /* We depend here upon the map container replacing values associated with
     existing keys.  We mark all entries changes anyway.  This is a vastly simpler
     algorithm than the old SEISPP::Metadata.  */
-    map<string,boost::any>::const_iterator rhsptr;
+    MetadataMap::const_iterator rhsptr;
     for(rhsptr=rhs.md.begin();rhsptr!=rhs.md.end();++rhsptr)
     {
-      md[rhsptr->first]=rhsptr->second;
+      md.insert_or_assign(rhsptr->first,rhsptr->second);
       changed_or_set.insert(rhsptr->first);
     }
   }
   return *this;
 }
+Metadata& Metadata::merge_shared(const Metadata& rhs)
+{
+  if(this!=(&rhs))
+  {
+    md.merge_shared(rhs.md);
+    for(auto rhsptr=rhs.md.begin();rhsptr!=rhs.md.end();++rhsptr)
+      changed_or_set.insert(rhsptr->first);
+  }
+  return *this;
+}
 const Metadata Metadata::operator+(const Metadata& other) const
 {
   Metadata result(*this);
@@ -140,7 +190,7 @@ const Metadata Metadata::operator+(const Metadata& other) const
 set<string> Metadata::keys() const noexcept
 {
   set<string> result;
-  map<string,boost::any>::const_iterator mptr;
+  MetadataMap::const_iterator mptr;
   for(mptr=md.begin();mptr!=md.end();++mptr)
   {
     string key(mptr->first);\
@@ -150,10 +200,7 @@ set<string> Metadata::keys() const noexcept
 }
 void Metadata::erase(const std::string key)
 {
-  map<string,boost::any>::iterator iptr;
-  iptr=md.find(key);
-  if(iptr!=md.end())
-    md.erase(iptr);
+  md.erase(key);
   /* Also need to modify this set if the key is found there */
   set<std::string>::iterator sptr;
   sptr=changed_or_set.find(key);
@@ -164,11 +211,11 @@ std::size_t Metadata::size() const noexcept
 {
   return md.size();
 }
-std::map<string,boost::any>::const_iterator  Metadata::begin() const noexcept
+MetadataMap::const_iterator  Metadata::begin() const noexcept
 {
   return md.begin();
 }
-std::map<string,boost::any>::const_iterator  Metadata::end() const noexcept
+MetadataMap::const_iterator  Metadata::end() const noexcept
 {
   return md.end();
 }
@@ -195,7 +242,7 @@ std::string Metadata::type(const string key) const
 ostringstream& operator<<(ostringstream& os, const Metadata& m)
 {
   try{
-    map<string,boost::any>::const_iterator mdptr;
+    MetadataMap::const_iterator mdptr;
     for(mdptr=m.md.begin();mdptr!=m.md.end();++mdptr)
     {
         /* Only handle simple types for now.  Issue an error message to
@@ -284,52 +331,200 @@ ostringstream& operator<<(ostringstream& os, const Metadata& m)
     return os;
   }catch(...){throw;};
 }
-/* This function is implemented with pybind11 so it should only be called under python. */
+/* The python pickle interface uses the same binary codec as the data
+objects.  Only values stored as python objects need the GIL. */
 pybind11::object serialize_metadata_py(const Metadata &md)
 {
+  vector<char> buf;
+  BinaryOArchive ar(buf);
+  serialize_metadata_binary(md,ar);
   pybind11::gil_scoped_acquire acquire;
-  try{
-    pybind11::dict md_dict = pybind11::cast(md);
-    pybind11::set changed_or_set = pybind11::cast(md.changed_or_set);
-    pybind11::module pickle = pybind11::module::import("pickle");
-    pybind11::object dumps = pickle.attr("dumps");
-    pybind11::object md_dump = dumps(pybind11::make_tuple(md_dict, changed_or_set));
-    pybind11::gil_scoped_release release;
-    return md_dump;
-  }catch(...){pybind11::gil_scoped_release release;throw;};
+  return pybind11::bytes(buf.data(),buf.size());
 }
-/* This is the reverse of serialize_metadata also using pybind11. */
+/* This is the reverse of serialize_metadata_py. */
 Metadata restore_serialized_metadata_py(const pybind11::object &s)
 {
-  pybind11::gil_scoped_acquire acquire;
-  try
+  char *p;
+  Py_ssize_t n;
   {
-    pybind11::module pickle = pybind11::module::import("pickle");
-    pybind11::object loads = pickle.attr("loads");
-    pybind11::tuple md_dump = loads(s);
-    pybind11::dict md_dict = md_dump[0];
-    pybind11::object md_py = pybind11::module_::import("mspasspy.ccore.utility").attr("Metadata")(md_dict);
-    Metadata md = md_py.cast<Metadata>();
-    md.changed_or_set = md_dump[1].cast<std::set<std::string>>();
-    pybind11::gil_scoped_release release;
-    return md;
+    pybind11::gil_scoped_acquire acquire;
+    if(!PyBytes_Check(s.ptr()))
+      throw MsPASSError("restore_serialized_metadata_py:  serialized Metadata must be a bytes object",
+        ErrorSeverity::Invalid);
+    PyBytes_AsStringAndSize(s.ptr(),&p,&n);
   }
-  catch (...)
+  Metadata md;
+  BinaryIArchive ar(p,static_cast<size_t>(n));
+  restore_metadata_binary(ar,md);
+  return md;
+}
+/* Type tags of the binary Metadata block */
+enum class MDBinaryTag : uint8_t
+{
+  Bool,
+  Int,
+  Long,
+  Float,
+  Double,
+  String,
+  Object
+};
+void serialize_metadata_binary(const Metadata& md, BinaryOArchive& ar)
+{
+  size_t n=md.md.size();
+  ar << static_cast<uint64_t>(n);
+  /* Bit i is set if entry i (in key order) is in changed_or_set.  Both
+  containers are sorted so one merge pass builds the bitmap.  Keys marked
+  as changed that are not defined (change_key leaves those) are written
+  after the bitmap. */
+  vector<uint8_t> changed((n+7)/8,0);
+  vector<string> undefined_changed;
+  auto cptr=md.changed_or_set.begin();
+  size_t i(0);
+  for(auto mdptr=md.md.begin();mdptr!=md.md.end();++mdptr,++i)
   {
-    pybind11::gil_scoped_release release;
-    throw;
-  };
+    const string& key=mdptr->first;
+    while(cptr!=md.changed_or_set.end() && *cptr<key)
+    {
+      undefined_changed.push_back(*cptr);
+      ++cptr;
+    }
+    if(cptr!=md.changed_or_set.end() && *cptr==key)
+    {
+      changed[i/8] |= static_cast<uint8_t>(1<<(i%8));
+      ++cptr;
+    }
+    const boost::any& a=mdptr->second;
+    const std::type_info& ti=a.type();
+    if(ti==typeid(double))
+      ar << MDBinaryTag::Double << key << boost::any_cast<double>(a);
+    else if(ti==typeid(long))
+      ar << MDBinaryTag::Long << key << boost::any_cast<long>(a);
+    else if(ti==typeid(string))
+      ar << MDBinaryTag::String << key << boost::any_cast<const string&>(a);
+    else if(ti==typeid(bool))
+      ar << MDBinaryTag::Bool << key << boost::any_cast<bool>(a);
+    else if(ti==typeid(int))
+      ar << MDBinaryTag::Int << key << boost::any_cast<int>(a);
+    else if(ti==typeid(float))
+      ar << MDBinaryTag::Float << key << boost::any_cast<float>(a);
+    else if(ti==typeid(pybind11::object))
+    {
+      string pbuf;
+      {
+        pybind11::gil_scoped_acquire acquire;
+        pybind11::object dumps=pybind11::module::import("pickle").attr("dumps");
+        pbuf=dumps(boost::any_cast<pybind11::object>(a)).cast<std::string>();
+      }
+      ar << MDBinaryTag::Object << key << pbuf;
+    }
+    else
+      throw MsPASSError("serialize_metadata_binary:  value for key="+key
+        +" has unsupported type "+demangled_name(a),ErrorSeverity::Invalid);
+  }
+  for(;cptr!=md.changed_or_set.end();++cptr) undefined_changed.push_back(*cptr);
+  ar << changed << undefined_changed;
+}
+/* Reads the value of one entry and returns it as a boost::any */
+boost::any restore_metadata_value(BinaryIArchive& ar, const MDBinaryTag tag,
+  const string& key)
+{
+  switch(tag)
+  {
+    case MDBinaryTag::Bool:
+    {
+      bool bval;
+      ar >> bval;
+      return bval;
+    }
+    case MDBinaryTag::Int:
+    {
+      int ival;
+      ar >> ival;
+      return ival;
+    }
+    case MDBinaryTag::Long:
+    {
+      long lval;
+      ar >> lval;
+      return lval;
+    }
+    case MDBinaryTag::Float:
+    {
+      float fval;
+      ar >> fval;
+      return fval;
+    }
+    case MDBinaryTag::Double:
+    {
+      double dval;
+      ar >> dval;
+      return dval;
+    }
+    case MDBinaryTag::String:
+    {
+      string sval;
+      ar >> sval;
+      return sval;
+    }
+    case MDBinaryTag::Object:
+    {
+      string pbuf;
+      ar >> pbuf;
+      pybind11::gil_scoped_acquire acquire;
+      pybind11::object loads=pybind11::module::import("pickle").attr("loads");
+      return boost::any(loads(pybind11::bytes(pbuf)));
+    }
+    default:
+      throw MsPASSError("restore_metadata_binary:  invalid type tag for key="+key
+        +" - serialized data are corrupted",ErrorSeverity::Invalid);
+  }
+}
+void restore_metadata_binary(BinaryIArchive& ar, Metadata& md)
+{
+  uint64_t n;
+  ar >> n;
+  /* Every entry is at least a tag and a key size */
+  if(n>ar.remaining()/(sizeof(uint8_t)+sizeof(uint64_t)))
+    throw MsPASSError("restore_metadata_binary:  entry count exceeds the size of the buffer - serialized data are corrupted",
+      ErrorSeverity::Invalid);
+  /* Entries were written in key order so each insert can use end as
+  the hint.  That makes the inserts constant time when md is empty. */
+  vector<string> keys;
+  keys.reserve(n);
+  md.md.reserve(md.md.size()+n);
+  for(uint64_t i=0;i<n;++i)
+  {
+    MDBinaryTag tag;
+    string key;
+    ar >> tag >> key;
+    boost::any a=restore_metadata_value(ar,tag,key);
+    md.md.insert_or_assign(md.md.end(),key,std::move(a));
+    keys.push_back(std::move(key));
+  }
+  vector<uint8_t> changed;
+  vector<string> undefined_changed;
+  ar >> changed >> undefined_changed;
+  if(changed.size()!=(n+7)/8)
+    throw MsPASSError("restore_metadata_binary:  size of the changed key bitmap does not match the number of entries - serialized data are corrupted",
+      ErrorSeverity::Invalid);
+  for(size_t i=0;i<n;++i)
+    if(changed[i/8] & (1<<(i%8)))
+      md.changed_or_set.emplace_hint(md.changed_or_set.end(),std::move(keys[i]));
+  for(auto& key : undefined_changed) md.changed_or_set.insert(key);
 }
 /* New method added Apr 2020 to change key assigned to a value - used for aliass*/
 void Metadata::change_key(const string oldkey, const string newkey)
 {
-  map<string,boost::any>::iterator mdptr;
-  mdptr=md.find(oldkey);
-  /* We silently do nothing if old is not found */
-  if(mdptr!=md.end())
+  /* We silently do nothing if old is not found.  The value may be held
+  in a layer shared with other objects so it is copied before the old
+  entry is erased. */
+  const boost::any *aptr=md.find(oldkey);
+  if(aptr!=nullptr)
   {
-    md.insert_or_assign(newkey, mdptr->second);
-    md.erase(mdptr);
+    boost::any a(*aptr);
+    md.erase(oldkey);
+    md.insert_or_assign(newkey,std::move(a));
   }
 }
 } // End mspass::utility Namespace block
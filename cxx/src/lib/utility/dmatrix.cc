@@ -1,6 +1,7 @@
 #include <math.h>
 #include "misc/blas.h"
 #include "mspass/utility/dmatrix.h"
+#include "mspass/utility/sample_kernels.h"
 
 namespace mspass::utility{
 using namespace std;
@@ -68,22 +69,53 @@ double& dmatrix::operator()(const size_t rowindex, const size_t colindex)
 // subtle difference here.  This one returns a pointer to the 
 // requested element
 //
-double* dmatrix::get_address(size_t rowindex, size_t colindex) const
+const double* dmatrix::get_address(size_t rowindex, size_t colindex) const
+{
+  int out_of_range=0;
+  if (rowindex>=nrr) out_of_range=1;
+  if (colindex>=ncc) out_of_range=1;
+  if (out_of_range)
+        throw dmatrix_index_error(nrr,ncc,rowindex,colindex);
+  /* The samples may be shared with copies of this matrix so the result
+  is read only */
+  return(ary.data()+rowindex+(nrr)*(colindex));
+}
+double* dmatrix::get_address(size_t rowindex, size_t colindex)
 {
-  double *ptr;
   int out_of_range=0;
   if (rowindex>=nrr) out_of_range=1;
-  if (rowindex<0) out_of_range=1;
   if (colindex>=ncc) out_of_range=1;
-  if (colindex<0) out_of_range=1;
   if (out_of_range)
         throw dmatrix_index_error(nrr,ncc,rowindex,colindex);
-  /* This is somewhat contradictory to the const qualifier of the method
-     but not really.  const in that position implies the method itself
-     does not alter the object, but a pointer that is not const is
-     always something that allows data to be changed*/
-  ptr=const_cast<double *>(&(ary[rowindex+(nrr)*(colindex)]));
-  return(ptr);
+  /* Non-const access makes the samples private to this matrix first */
+  return(ary.data()+rowindex+(nrr)*(colindex));
+}
+double* dmatrix::exclusive_address(size_t rowindex, size_t colindex)
+{
+  int out_of_range=0;
+  if (rowindex>=nrr) out_of_range=1;
+  if (colindex>=ncc) out_of_range=1;
+  if (out_of_range)
+        throw dmatrix_index_error(nrr,ncc,rowindex,colindex);
+  return(ary.exclusive_vector().data()+rowindex+(nrr)*(colindex));
+}
+dmatrix dmatrix::column_range(const size_t c0, const size_t nc) const
+{
+  if(c0+nc>ncc)
+    throw dmatrix_index_error(nrr,ncc,0,c0+nc-1);
+  dmatrix result;
+  result.nrr=nrr;
+  result.ncc=nc;
+  result.length=nrr*nc;
+  result.ary=ary.slice(nrr*c0,nrr*nc);
+  return result;
+}
+void dmatrix::pack(const std::vector<dmatrix*>& parts)
+{
+  std::vector<SampleVector*> samples;
+  samples.reserve(parts.size());
+  for(auto A : parts) samples.push_back(&(A->ary));
+  SampleVector::pack(samples);
 }
 
 dmatrix& dmatrix::operator=(const dmatrix& other)
@@ -100,101 +132,76 @@ dmatrix& dmatrix::operator=(const dmatrix& other)
 
 dmatrix& dmatrix::operator+=(const dmatrix& other)
 {
-  size_t i;
   if ((nrr!=other.nrr)||(length!=other.length))
     throw dmatrix_size_error(nrr, ncc, other.nrr, other.length);
-  for(i=0;i<length;i++)
-    ary[i]+=other.ary[i];
+  double *a=ary.data();
+  const double *b=other.ary.data();
+  add_samples(a,b,length);
   return *this;
 }
 
 dmatrix& dmatrix::operator-=(const dmatrix& other)
 {
-  size_t i;
   if ((nrr!=other.nrr)||(length!=other.length))
     throw dmatrix_size_error(nrr, ncc, other.nrr, other.length);
-  for(i=0;i<length;i++)
-    ary[i]-=other.ary[i];
+  double *a=ary.data();
+  const double *b=other.ary.data();
+  subtract_samples(a,b,length);
   return *this;
 }
 
-dmatrix dmatrix::operator+(const dmatrix &other) const
-{
-    try{
-        dmatrix result(*this);
-        result += other;
-        return result;
-    }catch(...){throw;};
-}
-dmatrix dmatrix::operator-(const dmatrix &other) const
-{
-    try{
-        dmatrix result(*this);
-        result -= other;
-        return result;
-    }catch(...){throw;};
-}
 
 
-dmatrix operator*(const dmatrix& x1,const dmatrix& b) 
+/* Computes c=op(a)*op(b) with dgemm.  m, n, and k are the dimensions
+of the product as in the BLAS.  c must already be m x n. */
+static void gemm_product(const dmatrix& a, const bool transpose_a,
+  const dmatrix& b, const bool transpose_b, const size_t m, const size_t n,
+  const size_t k, double *c)
 {
-	size_t i,j;
-        /* The computed length in last arg to the error object is a relic*/
-	if(x1.columns()!=b.rows())
-		throw dmatrix_size_error(x1.rows(), x1.columns(), 
-                        b.rows(), b.rows()*b.columns());
-	dmatrix prod(x1.rows(),b.columns());
-	for(i=0;i<x1.rows();i++)
-	  for(j=0;j<b.columns();j++)
-	  {
-              double *x1ptr,*bptr;
-              x1ptr=const_cast<dmatrix&>(x1).get_address(i,0);
-              bptr=const_cast<dmatrix&>(b).get_address(0,j);
-              /* This temporary seems necessary */
-              double *dptr;
-              dptr=prod.get_address(i,j);
-              *dptr=ddot(x1.columns(),x1ptr,x1.rows(),bptr,1);
-	  }
-	return prod;
+  /* dgemm requires leading dimensions of at least 1 */
+  if(m==0 || n==0 || k==0) return;
+  const char ta(transpose_a ? 'T' : 'N');
+  const char tb(transpose_b ? 'T' : 'N');
+  const int lda=max<size_t>(a.rows(),1);
+  const int ldb=max<size_t>(b.rows(),1);
+  dgemm(&ta,&tb,m,n,k,1.0,a.get_address(0,0),lda,b.get_address(0,0),ldb,
+    0.0,c,m);
 }
-
-dmatrix operator*(const double& x, const dmatrix &zx) noexcept
+dmatrix matmul(const dmatrix& a, const dmatrix& b,
+  const bool transpose_a, const bool transpose_b)
 {
-  size_t i;
-  dmatrix tempmat(zx.rows(),zx.columns());
-  size_t lenary=zx.rows()*zx.columns();
-  double *zptr,*dptr;
-  zptr=const_cast<dmatrix&>(zx).get_address(0,0);
-  dptr=tempmat.get_address(0,0);
-  for(i=0;i<lenary;++i)
-  {
-      (*dptr)=x*(*zptr);
-      ++dptr;
-      ++zptr;
-  }
-  return tempmat;
+  const size_t m = transpose_a ? a.columns() : a.rows();
+  const size_t k = transpose_a ? a.rows() : a.columns();
+  const size_t kb = transpose_b ? b.columns() : b.rows();
+  const size_t n = transpose_b ? b.rows() : b.columns();
+  if(k!=kb)
+    throw dmatrix_size_error(m,k,kb,n);
+  dmatrix prod(m,n);
+  /* The constructor leaves an empty matrix when m or n is 0 */
+  if(prod.rows()>0 && prod.columns()>0)
+    gemm_product(a,transpose_a,b,transpose_b,m,n,k,prod.get_address(0,0));
+  return prod;
 }
-
-dmatrix dmatrix::operator* (double x) const noexcept
+dmatrix operator*(const dmatrix& x1,const dmatrix& b) 
 {
-    double *ptr;
-    dmatrix result(*this);
-    ptr=result.get_address(0,0);
-    dscal(length,x,ptr,1);
-    return result;
+  return matmul(x1,b);
 }
 
 
 
 
+
 dmatrix tr(const dmatrix& x1) noexcept
 {
   size_t i,j;
   dmatrix temp(x1.columns(),x1.rows());
-  for(i=0; i<x1.rows(); i++)
-     for(j=0; j<x1.columns();j++)
+  /* Sizes match by construction so indices need not be checked */
+  UncheckedMatrix<double> t=temp.unchecked();
+  UncheckedMatrix<const double> x=x1.unchecked();
+  for(j=0; j<x.columns();j++)
+     for(i=0; i<x.rows(); i++)
      {
-  	temp(j,i)=x1(i,j);
+  	t(j,i)=x(i,j);
      }
   return temp;
 }
@@ -214,7 +221,7 @@ ostream& operator<<(ostream& os, dmatrix& x1)
 
 void dmatrix::zero()
 {
-    for(size_t i=0;i<length;++i) ary[i]=0.0;
+    ary.assign(length,0.0);
 }
 vector<size_t> dmatrix::size() const
 {
@@ -261,17 +268,14 @@ double &dvector::operator()(const size_t rowindex)
 }		
 dvector operator*(const dmatrix& x1,const dvector& b)
 {
-	size_t i;
   size_t nrx1=x1.rows();
   size_t ncx1=x1.columns();
   size_t nrb=const_cast<dvector&>(b).rows();
 	if(ncx1!=nrb)
 		throw dmatrix_size_error(nrx1, ncx1, nrb, 1);
 	dvector prod(nrx1);
-	for(i=0;i<nrx1;i++)
-		prod(i)=ddot(nrb,
-			const_cast<dmatrix&>(x1).get_address(i,0),nrx1,
-			const_cast<dvector&>(b).get_address(0,0),1);
+	if(nrx1>0)
+		gemm_product(x1,false,b,false,nrx1,1,nrb,prod.get_address(0,0));
 	return prod;
 }
 }  // end mspass namespace 
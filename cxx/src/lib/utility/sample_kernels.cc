@@ -0,0 +1,200 @@
+#include "mspass/utility/sample_kernels.h"
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MSPASS_X86_DISPATCH
+#endif
+
+namespace mspass::utility{
+using namespace std;
+namespace {
+/* Portable versions.   These are also the fallback for the tails of
+the vector versions. */
+void scale_generic(double *y, const size_t n, const double a)
+{
+  for(size_t i=0;i<n;++i) y[i]*=a;
+}
+void add_generic(double *y, const double *x, const size_t n)
+{
+  for(size_t i=0;i<n;++i) y[i]+=x[i];
+}
+void subtract_generic(double *y, const double *x, const size_t n)
+{
+  for(size_t i=0;i<n;++i) y[i]-=x[i];
+}
+double sumsq_generic(const double *x, const size_t n)
+{
+  double sumsq(0.0);
+  for(size_t i=0;i<n;++i) sumsq+=x[i]*x[i];
+  return sumsq;
+}
+
+#ifdef MSPASS_X86_DISPATCH
+/* AVX2 versions - 4 doubles per register.   The reduction uses two
+accumulators to hide the latency of the fused multiply-add. */
+__attribute__((target("avx2,fma")))
+void scale_avx2(double *y, const size_t n, const double a)
+{
+  const __m256d va=_mm256_set1_pd(a);
+  size_t i;
+  for(i=0;i+4<=n;i+=4)
+    _mm256_storeu_pd(y+i,_mm256_mul_pd(_mm256_loadu_pd(y+i),va));
+  scale_generic(y+i,n-i,a);
+}
+__attribute__((target("avx2,fma")))
+void add_avx2(double *y, const double *x, const size_t n)
+{
+  size_t i;
+  for(i=0;i+4<=n;i+=4)
+    _mm256_storeu_pd(y+i,_mm256_add_pd(_mm256_loadu_pd(y+i),_mm256_loadu_pd(x+i)));
+  add_generic(y+i,x+i,n-i);
+}
+__attribute__((target("avx2,fma")))
+void subtract_avx2(double *y, const double *x, const size_t n)
+{
+  size_t i;
+  for(i=0;i+4<=n;i+=4)
+    _mm256_storeu_pd(y+i,_mm256_sub_pd(_mm256_loadu_pd(y+i),_mm256_loadu_pd(x+i)));
+  subtract_generic(y+i,x+i,n-i);
+}
+__attribute__((target("avx2,fma")))
+double sumsq_avx2(const double *x, const size_t n)
+{
+  __m256d acc0=_mm256_setzero_pd();
+  __m256d acc1=_mm256_setzero_pd();
+  size_t i;
+  for(i=0;i+8<=n;i+=8)
+  {
+    const __m256d v0=_mm256_loadu_pd(x+i);
+    const __m256d v1=_mm256_loadu_pd(x+i+4);
+    acc0=_mm256_fmadd_pd(v0,v0,acc0);
+    acc1=_mm256_fmadd_pd(v1,v1,acc1);
+  }
+  acc0=_mm256_add_pd(acc0,acc1);
+  double part[4];
+  _mm256_storeu_pd(part,acc0);
+  return part[0]+part[1]+part[2]+part[3]+sumsq_generic(x+i,n-i);
+}
+/* AVX-512 versions - 8 doubles per register.  Tails use a mask so
+no scalar loop is needed. */
+__attribute__((target("avx512f")))
+void scale_avx512(double *y, const size_t n, const double a)
+{
+  const __m512d va=_mm512_set1_pd(a);
+  size_t i;
+  for(i=0;i+8<=n;i+=8)
+    _mm512_storeu_pd(y+i,_mm512_mul_pd(_mm512_loadu_pd(y+i),va));
+  if(i<n)
+  {
+    const __mmask8 m=static_cast<__mmask8>((1u<<(n-i))-1);
+    _mm512_mask_storeu_pd(y+i,m,_mm512_mul_pd(_mm512_maskz_loadu_pd(m,y+i),va));
+  }
+}
+__attribute__((target("avx512f")))
+void add_avx512(double *y, const double *x, const size_t n)
+{
+  size_t i;
+  for(i=0;i+8<=n;i+=8)
+    _mm512_storeu_pd(y+i,_mm512_add_pd(_mm512_loadu_pd(y+i),_mm512_loadu_pd(x+i)));
+  if(i<n)
+  {
+    const __mmask8 m=static_cast<__mmask8>((1u<<(n-i))-1);
+    _mm512_mask_storeu_pd(y+i,m,_mm512_add_pd(_mm512_maskz_loadu_pd(m,y+i),
+                                              _mm512_maskz_loadu_pd(m,x+i)));
+  }
+}
+__attribute__((target("avx512f")))
+void subtract_avx512(double *y, const double *x, const size_t n)
+{
+  size_t i;
+  for(i=0;i+8<=n;i+=8)
+    _mm512_storeu_pd(y+i,_mm512_sub_pd(_mm512_loadu_pd(y+i),_mm512_loadu_pd(x+i)));
+  if(i<n)
+  {
+    const __mmask8 m=static_cast<__mmask8>((1u<<(n-i))-1);
+    _mm512_mask_storeu_pd(y+i,m,_mm512_sub_pd(_mm512_maskz_loadu_pd(m,y+i),
+                                              _mm512_maskz_loadu_pd(m,x+i)));
+  }
+}
+__attribute__((target("avx512f")))
+double sumsq_avx512(const double *x, const size_t n)
+{
+  __m512d acc0=_mm512_setzero_pd();
+  __m512d acc1=_mm512_setzero_pd();
+  size_t i;
+  for(i=0;i+16<=n;i+=16)
+  {
+    const __m512d v0=_mm512_loadu_pd(x+i);
+    const __m512d v1=_mm512_loadu_pd(x+i+8);
+    acc0=_mm512_fmadd_pd(v0,v0,acc0);
+    acc1=_mm512_fmadd_pd(v1,v1,acc1);
+  }
+  for(;i+8<=n;i+=8)
+  {
+    const __m512d v=_mm512_loadu_pd(x+i);
+    acc0=_mm512_fmadd_pd(v,v,acc0);
+  }
+  if(i<n)
+  {
+    const __mmask8 m=static_cast<__mmask8>((1u<<(n-i))-1);
+    const __m512d v=_mm512_maskz_loadu_pd(m,x+i);
+    acc1=_mm512_fmadd_pd(v,v,acc1);
+  }
+  double part[8];
+  _mm512_storeu_pd(part,_mm512_add_pd(acc0,acc1));
+  return ((part[0]+part[1])+(part[2]+part[3]))+((part[4]+part[5])+(part[6]+part[7]));
+}
+#endif
+
+/* Table of the implementations selected for this cpu. */
+struct SampleKernels
+{
+  void (*scale)(double *, const size_t, const double);
+  void (*add)(double *, const double *, const size_t);
+  void (*subtract)(double *, const double *, const size_t);
+  double (*sumsq)(const double *, const size_t);
+  const char *isa;
+};
+SampleKernels select_kernels()
+{
+#ifdef MSPASS_X86_DISPATCH
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f"))
+    return SampleKernels{scale_avx512,add_avx512,subtract_avx512,
+                         sumsq_avx512,"avx512"};
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return SampleKernels{scale_avx2,add_avx2,subtract_avx2,
+                         sumsq_avx2,"avx2"};
+#endif
+  return SampleKernels{scale_generic,add_generic,subtract_generic,
+                       sumsq_generic,"generic"};
+}
+/* Function local static so initialization is thread safe and happens
+on first use rather than during static initialization of the library. */
+const SampleKernels& kernels()
+{
+  static const SampleKernels k(select_kernels());
+  return k;
+}
+} // End anonymous namespace
+
+void scale_samples(double *y, const size_t n, const double a)
+{
+  kernels().scale(y,n,a);
+}
+void add_samples(double *y, const double *x, const size_t n)
+{
+  kernels().add(y,x,n);
+}
+void subtract_samples(double *y, const double *x, const size_t n)
+{
+  kernels().subtract(y,x,n);
+}
+double sum_of_squares(const double *x, const size_t n)
+{
+  return kernels().sumsq(x,n);
+}
+string sample_kernel_isa()
+{
+  return string(kernels().isa);
+}
+} // End mspass::utility namespace
@@ -1,5 +1,10 @@
 #include <iostream>
+#include <utility>
+#include <vector>
+#include <math.h>
+#include <stdint.h>
 #include "mspass/utility/dmatrix.h"
+#include "mspass/utility/sample_kernels.h"
 using namespace std;
 using namespace mspass::utility;
 dmatrix MakeA()
@@ -72,6 +77,180 @@ int main(int argc, char **argv)
         cout << "Product y=Ax"<<endl;
         y=A*x;
         cout << y<<endl;
+        cout << "Testing matmul transpose variants against a triple loop"<<endl;
+        dmatrix ATA=matmul(A,A,true,false);
+        dmatrix AAT=matmul(A,A,false,true);
+        const dmatrix& cA(A);
+        const dmatrix& cATA(ATA);
+        const dmatrix& cAAT(AAT);
+        if(ATA.rows()!=A.columns() || ATA.columns()!=A.columns()
+           || AAT.rows()!=A.rows() || AAT.columns()!=A.rows())
+        {
+          cerr << "matmul transpose variants have the wrong size"<<endl;
+          exit(-1);
+        }
+        for(size_t i=0;i<ATA.rows();++i)
+          for(size_t j=0;j<ATA.columns();++j)
+          {
+            double sum(0.0),scale(0.0);
+            for(size_t k=0;k<A.rows();++k)
+            {
+              sum+=cA(k,i)*cA(k,j);
+              scale+=fabs(cA(k,i)*cA(k,j));
+            }
+            if(fabs(cATA(i,j)-sum)>1.0e-12*scale)
+            {
+              cerr << "matmul(A,A,true,false) does not match AT*A"<<endl;
+              exit(-1);
+            }
+          }
+        for(size_t i=0;i<AAT.rows();++i)
+          for(size_t j=0;j<AAT.columns();++j)
+          {
+            double sum(0.0),scale(0.0);
+            for(size_t k=0;k<A.columns();++k)
+            {
+              sum+=cA(i,k)*cA(j,k);
+              scale+=fabs(cA(i,k)*cA(j,k));
+            }
+            if(fabs(cAAT(i,j)-sum)>1.0e-12*scale)
+            {
+              cerr << "matmul(A,A,false,true) does not match A*AT"<<endl;
+              exit(-1);
+            }
+          }
+        cout << "Testing fused expression 2*A+A-A*3 (should be all zeros)"<<endl;
+        dmatrix fused=2.0*A+A-A*3.0;
+        for(size_t i=0;i<fused.rows();++i)
+          for(size_t j=0;j<fused.columns();++j)
+            if(std::as_const(fused)(i,j)!=0.0)
+            {
+              cerr << "expression evaluation error"<<endl<<fused<<endl;
+              exit(-1);
+            }
+        cout << "Testing unchecked accessor"<<endl;
+        UncheckedMatrix<const double> ua=std::as_const(A).unchecked();
+        for(size_t j=0;j<A.columns();++j)
+          for(size_t i=0;i<A.rows();++i)
+            if(ua(i,j)!=std::as_const(A)(i,j))
+            {
+              cerr << "unchecked accessor does not match operator()"<<endl;
+              exit(-1);
+            }
+        cout << "Testing sample kernels with instruction set "
+             << sample_kernel_isa()<<endl;
+        for(size_t n=0;n<40;++n)
+        {
+          vector<double> x(n),y(n),yref(n);
+          double sumsq(0.0);
+          for(size_t i=0;i<n;++i)
+          {
+            x[i]=0.5*static_cast<double>(i)-3.0;
+            y[i]=yref[i]=static_cast<double>(n-i);
+            sumsq+=x[i]*x[i];
+          }
+          add_samples(y.data(),x.data(),n);
+          scale_samples(y.data(),n,2.0);
+          subtract_samples(y.data(),x.data(),n);
+          for(size_t i=0;i<n;++i)
+            yref[i]=(yref[i]+x[i])*2.0-x[i];
+          if(y!=yref)
+          {
+            cerr << "sample kernels do not match scalar loops for n="<<n<<endl;
+            exit(-1);
+          }
+          if(fabs(sum_of_squares(x.data(),n)-sumsq)>1.0e-12*sumsq)
+          {
+            cerr << "sum_of_squares does not match scalar sum for n="<<n<<endl;
+            exit(-1);
+          }
+        }
+        cout << "Testing dmatrix::pack"<<endl;
+        dmatrix P1(A),P2(AT),P3(2,5);
+        P3.zero();
+        dmatrix P1copy(P1);
+        vector<dmatrix*> parts={&P1,&P2,&P3};
+        dmatrix::pack(parts);
+        /* 6 elements are padded to one 64 byte line of 8 */
+        if((std::as_const(P2).get_address(0,0)!=std::as_const(P1).get_address(0,0)+8)
+           || (std::as_const(P3).get_address(0,0)!=std::as_const(P2).get_address(0,0)+8)
+           || (reinterpret_cast<uintptr_t>(std::as_const(P1).get_address(0,0))%64!=0))
+        {
+          cerr << "packed matrices are not aligned, padded, and in order"<<endl;
+          exit(-1);
+        }
+        if((std::as_const(P1)(0,0)!=std::as_const(P1copy)(0,0)) || (std::as_const(P3)(1,4)!=0.0))
+        {
+          cerr << "pack changed matrix values"<<endl;
+          exit(-1);
+        }
+        const double *p2=std::as_const(P2).get_address(0,0);
+        P2(1,1)=100.0;
+        if(std::as_const(P2).get_address(0,0)!=p2)
+        {
+          cerr << "write to a packed matrix was not done in place"<<endl;
+          exit(-1);
+        }
+        dmatrix P2copy(P2);
+        P2(0,0)=-100.0;
+        if((std::as_const(P2copy)(0,0)==-100.0) || (std::as_const(P2copy)(1,1)!=100.0)
+           || (std::as_const(P1)(2,1)!=std::as_const(P1copy)(2,1)))
+        {
+          cerr << "packed matrix copy-on-write error"<<endl;
+          exit(-1);
+        }
+        cout << "Testing exclusive_address"<<endl;
+        dmatrix E(A);
+        double *eptr=E.exclusive_address(0,0);
+        dmatrix Ecopy(E);
+        dmatrix Eassigned;
+        Eassigned=E;
+        eptr[0]=999.0;
+        if((std::as_const(Ecopy)(0,0)==999.0) || (std::as_const(Eassigned)(0,0)==999.0)
+           || (std::as_const(E)(0,0)!=999.0))
+        {
+          cerr << "copy of a matrix with an exclusive pointer shares its samples"<<endl;
+          exit(-1);
+        }
+        E=A;
+        if((std::as_const(E).get_address(0,0)!=eptr) || (eptr[0]!=std::as_const(A)(0,0)))
+        {
+          cerr << "assignment to an exclusive matrix was not done in place"<<endl;
+          exit(-1);
+        }
+        cout << "Testing const reads of a SampleVector view"<<endl;
+        const SampleVector base{1.0,2.0,3.0,4.0,5.0};
+        const SampleVector sv=base.slice(1,3);
+        vector<double> svcopy(sv);
+        if(!sv.is_view() || (svcopy!=vector<double>{2.0,3.0,4.0})
+           || (sv.as_vector()!=svcopy) || (sv.data()!=base.data()+1))
+        {
+          cerr << "const read of a SampleVector view changed the view"<<endl;
+          exit(-1);
+        }
+        cout << "Testing views of an exclusive SampleVector"<<endl;
+        SampleVector xparent{1.0,2.0,3.0,4.0,5.0};
+        double *xptr=xparent.exclusive_vector().data();
+        SampleVector xview=std::as_const(xparent).slice(1,3);
+        xptr[1]=20.0;
+        xparent[2]=30.0;
+        xparent=SampleVector{-1.0,-2.0,-3.0,-4.0,-5.0};
+        if(!xview.is_view() || (std::as_const(xview).data()!=xptr+1)
+           || (std::as_const(xparent).data()!=xptr) || (xptr[0]!=-1.0))
+        {
+          cerr << "view of an exclusive SampleVector does not share its samples"<<endl;
+          exit(-1);
+        }
+        xparent[1]=20.0;
+        xparent.push_back(6.0);
+        xview[0]+=1.0;
+        if((xview.as_vector()!=vector<double>{21.0,-3.0,-4.0})
+           || (std::as_const(xparent)[1]!=20.0) || (xparent.size()!=6))
+        {
+          cerr << "view of an exclusive SampleVector was not released"<<endl;
+          exit(-1);
+        }
+        cout << "Success"<<endl;
         exit(0);
 
     }catch(std::exception& stex)
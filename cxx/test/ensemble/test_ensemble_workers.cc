@@ -0,0 +1,254 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Seismogram.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/algorithms/algorithms.h"
+#include "mspass/algorithms/amplitudes.h"
+#include "mspass/algorithms/Taper.h"
+#include "mspass/algorithms/Butterworth.h"
+#include "mspass/algorithms/EnsembleWorkers.h"
+using namespace std;
+using namespace mspass::utility;
+using namespace mspass::seismic;
+using namespace mspass::algorithms;
+using namespace mspass::algorithms::amplitudes;
+/* Tests of the threaded ensemble entry points.  Every result is compared
+to the serial result computed with the atomic version of the algorithm. */
+TimeSeries make_ts(const int k)
+{
+  TimeSeries d(1000);
+  for(size_t i=0;i<d.npts();++i) d.s[i]=sin(0.01*(i+k))*(k+1);
+  d.set_t0(0.0);
+  d.set_dt(0.01);
+  d.set_tref(TimeReferenceType::Relative);
+  d.set_live();
+  return d;
+}
+Seismogram make_seis(const int k)
+{
+  Seismogram d(500);
+  for(size_t j=0;j<d.npts();++j)
+    for(int i=0;i<3;++i) d.u(i,j)=cos(0.02*j*(i+1))*(k+1);
+  d.set_t0(0.0);
+  d.set_dt(0.01);
+  d.set_tref(TimeReferenceType::Relative);
+  d.set_live();
+  return d;
+}
+/* Operator whose apply throws for member 3 and marks the others */
+class FailOnMember
+{
+public:
+  FailOnMember(){};
+  void apply(TimeSeries& d)
+  {
+    if(d.get_long("member")==3)
+      throw MsPASSError("FailOnMember:  test error",ErrorSeverity::Invalid);
+    d.s[0]=-1.0;
+  };
+};
+int main(int argc, char **argv)
+{
+  const int nmembers(17);
+  LoggingEnsemble<TimeSeries> tse(nmembers);
+  for(int k=0;k<nmembers;++k)
+  {
+    TimeSeries d(make_ts(k));
+    d.put_long("member",k);
+    if(k==5) d.kill();
+    tse.member.push_back(d);
+  }
+  tse.set_live();
+  LoggingEnsemble<Seismogram> se(nmembers);
+  for(int k=0;k<nmembers;++k) se.member.push_back(make_seis(k));
+  se.set_live();
+
+  cout << "Testing for_each_index"<<endl;
+  vector<int> counts(1000,0);
+  for_each_index(counts.size(),NullOperator(),[&](NullOperator&, const size_t i){
+      ++counts[i];
+    },4);
+  for(auto c : counts) assert(c==1);
+  try{
+    for_each_index(100,NullOperator(),[](NullOperator&, const size_t i){
+        if(i==50) throw MsPASSError("test error",ErrorSeverity::Invalid);
+      },4);
+    cerr << "for_each_index did not rethrow an error"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+
+  cout << "Testing per member error handling"<<endl;
+  LoggingEnsemble<TimeSeries> tcopy(tse);
+  apply_to_members(FailOnMember(),tcopy,4);
+  for(int k=0;k<nmembers;++k)
+  {
+    if(k==3)
+    {
+      assert(tcopy.member[k].dead());
+      assert(tcopy.member[k].elog.size()==1);
+    }
+    else if(k==5)
+    {
+      assert(tcopy.member[k].dead());
+      assert(tcopy.member[k].s[0]==tse.member[k].s[0]);
+    }
+    else
+    {
+      assert(tcopy.member[k].live());
+      assert(tcopy.member[k].s[0]==-1.0);
+    }
+  }
+
+  cout << "Testing taper applied to ensemble members"<<endl;
+  CosineTaper taper(0.0,1.0,3.0,4.5);
+  tcopy=tse;
+  apply_to_members(taper,tcopy,4);
+  LoggingEnsemble<Seismogram> scopy(se);
+  apply_to_members(taper,scopy,3);
+  for(int k=0;k<nmembers;++k)
+  {
+    if(k==5) continue;
+    TimeSeries d(tse.member[k]);
+    taper.apply(d);
+    assert(d.s==tcopy.member[k].s);
+    Seismogram s(se.member[k]);
+    taper.apply(s);
+    for(size_t j=0;j<s.npts();++j)
+      for(int i=0;i<3;++i) assert(s.u(i,j)==scopy.member[k].u(i,j));
+  }
+
+  cout << "Testing WindowData for ensembles"<<endl;
+  TimeWindow tw(1.0,5.0);
+  LoggingEnsemble<TimeSeries> tw_out=WindowData(tse,tw,4);
+  assert(tw_out.live());
+  assert(tw_out.member.size()==tse.member.size());
+  for(int k=0;k<nmembers;++k)
+  {
+    if(k==5)
+    {
+      assert(tw_out.member[k].dead());
+      assert(tw_out.member[k].npts()==tse.member[k].npts());
+      continue;
+    }
+    TimeSeries d=WindowData(tse.member[k],tw);
+    assert(d.s==tw_out.member[k].s);
+    assert(tw_out.member[k].t0()==d.t0());
+  }
+  LoggingEnsemble<Seismogram> sw_out=WindowData(se,TimeWindow(1.0,20.0),4);
+  for(auto& m : sw_out.member) assert(m.dead());
+
+  cout << "Testing WindowData views"<<endl;
+  const TimeSeries& tparent(tse.member[0]);
+  TimeSeries tview=WindowData(tparent,tw,true);
+  const size_t is=tparent.sample_number(tw.start);
+  assert(tview.s.is_view());
+  assert(as_const(tview.s).data()==tparent.s.data()+is);
+  assert(tview.s==WindowData(tparent,tw).s);
+  assert(tview.npts()==tview.s.size() && tview.t0()==tw.start);
+  const Seismogram& sparent(se.member[0]);
+  Seismogram sview=WindowData(sparent,TimeWindow(1.0,4.0),true);
+  assert(as_const(sview.u).get_address(0,0)==sparent.u.get_address(0,is));
+  assert(sview.npts()==sview.u.columns() && sview.live());
+  LoggingEnsemble<TimeSeries> ew_out=WindowData(tse,tw,4,true);
+  for(int k=0;k<nmembers;++k)
+  {
+    if(k==5) continue;
+    assert(as_const(ew_out.member[k].s).data()==tse.member[k].s.data()+is);
+  }
+  /* A parent whose samples were used as a numpy array is exclusive.  The
+  view still shares its samples and sees later writes through the array,
+  but a write to the view does not change the parent. */
+  TimeSeries texcl(tparent);
+  double *texcl_array=texcl.s.exclusive_vector().data();
+  tview=WindowData(texcl,tw,true);
+  assert(tview.s.is_view());
+  assert(as_const(tview.s).data()==texcl_array+is);
+  texcl_array[is]=-10.0;
+  assert(as_const(tview.s)[0]==-10.0);
+  tview.s[1]=-20.0;
+  assert(!tview.s.is_view() && as_const(texcl.s)[is+1]==tparent.s[is+1]);
+  texcl=tparent;
+  assert(as_const(texcl.s).data()==texcl_array);
+
+  cout << "Testing agc for ensembles"<<endl;
+  scopy=se;
+  LoggingEnsemble<TimeSeries> gains=agc(scopy,0.5,4);
+  assert(gains.member.size()==se.member.size());
+  for(int k=0;k<nmembers;++k)
+  {
+    Seismogram s(se.member[k]);
+    TimeSeries g=agc(s,0.5);
+    assert(g.s==gains.member[k].s);
+    for(size_t j=0;j<s.npts();++j)
+      for(int i=0;i<3;++i) assert(s.u(i,j)==scopy.member[k].u(i,j));
+  }
+  scopy=se;
+  for(auto& m : scopy.member) m.kill();
+  gains=agc(scopy,0.5,4);
+  assert(gains.dead());
+  scopy=se;
+  scopy.kill();
+  gains=agc(scopy,0.5,4);
+  assert(gains.dead());
+
+  cout << "Testing scale_ensemble_members with threads"<<endl;
+  tcopy=tse;
+  LoggingEnsemble<TimeSeries> tcopy2(tse);
+  vector<double> amps1=scale_ensemble_members(tcopy,ScalingMethod::RMS,1.0,
+    TimeWindow(0.0,-1.0));
+  vector<double> amps4=scale_ensemble_members(tcopy2,ScalingMethod::RMS,1.0,
+    TimeWindow(0.0,-1.0),4);
+  assert(amps1==amps4);
+  assert(amps1[5]==0.0);
+  for(int k=0;k<nmembers;++k) assert(tcopy.member[k].s==tcopy2.member[k].s);
+
+  cout << "Testing pack_samples"<<endl;
+  tcopy=tse;
+  tcopy.pack_samples();
+  for(int k=0;k<nmembers;++k)
+  {
+    assert(tcopy.member[k].s.packed());
+    assert(tcopy.member[k].s==tse.member[k].s);
+    assert(reinterpret_cast<uintptr_t>(as_const(tcopy.member[k].s).data())%64==0);
+    if(k>0) assert(as_const(tcopy.member[k].s).data()
+              ==as_const(tcopy.member[k-1].s).data()+tcopy.member[k-1].npts());
+  }
+  apply_to_members(taper,tcopy,4);
+  for(int k=0;k<nmembers;++k)
+  {
+    assert(tcopy.member[k].s.packed());
+    if(k==5) continue;
+    TimeSeries d(tse.member[k]);
+    taper.apply(d);
+    assert(d.s==tcopy.member[k].s);
+  }
+  /* Filtering a packed member must work in its slot */
+  Butterworth bw(false,true,true,2,1.0,2,10.0,0.01);
+  const double *slot=as_const(tcopy.member[1].s).data();
+  TimeSeries bwref(tcopy.member[1]);
+  bw.apply(bwref);
+  bw.apply(tcopy.member[1]);
+  assert(tcopy.member[1].s.packed());
+  assert(as_const(tcopy.member[1].s).data()==slot);
+  assert(tcopy.member[1].s==bwref.s);
+  scopy=se;
+  scopy.pack_samples();
+  Seismogram s0(scopy.member[0]);
+  scopy.member[0]*=2.0;
+  assert(scopy.member[0].u(1,3)==2.0*s0.u(1,3));
+  assert(s0.u(1,3)==se.member[0].u(1,3));
+
+  cout << "Testing hold_python_objects"<<endl;
+  assert(!hold_python_objects(tse));
+  cout << "All tests passed"<<endl;
+}
@@ -0,0 +1,417 @@
+#include <assert.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <thread>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "mspass/seismic/keywords.h"
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Seismogram.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/io/fileio.h"
+#include "mspass/io/FileHandleCache.h"
+#include "mspass/io/ReadPlanner.h"
+#include "mspass/io/MappedFile.h"
+#include "mspass/io/PrefetchReader.h"
+#include "mspass/io/ContainerFile.h"
+#include "mspass/io/ConcurrentAppender.h"
+#include "mspass/algorithms/TimeWindow.h"
+using namespace std;
+using namespace mspass::io;
+using namespace mspass::seismic;
+using mspass::algorithms::TimeWindow;
+/* Tests the native fwrite_to_file and fread_from_file functions
+with the file handle cache off and on.  Files are written in
+the current directory. */
+const string dir(".");
+const string dfile("test_fileio.dat");
+LoggingEnsemble<TimeSeries> make_ensemble(const int nmembers)
+{
+  LoggingEnsemble<TimeSeries> e(nmembers);
+  for(int k=0;k<nmembers;++k)
+  {
+    TimeSeries d(100+k);
+    for(size_t i=0;i<d.npts();++i) d.s[i]=1000.0*k+i;
+    d.set_live();
+    e.member.push_back(d);
+  }
+  e.set_live();
+  return e;
+}
+void run_tests(const size_t cache_size)
+{
+  cout << "Running tests with file handle cache size="<<cache_size<<endl;
+  FileHandleCache::instance().set_size(cache_size);
+  unlink(dfile.c_str());
+  TimeSeries d(100);
+  for(size_t i=0;i<100;++i) d.s[i]=i;
+  d.set_live();
+  long int foff=fwrite_to_file(d,dir,dfile);
+  assert(foff==0);
+  foff=fwrite_to_file(d,dir,dfile);
+  assert(foff==800);
+  assert(d.get_long(SEISMICMD_foff)==800);
+  TimeSeries dr(100);
+  assert(fread_from_file(dr,dir,dfile,foff)==100);
+  for(size_t i=0;i<100;++i) assert(dr.s[i]==d.s[i]);
+
+  cout << "Testing ensemble writer and coalesced reader"<<endl;
+  LoggingEnsemble<TimeSeries> e=make_ensemble(20);
+  e.member[5].kill();
+  vector<long int> foffs=fwrite_to_file(e,dir,dfile);
+  assert(foffs.size()==20);
+  assert(foffs[5]==-1);
+  /* Members should be contiguous starting after the two TimeSeries*/
+  assert(foffs[0]==1600);
+  for(int k=1;k<20;++k)
+  {
+    if(k==5 || k==6) continue;
+    assert(foffs[k]==foffs[k-1]+static_cast<long int>(8*e.member[k-1].npts()));
+  }
+  /* Read back in reverse order.  The planner should sort the
+  requests and merge the gap left by dead member 5*/
+  LoggingEnsemble<TimeSeries> er=make_ensemble(20);
+  vector<long int> indexes;
+  for(int k=19;k>=0;--k)
+  {
+    if(k==5) continue;
+    er.member[k].put_long(SEISMICMD_foff,foffs[k]);
+    for(size_t i=0;i<er.member[k].npts();++i) er.member[k].s[i]=0.0;
+    indexes.push_back(k);
+  }
+  ReadStatistics stats;
+  size_t ns=fread_from_file(er,dir,dfile,indexes,stats);
+  size_t nexpected(0);
+  for(auto k : indexes) nexpected += er.member[k].npts();
+  assert(ns==nexpected);
+  assert(stats.nrequests==19);
+  assert(stats.nranges==1);
+  assert(stats.syscalls==1);
+  assert(stats.bytes_read==8*nexpected);
+  for(auto k : indexes)
+  {
+    assert(er.member[k].live());
+    for(size_t i=0;i<er.member[k].npts();++i)
+      assert(er.member[k].s[i]==e.member[k].s[i]);
+  }
+  cout << "Testing handling of short read at end of file"<<endl;
+  LoggingEnsemble<TimeSeries> eshort=make_ensemble(2);
+  eshort.member[0].put_long(SEISMICMD_foff,foffs[19]);
+  /* Last member of the file has 119 samples so member 1 gets only 19*/
+  eshort.member[1].put_long(SEISMICMD_foff,foffs[19]+800);
+  ns=fread_from_file(eshort,dir,dfile,{0,1});
+  assert(eshort.member[0].live());
+  assert(eshort.member[1].dead());
+  assert(ns==119);
+
+  cout << "Testing Seismogram ensemble"<<endl;
+  LoggingEnsemble<Seismogram> se(3);
+  for(int k=0;k<3;++k)
+  {
+    Seismogram s(10);
+    for(size_t j=0;j<10;++j)
+      for(size_t i=0;i<3;++i) s.u(i,j)=100.0*k+10.0*i+j;
+    s.set_live();
+    se.member.push_back(s);
+  }
+  se.set_live();
+  foffs=fwrite_to_file(se,dir,dfile);
+  LoggingEnsemble<Seismogram> ser(se);
+  for(int k=0;k<3;++k) ser.member[k].u.zero();
+  ns=fread_from_file(ser,dir,dfile,{2,0,1},stats);
+  assert(ns==90);
+  assert(stats.syscalls==1);
+  for(int k=0;k<3;++k)
+    for(size_t j=0;j<10;++j)
+      for(size_t i=0;i<3;++i) assert(ser.member[k].u(i,j)==se.member[k].u(i,j));
+  FileHandleCache::instance().close_all();
+  unlink(dfile.c_str());
+}
+int main(int argc, char **argv)
+{
+  run_tests(0);
+  run_tests(4);
+  cout << "Testing planner gap and range limits"<<endl;
+  TimeSeries d(1000);
+  for(size_t i=0;i<1000;++i) d.s[i]=i;
+  d.set_live();
+  unlink(dfile.c_str());
+  fwrite_to_file(d,dir,dfile);
+  shared_ptr<CachedFile> fh=FileHandleCache::instance().get(dfile,false);
+  vector<double> b1(10),b2(10),b3(10);
+  ReadPlanner plan(64);
+  plan.add(b1.data(),0,10);
+  /* 80 byte gap is merged, b3 is 720 bytes past b2 so is a new range*/
+  plan.add(b2.data(),160,10);
+  plan.add(b3.data(),1040,10);
+  vector<size_t> nread=plan.execute(*fh);
+  ReadStatistics stats=plan.statistics();
+  assert(nread[0]==10 && nread[1]==10 && nread[2]==10);
+  assert(stats.nranges==3);
+  plan=ReadPlanner(100);
+  plan.add(b1.data(),0,10);
+  plan.add(b2.data(),160,10);
+  plan.add(b3.data(),1040,10);
+  nread=plan.execute(*fh);
+  stats=plan.statistics();
+  assert(stats.nranges==2);
+  assert(stats.gap_bytes==80);
+  assert(b2[0]==20.0 && b3[9]==139.0);
+
+  cout << "Testing memory mapped readers"<<endl;
+  TimeSeries dm(1000);
+  assert(mmap_read_from_file(dm,dir,dfile,0)==1000);
+  for(size_t i=0;i<1000;++i) assert(dm.s[i]==d.s[i]);
+  dm.set_dt(0.01);
+  dm.set_t0(100.0);
+  assert(mmap_read_from_file(dm,dir,dfile,0,TimeWindow(101.0,101.99))==100);
+  assert(dm.npts()==100);
+  assert(fabs(dm.t0()-101.0)<0.001);
+  assert(dm.s[0]==100.0 && dm.s[99]==199.0);
+  try{
+    dm.set_npts(1000);
+    mmap_read_from_file(dm,dir,dfile,0,TimeWindow(90.0,101.0));
+    assert(false);
+  }catch(mspass::utility::MsPASSError& err)
+  {
+    cout << "Expected error handled"<<endl;
+  }
+  Seismogram dm3(0);
+  assert(mmap_read_from_file(dm3,dir,dfile,0)==0);
+  MappedSampleView view=mmap_sample_view(dir,dfile,800,10);
+  assert(view.size()==10 && view[0]==100.0 && view[9]==109.0);
+  LoggingEnsemble<TimeSeries> em=make_ensemble(3);
+  em.member[0].put_long(SEISMICMD_foff,0);
+  em.member[1].put_long(SEISMICMD_foff,7992);
+  assert(mmap_read_from_file(em,dir,dfile,{0,1,2})==101);
+  assert(em.member[0].live() && em.member[0].s[99]==99.0);
+  assert(em.member[1].dead());
+  assert(em.member[2].dead());
+  cout << "Testing prefetching reader"<<endl;
+  vector<PrefetchRequest> requests;
+  for(int k=0;k<10;++k)
+    requests.push_back(PrefetchRequest(dir,dfile,800*k,800));
+  requests.push_back(PrefetchRequest(dir,"not_a_file",0,800));
+  PrefetchReader reader(requests,3,2);
+  PrefetchResult result;
+  size_t nresults(0);
+  while(reader.next(result))
+  {
+    assert(result.index==nresults);
+    if(nresults<10)
+    {
+      TimeSeries dp(100);
+      assert(result.ok);
+      assert(result.load(dp)==100);
+      assert(dp.s[0]==100.0*nresults);
+    }
+    else
+      assert(!result.ok);
+    ++nresults;
+  }
+  assert(nresults==11);
+  cout << "Testing sample encodings"<<endl;
+  FileHandleCache::instance().close_all();
+  unlink(dfile.c_str());
+  /* Integer data longer than one delta block with one non-integer
+  block to force the raw fallback */
+  TimeSeries de(10000);
+  for(size_t i=0;i<10000;++i) de.s[i]=floor(5000.0*sin(0.01*i));
+  de.s[9000]=0.5;
+  de.set_live();
+  vector<SampleEncoding> encodings={SampleEncoding::float64,
+    SampleEncoding::float32,SampleEncoding::int32,SampleEncoding::delta};
+  for(auto enc : encodings)
+  {
+    long int efoff=fwrite_to_file(de,dir,dfile,enc);
+    assert(get_sample_encoding(de)==enc);
+    TimeSeries dr(de);
+    for(size_t i=0;i<dr.npts();++i) dr.s[i]=0.0;
+    assert(fread_from_file(dr,dir,dfile,efoff)==10000);
+    for(size_t i=0;i<10000;++i)
+    {
+      if(enc==SampleEncoding::int32)
+        assert(fabs(dr.s[i]-de.s[i])<=get_sample_scale(de));
+      else
+        assert(dr.s[i]==de.s[i]);
+    }
+    dr.set_dt(0.01);
+    dr.set_t0(0.0);
+    dr.set_npts(10000);
+    assert(mmap_read_from_file(dr,dir,dfile,efoff,TimeWindow(10.0,10.99))==100);
+    assert(fabs(dr.s[0]-de.s[1000])<=get_sample_scale(de));
+  }
+  assert(de.get_long(SEISMICMD_nbytes)<40000);
+  /* A fixed width save must not leave the delta size behind */
+  fwrite_to_file(de,dir,dfile,SampleEncoding::float32);
+  assert(!de.is_defined(SEISMICMD_nbytes));
+  LoggingEnsemble<TimeSeries> ee=make_ensemble(5);
+  vector<long int> foffs=fwrite_to_file(ee,dir,dfile,SampleEncoding::delta);
+  LoggingEnsemble<TimeSeries> eer(ee);
+  vector<long int> indexes;
+  for(int k=0;k<5;++k)
+  {
+    assert(eer.member[k].get_long(SEISMICMD_foff)==foffs[k]);
+    for(size_t i=0;i<eer.member[k].npts();++i) eer.member[k].s[i]=0.0;
+    indexes.push_back(k);
+  }
+  fread_from_file(eer,dir,dfile,indexes,stats);
+  assert(stats.nranges==1);
+  for(int k=0;k<5;++k)
+  {
+    assert(eer.member[k].live());
+    for(size_t i=0;i<ee.member[k].npts();++i)
+      assert(eer.member[k].s[i]==ee.member[k].s[i]);
+  }
+  cout << "Testing container files"<<endl;
+  const string cfile("test_container.dat");
+  unlink(cfile.c_str());
+  LoggingEnsemble<TimeSeries> ce=make_ensemble(6);
+  ce.member[2].kill();
+  Seismogram d3(50);
+  for(size_t i=0;i<50;++i)
+    for(int k=0;k<3;++k) d3.u(k,i)=100.0*k+i;
+  d3.set_t0(1000.0);
+  d3.set_live();
+  {
+    ContainerWriter cw(dir,cfile,false);
+    vector<long int> ids=cw.write(ce,SampleEncoding::delta);
+    assert(ids[2]==-1 && ids[5]==4);
+    assert(cw.write(d3,SampleEncoding::float64,"three_c")==5);
+  }
+  {
+    /* Append to the closed container */
+    ContainerWriter cw(dir,cfile);
+    assert(cw.size()==6);
+    cw.write(de,SampleEncoding::float32,"long_one");
+    cw.close();
+  }
+  ContainerReader cr(dir,cfile);
+  assert(cr.size()==7);
+  assert(cr.find("three_c")==5);
+  assert(cr.find("not_there")==-1);
+  assert(cr.entry(0).id==ce.member[0].id());
+  Seismogram d3r=cr.read_Seismogram(5);
+  assert(d3r.live() && d3r.npts()==50 && d3r.t0()==1000.0);
+  assert(d3r.u(2,49)==249.0);
+  TimeSeries dl=cr.read_TimeSeries(cr.find("long_one"));
+  for(size_t i=0;i<10000;++i) assert(dl.s[i]==de.s[i]);
+  try{
+    cr.read_TimeSeries(5);
+    assert(false);
+  }catch(mspass::utility::MsPASSError& err)
+  {
+    cout << "Expected error handled"<<endl;
+  }
+  LoggingEnsemble<TimeSeries> cer=cr.read_TimeSeriesEnsemble();
+  assert(cer.member.size()==6);
+  for(size_t k=0;k<5;++k)
+  {
+    assert(cer.member[k].live());
+    size_t korig = (k<2) ? k : k+1;
+    assert(cer.member[k].npts()==ce.member[korig].npts());
+    for(size_t i=0;i<cer.member[k].npts();++i)
+      assert(cer.member[k].s[i]==ce.member[korig].s[i]);
+  }
+  /* Corrupt one byte of the first block and verify the checksum catches it*/
+  {
+    FileHandleCache::instance().close_all();
+    FILE *fp=fopen(cfile.c_str(),"r+");
+    fseek(fp,cr.entry(0).foff+1,SEEK_SET);
+    fputc(0x7F,fp);
+    fclose(fp);
+  }
+  cer=cr.read_TimeSeriesEnsemble({0,1});
+  assert(cer.member[0].dead() && cer.member[1].live());
+  /* Data left by an appending writer that was not closed must not
+  hide the entries written earlier */
+  {
+    FileHandleCache::instance().close_all();
+    FILE *fp=fopen(cfile.c_str(),"a");
+    for(size_t i=0;i<1000;++i) fputc(static_cast<int>(i%251),fp);
+    fclose(fp);
+    ContainerReader crtail(dir,cfile);
+    assert(crtail.size()==7 && crtail.find("long_one")==6);
+  }
+  try{
+    ContainerWriter cw(dir,cfile);
+    cw.write(d3,SampleEncoding::float64,string(70000,'x'));
+    assert(false);
+  }catch(mspass::utility::MsPASSError& err)
+  {
+    cout << "Expected error handled"<<endl;
+  }
+  FileHandleCache::instance().close_all();
+  unlink(cfile.c_str());
+  cout << "Testing concurrent appenders"<<endl;
+  const string afile("test_append.dat");
+  unlink(afile.c_str());
+  unlink(ConcurrentAppender::lock_file_name(afile).c_str());
+  /* Small extents force frequent trips through the lock file */
+  ConcurrentAppender::set_enabled(true,4096);
+  const int nwriters(4),nsaves(50);
+  vector<vector<long int>> afoffs(nwriters);
+  auto writer=[&](const int w){
+    for(int k=0;k<nsaves;++k)
+    {
+      TimeSeries da(100+k);
+      for(size_t i=0;i<da.npts();++i) da.s[i]=10000.0*w+100.0*k+i;
+      da.set_live();
+      afoffs[w].push_back(fwrite_to_file(da,dir,afile));
+    }
+  };
+  /* Two processes with several threads each write the same file */
+  pid_t pid=fork();
+  vector<std::thread> writers;
+  int wstart = (pid==0) ? 0 : 2;
+  for(int w=wstart;w<wstart+2;++w) writers.emplace_back(writer,w);
+  for(auto& t : writers) t.join();
+  ConcurrentAppender::close_all();
+  if(pid==0)
+  {
+    /* Child passes its offsets to the parent through a file */
+    FILE *fp=fopen("test_append.foff","w");
+    for(int w=0;w<2;++w) fwrite(afoffs[w].data(),sizeof(long int),nsaves,fp);
+    fclose(fp);
+    _exit(0);
+  }
+  int status;
+  waitpid(pid,&status,0);
+  FILE *fp=fopen("test_append.foff","r");
+  for(int w=0;w<2;++w)
+  {
+    afoffs[w].resize(nsaves);
+    assert(fread(afoffs[w].data(),sizeof(long int),nsaves,fp)==nsaves);
+  }
+  fclose(fp);
+  unlink("test_append.foff");
+  ConcurrentAppender::set_enabled(false);
+  for(int w=0;w<nwriters;++w)
+  {
+    for(int k=0;k<nsaves;++k)
+    {
+      TimeSeries da(100+k);
+      assert(fread_from_file(da,dir,afile,afoffs[w][k])==da.npts());
+      for(size_t i=0;i<da.npts();++i)
+        assert(da.s[i]==10000.0*w+100.0*k+i);
+    }
+  }
+  FileHandleCache::instance().close_all();
+  /* A file created again after removal must not start at the offset
+  left in the lock file */
+  unlink(afile.c_str());
+  {
+    ConcurrentAppender a(afile,4096);
+    const double x(1.0);
+    assert(a.write_bytes(reinterpret_cast<const char*>(&x),sizeof(double))==0);
+  }
+  unlink(afile.c_str());
+  ConcurrentAppender::remove_lock_file(afile);
+  assert(access(ConcurrentAppender::lock_file_name(afile).c_str(),F_OK)!=0);
+  unlink(dfile.c_str());
+  /* The view keeps the mapping alive after the file is removed*/
+  assert(view[5]==105.0);
+  cout << "All tests passed"<<endl;
+}
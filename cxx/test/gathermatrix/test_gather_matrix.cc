@@ -0,0 +1,132 @@
+#include <assert.h>
+#include <math.h>
+#include <iostream>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/utility/dmatrix.h"
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/algorithms/GatherMatrix.h"
+using namespace std;
+using namespace mspass::utility;
+using namespace mspass::seismic;
+using namespace mspass::algorithms;
+TimeSeries make_ts(const size_t n, const double t0, const double dt, const int k)
+{
+  TimeSeries d(n);
+  for(size_t i=0;i<d.npts();++i) d.s[i]=static_cast<double>(100*k+i+1);
+  d.set_t0(t0);
+  d.set_dt(dt);
+  d.set_tref(TimeReferenceType::Relative);
+  d.set_live();
+  return d;
+}
+int main(int argc, char **argv)
+{
+  LoggingEnsemble<TimeSeries> e(5);
+  e.member.push_back(make_ts(50,0.0,0.01,0));
+  e.member.push_back(make_ts(40,0.05,0.01,1));
+  e.member.push_back(make_ts(30,-0.1,0.01,2));
+  e.member.push_back(make_ts(30,0.0,0.01,3));
+  e.member[3].kill();
+  e.member.push_back(make_ts(30,0.0,0.02,4));
+  e.set_live();
+
+  cout << "Testing GatherMatrix constructor"<<endl;
+  GatherMatrix g(e);
+  assert(g.members()==5);
+  assert(g.number_live()==3);
+  assert(g.live(0) && g.live(1) && g.live(2) && !g.live(3) && !g.live(4));
+  assert(fabs(g.t0()+0.1)<1.0e-12);
+  assert(g.dt()==0.01);
+  assert(g.row_offset(0)==10 && g.row_offset(1)==15 && g.row_offset(2)==0);
+  /* member 0 ends last - offset 10 plus 50 samples */
+  assert(g.npts()==60);
+  assert(g.sample_number(0.05)==15);
+  const dmatrix& A=g.matrix();
+  assert(A.rows()==60 && A.columns()==5);
+  for(size_t j=0;j<3;++j)
+  {
+    const size_t k0=g.row_offset(j);
+    for(size_t i=0;i<A.rows();++i)
+    {
+      if(i<k0 || i>=k0+e.member[j].npts())
+        assert(A(i,j)==0.0);
+      else
+        assert(A(i,j)==e.member[j].s[i-k0]);
+    }
+  }
+  for(size_t i=0;i<A.rows();++i) assert(A(i,3)==0.0 && A(i,4)==0.0);
+
+  cout << "Testing scatter"<<endl;
+  LoggingEnsemble<TimeSeries> eorig(e);
+  dmatrix& B=g.matrix();
+  for(size_t j=0;j<B.columns();++j)
+    for(size_t i=0;i<B.rows();++i) B(i,j)*=2.0;
+  g.scatter(e);
+  for(size_t j=0;j<5;++j)
+    for(size_t i=0;i<e.member[j].npts();++i)
+    {
+      if(j<3)
+        assert(e.member[j].s[i]==2.0*eorig.member[j].s[i]);
+      else
+        assert(e.member[j].s[i]==eorig.member[j].s[i]);
+    }
+  e.member[1].set_npts(10);
+  try{
+    g.scatter(e);
+    cerr << "scatter did not throw for a member with a changed size"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  e.member.pop_back();
+  try{
+    g.scatter(e);
+    cerr << "scatter did not throw for an ensemble with a different size"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+
+  cout << "Testing members too far apart for the matrix size"<<endl;
+  LoggingEnsemble<TimeSeries> far(eorig);
+  far.member[1].set_t0(1.0e6);
+  try{
+    GatherMatrix gfar(far);
+    cerr << "constructor did not throw for members 1e6 s apart"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  GatherMatrix gsmall(eorig,0.0001,60);
+  assert(gsmall.npts()==60);
+  try{
+    GatherMatrix gsmaller(eorig,0.0001,59);
+    cerr << "constructor did not throw for max_npts smaller than the time axis"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  cout << "Testing invalid sample interval"<<endl;
+  LoggingEnsemble<TimeSeries> baddt(eorig);
+  baddt.member[0].set_dt(0.0);
+  try{
+    GatherMatrix gbaddt(baddt);
+    cerr << "constructor did not throw for a zero sample interval"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+
+  cout << "Testing ensemble with no live members"<<endl;
+  LoggingEnsemble<TimeSeries> dead(eorig);
+  for(auto& d : dead.member) d.kill();
+  GatherMatrix gdead(dead);
+  assert(gdead.members()==5 && gdead.number_live()==0 && gdead.npts()==0);
+  cout << "All tests passed"<<endl;
+}
@@ -1,3 +1,4 @@
+#include <assert.h>
 #include <boost/archive/text_oarchive.hpp>
 #include "mspass/utility/ErrorLogger.h"
 #include "mspass/utility/MsPASSError.h"
@@ -186,6 +187,101 @@ int main(int argc, char **argv)
                 {
                     cout << *lptr<<endl;
                 }
+		cout << "Testing flat storage and key handles"<<endl;
+		Metadata mdflat;
+		const MetadataKey<double> dtkey("delta");
+		const MetadataKey<long> nkey("npts");
+		mdflat.put("zzz",1.0);
+		mdflat.put(dtkey,0.01);
+		mdflat.put_long("npts",100);
+		mdflat.put("aaa",string("first"));
+		/* Iteration is in key order regardless of insertion order */
+		string lastkey;
+		for(auto mptr=mdflat.begin();mptr!=mdflat.end();++mptr)
+		{
+		    assert(mptr->first>lastkey);
+		    lastkey=mptr->first;
+		}
+		assert(mdflat.size()==4);
+		assert(mdflat.get(dtkey)==0.01);
+		assert(mdflat.get_double("delta")==0.01);
+		assert(mdflat.get(nkey)==100);
+		assert(mdflat.is_defined(nkey));
+		assert(mdflat.modified().count("delta")==1);
+		mdflat.change_key("aaa","bbb");
+		assert(!mdflat.is_defined("aaa"));
+		assert(mdflat.get_string("bbb")=="first");
+		mdflat.erase("npts");
+		assert(!mdflat.is_defined(nkey));
+		mdflat.put_int("npts",7);
+		/* Handles accept the same alternative types as the typed getters */
+		assert(mdflat.get(nkey)==7);
+		assert(mdflat.get_long("npts")==7);
+		mdflat.put("delta",0.25f);
+		assert(mdflat.get(dtkey)==0.25);
+		mdflat.put("delta",string("bad"));
+		try{
+		    mdflat.get(dtkey);
+		    cout << "Error - handle get did not detect a type mismatch"<<endl;
+		    exit(-1);
+		}catch(MetadataGetError& merr)
+		{
+		    cout << "Handle get detected type mismatch as expected"<<endl;
+		}
+		mdflat.put(dtkey,0.01);
+		Metadata mdcopy(mdflat);
+		mdcopy.put(dtkey,0.02);
+		assert(mdflat.get(dtkey)==0.01);
+		assert(mdcopy.get(dtkey)==0.02);
+		cout << "Flat storage tests passed"<<endl;
+		cout << "Testing shared storage with merge_shared"<<endl;
+		Metadata header;
+		header.put("delta",0.05);
+		header.put("evid",long(42));
+		header.put("sta",string("AAK"));
+		Metadata m1,m2;
+		m1.put("sta",string("BBK"));
+		m1.put("npts",long(10));
+		m1.merge_shared(header);
+		m2.merge_shared(header);
+		assert(m1.size()==4);
+		assert(m2.size()==3);
+		assert(m1.get_string("sta")=="AAK");
+		assert(m1.get_long("npts")==10);
+		assert(m1.get(dtkey)==0.05);
+		/* Changes to a member must not be visible in the header or other members */
+		m1.put(dtkey,0.1);
+		m2.erase("evid");
+		assert(header.get(dtkey)==0.05);
+		assert(m2.get(dtkey)==0.05);
+		assert(m1.get_long("evid")==42);
+		assert(!m2.is_defined("evid"));
+		assert(m2.size()==2);
+		m2.put("evid",long(7));
+		assert(m2.get_long("evid")==7);
+		assert(header.get_long("evid")==42);
+		header.put("sta",string("CCK"));
+		assert(m1.get_string("sta")=="AAK");
+		lastkey="";
+		size_t nkeys(0);
+		for(auto mptr=m1.begin();mptr!=m1.end();++mptr,++nkeys)
+		{
+		    assert(mptr->first>lastkey);
+		    lastkey=mptr->first;
+		}
+		assert(nkeys==m1.size());
+		/* A second merge replaces the shared values and keeps the others */
+		Metadata header2;
+		header2.put("sta",string("DDK"));
+		m1.merge_shared(header2);
+		assert(m1.get_string("sta")=="DDK");
+		assert(m1.get(dtkey)==0.1);
+		assert(m1.get_long("evid")==42);
+		assert(m1.size()==4);
+		m1.change_key("evid","event_id");
+		assert(m1.get_long("event_id")==42);
+		assert(!m1.is_defined("evid"));
+		cout << "Shared storage tests passed"<<endl;
 
 	}
 	catch (MsPASSError& sess)
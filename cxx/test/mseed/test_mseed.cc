@@ -1,5 +1,7 @@
 #include <assert.h>
+#include <unistd.h>
 #include "mspass/io/mseed_index.h"
+#include "mspass/io/MseedTimeIndex.h"
 #include "mspass/seismic/TimeSeries.h"
 #include "mspass/utility/ErrorLogger.h"
 using namespace std;
@@ -53,6 +55,61 @@ int main(int argc, char **argv)
   assert(ind[3].sta=="A2000");
   assert(ind[3].foff==1925120);
   assert(ind[3].npts==47205);
+  cout << "Testing mseed_fread_from_file for block 0 and block 3"<<endl;
+  TimeSeries d(ind[0].npts);
+  d.set_dt(1.0/ind[0].samprate);
+  d.set_t0(ind[0].starttime);
+  size_t ns=mseed_fread_from_file(d,string(""),fname,ind[0]);
+  cout << "Number of samples decoded="<<ns<<endl;
+  assert(ns==70);
+  assert(d.npts()==70);
+  assert(fabs(d.t0()-ind[0].starttime)<0.5*d.dt());
+  /* This overload is driven by the index and has to resize the vector */
+  TimeSeries d3;
+  d3.set_dt(1.0/ind[3].samprate);
+  d3.set_t0(ind[3].starttime);
+  ns=mseed_fread_from_file(d3,string(""),fname,ind[3]);
+  cout << "Number of samples decoded="<<ns<<endl;
+  assert(ns==47205);
+  assert(d3.npts()==47205);
+  cout << "Testing parallel indexer and sidecar cache"<<endl;
+  string sidecar=mseed_sidecar_name(fname,".");
+  unlink(sidecar.c_str());
+  vector<string> files={fname,fname,"not_a_file.msd"};
+  auto results=mseed_index_files(files,3,true,false,true,".");
+  assert(results.size()==3);
+  assert(results[0].first.size()==ind.size());
+  assert(results[1].first.size()==ind.size());
+  assert(results[2].first.size()==0);
+  assert(results[2].second.size()>0);
+  assert(access(sidecar.c_str(),R_OK)==0);
+  results=mseed_index_files(files,2,true,false,true,".");
+  for(size_t i=0;i<ind.size();++i)
+  {
+    assert(results[0].first[i].sta==ind[i].sta);
+    assert(results[0].first[i].foff==ind[i].foff);
+    assert(results[0].first[i].npts==ind[i].npts);
+    assert(results[0].first[i].starttime==ind[i].starttime);
+  }
+  unlink(sidecar.c_str());
+  cout << "Testing time range queries"<<endl;
+  MseedTimeIndex tindex(ind,string(""),fname);
+  assert(tindex.size()==ind.size());
+  vector<MseedBlock> blocks=tindex.query(ind[1].net,ind[1].sta,ind[1].loc,
+    ind[1].chan,ind[1].starttime+100.0,ind[1].starttime+200.0);
+  assert(blocks.size()>=1);
+  bool found(false);
+  for(auto& b : blocks)
+  {
+    assert(b.dfile==fname);
+    assert(b.index.starttime<=ind[1].starttime+200.0);
+    assert(b.index.endtime>=ind[1].starttime+100.0);
+    if(b.index.foff==ind[1].foff) found=true;
+  }
+  assert(found);
+  blocks=tindex.query(ind[1].net,ind[1].sta,ind[1].loc,ind[1].chan,
+    ind[1].endtime+1.0e6,ind[1].endtime+2.0e6);
+  assert(blocks.size()==0);
 }
 
 
@@ -0,0 +1,356 @@
+#include <assert.h>
+#include <math.h>
+#include <limits>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "mspass/utility/MsPASSError.h"
+#include "mspass/seismic/keywords.h"
+#include "mspass/seismic/TimeSeries.h"
+#include "mspass/seismic/Seismogram.h"
+#include "mspass/seismic/Ensemble.h"
+#include "mspass/seismic/BinarySerialization.h"
+#include "mspass/seismic/ArrowConverter.h"
+using namespace std;
+using namespace mspass::utility;
+using namespace mspass::seismic;
+/* Tests of the binary format used by the pickle interface.  These only
+use Metadata types that do not require a python interpreter. */
+void load_common(Metadata& md, ProcessingHistory& his)
+{
+  md.put("sta",string("AAK"));
+  md.put_long("npts_saved",12345);
+  md.put("delta",0.025);
+  md.put("flag",true);
+  md.put_int("ival",-7);
+  md.put<float>("fval",1.5);
+  md.clear_modified();
+  md.put("changed",string("yes"));
+  his.set_jobname("testjob");
+  his.set_jobid("42");
+  his.set_as_origin("reader","0",his.newid(),AtomicType::TIMESERIES);
+  his.new_map("filter","1",AtomicType::TIMESERIES);
+  his.elog.log_error("test","a logged warning",ErrorSeverity::Complaint);
+}
+void compare_common(const Metadata& a, const Metadata& b,
+  const ProcessingHistory& ha, const ProcessingHistory& hb)
+{
+  assert(a.keys()==b.keys());
+  assert(b.get_string("sta")=="AAK");
+  assert(b.get_long("npts_saved")==12345);
+  assert(b.get_double("delta")==0.025);
+  assert(b.get_bool("flag"));
+  assert(b.get_int("ival")==-7);
+  assert(b.get<float>("fval")==1.5);
+  assert(a.modified()==b.modified());
+  assert(ha.jobname()==hb.jobname());
+  assert(ha.jobid()==hb.jobid());
+  assert(ha.id()==hb.id());
+  assert(ha.stage()==hb.stage());
+  assert(ha.status()==hb.status());
+  assert(ha.get_nodes().size()==hb.get_nodes().size());
+  assert(hb.elog.size()==1);
+  assert(hb.elog.get_error_log().front().message=="a logged warning");
+}
+int main(int argc, char **argv)
+{
+  cout << "Testing binary serialization of TimeSeries"<<endl;
+  TimeSeries ts(1000);
+  for(size_t i=0;i<ts.npts();++i) ts.s[i]=sin(0.01*i);
+  ts.set_t0(1.0e9);
+  ts.set_dt(0.01);
+  ts.set_tref(TimeReferenceType::UTC);
+  ts.set_live();
+  load_common(ts,ts);
+  vector<char> buf;
+  size_t n=serialize_binary(ts,buf);
+  assert(n==buf.size());
+  /* The format must be much smaller than a text archive */
+  assert(n<BINARY_SERIALIZATION_HEADER_SIZE+sizeof(double)*ts.npts()+2048);
+  size_t nused;
+  TimeSeries ts2=deserialize_TimeSeries(buf.data(),buf.size(),&nused);
+  assert(nused==n);
+  assert(ts2.live());
+  assert(ts2.npts()==ts.npts());
+  assert(ts2.t0()==ts.t0());
+  assert(ts2.dt()==ts.dt());
+  assert(ts2.time_is_UTC());
+  assert(ts2.s==ts.s);
+  compare_common(ts,ts2,ts,ts2);
+  assert(ts2.modified().size()==1);
+
+  cout << "Testing binary serialization of Seismogram"<<endl;
+  Seismogram seis(500);
+  for(size_t j=0;j<seis.npts();++j)
+    for(int i=0;i<3;++i) seis.u(i,j)=static_cast<double>(i*1000+j);
+  seis.set_t0(0.0);
+  seis.set_dt(0.05);
+  seis.set_tref(TimeReferenceType::Relative);
+  seis.force_t0_shift(1.0e8);
+  seis.set_live();
+  load_common(seis,seis);
+  /* Appended after the TimeSeries to test reading from inside a buffer */
+  size_t n2=serialize_binary(seis,buf);
+  assert(buf.size()==n+n2);
+  Seismogram seis2=deserialize_Seismogram(buf.data()+n,n2,&nused);
+  assert(nused==n2);
+  assert(seis2.live());
+  assert(seis2.npts()==seis.npts());
+  assert(seis2.time_is_relative());
+  assert(seis2.shifted());
+  assert(seis2.time_reference()==1.0e8);
+  assert(seis2.cardinal()==seis.cardinal());
+  assert(seis2.orthogonal()==seis.orthogonal());
+  for(size_t j=0;j<seis.npts();++j)
+    for(int i=0;i<3;++i) assert(seis2.u(i,j)==seis.u(i,j));
+  compare_common(seis,seis2,seis,seis2);
+
+  cout << "Testing empty and dead data"<<endl;
+  TimeSeries empty;
+  vector<char> ebuf;
+  serialize_binary(empty,ebuf);
+  TimeSeries empty2=deserialize_TimeSeries(ebuf.data(),ebuf.size());
+  assert(empty2.dead());
+  assert(empty2.npts()==0);
+
+  cout << "Testing binary serialization of ensembles"<<endl;
+  LoggingEnsemble<TimeSeries> tse(5);
+  for(int k=0;k<5;++k)
+  {
+    TimeSeries d(ts);
+    for(size_t i=0;i<d.npts();++i) d.s[i] += k;
+    d.put_long("member",k);
+    if(k==2) d.kill();
+    tse.member.push_back(d);
+  }
+  tse.put("ensemble_key",string("test"));
+  tse.elog.log_error("ensemble","ensemble warning",ErrorSeverity::Complaint);
+  tse.set_live();
+  vector<char> ebuf0;
+  size_t ne=serialize_binary(tse,ebuf0);
+  /* The whole ensemble costs about the same as its members */
+  assert(ne<6*n);
+  LoggingEnsemble<TimeSeries> tse2=deserialize_TimeSeriesEnsemble(ebuf0.data(),
+    ebuf0.size(),&nused);
+  assert(nused==ne);
+  assert(tse2.live());
+  assert(tse2.get_string("ensemble_key")=="test");
+  assert(tse2.elog.size()==1);
+  assert(tse2.member.size()==5);
+  for(int k=0;k<5;++k)
+  {
+    assert(tse2.member[k].get_long("member")==k);
+    assert(tse2.member[k].s==tse.member[k].s);
+    assert(tse2.member[k].live()==(k!=2));
+    compare_common(tse.member[k],tse2.member[k],tse.member[k],tse2.member[k]);
+  }
+  LoggingEnsemble<Seismogram> se;
+  se.member.push_back(seis);
+  se.member.push_back(seis);
+  se.kill();
+  ebuf0.clear();
+  serialize_binary(se,ebuf0);
+  LoggingEnsemble<Seismogram> se2=deserialize_SeismogramEnsemble(ebuf0.data(),ebuf0.size());
+  assert(se2.dead());
+  assert(se2.member.size()==2);
+  for(size_t j=0;j<seis.npts();++j)
+    for(int i=0;i<3;++i) assert(se2.member[1].u(i,j)==seis.u(i,j));
+  LoggingEnsemble<TimeSeries> tse3;
+  ebuf0.clear();
+  serialize_binary(tse3,ebuf0);
+  tse3=deserialize_TimeSeriesEnsemble(ebuf0.data(),ebuf0.size());
+  assert(tse3.member.size()==0);
+  assert(tse3.dead());
+  try{
+    deserialize_TimeSeriesEnsemble(ebuf0.data(),ebuf0.size()-1);
+    cerr << "Truncated ensemble was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+
+  cout << "Testing samples passed out-of-band"<<endl;
+  vector<char> obuf;
+  size_t no=serialize_binary(ts,obuf,true);
+  assert(no+sizeof(double)*ts.npts()==n);
+  TimeSeries ts3;
+  deserialize_binary(obuf.data(),obuf.size(),ts3,&nused,sample_buffer(ts));
+  assert(nused==no);
+  assert(ts3.s==ts.s);
+  compare_common(ts,ts3,ts,ts3);
+  obuf.clear();
+  serialize_binary(seis,obuf,true);
+  Seismogram seis3;
+  deserialize_binary(obuf.data(),obuf.size(),seis3,NULL,sample_buffer(seis));
+  for(size_t j=0;j<seis.npts();++j)
+    for(int i=0;i<3;++i) assert(seis3.u(i,j)==seis.u(i,j));
+  try{
+    deserialize_Seismogram(obuf.data(),obuf.size());
+    cerr << "Missing out-of-band samples were not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  try{
+    deserialize_binary(obuf.data(),obuf.size(),seis3,NULL,sample_buffer(ts));
+    cerr << "Wrong size of out-of-band samples was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  obuf.clear();
+  serialize_binary(tse,obuf,true);
+  vector<SampleBufferView> tsamples;
+  for(auto& d : tse.member) tsamples.push_back(sample_buffer(d));
+  LoggingEnsemble<TimeSeries> tse4=deserialize_TimeSeriesEnsemble(obuf.data(),
+    obuf.size(),NULL,tsamples);
+  assert(tse4.member.size()==5);
+  for(int k=0;k<5;++k) assert(tse4.member[k].s==tse.member[k].s);
+  tsamples.pop_back();
+  try{
+    deserialize_TimeSeriesEnsemble(obuf.data(),obuf.size(),NULL,tsamples);
+    cerr << "Missing ensemble member samples were not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+
+  cout << "Testing Metadata block with more than 8 entries"<<endl;
+  Metadata mdl;
+  for(int k=0;k<20;++k) mdl.put_long("key"+to_string(k),k);
+  mdl.clear_modified();
+  mdl.put_long("key3",-3);
+  mdl.put_long("key17",-17);
+  /* change_key leaves key9 marked as changed but not defined */
+  mdl.put_long("key9",9);
+  mdl.change_key("key9","renamed");
+  vector<char> mbuf;
+  BinaryOArchive oar(mbuf);
+  serialize_metadata_binary(mdl,oar);
+  Metadata mdl2;
+  BinaryIArchive iar(mbuf.data(),mbuf.size());
+  restore_metadata_binary(iar,mdl2);
+  assert(iar.remaining()==0);
+  assert(mdl2.keys()==mdl.keys());
+  assert(mdl2.modified()==mdl.modified());
+  assert(mdl2.modified().count("key9")==1);
+  assert(mdl2.get_long("key17")==-17);
+  assert(mdl2.get_long("renamed")==9);
+
+  cout << "Testing arrow export and import of ensembles"<<endl;
+  LoggingEnsemble<TimeSeries> ate(tse);
+  ate.member[1].put_int("member",1);
+  ate.member[3].erase("sta");
+  ate.member[4].ator(1.0e9+2.0);
+  ArrowSchema aschema;
+  ArrowArray aarray;
+  export_to_arrow(ate,&aschema,&aarray);
+  assert(string(aschema.format)=="+s");
+  assert(aarray.length==5);
+  LoggingEnsemble<TimeSeries> ate2=import_from_arrow(&aschema,&aarray);
+  assert(ate2.live());
+  assert(ate2.get_string("ensemble_key")=="test");
+  assert(ate2.member.size()==ate.member.size());
+  for(size_t k=0;k<ate.member.size();++k)
+  {
+    const TimeSeries& a=ate.member[k];
+    const TimeSeries& b=ate2.member[k];
+    assert(a.live()==b.live());
+    assert(a.s==b.s);
+    assert(a.t0()==b.t0());
+    assert(a.dt()==b.dt());
+    assert(a.time_is_UTC()==b.time_is_UTC());
+    assert(a.shifted()==b.shifted());
+    /* int and long values share one int64 column */
+    assert(b.get_long("member")==static_cast<long>(k));
+    assert(b.is_defined("sta")==(k!=3));
+    assert(b.get<float>("fval")==1.5);
+    assert(b.get_bool("flag"));
+  }
+  assert(ate2.member[4].time_reference()==1.0e9+2.0);
+  /* A slice of the record batch is an offset into the same buffers */
+  aarray.offset=2;
+  aarray.length=2;
+  LoggingEnsemble<TimeSeries> ate3=import_from_arrow(&aschema,&aarray);
+  assert(ate3.member.size()==2);
+  assert(ate3.member[0].dead());
+  assert(ate3.member[1].s==ate.member[3].s);
+  assert(!ate3.member[1].is_defined("sta"));
+  /* Corrupt schema metadata must throw instead of reading past the field */
+  const char *goodmd=aschema.metadata;
+  int32_t badmd[3]={1,-5,0};
+  aschema.metadata=reinterpret_cast<const char*>(badmd);
+  try{
+    import_from_arrow(&aschema,&aarray);
+    cerr << "Negative schema metadata length was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  badmd[1]=numeric_limits<int32_t>::max();
+  try{
+    import_from_arrow(&aschema,&aarray);
+    cerr << "Schema metadata length past the end of the field was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  aschema.metadata=goodmd;
+  aschema.release(&aschema);
+  aarray.release(&aarray);
+  assert(aschema.release==NULL && aarray.release==NULL);
+  ate.member[0].put("member",string("zero"));
+  try{
+    export_to_arrow(ate,&aschema,&aarray);
+    cerr << "Incompatible column types were not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  ate.member[0].put_long("member",0);
+  ate.member[0].put("utc",true);
+  try{
+    export_to_arrow(ate,&aschema,&aarray);
+    cerr << "Reserved column name was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+
+  cout << "Testing error handling"<<endl;
+  try{
+    deserialize_Seismogram(buf.data(),n);
+    cerr << "Type mismatch was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  try{
+    deserialize_TimeSeries(buf.data(),n-1);
+    cerr << "Truncated buffer was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  vector<char> bad(buf.begin(),buf.begin()+n);
+  bad[0]='X';
+  try{
+    deserialize_TimeSeries(bad.data(),bad.size());
+    cerr << "Bad magic string was not detected"<<endl;
+    exit(-1);
+  }catch(MsPASSError& err)
+  {
+    cout << "Caught expected error:  "<<err.what()<<endl;
+  }
+  cout << "All tests passed"<<endl;
+}
@@ -79,7 +79,7 @@ int main(int argc, char **argv)
   iret=tfront.apply(seis1);
   cout << "Seismogram apply method completed returning "<<iret<<endl;
   if(iret!=0) print_error_log(seis1.elog);
-  tsout.push_back(ts1.s);
+  tsout.push_back(ts1.s.as_vector());
   seisout.push_back(seis1.u);
   cout << "Trying linear tail mute taper"<<endl;
   LinearTaper tback(-20.0,-30.0,150.0,180.0);
@@ -91,7 +91,7 @@ int main(int argc, char **argv)
   iret=tback.apply(seis2);
   cout << "Seismogram apply method completed returning "<<iret<<endl;
   if(iret!=0) print_error_log(seis2.elog);
-  tsout.push_back(ts2.s);
+  tsout.push_back(ts2.s.as_vector());
   seisout.push_back(seis2.u);
   cout << "Trying full linear taper"<<endl;
   LinearTaper tfull(10.0,25.0,150.0,180.0);
@@ -103,7 +103,7 @@ int main(int argc, char **argv)
   iret=tfull.apply(seis3);
   cout << "Seismogram apply method completed returning "<<iret<<endl;
   if(iret!=0) print_error_log(seis3.elog);
-  tsout.push_back(ts3.s);
+  tsout.push_back(ts3.s.as_vector());
   seisout.push_back(seis3.u);
   cout << "Intentional error to test error logging functions"<<endl;
   seis3.set_t0(10000.0);
@@ -139,7 +139,7 @@ int main(int argc, char **argv)
   iret=tcfront.apply(seis1);
   cout << "Seismogram apply method completed returning "<<iret<<endl;
   if(iret!=0) print_error_log(seis1.elog);
-  tsout.push_back(ts1.s);
+  tsout.push_back(ts1.s.as_vector());
   seisout.push_back(seis1.u);
   cout << "Trying cosine tail mute taper"<<endl;
   CosineTaper tcback(-20.0,-30.0,150.0,180.0);
@@ -151,7 +151,7 @@ int main(int argc, char **argv)
   iret=tcback.apply(seis2);
   cout << "Seismogram apply method completed returning "<<iret<<endl;
   if(iret!=0) print_error_log(seis2.elog);
-  tsout.push_back(ts2.s);
+  tsout.push_back(ts2.s.as_vector());
   seisout.push_back(seis2.u);
   cout << "Trying full CosineTaper taper"<<endl;
   CosineTaper tcfull(10.0,25.0,150.0,180.0);
@@ -163,7 +163,7 @@ int main(int argc, char **argv)
   iret=tcfull.apply(seis3);
   cout << "Seismogram apply method completed returning "<<iret<<endl;
   if(iret!=0) print_error_log(seis3.elog);
-  tsout.push_back(ts3.s);
+  tsout.push_back(ts3.s.as_vector());
   seisout.push_back(seis3.u);
   cout << "Intentional error to test error logging functions"<<endl;
   seis3.set_t0(10000.0);
@@ -481,6 +481,20 @@ int main(int argc, char **argv)
 		exit(-1);
 	}
 	cout << "Copy constructor for Seismogram passed all tests"<<endl;
+	cout << "Testing copy on write of Seismogram samples"<<endl;
+	Seismogram s7(s6);
+	const Seismogram& s6c(s6);
+	const Seismogram& s7c(s7);
+	/* Reading must not separate the copies */
+	assert(s7c.u.get_address(0,0)==s6c.u.get_address(0,0));
+	double s6val=s6c.u(0,0);
+	s7.u(0,0)=s6val+1.0;
+	assert(s7c.u.get_address(0,0)!=s6c.u.get_address(0,0));
+	assert(s6c.u(0,0)==s6val);
+	assert(s7c.u(0,0)==s6val+1.0);
+	s7*=2.0;
+	assert(s6c.u(0,0)==s6val);
+	cout << "Success"<<endl;
     }
     catch (MsPASSError&  serr)
     {
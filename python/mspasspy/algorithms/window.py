@@ -296,6 +296,7 @@ def WindowData(
     alg_name="scale",
     alg_id=None,
     dryrun=False,
+    view=False,
 ):
     """
     Cut data defined by a TimeWindow object.
@@ -335,6 +336,12 @@ def WindowData(
       Note this functionality is implemented via the mspass_func_wrapper decorator.
     :param dryrun:
       Note this functionality is implemented via the mspass_func_wrapper decorator.
+    :param view: when True the samples of the result are a view of the
+      samples of d instead of a copy.  The view is copied the first time
+      the result is changed.  It keeps all the samples of d in memory
+      until then.  Changes made to the samples of d through its data
+      attribute before that are seen by the view.  Default is False.
+    :type view: :class:`bool`
 
     :return: copy of d with sample range reduced to twin range.  Returns
       an empty version of the parent data type (default constructor) if
@@ -360,10 +367,10 @@ def WindowData(
             d.kill()
             return d
         if isinstance(d, TimeSeries):
-            dcut = _WindowData(d, twcut)
+            dcut = _WindowData(d, twcut, view)
             return dcut
         elif isinstance(d, Seismogram):
-            dcut = _WindowData3C(d, twcut)
+            dcut = _WindowData3C(d, twcut, view)
             return dcut
         else:
             raise RuntimeError(
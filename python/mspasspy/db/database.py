@@ -46,7 +46,16 @@ import json
 import base64
 import uuid
 
-from mspasspy.ccore.io import _mseed_file_indexer, _fwrite_to_file, _fread_from_file
+from mspasspy.ccore.io import (
+    _mseed_file_indexer,
+    _mseed_index_files,
+    _mseed_fread_from_file,
+    _fwrite_to_file,
+    _fread_from_file,
+    close_file_handle,
+    remove_lock_file,
+    SampleEncoding,
+)
 
 from mspasspy.ccore.seismic import (
     TimeSeries,
@@ -1069,6 +1078,7 @@ class Database(pymongo.database.Database):
         normalizing_collections=["channel", "site", "source"],
         alg_name="save_data",
         alg_id="0",
+        sample_encoding=None,
     ):
         """
         Standard method to save all seismic data objects to be managed by
@@ -1450,6 +1460,16 @@ class Database(pymongo.database.Database):
           be saved to the database if it was actually enabled in the workflow.
           If the history container is empty will silently do nothing.
           Default is False meaning history data is ignored.
+        :param sample_encoding:  optional encoding for native binary
+          sample data.  Must be one of "float64", "float32", "int32",
+          or "delta".  float32 and int32 halve the file size but are lossy.
+          "delta" is lossless and is very compact for integer valued
+          data (e.g. raw counts).   The encoding is saved in the
+          wf document with the key "sample_encoding" and readers
+          decode the data automatically.  Default is None which is the
+          same as "float64" (the original native format).  Ignored
+          unless storage_mode is "file" and format is binary.
+        :type sample_encoding:  :class:`str`
         :return: python dict of requested attributes by default.  Edited
           copy of input when return_data is True.
         """
@@ -1520,6 +1540,7 @@ class Database(pymongo.database.Database):
                 dfile=dfile,
                 format=format,
                 overwrite=overwrite,
+                sample_encoding=sample_encoding,
             )
             # ensembles need to loop over members to do the atomic operations
             # remaining.  Hence, this conditional
@@ -3643,7 +3664,12 @@ class Database(pymongo.database.Database):
             # delete this file
             if match_doc_cnt == 0:
                 fname = os.path.join(dir_name, dfile_name)
+                # a cached descriptor would keep writing to the removed file
+                close_file_handle(dir_name, dfile_name)
                 os.remove(fname)
+                # a stale lock file would make a new file of that name
+                # start at the old end of file
+                remove_lock_file(dir_name, dfile_name)
 
         # clear history
         if clear_history:
@@ -4231,6 +4257,39 @@ class Database(pymongo.database.Database):
                     )
                     raise MsPASSError(message.ErrorSeverity.Fatal) from merr
 
+        elif (
+            format == "mseed"
+            and isinstance(mspass_object, TimeSeries)
+            and nbytes > 0
+            and isinstance(merge_fill_value, (int, float))
+            and not isinstance(merge_fill_value, bool)
+            and merge_method == 0
+            and merge_interpolation_samples == 0
+        ):
+            # miniseed blocks defined by index_mseed_file are decoded in C++
+            # directly into the sample vector.  This avoids creating obspy
+            # Stream/Trace objects for every datum.  The C++ reader only
+            # reproduces obspy's merge with method 0 and a numeric
+            # fill_value.  Everything else, including the default None that
+            # leaves gaps masked, falls through to obspy below.
+            fill_value = float(merge_fill_value)
+            try:
+                count = _mseed_fread_from_file(
+                    mspass_object, dir, dfile, foff, nbytes, fill_value
+                )
+            except MsPASSError as merr:
+                message = "Database._read_data_from_dfile:  "
+                message += "C++ function _mseed_fread_from_file failed while reading miniseed data from file={}".format(
+                    dfile
+                )
+                raise MsPASSError(message, ErrorSeverity.Fatal) from merr
+            if count > 0:
+                mspass_object.set_live()
+            else:
+                message = "Error during read with format={}\n".format(format)
+                message += "Unable to reconstruct data vector"
+                mspass_object.elog.log_error(alg, message, ErrorSeverity.Invalid)
+                mspass_object.kill()
         else:
             fname = os.path.join(dir, dfile)
             with open(fname, mode="rb") as fh:
@@ -5623,6 +5682,102 @@ class Database(pymongo.database.Database):
         o["endtime"] = index_record.endtime
         return o
 
+    @staticmethod
+    def _check_mseed_file_found(elog):
+        """
+        Helper used by index_mseed_file and index_mseed_files to
+        raise FileNotFoundError when the indexer could not open a file.
+
+        :param elog:  ErrorLogger returned by the C++ indexer.
+        """
+        if elog.size() > 0 and "No such file or directory" in str(
+            elog.get_error_log()
+        ):
+            raise FileNotFoundError(str(elog.get_error_log()))
+
+    def _mseed_index_to_docs(self, ind, odir, dfile, normalize_channel, verbose):
+        """
+        Helper used by index_mseed_file and index_mseed_files to convert
+        the index records of one file to documents for the wf_miniseed
+        collection.
+
+        :param ind:  list of mseed_index records for the file.
+        :param odir:  directory name to store (full path).
+        :param dfile:  file name to store.
+        :param normalize_channel:  when True set channel_id from
+          get_seed_channel.
+        :param verbose:  passed to get_seed_channel.
+        :return:  list of documents (not yet saved).
+        """
+        docs = []
+        for i in ind:
+            doc = self._convert_mseed_index(i)
+            doc["storage_mode"] = "file"
+            doc["format"] = "mseed"
+            doc["dir"] = odir
+            doc["dfile"] = dfile
+            # mseed is dogmatically UTC so we always set it this way
+            doc["time_standard"] = "UTC"
+            if normalize_channel:
+                if "loc" in doc:
+                    chandoc = self.get_seed_channel(
+                        doc["net"],
+                        doc["sta"],
+                        doc["chan"],
+                        doc["loc"],
+                        time=doc["starttime"],
+                        verbose=verbose,
+                    )
+                else:
+                    chandoc = self.get_seed_channel(
+                        doc["net"],
+                        doc["sta"],
+                        doc["chan"],
+                        time=doc["starttime"],
+                        verbose=verbose,
+                    )
+                if chandoc is not None:
+                    doc["channel_id"] = chandoc["_id"]
+            docs.append(doc)
+        return docs
+
+    def _save_mseed_elog(self, elog, ids_affected, elog_collection, odir, dfile):
+        """
+        Helper used by index_mseed_file and index_mseed_files to save the
+        error log the indexer returned for one file.
+
+        To mesh with the standard elog collection a copy of the error
+        messages is saved with a tag for each id in ids_affected.
+        That makes elog connection to wf_miniseed records exactly like
+        wf_TimeSeries records but with a different collection link.
+        Files that could not be read have no index documents so the log
+        is saved once with the dir and dfile of the file.
+
+        :return:  list of ids of the documents saved in elog_collection
+          (empty if the log was empty).
+        """
+        if elog.size() == 0:
+            return []
+        jobid = elog.get_job_id()
+        logdata = []
+        for x in elog.get_error_log():
+            logdata.append(
+                {
+                    "job_id": jobid,
+                    "algorithm": x.algorithm,
+                    "badness": str(x.badness),
+                    "error_message": x.message,
+                    "process_id": x.p_id,
+                }
+            )
+        if len(ids_affected) > 0:
+            elog_docs = [
+                {"logdata": logdata, "wf_miniseed_id": wfid} for wfid in ids_affected
+            ]
+        else:
+            elog_docs = [{"logdata": logdata, "dir": odir, "dfile": dfile}]
+        return self[elog_collection].insert_many(elog_docs).inserted_ids
+
     def index_mseed_file(
         self,
         dfile,
@@ -5757,70 +5912,105 @@ class Database(pymongo.database.Database):
         # TODO:  should have a way to pass verbose to this function
         # present verbose is not appropriate.
         (ind, elog) = _mseed_file_indexer(fname, segment_time_tears)
-        if len(elog.get_error_log()) > 0 and "No such file or directory" in str(
-            elog.get_error_log()
-        ):
-            raise FileNotFoundError(str(elog.get_error_log()))
+        self._check_mseed_file_found(elog)
+        docs = self._mseed_index_to_docs(ind, odir, dfile, normalize_channel, verbose)
         ids_affected = []
-        for i in ind:
-            doc = self._convert_mseed_index(i)
-            doc["storage_mode"] = "file"
-            doc["format"] = "mseed"
-            doc["dir"] = odir
-            doc["dfile"] = dfile
-            # mseed is dogmatically UTC so we always set it this way
-            doc["time_standard"] = "UTC"
-            thisid = dbh.insert_one(doc).inserted_id
-            ids_affected.append(thisid)
-        if normalize_channel:
-            # these quantities are always defined unless there was a read error
-            # and I don't think we can get here if we had a read error.
-            net = doc["net"]
-            sta = doc["sta"]
-            chan = doc["chan"]
-            stime = doc["starttime"]
-            if "loc" in doc:
-                loc = doc["loc"]
-                chandoc = self.get_seed_channel(
-                    net, sta, chan, loc, time=stime, verbose=False
-                )
-            else:
-                chandoc = self.get_seed_channel(
-                    net, sta, chan, time=stime, verbose=False
-                )
-            if chandoc != None:
-                doc["channel_id"] = chandoc["_id"]
+        if len(docs) > 0:
+            ids_affected = dbh.insert_many(docs).inserted_ids
+        # log_ids is defined but empty in the tuple returned when
+        # return_ids is true and the log was empty
+        log_ids = self._save_mseed_elog(
+            elog, ids_affected, elog_collection, odir, dfile
+        )
+        if return_ids:
+            return [ids_affected, log_ids]
+        else:
+            return None
 
-        # log_ids is created here so it is defined but empty in
-        # the tuple returned when return_ids is true
+    def index_mseed_files(
+        self,
+        dfiles,
+        dir=None,
+        collection="wf_miniseed",
+        segment_time_tears=True,
+        elog_collection="elog",
+        return_ids=False,
+        normalize_channel=False,
+        verbose=False,
+        nthreads=1,
+        use_cache=True,
+        cache_dir=None,
+    ):
+        """
+        Index a list of miniseed files with parallel threads.
+
+        This is an alternative to calling `index_mseed_file` in a loop
+        for a large archive.  The files are scanned by a pool of
+        threads in C++ and the index for each file is cached in a small
+        binary "sidecar" file keyed by the size and modification time
+        of the data file.   Reindexing an unchanged archive only
+        reads the sidecar files so it is nearly instant.  The documents
+        saved are identical to those created by `index_mseed_file`.
+
+        :param dfiles:  list of file names to index.  Like `index_mseed_file`
+          these are assumed to be leaf names in the directory dir.
+        :param dir:  directory containing the files.   Default is the
+          current directory.
+        :param collection:  collection for the index documents.
+          Default is "wf_miniseed".
+        :param segment_time_tears:  see `index_mseed_file`.  Default is True.
+        :param elog_collection:  collection for error log messages.
+          Default is "elog".
+        :param return_ids:  see `index_mseed_file`.  When True the ids of
+          all files are returned in the same two list form.
+        :param normalize_channel:  see `index_mseed_file`.  Default is False.
+        :param verbose:  see `index_mseed_file`.  Default is False.
+        :param nthreads:  number of threads used to scan files.  Default is 1.
+        :param use_cache:  when False the sidecar files are neither
+          read nor written.   Default is True.
+        :param cache_dir:  directory for sidecar files.  Default is None
+          which puts each sidecar next to its data file with the suffix
+          ".msidx".  Set this for read only archives.
+        :return:  None unless return_ids is True.  Then a list of two
+          lists with the ids of the index documents and of the elog
+          documents saved.
+        :exception: FileNotFoundError is raised if any of the files
+          does not exist.  Nothing is saved in that case.
+        """
+        if dir is None:
+            odir = os.getcwd()
+        else:
+            odir = os.path.abspath(dir)
+        if cache_dir is None:
+            cache_dir = ""
+        else:
+            cache_dir = os.path.abspath(cache_dir)
+        fnames = [os.path.join(odir, dfile) for dfile in dfiles]
+        results = _mseed_index_files(
+            fnames,
+            nthreads=nthreads,
+            segment=segment_time_tears,
+            use_cache=use_cache,
+            cache_dir=cache_dir,
+        )
+        for ind, elog in results:
+            self._check_mseed_file_found(elog)
+        dbh = self[collection]
+        ids = []
         log_ids = []
-        if elog.size() > 0:
-            elog_col = self[elog_collection]
-
-            errs = elog.get_error_log()
-            jobid = elog.get_job_id()
-            logdata = []
-            for x in errs:
-                logdata.append(
-                    {
-                        "job_id": jobid,
-                        "algorithm": x.algorithm,
-                        "badness": str(x.badness),
-                        "error_message": x.message,
-                        "process_id": x.p_id,
-                    }
-                )
-            docentry = {"logdata": logdata}
-            # To mesh with the standard elog collection we add a copy of the
-            # error messages with a tag for each id in the ids_affected list.
-            # That should make elog connection to wf_miniseed records exactly
-            # like wf_TimeSeries records but with a different collection link
-            for wfid in ids_affected:
-                docentry["wf_miniseed_id"] = wfid
-                elogid = elog_col.insert_one(docentry).inserted_id
-                log_ids.append(elogid)
+        for dfile, (ind, elog) in zip(dfiles, results):
+            docs = self._mseed_index_to_docs(
+                ind, odir, dfile, normalize_channel, verbose
+            )
+            ids_affected = []
+            if len(docs) > 0:
+                ids_affected = dbh.insert_many(docs).inserted_ids
+                ids += ids_affected
+            log_ids += self._save_mseed_elog(
+                elog, ids_affected, elog_collection, odir, dfile
+            )
         if return_ids:
-            return [ids_affected, log_ids]
+            return [ids, log_ids]
         else:
             return None
 
@@ -6038,6 +6228,7 @@ class Database(pymongo.database.Database):
         dfile=None,
         format=None,
         overwrite=False,
+        sample_encoding=None,
     ):
         """
         Function to save sample data arrays for any MsPASS data objects.
@@ -6117,6 +6308,10 @@ class Database(pymongo.database.Database):
           the function alway only appends data recording foff of the start
           position of the write. (Ignored when storage_mode == "gridfs")
 
+        :param sample_encoding:  encoding name for binary sample data.
+          See `_save_sample_data_to_file`.  (Ignored when storage_mode == "gridfs")
+        :type sample_encoding:  string or None
+
         :exception:
         1) will raise a TypeError if mspass_object is not a mspass seismic
         data object (atomic or ensmebles).   That shouldnt' normally happen
@@ -6141,6 +6336,7 @@ class Database(pymongo.database.Database):
                     dfile,
                     format,
                     overwrite,
+                    sample_encoding,
                 )
             elif storage_mode == "gridfs":
                 mspass_object = self._save_sample_data_to_gridfs(
@@ -6166,6 +6362,7 @@ class Database(pymongo.database.Database):
         dfile=None,
         format=None,
         overwrite=False,
+        sample_encoding=None,
     ):
         """
         Private method to write sample data to a file.  Default is binary
@@ -6259,6 +6456,14 @@ class Database(pymongo.database.Database):
           Be especially aware that with this option you can clobber files
           needec by other docs to reconstruct data.
 
+        :param sample_encoding:  name of the encoding used for binary
+          output.  Must be one of "float64", "float32", "int32", or "delta".
+          Default is None which writes raw 8 byte floats (same as "float64").
+          Encoded writes set the "sample_encoding" attribute (plus
+          "sample_scale" for int32 and "nbytes" for delta) that readers
+          use to decode the data.   Ignored for formatted output.
+        :type sample_encoding:  string or None
+
         :return:  copy of the input with Metadata modified to contain all
         data required to reconstruct the object from the stored sample data.
 
@@ -6268,6 +6473,14 @@ class Database(pymongo.database.Database):
             return mspass_object
         if format is None:
             format = "binary"
+        encoding = None
+        if sample_encoding is not None and format == "binary":
+            if sample_encoding not in SampleEncoding.__members__:
+                raise ValueError(
+                    "Database._save_sample_data_to_file:  "
+                    + "illegal value for sample_encoding={}".format(sample_encoding)
+                )
+            encoding = SampleEncoding.__members__[sample_encoding]
 
         if dir is None:
             if mspass_object.is_defined("dir"):
@@ -6317,7 +6530,10 @@ class Database(pymongo.database.Database):
                 # because C implementation uses fwrite that is known
                 # to be thread save (automatic locking unless forced off)
                 try:
-                    foff = _fwrite_to_file(mspass_object, dir, dfile)
+                    if encoding is None:
+                        foff = _fwrite_to_file(mspass_object, dir, dfile)
+                    else:
+                        foff = _fwrite_to_file(mspass_object, dir, dfile, encoding)
                 except MsPASSError as merr:
                     mspass_object.elog.log_error(merr)
                     mspass_object.kill()
@@ -6325,11 +6541,19 @@ class Database(pymongo.database.Database):
                     # call this method with a datum already marked dead
                     return mspass_object
                 # we can compute the number of bytes written for this case
-                if isinstance(mspass_object, TimeSeries):
-                    nbytes_written = 8 * mspass_object.npts
+                # except for delta encoded data where the writer sets nbytes
+                if encoding == SampleEncoding.delta:
+                    nbytes_written = mspass_object["nbytes"]
                 else:
-                    # This can only be a Seismogram currently so this is not elif
-                    nbytes_written = 24 * mspass_object.npts
+                    if encoding in (SampleEncoding.float32, SampleEncoding.int32):
+                        bytes_per_sample = 4
+                    else:
+                        bytes_per_sample = 8
+                    if isinstance(mspass_object, TimeSeries):
+                        nbytes_written = bytes_per_sample * mspass_object.npts
+                    else:
+                        # This can only be a Seismogram currently
+                        nbytes_written = 3 * bytes_per_sample * mspass_object.npts
             else:
                 with open(fname, mode="a+b") as fh:
                     # this applies a unix lock - only works in linux
@@ -6380,7 +6604,12 @@ class Database(pymongo.database.Database):
             if format == "binary":
                 try:
                     # this works because pytbin11 support overloading
-                    foff_list = _fwrite_to_file(mspass_object, dir, dfile)
+                    if encoding is None:
+                        foff_list = _fwrite_to_file(mspass_object, dir, dfile)
+                    else:
+                        foff_list = _fwrite_to_file(
+                            mspass_object, dir, dfile, encoding
+                        )
                 except MsPASSError as merr:
                     mspass_object.elog.log_error(merr)
                     mspass_object.kill()
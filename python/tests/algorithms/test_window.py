@@ -10,6 +10,7 @@ import numpy as np
 import pytest
 
 from mspasspy.ccore.seismic import (
+    DoubleVector,
     TimeReferenceType,
     _CoreTimeSeries,
     _CoreSeismogram,
@@ -201,6 +202,22 @@ def test_scale():
         assert np.isclose(amp, 800.0)
 
 
+def test_RMSAmplitude_range():
+    # squares of these amplitudes overflow or underflow a double
+    for a in [1.0e200, 1.0e-200]:
+        dts = _CoreTimeSeries(9)
+        setbasics(dts, 9)
+        for i in range(9):
+            dts.data[i] = a if i % 2 == 0 else -a
+        assert np.isclose(RMSAmplitude(dts), a, rtol=1.0e-12, atol=0.0)
+        d3c = _CoreSeismogram(5)
+        setbasics(d3c, 5)
+        for k in range(3):
+            for i in range(5):
+                d3c.data[k, i] = a
+        assert np.isclose(RMSAmplitude(d3c), np.sqrt(3.0) * a, rtol=1.0e-12, atol=0.0)
+
+
 def test_windowdata():
     npts = 1000
     ts = TimeSeries()
@@ -227,6 +244,33 @@ def test_windowdata():
     assert d.data.columns() == 101
     assert d.t0 == 2.0
     assert d.endtime() == 3.0
+    print("testing view mode")
+    dcopy = WindowData(ts, 2, 3)
+    dview = WindowData(ts, 2, 3, view=True)
+    assert dview.npts == 101
+    assert dview.t0 == 2.0
+    assert np.allclose(dview.data, dcopy.data)
+    # changing the view must not change the parent
+    dview.data[0] = -1.0
+    assert ts.data[200] == 200.0
+    assert dcopy.data[0] == 200.0
+    # ts.data was used from python so the view shares the samples of an
+    # exclusive parent and sees changes made to the parent afterward
+    dview = WindowData(ts, 2, 3, view=True)
+    ts.data[201] = -2.0
+    assert dview.data[1] == -2.0
+    ts.data[201] = 201.0
+    # assigning new samples to a view must replace the view range
+    dview = WindowData(ts, 2, 3, view=True)
+    dview.data = DoubleVector([7.0, 8.0])
+    assert len(dview.data) == 2
+    assert dview.data[0] == 7.0 and dview.data[1] == 8.0
+    d3c = WindowData(t3c, 2, 3)
+    d3cview = WindowData(t3c, 2, 3, view=True)
+    assert d3cview.data.columns() == 101
+    assert np.allclose(np.array(d3cview.data), np.array(d3c.data))
+    d3cview.data[0, 0] = -1.0
+    assert t3c.data[0, 200] == 300.0
     print("testing error handling")
     t3c.kill()
     d = WindowData(t3c, 2, 3)
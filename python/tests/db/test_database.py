@@ -1591,6 +1591,28 @@ class TestDatabase:
             ts = self.db.read_data(doc, collection="wf_miniseed")
             assert ts.npts == len(ts.data)
 
+    def test_index_mseed_files(self):
+        dir = "python/tests/data/"
+        ret = self.db.index_mseed_files(
+            ["3channels.mseed"],
+            dir=dir,
+            collection="wf_miniseed_files",
+            use_cache=False,
+            return_ids=True,
+        )
+        assert len(ret[0]) == 3
+        assert self.db["wf_miniseed_files"].count_documents({}) == 3
+        with pytest.raises(FileNotFoundError):
+            self.db.index_mseed_files(
+                ["3channels.mseed", "not_a_file.mseed"],
+                dir=dir,
+                collection="wf_miniseed_files",
+                use_cache=False,
+            )
+        # nothing is saved when any file is missing
+        assert self.db["wf_miniseed_files"].count_documents({}) == 3
+        self.db.drop_collection("wf_miniseed_files")
+
     def test_delete_wf(self):
         # clear all the wf collection documents
         # self.db['wf_TimeSeries'].delete_many({})
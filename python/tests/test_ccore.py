@@ -504,6 +504,15 @@ def test_TimeSeries():
         ts.data[i] = i * 0.5
     ts_copy = pickle.loads(pickle.dumps(ts))
     assert ts.data == ts_copy.data
+    # protocol 5 passes the samples as out-of-band buffers
+    buffers = []
+    ts_pickle = pickle.dumps(ts, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == 1
+    assert len(ts_pickle) < 8 * ts.npts
+    ts_copy = pickle.loads(ts_pickle, buffers=buffers)
+    assert ts.data == ts_copy.data
+    ts_copy = pickle.loads(pickle.dumps(ts, protocol=5))
+    assert ts.data == ts_copy.data
     assert ts.data[3] == 1.5
     assert ts.data[103] == 8
     assert ts.time(100) == 0.1
@@ -643,6 +652,13 @@ def test_Seismogram():
     assert seis_copy.live == seis.live
     assert seis_copy.tref == seis.tref
     assert (seis_copy.data[:] == seis.data[:]).all()
+    buffers = []
+    seis_copy = pickle.loads(
+        pickle.dumps(seis, protocol=5, buffer_callback=buffers.append), buffers=buffers
+    )
+    assert len(buffers) == 1
+    assert seis_copy.t0 == seis.t0
+    assert (seis_copy.data[:] == seis.data[:]).all()
 
     # test the += operator
     seis1 = Seismogram(seis)
@@ -830,6 +846,62 @@ def test_Seismogram():
     assert memuse >= memlow and memuse <= memhigh
 
 
+def test_TimeSeriesEnsemble_arrow():
+    pa = pytest.importorskip("pyarrow")
+    es = TimeSeriesEnsemble(Metadata({"ensemble_key": "test"}), 3)
+    for i in range(3):
+        d = make_constant_data_ts(TimeSeries(10))
+        d.data[0] = float(i)
+        d["member"] = i
+        if i != 1:
+            d["sta"] = "AAK"
+        es.member.append(d)
+    es.member[2].kill()
+    es.set_live()
+    batch = es.to_arrow()
+    assert isinstance(batch, pa.RecordBatch)
+    assert batch.num_rows == 3
+    assert batch.column("member").to_pylist() == [0, 1, 2]
+    assert batch.column("sta").to_pylist() == ["AAK", None, "AAK"]
+    assert batch.column("live").to_pylist() == [True, True, False]
+    assert batch.column("samples")[1].as_py() == list(es.member[1].data)
+    for es2 in [
+        TimeSeriesEnsemble.from_arrow(batch),
+        TimeSeriesEnsemble.from_arrow(pa.Table.from_batches([batch])),
+    ]:
+        assert es2.live
+        assert es2["ensemble_key"] == "test"
+        assert len(es2.member) == 3
+        for i in range(3):
+            assert es2.member[i].live == es.member[i].live
+            assert es2.member[i].npts == es.member[i].npts
+            assert es2.member[i].dt == es.member[i].dt
+            assert es2.member[i].t0 == es.member[i].t0
+            assert np.array_equal(es2.member[i].data, es.member[i].data)
+            assert es2.member[i]["member"] == i
+        assert not es2.member[1].is_defined("sta")
+    # Data from other sources need only a samples column
+    table = pa.table({"samples": [[1.0, 2.0], [3.0]], "sta": ["A", "B"]})
+    es3 = TimeSeriesEnsemble.from_arrow(table)
+    assert es3.live
+    assert es3.member[1].npts == 1
+    assert es3.member[0]["sta"] == "A"
+    with pytest.raises(MsPASSError, match="samples"):
+        TimeSeriesEnsemble.from_arrow(pa.table({"sta": ["A"]}))
+    # No rows give an empty ensemble for a RecordBatch and a Table
+    empty = TimeSeriesEnsemble(Metadata({"ensemble_key": "test"}), 0)
+    empty.set_live()
+    empty_batch = empty.to_arrow()
+    assert empty_batch.num_rows == 0
+    for es4 in [
+        TimeSeriesEnsemble.from_arrow(empty_batch),
+        TimeSeriesEnsemble.from_arrow(pa.Table.from_batches([empty_batch])),
+        TimeSeriesEnsemble.from_arrow(pa.Table.from_batches([], schema=batch.schema)),
+    ]:
+        assert len(es4.member) == 0
+        assert es4["ensemble_key"] == "test"
+
+
 @pytest.fixture(params=[TimeSeriesEnsemble, SeismogramEnsemble])
 def Ensemble(request):
     return request.param
@@ -913,6 +985,14 @@ def test_Ensemble(Ensemble):
         assert es.member[1].data == escopy.member[1].data
     else:
         assert (es.member[1].data[:] == escopy.member[1].data[:]).all()
+    # Protocol 5 passes the member samples as out-of-band buffers
+    buffers = []
+    escopy = pickle.loads(
+        pickle.dumps(es, protocol=5, buffer_callback=buffers.append), buffers=buffers
+    )
+    assert len(buffers) == len(es.member)
+    for i in range(len(es.member)):
+        assert np.array_equal(escopy.member[i].data, es.member[i].data)
 
 
 def test_operators():